@@ -0,0 +1,107 @@
+#include "core/wob.hpp"
+#include "core/allocator.hpp"
+#include "core/sizeClassAllocator.hpp"
+#include "core/context.hpp"
+#include "core/array.hpp"
+#include "core/string.hpp"
+#include "core/hashmap.hpp"
+#include "core/slist.hpp"
+#include "core/time.hpp"
+
+using namespace wob;
+
+static uint32_t rngState = 0x9E3779B9u;
+
+// xorshift32, deterministic so every allocator replay the same sequence
+static uint32_t nextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+static uint32_t randomRange(uint32_t min, uint32_t max)
+{
+	return min + nextRandom() % (max - min + 1);
+}
+
+// roughly the engine mix : mostly small nodes and strings, some buffers, few big blocks
+static size_t randomSize()
+{
+	uint32_t const r = nextRandom() % 100;
+	if (r < 50)
+		return randomRange(16, 64);
+	if (r < 80)
+		return randomRange(64, 1024);
+	if (r < 95)
+		return randomRange(1024, 8192);
+	return randomRange(8192, 1024 * 1024);
+}
+
+static double benchMix(IAllocator& allocator, uint32_t n)
+{
+	constexpr uint32_t liveSlots = 4096;
+	void* live[liveSlots] = {};
+
+	rngState = 0x9E3779B9u;
+	long long const t0 = getPerfCount();
+	for (uint32_t i = 0; i < n; i++)
+	{
+		uint32_t const slot = nextRandom() % liveSlots;
+		allocator.deallocate(live[slot]);
+		size_t const size = randomSize();
+		live[slot] = allocator.allocate(size, alignof(max_align_t));
+		static_cast<uint8_t*>(live[slot])[0] = (uint8_t)i;
+	}
+
+	for (void* ptr : live)
+		allocator.deallocate(ptr);
+	return perfCountToMs(t0, getPerfCount());
+}
+
+static double benchContainers(IAllocator& allocator, uint32_t n)
+{
+	IAllocator* const previous = context.allocator;
+	context.allocator = &allocator;
+
+	long long const t0 = getPerfCount();
+	for (uint32_t frame = 0; frame < n; frame++)
+	{
+		Array<uint32_t> indices;
+		for (uint32_t i = 0; i < 256; i++)
+			indices.push(i);
+
+		HashMap<uint32_t, String> names;
+		SList<uint32_t> nodes;
+		for (uint32_t i = 0; i < 64; i++)
+		{
+			names.add(i, String("entity_with_a_long_enough_name"));
+			nodes.add(uint32_t(i));
+		}
+	}
+	double const ms = perfCountToMs(t0, getPerfCount());
+
+	context.allocator = previous;
+	return ms;
+}
+
+int main()
+{
+	SizeClassAllocator& sizeClass = getSizeClassAllocator();
+
+	uint32_t const counts[] = { 100'000, 1'000'000, 10'000'000 };
+	for (uint32_t n : counts)
+	{
+		printf("mix        n=%-9u malloc %9.2f ms | size class %9.2f ms\n", n,
+			benchMix(mallocator, n), benchMix(sizeClass, n));
+	}
+
+	uint32_t const frames[] = { 1'000, 10'000 };
+	for (uint32_t n : frames)
+	{
+		printf("containers n=%-9u malloc %9.2f ms | size class %9.2f ms\n", n,
+			benchContainers(mallocator, n), benchContainers(sizeClass, n));
+	}
+	return 0;
+}
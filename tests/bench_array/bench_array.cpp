@@ -0,0 +1,97 @@
+#include "core/wob.hpp"
+#include "core/array.hpp"
+#include "core/arrayView.hpp"
+#include "core/time.hpp"
+
+using namespace wob;
+
+// same layout as Draw2D::Vertex
+struct PodVertex
+{
+	float x, y;
+	float r, g, b, a;
+	float u, v;
+};
+
+// same data with user provided copy / move, takes the element by element paths
+struct NonPodVertex
+{
+	NonPodVertex() = default;
+	NonPodVertex(PodVertex const& v) : data(v) {}
+	NonPodVertex(NonPodVertex const& rhs) : data(rhs.data) {}
+	NonPodVertex(NonPodVertex&& rhs) noexcept : data(rhs.data) {}
+	NonPodVertex& operator=(NonPodVertex const& rhs) { data = rhs.data; return *this; }
+	~NonPodVertex() {}
+
+	PodVertex data;
+};
+
+static PodVertex makeVertex(uint32_t i)
+{
+	float const f = (float)i;
+	return { f, f, 1.0f, 1.0f, 1.0f, 1.0f, f, f };
+}
+
+template<typename T>
+static void benchArray(const char* name, uint32_t n, uint32_t repeat)
+{
+	Array<T> source;
+	source.reserve(n);
+	for (uint32_t i = 0; i < n; i++)
+		source.push(T(makeVertex(i)));
+
+	float checksum = 0.0f;
+
+	// push with geometric growth from an empty array
+	long long const t0 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		Array<T> arr;
+		for (uint32_t i = 0; i < n; i++)
+			arr.push(source[i]);
+		checksum += reinterpret_cast<PodVertex const&>(arr.back()).x;
+	}
+
+	// bulk append of the whole source
+	long long const t1 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		Array<T> arr;
+		arr.append(ArrayView<T const>(source.data(), source.size()));
+		checksum += reinterpret_cast<PodVertex const&>(arr.back()).x;
+	}
+
+	// copy construction
+	long long const t2 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		Array<T> arr(source);
+		checksum += reinterpret_cast<PodVertex const&>(arr.back()).x;
+	}
+
+	// grow a full array, every reserve relocate the content
+	long long const t3 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		Array<T> arr(source);
+		for (uint32_t capacity = n * 2; capacity <= n * 16; capacity *= 2)
+			arr.reserve(capacity);
+		checksum += reinterpret_cast<PodVertex const&>(arr.back()).x;
+	}
+	long long const t4 = getPerfCount();
+
+	printf("%-8s n=%-8u push %8.2f ms | append %8.2f ms | copy %8.2f ms | grow %8.2f ms (%f)\n", name, n,
+		perfCountToMs(t0, t1), perfCountToMs(t1, t2), perfCountToMs(t2, t3), perfCountToMs(t3, t4), checksum);
+}
+
+int main()
+{
+	uint32_t const counts[] = { 1'000, 100'000, 1'000'000 };
+	for (uint32_t n : counts)
+	{
+		uint32_t const repeat = 100'000'000 / (n * 100) + 1;
+		benchArray<PodVertex>("pod", n, repeat);
+		benchArray<NonPodVertex>("non pod", n, repeat);
+	}
+	return 0;
+}
@@ -0,0 +1,75 @@
+#include "core/wob.hpp"
+#include "core/floatToChars.hpp"
+#include "core/dragon4.hpp"
+#include "core/array.hpp"
+#include "core/time.hpp"
+
+using namespace wob;
+
+static uint64_t rngState = 0x9E3779B97F4A7C15ull;
+
+static uint64_t nextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 7;
+	rngState ^= rngState << 17;
+	return rngState;
+}
+
+template<typename T>
+static void benchFloats(const char* name, Array<T> const& values)
+{
+	char buffer[64];
+	uint64_t checksum = 0;
+
+	long long const t0 = getPerfCount();
+	for (T v : values)
+	{
+		if constexpr (sizeof(T) == sizeof(float))
+			checksum += d4::PrintFloat32(buffer, sizeof(buffer), v, d4::PrintFloatFormat_Positional, -1);
+		else
+			checksum += d4::PrintFloat64(buffer, sizeof(buffer), v, d4::PrintFloatFormat_Positional, -1);
+	}
+
+	long long const t1 = getPerfCount();
+	for (T v : values)
+		checksum += floatToChars(buffer, v);
+
+	long long const t2 = getPerfCount();
+	for (T v : values)
+		checksum += snprintf(buffer, sizeof(buffer), "%.17g", (double)v);
+	long long const t3 = getPerfCount();
+
+	double const n = (double)values.size();
+	printf("%-22s dragon4 %7.1f ns | floatToChars %7.1f ns | snprintf %%.17g %7.1f ns (%llu)\n", name,
+		perfCountToMs(t0, t1) * 1e6 / n, perfCountToMs(t1, t2) * 1e6 / n, perfCountToMs(t2, t3) * 1e6 / n,
+		(unsigned long long)checksum);
+}
+
+int main()
+{
+	uint32_t const count = 1'000'000;
+
+	// what shaders and logs print : positions, colors, uvs
+	Array<float> gameplay;
+	for (uint32_t i = 0; i < count; i++)
+		gameplay.push((float)(int32_t)(nextRandom() % 2'000'000 - 1'000'000) / 1000.0f);
+
+	Array<float> floatBits;
+	Array<double> doubleBits;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t const bits32 = (uint32_t)nextRandom();
+		uint64_t const bits64 = nextRandom();
+		// keep finite values in the positional range so Dragon4 output fits its buffer
+		float const f = __builtin_bit_cast(float, bits32);
+		double const d = __builtin_bit_cast(double, bits64);
+		floatBits.push(f == f && f > -1e15f && f < 1e15f ? f : 1.5f);
+		doubleBits.push(d == d && d > -1e15 && d < 1e15 ? d : 1.5);
+	}
+
+	benchFloats("float [-1000, 1000]", gameplay);
+	benchFloats("float random bits", floatBits);
+	benchFloats("double random bits", doubleBits);
+	return 0;
+}
@@ -0,0 +1,50 @@
+#include "core/wob.hpp"
+#include "core/format.hpp"
+#include "core/stringBuilder.hpp"
+#include "core/time.hpp"
+
+using namespace wob;
+
+// typical log line : a few integers, a name and a float
+int main()
+{
+	uint32_t const iterations = 1'000'000;
+	uint64_t checksum = 0;
+
+	long long const t0 = getPerfCount();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		char buffer[128];
+		int const n = snprintf(buffer, sizeof(buffer), "entity %u at %d x %d : %s", i, (int)i * 3, -(int)i, "player_spawn");
+		checksum += n;
+	}
+
+	long long const t1 = getPerfCount();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		char buffer[128];
+		checksum += formatTo(buffer, sizeof(buffer), "entity {} at {} x {} : {}", i, (int)i * 3, -(int)i, "player_spawn");
+	}
+
+	long long const t2 = getPerfCount();
+	char storage[128];
+	StringBuilder builder(storage);
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		builder.clear();
+		formatTo(builder, "entity {} at {} x {} : {}", i, (int)i * 3, -(int)i, "player_spawn");
+		checksum += builder.size();
+	}
+
+	long long const t3 = getPerfCount();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		String const str = format("entity {} at {} x {} : {}", i, (int)i * 3, -(int)i, "player_spawn");
+		checksum += str.size();
+	}
+	long long const t4 = getPerfCount();
+
+	printf("snprintf %.2f ms | formatTo buffer %.2f ms | formatTo builder %.2f ms | format String %.2f ms (%llu)\n",
+		perfCountToMs(t0, t1), perfCountToMs(t1, t2), perfCountToMs(t2, t3), perfCountToMs(t3, t4), (unsigned long long)checksum);
+	return 0;
+}
@@ -0,0 +1,116 @@
+#include "core/wob.hpp"
+#include "core/hashmap.hpp"
+#include "core/slist.hpp"
+#include "core/array.hpp"
+#include "core/time.hpp"
+
+using namespace wob;
+
+// previous separate chaining map, kept as a reference point
+template<typename K, typename V, typename H = Hash<K>>
+class ChainedHashMap
+{
+public:
+	using Bucket_t = SList<Pair<K, V>>;
+
+	ChainedHashMap(uint32_t nBuckets = 16)
+	{
+		buckets.resize(nBuckets);
+	}
+
+	void add(K const& key, V const& value)
+	{
+		add(buckets, Pair<K, V>{ key, value });
+		size_++;
+		if ((float)size_ / buckets.size() > 0.75f)
+			rehash(buckets.size() * 2);
+	}
+
+	void remove(K const& key)
+	{
+		uint32_t const index = H{}(key) % buckets.size();
+		buckets[index].removeFirst([&key](auto const& node) {
+			return node->data.first == key;
+			});
+		size_--;
+	}
+
+	bool exist(K const& key) const
+	{
+		uint32_t const index = H{}(key) % buckets.size();
+		return buckets[index].findIf([&key](auto const& pair) { return pair.first == key; }) != buckets[index].end();
+	}
+
+	void rehash(uint32_t newBucketCount)
+	{
+		Array<Bucket_t> newBuckets;
+		newBuckets.resize(newBucketCount);
+		for (auto& bucket : buckets)
+		{
+			for (auto& pair : bucket)
+				add(newBuckets, wob::move(pair));
+		}
+		buckets = wob::move(newBuckets);
+	}
+
+private:
+
+	static void add(Array<Bucket_t>& b, Pair<K, V>&& pair)
+	{
+		uint32_t const index = H{}(pair.first) % b.size();
+		b[index].add(wob::move(pair));
+	}
+
+	Array<Bucket_t> buckets;
+	uint32_t size_ = 0;
+};
+
+// xorshift, keys must be unique so we use a bijective scramble of the index instead of rand
+static uint32_t scramble(uint32_t x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352d;
+	x ^= x >> 15;
+	x *= 0x846ca68b;
+	x ^= x >> 16;
+	return x;
+}
+
+template<typename Map>
+static void benchMap(const char* name, uint32_t n)
+{
+	Map map(16);
+	uint64_t found = 0;
+
+	long long t0 = getPerfCount();
+	for (uint32_t i = 0; i < n; i++)
+		map.add(scramble(i), i);
+
+	long long t1 = getPerfCount();
+	for (uint32_t i = 0; i < n; i++)
+		found += map.exist(scramble(i));
+
+	long long t2 = getPerfCount();
+	for (uint32_t i = 0; i < n; i++)
+		found += map.exist(scramble(i + n));
+
+	long long t3 = getPerfCount();
+	for (uint32_t i = 0; i < n; i++)
+		map.remove(scramble(i));
+	long long t4 = getPerfCount();
+
+	WOB_ASSERT(found == n);
+	printf("%-8s n=%-9u insert %9.2f ms | hit %9.2f ms | miss %9.2f ms | erase %9.2f ms\n", name, n,
+		perfCountToMs(t0, t1), perfCountToMs(t1, t2), perfCountToMs(t2, t3), perfCountToMs(t3, t4));
+}
+
+int main()
+{
+	uint32_t const counts[] = { 1'000, 100'000, 10'000'000 };
+	for (uint32_t n : counts)
+	{
+		benchMap<HashMap<uint32_t, uint32_t>>("flat", n);
+		benchMap<ChainedHashMap<uint32_t, uint32_t>>("chained", n);
+	}
+	return 0;
+}
@@ -0,0 +1,51 @@
+#include "core/wob.hpp"
+#include "core/log.hpp"
+#include "core/context.hpp"
+#include "core/time.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+// per message latency seen by the calling thread, sinks write to a file
+static double logMessages(uint32_t iterations)
+{
+	long long const start = getPerfCount();
+	for (uint32_t i = 0; i < iterations; i++)
+		WOB_LOG("entity {} at {} x {} : {} {}", i, (int)i * 3, -(int)i, "player_spawn", i * 0.5f);
+	return perfCountToMs(start, getPerfCount()) * 1'000'000.0 / iterations;
+}
+
+int main()
+{
+	uint32_t const iterations = 200'000;
+	FILE* const syncFile = tmpfile();
+	FILE* const asyncFile = tmpfile();
+	if (!syncFile || !asyncFile)
+		return 1;
+
+	StreamSink syncSink(syncFile);
+	Logger::instance().addSink(syncSink);
+	double const syncNs = logMessages(iterations);
+
+	StreamSink asyncSink(asyncFile);
+	AsyncLogger async(*context.allocator, 1 << 16, LogOverflow::Block);
+	async.addSink(asyncSink);
+	async.start();
+	Logger::instance().setAsync(&async);
+	double const asyncNs = logMessages(iterations);
+	long long const drainStart = getPerfCount();
+	async.flush();
+	double const drainMs = perfCountToMs(drainStart, getPerfCount());
+	Logger::instance().setAsync(nullptr);
+	async.stop();
+
+	Logger::instance().setLevel(LogLevel::Warning);
+	double const filteredNs = logMessages(iterations);
+
+	printf("per message on the caller : sync %.1f ns | async %.1f ns (drain %.2f ms) | filtered %.1f ns\n",
+		syncNs, asyncNs, drainMs, filteredNs);
+	fclose(syncFile);
+	fclose(asyncFile);
+	return 0;
+}
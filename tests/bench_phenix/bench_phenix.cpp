@@ -0,0 +1,121 @@
+#include "core/wob.hpp"
+#include "core/allocator.hpp"
+#include "core/context.hpp"
+#include "core/time.hpp"
+#include "renderer/phenixslang.hpp"
+
+using namespace wob;
+using namespace wob::phenix;
+
+// forward to malloc and count every allocation
+class CountingAllocator final : public IAllocator
+{
+public:
+	[[nodiscard]] void* allocate(size_t size, size_t align) override
+	{
+		allocationCount++;
+		allocatedBytes += size;
+		return mallocator.allocate(size, align);
+	}
+
+	void deallocate(void* ptr) override
+	{
+		mallocator.deallocate(ptr);
+	}
+
+	[[nodiscard]] void* reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align) override
+	{
+		allocationCount++;
+		allocatedBytes += newSize;
+		return mallocator.reallocate(ptr, oldSize, newSize, align);
+	}
+
+	uint64_t allocationCount = 0;
+	uint64_t allocatedBytes = 0;
+};
+
+static VarDecl makeMember(TType type, const char* name, AttributeType attribute)
+{
+	VarDecl member;
+	member.type = type;
+	member.name = name;
+	if (attribute != AttributeType::Custom)
+		member.attributes.push(Attribute{ attribute, String() });
+	return member;
+}
+
+static void setLiteral(LiteralNode& lit, vec4 v)
+{
+	lit.type = ASTNodeType::Literal;
+	lit.ltype = TType::Vec4;
+	lit.v4 = v;
+}
+
+int main()
+{
+	CountingAllocator counter;
+	IAllocator* const previous = context.allocator;
+	context.allocator = &counter;
+
+	ShaderProgram program;
+	StructDecl output;
+	output.name = "VS_OUTPUT";
+	output.members.push(makeMember(TType::Vec4, "position", AttributeType::Position));
+	output.members.push(makeMember(TType::Vec4, "color", AttributeType::Color));
+	output.members.push(makeMember(TType::Vec2, "uv", AttributeType::Custom));
+	program.structDecl.push(wob::move(output));
+
+	// return input.color * float4(...) + float4(...);
+	VariableNode color;
+	color.type = ASTNodeType::VarDecl;
+	color.name = "input.color";
+	LiteralNode tint, bias;
+	setLiteral(tint, vec4(1.0f, 0.5f, 0.25f, 1.0f));
+	setLiteral(bias, vec4(0.1f, 0.1f, 0.1f, 0.0f));
+	BinaryOpNode mul;
+	mul.type = ASTNodeType::BinOp;
+	mul.op = BinaryOp::Mul;
+	mul.left = &color;
+	mul.right = &tint;
+	BinaryOpNode add;
+	add.type = ASTNodeType::BinOp;
+	add.op = BinaryOp::Add;
+	add.left = &mul;
+	add.right = &bias;
+	ReturnStatement ret;
+	ret.type = ASTNodeType::ReturnStatement;
+	ret.node = &add;
+
+	FunDef main;
+	main.name = "main";
+	main.retType = TType::Vec4;
+	VarDecl input;
+	input.name = "input";
+	input.type = TType::UserDefined;
+	input.type.userTypeName = "VS_OUTPUT";
+	main.args.push(wob::move(input));
+	main.body.statements.push(&ret);
+	program.fnDefs.push(wob::move(main));
+
+	uint32_t const iterations = 10'000;
+	uint64_t const countBefore = counter.allocationCount;
+	uint64_t const bytesBefore = counter.allocatedBytes;
+	uint64_t checksum = 0;
+
+	long long const t0 = getPerfCount();
+	for (uint32_t i = 0; i < iterations; i++)
+	{
+		String const hlsl = compileToHLSL(program);
+		checksum += hlsl.size();
+	}
+	long long const t1 = getPerfCount();
+
+	context.allocator = previous;
+
+	printf("%s\n", compileToHLSL(program).c_str());
+	printf("compileToHLSL: %.2f allocations, %.0f bytes per compile | %.3f us per compile (%llu)\n",
+		(double)(counter.allocationCount - countBefore) / iterations,
+		(double)(counter.allocatedBytes - bytesBefore) / iterations,
+		perfCountToMs(t0, t1) * 1000.0 / iterations, (unsigned long long)checksum);
+	return 0;
+}
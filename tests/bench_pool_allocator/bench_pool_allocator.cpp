@@ -0,0 +1,101 @@
+#include "core/wob.hpp"
+#include "core/poolAllocator.hpp"
+#include "core/context.hpp"
+#include "core/slist.hpp"
+#include "core/time.hpp"
+#include "spatial/BSPTree.hpp"
+
+using namespace wob;
+
+static uint32_t rngState = 0x9E3779B9u;
+
+static uint32_t nextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 17;
+	rngState ^= rngState << 5;
+	return rngState;
+}
+
+static float randomFloat(float min, float max)
+{
+	return min + (max - min) * (float)(nextRandom() & 0xFFFFFF) / (float)0xFFFFFF;
+}
+
+// grow to 1M nodes then shrink back while randomly mixing adds and removes, twice
+static double slistChurn(IAllocator* allocator, uint32_t nodeCount)
+{
+	rngState = 0x9E3779B9u;
+	long long const start = getPerfCount();
+	{
+		SList<uint32_t> list(allocator);
+		for (int round = 0; round < 2; round++)
+		{
+			uint32_t size = 0;
+			while (size < nodeCount)
+			{
+				if (size > 0 && (nextRandom() & 3) == 0)
+				{
+					list.removeFront();
+					size--;
+				}
+				else
+				{
+					list.addFront(uint32_t(size));
+					size++;
+				}
+			}
+			while (size > 0)
+			{
+				if ((nextRandom() & 3) == 0)
+				{
+					list.addFront(uint32_t(size));
+					size++;
+				}
+				else
+				{
+					list.removeFront();
+					size--;
+				}
+			}
+		}
+	}
+	return perfCountToMs(start, getPerfCount());
+}
+
+static double bspBuild(Array<BSPTree::Object>& objects, IAllocator& allocator, IAllocator& elementAllocator)
+{
+	long long const start = getPerfCount();
+	{
+		auto const tree = BSPTree::build(allocator, elementAllocator, ArrayView(objects.begin(), objects.end()));
+		WOB_ASSERT(tree);
+	}
+	return perfCountToMs(start, getPerfCount());
+}
+
+int main()
+{
+	IAllocator& general = *context.allocator;
+
+	uint32_t const nodeCount = 1'000'000;
+	double const churnGeneral = slistChurn(&general, nodeCount);
+	SList<uint32_t>::NodePool nodePool(general, 4096);
+	double const churnPool = slistChurn(&nodePool, nodeCount);
+	printf("SList churn up to %u nodes : general %.2f ms | pool %.2f ms\n", nodeCount, churnGeneral, churnPool);
+
+	// picking the splitting plane tests every object against every other one, the build is quadratic
+	uint32_t const objectCount = 4'000;
+	Array<BSPTree::Object> objects;
+	for (uint32_t i = 0; i < objectCount; i++)
+	{
+		vec3 const center{ randomFloat(-100.f, 100.f), randomFloat(-100.f, 100.f), randomFloat(-100.f, 100.f) };
+		vec3 const extent{ randomFloat(0.1f, 2.f), randomFloat(0.1f, 2.f), randomFloat(0.1f, 2.f) };
+		objects.push(BSPTree::Object{ (void*)(uintptr_t)(i + 1), AABB{ center - extent, center + extent } });
+	}
+
+	double const bspGeneral = bspBuild(objects, general, general);
+	BSPTree::ElementPool elementPool(general, 1024);
+	double const bspPool = bspBuild(objects, general, elementPool);
+	printf("BSP build %u objects : general %.2f ms | element pool %.2f ms\n", objectCount, bspGeneral, bspPool);
+	return 0;
+}
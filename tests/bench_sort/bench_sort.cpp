@@ -0,0 +1,106 @@
+#include "core/wob.hpp"
+#include "core/sort.hpp"
+#include "core/array.hpp"
+#include "core/time.hpp"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+using namespace wob;
+
+// sort key and payload of a batched draw, sorted by texture
+struct DrawKey
+{
+	uint32_t texture;
+	uint32_t command;
+};
+
+static uint64_t nextRandom(uint64_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 7;
+	state ^= state << 17;
+	return state;
+}
+
+template<typename T>
+static int compareQsort(void const* a, void const* b)
+{
+	T const& lhs = *static_cast<T const*>(a);
+	T const& rhs = *static_cast<T const*>(b);
+	return lhs < rhs ? -1 : (rhs < lhs ? 1 : 0);
+}
+
+template<>
+int compareQsort<DrawKey>(void const* a, void const* b)
+{
+	DrawKey const& lhs = *static_cast<DrawKey const*>(a);
+	DrawKey const& rhs = *static_cast<DrawKey const*>(b);
+	return lhs.texture < rhs.texture ? -1 : (rhs.texture < lhs.texture ? 1 : 0);
+}
+
+static uint32_t makeValue(uint64_t& state, uint32_t*) { return (uint32_t)nextRandom(state); }
+// 30 bits Morton codes of a 1024^3 grid
+static uint64_t makeValue(uint64_t& state, uint64_t*) { return nextRandom(state) & ((1ull << 30) - 1); }
+// a few hundred textures
+static DrawKey makeValue(uint64_t& state, DrawKey*) { return { (uint32_t)(nextRandom(state) % 300), (uint32_t)state }; }
+
+static bool lessValue(uint32_t a, uint32_t b) { return a < b; }
+static bool lessValue(uint64_t a, uint64_t b) { return a < b; }
+static bool lessValue(DrawKey const& a, DrawKey const& b) { return a.texture < b.texture; }
+
+static uint32_t keyOf(uint32_t v) { return v; }
+static uint64_t keyOf(uint64_t v) { return v; }
+static uint32_t keyOf(DrawKey const& v) { return v.texture; }
+
+template<typename T, typename SortFn>
+static double timeSort(Array<T> const& source, uint32_t repeat, SortFn&& sortFn)
+{
+	Array<T> values;
+	double total = 0.0;
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		values = source;
+		long long const t0 = getPerfCount();
+		sortFn(values);
+		total += perfCountToMs(t0, getPerfCount());
+		WOB_ASSERT(ranges::isSorted(values, [](T const& a, T const& b) { return lessValue(a, b); }));
+	}
+	return total / repeat;
+}
+
+template<typename T>
+static void benchSort(const char* name, uint32_t n)
+{
+	uint64_t state = 0x2545F4914F6CDD1Dull ^ n;
+	Array<T> source;
+	source.reserve(n);
+	for (uint32_t i = 0; i < n; i++)
+		source.push(makeValue(state, (T*)nullptr));
+
+	// about 10M sorted elements per measure, at least once
+	uint32_t const repeat = 10'000'000 / n > 0 ? 10'000'000 / n : 1;
+	auto const less = [](T const& a, T const& b) { return lessValue(a, b); };
+	auto const key = [](T const& v) { return keyOf(v); };
+
+	double const qsortMs = timeSort(source, repeat, [](Array<T>& v) { qsort(v.data(), v.size(), sizeof(T), &compareQsort<T>); });
+	double const sortMs = timeSort(source, repeat, [&](Array<T>& v) { ranges::sort(v, less); });
+	double const stableMs = timeSort(source, repeat, [&](Array<T>& v) { ranges::stableSort(v, less); });
+	double const radixMs = timeSort(source, repeat, [&](Array<T>& v) { ranges::radixSort(v, key); });
+	double const parallelMs = timeSort(source, repeat, [&](Array<T>& v) { ranges::parallelSort(v, less); });
+
+	printf("%-8s n=%-9u qsort %9.3f ms | sort %9.3f ms | stable %9.3f ms | radix %9.3f ms | parallel %9.3f ms (%u threads)\n",
+		name, n, qsortMs, sortMs, stableMs, radixMs, parallelMs, Thread::processorCount());
+}
+
+int main()
+{
+	uint32_t const counts[] = { 1'000, 10'000, 100'000, 1'000'000, 10'000'000 };
+	for (uint32_t n : counts)
+	{
+		benchSort<uint32_t>("uint32", n);
+		benchSort<uint64_t>("morton", n);
+		benchSort<DrawKey>("draw key", n);
+	}
+	return 0;
+}
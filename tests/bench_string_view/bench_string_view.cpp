@@ -0,0 +1,102 @@
+#include "core/wob.hpp"
+#include "core/stringView.hpp"
+#include "core/string.hpp"
+#include "core/time.hpp"
+
+#include <stdio.h>
+#include <ctype.h>
+
+using namespace wob;
+
+// shader like source, long indented lines
+static String makeSource(uint32_t lineCount)
+{
+	String source;
+	for (uint32_t i = 0; i < lineCount; i++)
+	{
+		source.append("\t\t(var vec4 position_");
+		source.append(i % 2 ? "interpolated" : "world");
+		source.append("                                   POSITION)\n");
+	}
+	return source;
+}
+
+static double throughputGBs(size_t bytes, long long t0, long long t1)
+{
+	return (double)bytes / (perfCountToMs(t0, t1) * 1e6);
+}
+
+int main()
+{
+	String const source = makeSource(400'000);
+	StringView const view = source;
+	uint32_t const repeat = 10;
+	size_t checksum = 0;
+
+	// line counting
+	long long const t0 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		size_t lines = 0;
+		for (char c : view)
+			lines += c == '\n';
+		checksum += lines;
+	}
+	long long const t1 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+		checksum += view.count('\n');
+	long long const t2 = getPerfCount();
+
+	// tokenize : skip whitespace, then an identifier, then one char
+	CharClass const whitespace = CharClass::whitespace();
+	CharClass const identifier = CharClass::identifier();
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		size_t i = 0;
+		while (i < view.size())
+		{
+			while (i < view.size() && isspace((unsigned char)view[i]))
+				i++;
+			size_t const start = i;
+			while (i < view.size() && (isalnum((unsigned char)view[i]) || view[i] == '_'))
+				i++;
+			checksum += i - start;
+			i += i == start;
+		}
+	}
+	long long const t3 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		size_t i = 0;
+		while (i < view.size())
+		{
+			i = view.skipWhile(whitespace, i);
+			size_t const start = i;
+			i = view.skipWhile(identifier, i);
+			checksum += i - start;
+			i += i == start;
+		}
+	}
+	long long const t4 = getPerfCount();
+
+	// substring search of a missing word
+	for (uint32_t r = 0; r < repeat; r++)
+	{
+		size_t i = 0;
+		while (i + 8 <= view.size() && memcmp(view.data() + i, "COLOR_IN", 8) != 0)
+			i++;
+		checksum += i;
+	}
+	long long const t5 = getPerfCount();
+	for (uint32_t r = 0; r < repeat; r++)
+		checksum += view.find(StringView("COLOR_IN")) == StringView::npos;
+	long long const t6 = getPerfCount();
+
+	size_t const bytes = view.size() * repeat;
+	printf("%zu bytes\n", view.size());
+	printf("count    scalar %6.2f GB/s | simd %6.2f GB/s\n", throughputGBs(bytes, t0, t1), throughputGBs(bytes, t1, t2));
+	printf("tokenize scalar %6.2f GB/s | simd %6.2f GB/s\n", throughputGBs(bytes, t2, t3), throughputGBs(bytes, t3, t4));
+	printf("find     scalar %6.2f GB/s | simd %6.2f GB/s\n", throughputGBs(bytes, t4, t5), throughputGBs(bytes, t5, t6));
+	printf("(%zu)\n", checksum);
+	return 0;
+}
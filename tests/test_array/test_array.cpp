@@ -0,0 +1,86 @@
+#include "core/wob.hpp"
+#include "core/array.hpp"
+#include "core/allocator.hpp"
+#include "core/string.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static void testExpandInPlace()
+{
+	StackAllocator stack(mallocator, 1_kb);
+	void* a = stack.allocate(16, 8);
+	void* b = stack.allocate(16, 8);
+	WOB_ASSERT(!stack.tryExpandInPlace(a, 32));
+	WOB_ASSERT(stack.tryExpandInPlace(b, 64));
+	WOB_ASSERT(stack.getMarker() == 16 + 64);
+	WOB_ASSERT(!stack.tryExpandInPlace(b, 2_kb));
+
+	// last block grows in place, contents are kept
+	Array<uint32_t> ints(stack);
+	for (uint32_t i = 0; i < 100; i++)
+		ints.push(i);
+	uint32_t const* const data = ints.data();
+	ints.reserve(200);
+	WOB_ASSERT(ints.data() == data && ints.capacity() == 200);
+	for (uint32_t i = 0; i < 100; i++)
+		WOB_ASSERT(ints[i] == i);
+}
+
+static void testShrink()
+{
+	Array<String> strings;
+	for (uint32_t i = 0; i < 100; i++)
+		strings.push(String("a string long enough to allocate"));
+	strings.shrink();
+	WOB_ASSERT(strings.size() == 100 && strings.capacity() == 100);
+	WOB_ASSERT(strings[99] == "a string long enough to allocate");
+
+	Array<uint64_t> ints;
+	for (uint64_t i = 0; i < 10000; i++)
+		ints.push(i * 3);
+	ints.shrink();
+	WOB_ASSERT(ints.capacity() == 10000 && ints[9999] == 9999 * 3);
+}
+
+// ranges inserted and appended in one step, trivially relocatable or not
+static void testBulkInsert()
+{
+	Array<String> strings;
+	strings.push(String("first"));
+	strings.push(String("last"));
+	String middle[] = { String("a"), String("b") };
+	strings.insert(strings.begin() + 1, middle);
+	WOB_ASSERT(strings.size() == 4);
+	WOB_ASSERT(strings[0] == "first" && strings[1] == "a" && strings[2] == "b" && strings[3] == "last");
+
+	String const more[] = { String("c"), String("d") };
+	strings.append(ArrayView<String const>(more));
+	strings.pushN(String("e"), 3);
+	WOB_ASSERT(strings.size() == 9 && strings[5] == "d" && strings[8] == "e");
+
+	Array<String> copy(strings);
+	WOB_ASSERT(copy.size() == 9 && copy[4] == "c");
+
+	Array<uint16_t> indices;
+	uint16_t const quad[] = { 0, 1, 2, 2, 1, 3 };
+	for (uint32_t i = 0; i < 100; i++)
+		indices.append(ArrayView<uint16_t const>(quad));
+	uint16_t const head[] = { 7, 7 };
+	indices.insert(indices.begin(), head);
+	WOB_ASSERT(indices.size() == 602 && indices[0] == 7 && indices[2] == 0 && indices[601] == 3);
+
+	Array<char> chars;
+	chars.pushN('x', 100);
+	WOB_ASSERT(chars.size() == 100 && chars[99] == 'x');
+}
+
+int main()
+{
+	testExpandInPlace();
+	testShrink();
+	testBulkInsert();
+	printf("array tests passed\n");
+	return 0;
+}
@@ -0,0 +1,238 @@
+#include "core/wob.hpp"
+#include "core/assetStreamer.hpp"
+#include "core/jobSystem.hpp"
+#include "core/task.hpp"
+#include "core/string.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static void writeFile(const char* path, uint32_t size, uint8_t seed)
+{
+	FILE* const file = fopen(path, "wb");
+	WOB_ASSERT(file);
+	for (uint32_t i = 0; i < size; i++)
+		fputc((uint8_t)(seed + i), file);
+	fclose(file);
+}
+
+static bool checkContent(Array<uint8_t> const& data, uint32_t size, uint8_t seed)
+{
+	if (data.size() != size)
+		return false;
+	for (uint32_t i = 0; i < size; i++)
+	{
+		if (data[i] != (uint8_t)(seed + i))
+			return false;
+	}
+	return true;
+}
+
+struct Completion
+{
+	uint32_t order[16];
+	uint32_t count = 0;
+	Array<uint8_t> data[16];
+	bool ok[16] = {};
+};
+
+struct Tag
+{
+	Completion* completion;
+	uint32_t id;
+};
+
+static void onComplete(StreamedFile& file, void* userData)
+{
+	Tag& tag = *static_cast<Tag*>(userData);
+	Completion& c = *tag.completion;
+	c.order[c.count++] = tag.id;
+	c.ok[tag.id] = file.ok;
+	c.data[tag.id] = wob::move(file.data);
+}
+
+// keep only the bytes at even positions
+static bool decodeHalf(StreamedFile& file, void*)
+{
+	uint32_t const n = file.data.size() / 2;
+	for (uint32_t i = 0; i < n; i++)
+		file.data[i] = file.data[i * 2];
+	file.data.resizeNoInit(n);
+	return true;
+}
+
+static bool decodeFail(StreamedFile&, void*)
+{
+	return false;
+}
+
+static void pollUntilDone(AssetStreamer& streamer)
+{
+	while (streamer.pendingCount() > 0)
+	{
+		streamer.poll();
+		Thread::yield();
+	}
+}
+
+static void testRequests()
+{
+	AssetStreamer streamer(*context.allocator);
+	Completion c;
+	Tag tags[4] = { { &c, 0 }, { &c, 1 }, { &c, 2 }, { &c, 3 } };
+
+	streamer.request({ "stream_a.bin", StreamPriority::Normal, nullptr, &onComplete, &tags[0] });
+	streamer.request({ "stream_b.bin", StreamPriority::Normal, &decodeHalf, &onComplete, &tags[1] });
+	streamer.request({ "does_not_exist.bin", StreamPriority::Normal, &decodeHalf, &onComplete, &tags[2] });
+	streamer.request({ "stream_a.bin", StreamPriority::Low, &decodeFail, &onComplete, &tags[3] });
+	WOB_ASSERT(streamer.pendingCount() == 4);
+	pollUntilDone(streamer);
+
+	WOB_ASSERT(c.count == 4 && streamer.inFlightBytes() == 0);
+	WOB_ASSERT(c.ok[0] && checkContent(c.data[0], 1000, 7));
+	WOB_ASSERT(c.ok[1] && c.data[1].size() == 50000);
+	for (uint32_t i = 0; i < 50000; i++)
+		WOB_ASSERT(c.data[1][i] == (uint8_t)(3 + i * 2));
+	WOB_ASSERT(!c.ok[2] && !c.ok[3]);
+}
+
+// with a cap of one byte the files go one at a time, by priority
+static void testBudgetAndPriority()
+{
+	AssetStreamer::InitInfo info;
+	info.maxInFlightBytes = 1;
+	AssetStreamer streamer(*context.allocator, info);
+	Completion c;
+	Tag tags[4] = { { &c, 0 }, { &c, 1 }, { &c, 2 }, { &c, 3 } };
+
+	streamer.request({ "stream_a.bin", StreamPriority::Low, nullptr, &onComplete, &tags[0] });
+	// the first read fills the budget, the io thread waits for poll
+	while (streamer.inFlightBytes() == 0)
+		Thread::yield();
+
+	streamer.request({ "stream_a.bin", StreamPriority::Low, nullptr, &onComplete, &tags[1] });
+	streamer.request({ "stream_b.bin", StreamPriority::Normal, nullptr, &onComplete, &tags[2] });
+	streamer.request({ "stream_a.bin", StreamPriority::High, nullptr, &onComplete, &tags[3] });
+	for (uint32_t i = 0; i < 50; i++)
+	{
+		Thread::sleepMs(1);
+		WOB_ASSERT(streamer.inFlightBytes() <= 1000);
+	}
+	pollUntilDone(streamer);
+
+	WOB_ASSERT(c.count == 4);
+	WOB_ASSERT(c.order[0] == 0 && c.order[1] == 3 && c.order[2] == 2 && c.order[3] == 1);
+	WOB_ASSERT(checkContent(c.data[2], 100000, 3));
+}
+
+// io threads reserve the budget together, none of them may push it past the cap
+static void testBudgetWithIoThreads()
+{
+	AssetStreamer::InitInfo info;
+	info.ioThreadCount = 4;
+	info.maxInFlightBytes = 2500;
+	AssetStreamer streamer(*context.allocator, info);
+	Completion c;
+	Tag tags[16];
+	for (uint32_t i = 0; i < 16; i++)
+	{
+		tags[i] = { &c, i };
+		streamer.request({ "stream_a.bin", StreamPriority::Normal, nullptr, &onComplete, &tags[i] });
+	}
+	while (streamer.pendingCount() > 0)
+	{
+		WOB_ASSERT(streamer.inFlightBytes() <= 2500);
+		Thread::sleepMs(1);
+		streamer.poll();
+	}
+	WOB_ASSERT(c.count == 16 && streamer.inFlightBytes() == 0);
+}
+
+// sum of the bytes, reads a mapped file through content()
+static bool decodeSum(StreamedFile& file, void* userData)
+{
+	uint64_t& sum = *static_cast<uint64_t*>(userData);
+	for (uint8_t b : file.content())
+		sum += b;
+	return file.data.empty();
+}
+
+static void testMapped()
+{
+	AssetStreamer streamer(*context.allocator);
+	uint64_t sum = 0;
+	StreamRequest request{ "stream_b.bin", StreamPriority::Normal, &decodeSum, nullptr, &sum };
+	request.map = true;
+	streamer.request(request);
+	pollUntilDone(streamer);
+
+	uint64_t expected = 0;
+	for (uint32_t i = 0; i < 100000; i++)
+		expected += (uint8_t)(3 + i);
+	WOB_ASSERT(sum == expected && streamer.inFlightBytes() == 0);
+}
+
+static Task<> loadBoth(AssetStreamer& streamer, uint32_t* loaded)
+{
+	Result<Array<uint8_t>> a = co_await streamer.read("stream_a.bin", StreamPriority::High);
+	WOB_ASSERT(a && checkContent(a.value(), 1000, 7));
+	Result<Array<uint8_t>> missing = co_await streamer.read("does_not_exist.bin");
+	WOB_ASSERT(!missing && missing.error() == ErrorCode::FileReadFailed);
+	Result<Array<uint8_t>> b = co_await streamer.read("stream_b.bin");
+	WOB_ASSERT(b && checkContent(b.value(), 100000, 3));
+	Result<MappedFile> mapped = co_await streamer.map("stream_a.bin");
+	WOB_ASSERT(mapped && mapped.value().size() == 1000 && mapped.value().view()[999] == (uint8_t)(7 + 999));
+	Result<MappedFile> notMapped = co_await streamer.map("does_not_exist.bin", StreamPriority::Low);
+	WOB_ASSERT(!notMapped);
+	(*loaded)++;
+}
+
+static void testCoroutine()
+{
+	AssetStreamer streamer(*context.allocator);
+	TaskScheduler scheduler;
+	uint32_t loaded = 0;
+	scheduler.spawn(loadBoth(streamer, &loaded));
+	scheduler.spawn(loadBoth(streamer, &loaded));
+	while (scheduler.runningCount() > 0)
+	{
+		streamer.poll();
+		scheduler.beginFrame();
+		Thread::yield();
+	}
+	WOB_ASSERT(loaded == 2);
+}
+
+int main()
+{
+	writeFile("stream_a.bin", 1000, 7);
+	writeFile("stream_b.bin", 100000, 3);
+
+	// decode inline on the frame loop
+	testRequests();
+
+	{
+		JobSystem::InitInfo info;
+		info.workerCount = 2;
+		JobSystem jobs(*context.allocator, info);
+		context.jobSystem = &jobs;
+		testRequests();
+		testBudgetAndPriority();
+		testBudgetWithIoThreads();
+		testMapped();
+		testCoroutine();
+		context.jobSystem = nullptr;
+	}
+
+	// requests left in flight are dropped
+	{
+		AssetStreamer streamer(*context.allocator);
+		streamer.request({ "stream_b.bin", StreamPriority::Normal, nullptr, nullptr, nullptr });
+	}
+
+	remove("stream_a.bin");
+	remove("stream_b.bin");
+	printf("asset streamer tests passed\n");
+	return 0;
+}
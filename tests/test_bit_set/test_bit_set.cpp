@@ -0,0 +1,131 @@
+#include "core/wob.hpp"
+#include "core/bitSet.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static_assert(sizeof(BitSet<64>) == 8 && sizeof(BitSet<65>) == 16);
+
+template<typename Bits>
+static uint32_t collect(Bits const& bits, uint32_t* out)
+{
+	uint32_t n = 0;
+	for (uint32_t i : bits)
+		out[n++] = i;
+	return n;
+}
+
+static void testFixed()
+{
+	BitSet<130> bits;
+	WOB_ASSERT(bits.none() && bits.count() == 0 && bits.findFirst() == BitSet<130>::npos);
+	WOB_ASSERT(bits.begin() == bits.end());
+
+	bits.set(0).set(63).set(64).set(129);
+	WOB_ASSERT(bits.test(63) && bits[64] && !bits.test(1) && bits.count() == 4);
+	WOB_ASSERT(bits.findFirst() == 0 && bits.findNext(0) == 63 && bits.findNext(63) == 64 && bits.findNext(64) == 129);
+	WOB_ASSERT(bits.findNext(129) == BitSet<130>::npos);
+
+	uint32_t indices[130];
+	uint32_t const n = collect(bits, indices);
+	WOB_ASSERT(n == 4 && indices[0] == 0 && indices[1] == 63 && indices[2] == 64 && indices[3] == 129);
+
+	bits.reset(63).flip(1).set(2, false).set(3, true);
+	WOB_ASSERT(!bits.test(63) && bits.test(1) && !bits.test(2) && bits.test(3) && bits.count() == 5);
+
+	// the padding bits of the last word stay cleared
+	bits.setAll();
+	WOB_ASSERT(bits.all() && bits.count() == 130 && bits.words()[2] == 3);
+	bits.flipAll();
+	WOB_ASSERT(bits.none());
+	bits.set(7);
+	bits.resetAll();
+	WOB_ASSERT(bits.none());
+}
+
+static void testWordOperations()
+{
+	BitSet<200> a;
+	BitSet<200> b;
+	for (uint32_t i = 0; i < 200; i += 2)
+		a.set(i);
+	for (uint32_t i = 0; i < 200; i += 3)
+		b.set(i);
+
+	BitSet<200> both = a;
+	both &= b;
+	BitSet<200> either = a;
+	either |= b;
+	BitSet<200> onlyA = a;
+	onlyA.andNot(b);
+	BitSet<200> diff = a;
+	diff ^= b;
+	for (uint32_t i = 0; i < 200; i++)
+	{
+		WOB_ASSERT(both.test(i) == (i % 6 == 0));
+		WOB_ASSERT(either.test(i) == (i % 2 == 0 || i % 3 == 0));
+		WOB_ASSERT(onlyA.test(i) == (i % 2 == 0 && i % 3 != 0));
+		WOB_ASSERT(diff.test(i) == ((i % 2 == 0) != (i % 3 == 0)));
+	}
+	WOB_ASSERT(a.intersects(b) && !onlyA.intersects(b));
+	WOB_ASSERT(both == both && both != either);
+}
+
+static void testDynamic()
+{
+	DynamicBitSet bits;
+	WOB_ASSERT(bits.empty() && bits.none() && bits.begin() == bits.end() && bits.findFirst() == DynamicBitSet::npos);
+
+	bits.resize(1000);
+	WOB_ASSERT(bits.size() == 1000 && bits.none());
+	for (uint32_t i = 0; i < 1000; i += 37)
+		bits.set(i);
+	WOB_ASSERT(bits.count() == 28);
+
+	uint32_t expected = 0;
+	for (uint32_t i : bits)
+	{
+		WOB_ASSERT(i == expected);
+		expected += 37;
+	}
+	WOB_ASSERT(expected == 1036);
+
+	// bits cut by a shrink are cleared when it grows again
+	bits.resize(100);
+	WOB_ASSERT(bits.count() == 3);
+	bits.resize(1000);
+	WOB_ASSERT(bits.count() == 3 && !bits.test(111) && !bits.test(999));
+
+	// mixes with fixed size sets of the same size
+	BitSet<1000> mask;
+	mask.set(37).set(500);
+	bits &= mask;
+	WOB_ASSERT(bits.count() == 1 && bits.test(37));
+	WOB_ASSERT(bits != mask);
+	bits.set(500);
+	WOB_ASSERT(bits == mask);
+
+	DynamicBitSet copy = bits;
+	copy.flipAll();
+	WOB_ASSERT(copy.count() == 998 && !copy.intersects(bits));
+
+	DynamicBitSet sized(70);
+	sized.setAll();
+	WOB_ASSERT(sized.count() == 70 && sized.all() && sized.findNext(68) == 69);
+}
+
+static void testCountSetBits()
+{
+	WOB_ASSERT(countSetBits(0) == 0 && countSetBits(~0ull) == 64 && countSetBits(0x8000'0000'0000'0001ull) == 2);
+}
+
+int main()
+{
+	testFixed();
+	testWordOperations();
+	testDynamic();
+	testCountSetBits();
+	printf("bit set tests passed\n");
+	return 0;
+}
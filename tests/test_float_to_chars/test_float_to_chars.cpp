@@ -0,0 +1,193 @@
+#include "core/wob.hpp"
+#include "core/floatToChars.hpp"
+#include "core/dragon4.hpp"
+#include "core/format.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+using namespace wob;
+
+static uint64_t rngState = 0x9E3779B97F4A7C15ull;
+
+// xorshift64, deterministic so failures can be replayed
+static uint64_t nextRandom()
+{
+	rngState ^= rngState << 13;
+	rngState ^= rngState >> 7;
+	rngState ^= rngState << 17;
+	return rngState;
+}
+
+// reference digits from Dragon4 for value = significand * 2^exponent
+static void referenceDigits(uint64_t significand, int32_t exponent, bool lowerBoundaryCloser, grisu::Decimal& out)
+{
+	int32_t printExponent = 0;
+	out.count = d4::Dragon4(significand, exponent, grisu::highBitIndex(significand), lowerBoundaryCloser,
+		d4::CutoffMode_Unique, 0, out.digits, sizeof(out.digits), &printExponent);
+	out.exponent = printExponent - (int32_t)out.count + 1;
+}
+
+static bool sameDecimal(grisu::Decimal const& lhs, grisu::Decimal const& rhs)
+{
+	return lhs.count == rhs.count && lhs.exponent == rhs.exponent && memcmp(lhs.digits, rhs.digits, lhs.count) == 0;
+}
+
+struct FuzzStats
+{
+	uint32_t tested = 0;
+	uint32_t grisuFailures = 0;
+};
+
+// Grisu3 either proves its digits, which must then be Dragon4 ones, or gives up
+static void checkDigits(uint64_t significand, int32_t exponent, bool lowerBoundaryCloser, FuzzStats& stats)
+{
+	grisu::Decimal reference{};
+	referenceDigits(significand, exponent, lowerBoundaryCloser, reference);
+
+	grisu::Decimal grisu{};
+	if (grisu::shortestDigits(significand, exponent, lowerBoundaryCloser, grisu))
+	{
+		WOB_ASSERT(sameDecimal(grisu, reference));
+	}
+	else
+	{
+		stats.grisuFailures++;
+	}
+	stats.tested++;
+}
+
+static void checkDouble(uint64_t bits, FuzzStats& stats)
+{
+	double const value = __builtin_bit_cast(double, bits);
+	uint32_t const biasedExponent = (uint32_t)(bits >> 52) & 0x7FF;
+	uint64_t const mantissa = bits & 0xFFFFFFFFFFFFFull;
+	if (biasedExponent == 0x7FF || (biasedExponent == 0 && mantissa == 0))
+		return;
+
+	uint64_t const significand = biasedExponent ? (mantissa | (1ull << 52)) : mantissa;
+	int32_t const exponent = (biasedExponent ? (int32_t)biasedExponent : 1) - 1075;
+	checkDigits(significand, exponent, mantissa == 0 && biasedExponent > 1, stats);
+
+	// the printed string reads back to the same bits
+	char buffer[floatCharsMax + 1];
+	uint32_t const size = floatToChars(buffer, value);
+	WOB_ASSERT(size < floatCharsMax);
+	buffer[size] = '\0';
+	double const parsed = strtod(buffer, nullptr);
+	WOB_ASSERT(__builtin_bit_cast(uint64_t, parsed) == bits);
+}
+
+static void checkFloat(uint32_t bits, FuzzStats& stats)
+{
+	float const value = __builtin_bit_cast(float, bits);
+	uint32_t const biasedExponent = (bits >> 23) & 0xFF;
+	uint32_t const mantissa = bits & 0x7FFFFF;
+	if (biasedExponent == 0xFF || (biasedExponent == 0 && mantissa == 0))
+		return;
+
+	uint64_t const significand = biasedExponent ? (mantissa | (1u << 23)) : mantissa;
+	int32_t const exponent = (biasedExponent ? (int32_t)biasedExponent : 1) - 150;
+	checkDigits(significand, exponent, mantissa == 0 && biasedExponent > 1, stats);
+
+	char buffer[floatCharsMax + 1];
+	uint32_t const size = floatToChars(buffer, value);
+	WOB_ASSERT(size < floatCharsMax);
+	buffer[size] = '\0';
+	float const parsed = strtof(buffer, nullptr);
+	WOB_ASSERT(__builtin_bit_cast(uint32_t, parsed) == bits);
+
+	// same text as the previous Dragon4 positional path in the positional range
+	if (value == 0.0f || (fabsf(value) >= 1e-6f && fabsf(value) < 1e21f))
+	{
+		char reference[64];
+		d4::PrintFloat32(reference, sizeof(reference), value, d4::PrintFloatFormat_Positional, -1);
+		WOB_ASSERT(strcmp(buffer, reference) == 0);
+	}
+}
+
+static bool printsAs(float value, const char* expected)
+{
+	char buffer[floatCharsMax];
+	uint32_t const size = floatToChars(buffer, value);
+	return StringView(buffer, size) == StringView(expected);
+}
+
+static bool printsAs(double value, const char* expected)
+{
+	char buffer[floatCharsMax];
+	uint32_t const size = floatToChars(buffer, value);
+	return StringView(buffer, size) == StringView(expected);
+}
+
+// usable in constant expressions when Grisu3 succeeds
+constexpr uint32_t constexprSize()
+{
+	char buffer[floatCharsMax] = {};
+	return floatToChars(buffer, 0.1);
+}
+static_assert(constexprSize() == 3);
+
+int main()
+{
+	{
+		WOB_LOG("[TEST] floatToChars");
+
+		WOB_ASSERT(printsAs(0.0f, "0"));
+		WOB_ASSERT(printsAs(-0.0, "-0"));
+		WOB_ASSERT(printsAs(1.0f, "1"));
+		WOB_ASSERT(printsAs(0.5f, "0.5"));
+		WOB_ASSERT(printsAs(0.1f, "0.1"));
+		WOB_ASSERT(printsAs(0.1, "0.1"));
+		WOB_ASSERT(printsAs(-1.25, "-1.25"));
+		WOB_ASSERT(printsAs(100.0f, "100"));
+		WOB_ASSERT(printsAs(3.14159274f, "3.1415927"));
+		WOB_ASSERT(printsAs(1.0 / 3.0, "0.3333333333333333"));
+		WOB_ASSERT(printsAs(0.000001, "0.000001"));
+		WOB_ASSERT(printsAs(0.0000001, "1e-7"));
+		WOB_ASSERT(printsAs(1e20, "100000000000000000000"));
+		WOB_ASSERT(printsAs(1e21, "1e+21"));
+		WOB_ASSERT(printsAs(1.5e300, "1.5e+300"));
+		WOB_ASSERT(printsAs(5e-324, "5e-324"));
+		WOB_ASSERT(printsAs(1.7976931348623157e308, "1.7976931348623157e+308"));
+		WOB_ASSERT(printsAs(3.4028235e38f, "3.4028235e+38"));
+		WOB_ASSERT(printsAs(1e-45f, "1e-45"));
+		WOB_ASSERT(printsAs(__builtin_inff(), "Inf"));
+		WOB_ASSERT(printsAs(-__builtin_inf(), "-Inf"));
+
+		WOB_ASSERT(format("float2({}f, {}f)", 0.25f, -2.0f) == "float2(0.25f, -2f)");
+	}
+
+	{
+		WOB_LOG("[TEST] floatToChars fuzz against Dragon4");
+
+		FuzzStats doubles;
+		for (uint32_t i = 0; i < 1'000'000; i++)
+			checkDouble(nextRandom(), doubles);
+
+		// powers of two and their neighbours have unequal margins, the hard cases for Grisu
+		for (uint64_t biasedExponent = 0; biasedExponent < 0x7FF; biasedExponent++)
+		{
+			uint64_t const bits = biasedExponent << 52;
+			checkDouble(bits, doubles);
+			checkDouble(bits + 1, doubles);
+			checkDouble(bits - 1, doubles);
+		}
+
+		FuzzStats floats;
+		for (uint32_t i = 0; i < 1'000'000; i++)
+			checkFloat((uint32_t)nextRandom(), floats);
+
+		for (uint32_t biasedExponent = 0; biasedExponent < 0xFF; biasedExponent++)
+		{
+			uint32_t const bits = biasedExponent << 23;
+			checkFloat(bits, floats);
+			checkFloat(bits + 1, floats);
+			checkFloat(bits - 1, floats);
+		}
+
+		printf("doubles %u tested, %u Dragon4 fallbacks | floats %u tested, %u Dragon4 fallbacks\n",
+			doubles.tested, doubles.grisuFailures, floats.tested, floats.grisuFailures);
+	}
+	return 0;
+}
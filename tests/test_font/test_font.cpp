@@ -23,12 +23,12 @@ public:
 	void start() override
 	{
 		{ 
-			auto const fontData = readFileBin("../../../../wobEngine/assets/fonts/courier.ttf");
+			MappedFile fontFile;
+			fontFile.open("../../../../wobEngine/assets/fonts/courier.ttf", FileAccess::Sequential);
 			FontParams params{};
-			params.fontData = fontData;
 			params.fontSize = 25;
 			params.oversampling = 2;
-			auto fontResult = createFontRessource(params);
+			auto fontResult = createFontRessource(fontFile, params);
 
 			//if (!fontResult)
 			//	WOB_FATAL_ERROR("font creation failed");
@@ -0,0 +1,97 @@
+#include "core/wob.hpp"
+#include "core/frameAllocator.hpp"
+#include "core/array.hpp"
+#include "core/string.hpp"
+#include "core/format.hpp"
+
+#include <string.h>
+
+using namespace wob;
+
+// memory of a frame stays valid the next frame and is reused two frames later
+static void testRotation()
+{
+	FrameAllocator frame(mallocator, 1_kb);
+
+	uint8_t* const first = static_cast<uint8_t*>(frame.allocate(64, 8));
+	memset(first, 0xAB, 64);
+	WOB_ASSERT(frame.frameUsage() == 64);
+
+	frame.beginFrame();
+	uint8_t* const second = static_cast<uint8_t*>(frame.allocate(64, 8));
+	WOB_ASSERT(second != first);
+	WOB_ASSERT(first[63] == 0xAB);
+	WOB_ASSERT(frame.lastFrameUsage() == 64);
+
+	frame.beginFrame();
+	uint8_t* const third = static_cast<uint8_t*>(frame.allocate(64, 8));
+	WOB_ASSERT(third == first);
+
+	// alignment padding counts in the usage
+	void* const aligned = frame.allocate(1, 256);
+	WOB_ASSERT(((uintptr_t)aligned & 255) == 0);
+}
+
+static void testOverflow()
+{
+	FrameAllocator frame(mallocator, 256);
+
+	void* const inArena = frame.allocate(200, 8);
+	void* const overflow = frame.allocate(1000, 64);
+	WOB_ASSERT(inArena && overflow);
+	WOB_ASSERT(((uintptr_t)overflow & 63) == 0);
+	memset(overflow, 0, 1000);
+	WOB_ASSERT(frame.frameUsage() == 1200);
+
+	frame.beginFrame();
+	WOB_ASSERT(frame.overflowFrameCount() == 1);
+	WOB_ASSERT(frame.highWaterMark() == 1200);
+
+	// the overflow blocks are released when their arena comes back, ASan checks they don't leak
+	frame.beginFrame();
+	WOB_ASSERT(frame.frameUsage() == 0);
+	WOB_ASSERT(frame.highWaterMark() == 1200);
+}
+
+static void testArrayGrowsInPlace()
+{
+	FrameAllocator frame(mallocator, 64_kb);
+	Array<uint32_t> values(frame);
+	for (uint32_t i = 0; i < 1000; i++)
+		values.push(i);
+
+	// the array is the only allocation so every growth extends it in place
+	WOB_ASSERT(frame.frameUsage() == values.capacity() * sizeof(uint32_t));
+	for (uint32_t i = 0; i < 1000; i++)
+		WOB_ASSERT(values[i] == i);
+}
+
+static void testScope()
+{
+	FrameAllocator frame(mallocator, 64_kb);
+	IAllocator* const previous = context.allocator;
+	context.frameAllocator = &frame;
+	{
+		FrameAllocatorScope scope;
+		WOB_ASSERT(context.allocator == &frame);
+
+		Array<int> numbers;
+		numbers.resize(100);
+		String const text = format("a string long enough to need the heap {} {}", 42, 3.5f);
+		WOB_ASSERT(numbers.getAllocator() == &frame);
+		WOB_ASSERT(text == "a string long enough to need the heap 42 3.5");
+		WOB_ASSERT(frame.frameUsage() >= 100 * sizeof(int) + text.size());
+	}
+	WOB_ASSERT(context.allocator == previous);
+	context.frameAllocator = nullptr;
+}
+
+int main()
+{
+	testRotation();
+	testOverflow();
+	testArrayGrowsInPlace();
+	testScope();
+	printf("frame allocator tests passed\n");
+	return 0;
+}
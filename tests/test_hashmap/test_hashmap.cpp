@@ -0,0 +1,68 @@
+#include "core/wob.hpp"
+#include "core/hashmap.hpp"
+#include "core/string.hpp"
+#include "core/stringView.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+// lookups after many removals, copy and clear
+static void testAddRemove()
+{
+	HashMap<uint32_t, uint32_t> map;
+	for (uint32_t i = 0; i < 10000; i++)
+		map.add(i, i * 2);
+	WOB_ASSERT(map.size() == 10000);
+
+	for (uint32_t i = 0; i < 10000; i += 2)
+		map.remove(i);
+	WOB_ASSERT(map.size() == 5000);
+
+	for (uint32_t i = 0; i < 10000; i++)
+		WOB_ASSERT(map.exist(i) == (i % 2 == 1));
+
+	map.add(1u, 7u);
+	WOB_ASSERT(map[1] == 7);
+	WOB_ASSERT(map.size() == 5000);
+
+	uint32_t count = 0;
+	for (auto const& [k, v] : map)
+		count++;
+	WOB_ASSERT(count == map.size());
+
+	HashMap<uint32_t, uint32_t> copy(map);
+	WOB_ASSERT(copy.size() == map.size() && copy[9999] == 9999 * 2);
+	map.clear();
+	WOB_ASSERT(map.size() == 0 && !map.exist(3) && copy.exist(3));
+}
+
+static void testTransparentLookup()
+{
+	using Map_t = HashMap<String, int>;
+	Map_t map;
+	map.add(String("position"), 1);
+	map.add(String("normal"), 2);
+
+	// transparent lookups, no String built
+	WOB_ASSERT(map.exist("position"));
+	WOB_ASSERT(map.exist(StringView("normal")));
+	WOB_ASSERT(!map.exist(StringView("normals")));
+	WOB_ASSERT(!map.exist(StringView("norm")));
+	WOB_ASSERT(map["normal"] == 2);
+
+	uint64_t const hash = Map_t::computeHash(StringView("position"));
+	WOB_ASSERT(hash == Map_t::computeHash(String("position")));
+	WOB_ASSERT(*map.find(StringView("position"), hash) == 1);
+
+	map.remove(StringView("position"));
+	WOB_ASSERT(map.size() == 1 && !map.exist("position"));
+}
+
+int main()
+{
+	testAddRemove();
+	testTransparentLookup();
+	printf("hashmap tests passed\n");
+	return 0;
+}
@@ -0,0 +1,210 @@
+#include "core/wob.hpp"
+#include "core/jobSystem.hpp"
+#include "core/array.hpp"
+#include "core/sort.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static void increment(void* data)
+{
+	static_cast<Atomic<uint32_t>*>(data)->fetchAdd(1);
+}
+
+static void testCounter(JobSystem& jobs)
+{
+	Atomic<uint32_t> value(0);
+	Job batch[100];
+	for (Job& job : batch)
+		job = Job{ &increment, &value };
+
+	JobCounter counter;
+	WOB_ASSERT(counter.isDone());
+	jobs.run(batch, 100, counter);
+	jobs.wait(counter);
+	WOB_ASSERT(counter.isDone() && value.load() == 100);
+
+	// counters can be reused once done
+	jobs.run(batch[0], counter);
+	jobs.wait(counter);
+	WOB_ASSERT(value.load() == 101);
+}
+
+// fib(n) forks fib(n - 1) and fib(n - 2) as jobs and joins them
+struct Fib
+{
+	uint32_t n;
+	uint64_t result;
+};
+
+static void fibJob(void* data)
+{
+	Fib& fib = *static_cast<Fib*>(data);
+	if (fib.n < 2)
+	{
+		fib.result = fib.n;
+		return;
+	}
+
+	Fib children[2] = { { fib.n - 1, 0 }, { fib.n - 2, 0 } };
+	Job jobs[2] = { { &fibJob, &children[0] }, { &fibJob, &children[1] } };
+	JobCounter counter;
+	context.jobSystem->run(jobs, 2, counter);
+	context.jobSystem->wait(counter);
+	fib.result = children[0].result + children[1].result;
+}
+
+static void testNested(JobSystem& jobs)
+{
+	Fib fib{ 20, 0 };
+	Job job{ &fibJob, &fib };
+	JobCounter counter;
+	jobs.run(job, counter);
+	jobs.wait(counter);
+	WOB_ASSERT(fib.result == 6765);
+}
+
+static void testWorkerContext(JobSystem& jobs)
+{
+	struct Seen
+	{
+		JobSystem* system;
+		IAllocator* allocator;
+		FrameAllocator* frameAllocator;
+	};
+
+	Seen seen[64];
+	Job batch[64];
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		batch[i] = Job{ [](void* data) {
+			Seen& s = *static_cast<Seen*>(data);
+			s = Seen{ context.jobSystem, context.allocator, context.frameAllocator };
+			// allocating from a worker goes through its own context
+			void* p = context.allocator->allocate(64, 16);
+			context.allocator->deallocate(p);
+		}, &seen[i] };
+	}
+
+	JobCounter counter;
+	jobs.run(batch, 64, counter);
+	jobs.wait(counter);
+	for (Seen const& s : seen)
+		WOB_ASSERT(s.system == &jobs && s.allocator == context.allocator && s.frameAllocator == nullptr);
+}
+
+static void testParallelFor()
+{
+	Array<uint32_t> values;
+	values.resize(100000);
+	for (uint32_t i = 0; i < values.size(); i++)
+		values[i] = i;
+
+	parallelFor(ArrayView<uint32_t>(values.data(), values.size()), 1000, [](uint32_t& v) { v = v * 2 + 1; });
+	for (uint32_t i = 0; i < values.size(); i++)
+		WOB_ASSERT(values[i] == i * 2 + 1);
+
+	// nested loops and grains larger than the range
+	Atomic<uint32_t> total(0);
+	parallelFor(ArrayView<uint32_t>(values.data(), 64), 1, [&](uint32_t&) {
+		parallelFor(ArrayView<uint32_t>(values.data(), 100), 7, [&](uint32_t&) { total.fetchAdd(1); });
+	});
+	WOB_ASSERT(total.load() == 6400);
+	parallelFor(ArrayView<uint32_t>(values.data(), 10), 1000, [&](uint32_t&) { total.fetchAdd(1); });
+	WOB_ASSERT(total.load() == 6410);
+}
+
+static void testParallelSort()
+{
+	Array<uint32_t> values;
+	uint32_t state = 12345;
+	for (uint32_t i = 0; i < 300000; i++)
+	{
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		values.push(state);
+	}
+	ranges::parallelSort(values, ranges::Less{}, 4);
+	WOB_ASSERT(ranges::isSorted(values));
+}
+
+// more jobs than a queue holds, the overflow runs on the pushing thread
+static void testOverflow()
+{
+	JobSystem::InitInfo info;
+	info.workerCount = 2;
+	info.queueCapacity = 8;
+	JobSystem jobs(*context.allocator, info);
+
+	Atomic<uint32_t> value(0);
+	Array<Job> batch;
+	batch.resize(1000);
+	for (Job& job : batch)
+		job = Job{ &increment, &value };
+
+	for (uint32_t round = 0; round < 20; round++)
+	{
+		JobCounter counter;
+		jobs.run(batch.data(), batch.size(), counter);
+		jobs.wait(counter);
+	}
+	WOB_ASSERT(value.load() == 20000);
+}
+
+static Atomic<uint32_t> drained(0);
+static Job followUps[64];
+
+static void queueFollowUp(void* data)
+{
+	drained.fetchAdd(1);
+	context.jobSystem->run(followUps[(uintptr_t)data]);
+}
+
+// jobs nothing waits for still run before the system is destroyed, with the ones they queue
+static void testDrainOnDestroy()
+{
+	Job firsts[64];
+	{
+		JobSystem::InitInfo info;
+		info.workerCount = 2;
+		JobSystem jobs(*context.allocator, info);
+		context.jobSystem = &jobs;
+		for (uint32_t i = 0; i < 64; i++)
+		{
+			followUps[i] = Job{ &increment, &drained };
+			firsts[i] = Job{ &queueFollowUp, (void*)(uintptr_t)i };
+			jobs.run(firsts[i]);
+		}
+	}
+	context.jobSystem = nullptr;
+	WOB_ASSERT(drained.load() == 128);
+}
+
+int main()
+{
+	// without a job system parallelFor runs serially
+	testParallelFor();
+
+	{
+		JobSystem::InitInfo info;
+		info.workerCount = 3;
+		JobSystem jobs(*context.allocator, info);
+		WOB_ASSERT(jobs.threadCount() == 4);
+
+		context.jobSystem = &jobs;
+		testCounter(jobs);
+		testNested(jobs);
+		testWorkerContext(jobs);
+		testParallelFor();
+		testParallelSort();
+		context.jobSystem = nullptr;
+	}
+
+	testOverflow();
+	testDrainOnDestroy();
+
+	printf("job system tests passed\n");
+	return 0;
+}
@@ -0,0 +1,204 @@
+#include "core/wob.hpp"
+#include "core/log.hpp"
+#include "core/thread.hpp"
+#include "core/atomic.hpp"
+#include "core/context.hpp"
+
+#include <string.h>
+
+using namespace wob;
+
+// counts messages per producer and checks each producer messages arrive in order
+class CheckingSink final : public Sink
+{
+public:
+	static constexpr uint32_t maxProducers = 8;
+
+	void dispatch_log(const char* message) noexcept override
+	{
+		WOB_UNUSED(message);
+	}
+
+	void dispatch(LogRecord const& record) noexcept override
+	{
+		WOB_ASSERT(record.message[record.size] == '\0');
+		lastSize = record.size;
+		memcpy(last, record.message, record.size + 1);
+		count++;
+
+		uint32_t producer = 0, index = 0;
+		if (sscanf(record.message, "info: producer %u message %u", &producer, &index) == 2)
+		{
+			WOB_ASSERT(producer < maxProducers);
+			WOB_ASSERT(index == nextIndex[producer]);
+			nextIndex[producer]++;
+		}
+	}
+
+	void flush() noexcept override
+	{
+		flushCount++;
+	}
+
+	uint32_t count = 0;
+	uint32_t flushCount = 0;
+	uint32_t nextIndex[maxProducers]{};
+	uint32_t lastSize = 0;
+	char last[AsyncLogger::maxMessageSize + 1]{};
+};
+
+struct Producer
+{
+	AsyncLogger* async;
+	uint32_t id;
+	uint32_t messageCount;
+	Thread thread;
+};
+
+static void produce(void* userData)
+{
+	Producer& producer = *static_cast<Producer*>(userData);
+	// each thread has its own Logger, they all feed the same ring buffer
+	Logger::instance().setAsync(producer.async);
+	for (uint32_t i = 0; i < producer.messageCount; i++)
+		WOB_LOG("producer {} message {}", producer.id, i);
+}
+
+static void testMultipleProducers()
+{
+	CheckingSink sink;
+	AsyncLogger async(*context.allocator, 256, LogOverflow::Block);
+	async.addSink(sink);
+	WOB_ASSERT(async.start());
+
+	uint32_t const producerCount = 4;
+	uint32_t const messageCount = 20'000;
+	Producer producers[producerCount];
+	for (uint32_t i = 0; i < producerCount; i++)
+	{
+		producers[i].async = &async;
+		producers[i].id = i;
+		producers[i].messageCount = messageCount;
+		WOB_ASSERT(producers[i].thread.start(&produce, &producers[i]));
+	}
+	for (Producer& producer : producers)
+		producer.thread.join();
+
+	async.flush();
+	WOB_ASSERT(sink.count == producerCount * messageCount);
+	for (uint32_t i = 0; i < producerCount; i++)
+		WOB_ASSERT(sink.nextIndex[i] == messageCount);
+	WOB_ASSERT(async.droppedCount() == 0);
+	// sinks are flushed per batch, not per message
+	WOB_ASSERT(sink.flushCount < sink.count);
+	async.stop();
+	printf("multiple producers : %u messages, %u flushes\n", sink.count, sink.flushCount);
+}
+
+static void testDropPolicy()
+{
+	CheckingSink sink;
+	AsyncLogger async(*context.allocator, 16, LogOverflow::Drop);
+	async.addSink(sink);
+
+	// the logging thread isn't started yet so nothing is consumed
+	for (uint32_t i = 0; i < 40; i++)
+		async.push(LogLevel::Info, source_location(), "x\n", 2);
+	WOB_ASSERT(async.droppedCount() == 24);
+
+	WOB_ASSERT(async.start());
+	async.flush();
+	async.stop();
+	// 16 messages then the drop report
+	WOB_ASSERT(sink.count == 17);
+	WOB_ASSERT(strcmp(sink.last, "warn: 24 log messages dropped\n") == 0);
+}
+
+static void testBlockWithoutConsumer()
+{
+	CheckingSink sink;
+	AsyncLogger async(*context.allocator, 16, LogOverflow::Block);
+	async.addSink(sink);
+
+	// no logging thread to wait for, blocking producers drop instead of hanging
+	for (uint32_t i = 0; i < 20; i++)
+		async.push(LogLevel::Info, source_location(), "x\n", 2);
+	WOB_ASSERT(async.droppedCount() == 4);
+
+	WOB_ASSERT(async.start());
+	async.stop();
+	// 16 messages then the drop report
+	WOB_ASSERT(sink.count == 17);
+
+	// after stop producers dispatch by themselves, nothing is dropped
+	for (uint32_t i = 0; i < 20; i++)
+		async.push(LogLevel::Info, source_location(), "x\n", 2);
+	WOB_ASSERT(async.droppedCount() == 4);
+	WOB_ASSERT(sink.count == 37);
+	async.push(LogLevel::Error, source_location(), "error: late\n", 12);
+	WOB_ASSERT(sink.count == 38);
+	WOB_ASSERT(strcmp(sink.last, "error: late\n") == 0);
+}
+
+static uint32_t evaluations = 0;
+
+static int countedValue()
+{
+	evaluations++;
+	return 42;
+}
+
+static void testLevelFilter()
+{
+	// the logger has no removeSink, the sink must outlive it
+	static CheckingSink sink;
+	Logger& logger = Logger::instance();
+	logger.addSink(sink);
+
+	logger.setLevel(LogLevel::Error);
+	WOB_LOG("filtered {}", countedValue());
+	WOB_WARN("filtered {}", countedValue());
+	WOB_ASSERT(evaluations == 0);
+	WOB_ASSERT(sink.count == 0);
+
+	logger.setLevel(LogLevel::Info);
+	WOB_LOG("kept {}", countedValue());
+	WOB_ASSERT(evaluations == 1);
+	WOB_ASSERT(sink.count == 1);
+	WOB_ASSERT(strcmp(sink.last, "info: kept 42\n") == 0);
+}
+
+static void testTruncation()
+{
+	CheckingSink sink;
+	AsyncLogger async(*context.allocator, 16);
+	async.addSink(sink);
+	WOB_ASSERT(async.start());
+	Logger::instance().setAsync(&async);
+
+	char longText[512];
+	memset(longText, 'a', sizeof(longText) - 1);
+	longText[sizeof(longText) - 1] = '\0';
+	WOB_LOG("{}", longText);
+	async.flush();
+	WOB_ASSERT(sink.lastSize == AsyncLogger::maxMessageSize);
+	WOB_ASSERT(strcmp(sink.last + AsyncLogger::maxMessageSize - 4, "...\n") == 0);
+
+	// errors are dispatched before the call returns
+	WOB_LOG_ERROR("error {}", 1);
+	WOB_ASSERT(strstr(sink.last, "error 1\n") != nullptr);
+
+	Logger::instance().setAsync(nullptr);
+	async.stop();
+}
+
+int main()
+{
+	testMultipleProducers();
+	testDropPolicy();
+	testBlockWithoutConsumer();
+	testLevelFilter();
+	testTruncation();
+	printf("log tests passed\n");
+	return 0;
+}
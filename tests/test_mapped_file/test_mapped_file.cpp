@@ -0,0 +1,73 @@
+#include "core/wob.hpp"
+#include "core/mappedFile.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static void writeFile(const char* path, uint32_t size)
+{
+	FILE* const file = fopen(path, "wb");
+	WOB_ASSERT(file);
+	for (uint32_t i = 0; i < size; i++)
+		fputc((uint8_t)(i * 7), file);
+	fclose(file);
+}
+
+static void testMapping()
+{
+	// spans several pages and ends in the middle of one
+	uint32_t const size = 3 * 4096 + 123;
+	writeFile("mapped.bin", size);
+
+	MappedFile file;
+	WOB_ASSERT(!file.isOpen() && file.view().empty());
+	WOB_ASSERT(file.open("mapped.bin", FileAccess::Sequential));
+	WOB_ASSERT(file.isOpen() && file.size() == size);
+
+	ArrayView<uint8_t const> const view = file.view();
+	for (uint32_t i = 0; i < size; i++)
+		WOB_ASSERT(view[i] == (uint8_t)(i * 7));
+
+	// hints on unaligned sub ranges
+	file.advise(FileAccess::Random, 5000, 100);
+	file.prefetch(4095, 2);
+	file.prefetch();
+	file.advise(FileAccess::Normal);
+
+	ArrayView<uint8_t const> const tail = file.view(size - 10, 10);
+	WOB_ASSERT(tail.size() == 10 && tail[9] == (uint8_t)((size - 1) * 7));
+
+	// moves hand the mapping over
+	MappedFile moved(wob::move(file));
+	WOB_ASSERT(!file.isOpen() && moved.isOpen() && moved.data() == view.data());
+	MappedFile assigned;
+	assigned = wob::move(moved);
+	WOB_ASSERT(!moved.isOpen() && assigned.size() == size && assigned.view()[1] == 7);
+
+	assigned.close();
+	WOB_ASSERT(!assigned.isOpen() && assigned.size() == 0);
+	remove("mapped.bin");
+}
+
+static void testEdgeCases()
+{
+	MappedFile file;
+	WOB_ASSERT(!file.open("does_not_exist.bin"));
+	WOB_ASSERT(!file.isOpen());
+
+	writeFile("empty.bin", 0);
+	WOB_ASSERT(file.open("empty.bin", FileAccess::Random));
+	WOB_ASSERT(file.isOpen() && file.size() == 0 && file.view().empty());
+	file.prefetch();
+	file.close();
+	remove("empty.bin");
+}
+
+int main()
+{
+	testMapping();
+	testEdgeCases();
+	printf("mapped file tests passed\n");
+	return 0;
+}
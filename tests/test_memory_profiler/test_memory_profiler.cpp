@@ -0,0 +1,281 @@
+#include "core/wob.hpp"
+#include "core/memoryProfiler.hpp"
+#include "core/allocator.hpp"
+#include "core/array.hpp"
+#include "core/thread.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static void testTagsAndPeak()
+{
+	MemoryProfiler profiler(mallocator, 256, 64);
+	AllocatorProfiler tracked(mallocator, &profiler);
+
+	void* untagged = tracked.allocate(100, 8);
+	void* renderer;
+	{
+		MemoryScope scope(MemoryTag::Renderer);
+		renderer = tracked.allocate(1000, 64);
+	}
+
+	MemoryStats stats = profiler.tagStats(MemoryTag::Renderer);
+	WOB_ASSERT(stats.liveBytes == 1000 && stats.liveCount == 1);
+	WOB_ASSERT(profiler.tagStats(MemoryTag::Untagged).liveBytes == 100);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 1100);
+	WOB_ASSERT(tracked.liveAllocationCount() == 2);
+
+	tracked.deallocate(renderer);
+	stats = profiler.tagStats(MemoryTag::Renderer);
+	WOB_ASSERT(stats.liveBytes == 0 && stats.peakBytes == 1000 && stats.totalCount == 1);
+	WOB_ASSERT(profiler.totalStats().peakBytes == 1100);
+
+	tracked.deallocate(untagged);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 0);
+	WOB_ASSERT(profiler.dumpLeaks() == 0);
+}
+
+// allocations made in the same scope share a callsite, a reallocated block keeps it
+static void testCallsites()
+{
+	MemoryProfiler profiler(mallocator, 256, 64);
+	AllocatorProfiler tracked(mallocator, &profiler);
+
+	Array<uint32_t>* values;
+	{
+		MemoryScope scope(MemoryTag::Game);
+		values = tracked.create<Array<uint32_t>>(tracked);
+		for (uint32_t i = 0; i < 1000; i++)
+			values->push(i);
+	}
+
+	uint32_t found = 0;
+	for (uint32_t i = 0; i < profiler.callsiteCapacity(); i++)
+	{
+		MemoryCallsite site;
+		if (!profiler.getCallsite(i, site))
+			continue;
+		found++;
+		WOB_ASSERT(site.tag == MemoryTag::Game);
+		WOB_ASSERT(site.line != 0);
+		WOB_ASSERT(site.stats.liveCount == 2);
+		WOB_ASSERT(site.stats.liveBytes == (int64_t)(sizeof(Array<uint32_t>) + values->capacity() * sizeof(uint32_t)));
+	}
+	WOB_ASSERT(found == 1);
+
+	tracked.destroy(values);
+	WOB_ASSERT(profiler.totalStats().liveCount == 0);
+}
+
+// base allocator failing every reallocation, the old block must stay tracked
+class FailingRealloc final : public IAllocator
+{
+public:
+	[[nodiscard]] void* allocate(size_t size, size_t align) override { return mallocator.allocate(size, align); }
+	void deallocate(void* ptr) override { mallocator.deallocate(ptr); }
+	[[nodiscard]] void* reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align) override
+	{
+		WOB_UNUSED(ptr);
+		WOB_UNUSED(oldSize);
+		WOB_UNUSED(newSize);
+		WOB_UNUSED(align);
+		return nullptr;
+	}
+};
+
+static void testReallocate()
+{
+	MemoryProfiler profiler(mallocator, 256, 64);
+	AllocatorProfiler tracked(mallocator, &profiler);
+
+	void* block;
+	{
+		MemoryScope scope(MemoryTag::Assets);
+		block = tracked.allocate(100, 16);
+	}
+	block = tracked.reallocate(block, 100, 5000, 16);
+	MemoryStats stats = profiler.tagStats(MemoryTag::Assets);
+	WOB_ASSERT(stats.liveBytes == 5000 && stats.liveCount == 1);
+
+	FailingRealloc failing;
+	AllocatorProfiler failingTracked(failing, &profiler);
+	void* kept = failingTracked.allocate(64, 16);
+	WOB_ASSERT(failingTracked.reallocate(kept, 64, 128, 16) == nullptr);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 5064);
+	failingTracked.deallocate(kept);
+
+	tracked.deallocate(block);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 0);
+	WOB_ASSERT(profiler.dumpLeaks() == 0);
+}
+
+static void testFrameCounts()
+{
+	MemoryProfiler profiler(mallocator, 256, 64);
+	AllocatorProfiler tracked(mallocator, &profiler);
+
+	MemoryScope scope(MemoryTag::UI);
+	for (int frame = 0; frame < 3; frame++)
+	{
+		profiler.beginFrame();
+		for (int i = 0; i <= frame; i++)
+			tracked.deallocate(tracked.allocate(16, 8));
+	}
+	profiler.beginFrame();
+
+	MemoryStats const stats = profiler.tagStats(MemoryTag::UI);
+	WOB_ASSERT(stats.lastFrameCount == 3 && stats.lastFrameBytes == 48);
+	WOB_ASSERT(stats.totalCount == 6 && stats.peakBytes == 16);
+}
+
+static void testLeaksAndOverflow()
+{
+	MemoryProfiler profiler(mallocator, 16, 16);
+	AllocatorProfiler tracked(mallocator, &profiler);
+
+	void* blocks[20];
+	for (void*& block : blocks)
+		block = tracked.allocate(8, 8);
+
+	// the table holds 16 records, the others are counted but not tracked
+	WOB_ASSERT(profiler.droppedCount() == 4);
+	WOB_ASSERT(profiler.totalStats().liveCount == 16);
+
+	tracked.deallocate(blocks[0]);
+	WOB_ASSERT(profiler.dumpLeaks() == 15);
+
+	for (int i = 1; i < 20; i++)
+		tracked.deallocate(blocks[i]);
+	WOB_ASSERT(profiler.dumpLeaks() == 0);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 0);
+	WOB_ASSERT(tracked.liveAllocationCount() == 0);
+}
+
+// freed records leave deleted slots, the table is rehashed before they fill it
+static void testCompaction()
+{
+	MemoryProfiler profiler(mallocator, 64, 16);
+
+	// long lived records must stay reachable through the rehashes
+	uintptr_t const kept = 0x10000;
+	for (uintptr_t i = 0; i < 8; i++)
+		profiler.profileAlloc((void const*)(kept + i * 16), 16, 16);
+
+	for (uintptr_t i = 0; i < 10'000; i++)
+	{
+		void const* ptr = (void const*)(0x100000 + i * 64);
+		profiler.profileAlloc(ptr, 32, 16);
+		profiler.profileDealloc(ptr);
+		WOB_ASSERT(profiler.deletedRecordCount() < 16);
+	}
+	WOB_ASSERT(profiler.droppedCount() == 0);
+	WOB_ASSERT(profiler.totalStats().liveCount == 8);
+
+	for (uintptr_t i = 0; i < 8; i++)
+		profiler.profileResize((void const*)(kept + i * 16), 32);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 8 * 32);
+	for (uintptr_t i = 0; i < 8; i++)
+		profiler.profileDealloc((void const*)(kept + i * 16));
+	WOB_ASSERT(profiler.totalStats().liveBytes == 0);
+	WOB_ASSERT(profiler.dumpLeaks() == 0);
+}
+
+struct Worker
+{
+	Thread thread;
+	AllocatorProfiler* allocator;
+	MemoryTag tag;
+};
+
+static void churn(void* userData)
+{
+	Worker& worker = *static_cast<Worker*>(userData);
+	MemoryScope scope(worker.tag);
+	void* blocks[64];
+	for (int round = 0; round < 200; round++)
+	{
+		for (void*& block : blocks)
+			block = worker.allocator->allocate(32, 16);
+		for (void* block : blocks)
+			worker.allocator->deallocate(block);
+	}
+}
+
+struct AddressWorker
+{
+	Thread thread;
+	MemoryProfiler* profiler;
+	uintptr_t base;
+};
+
+// every address is new so deleted slots pile up and the table is rehashed under the other threads
+static void churnAddresses(void* userData)
+{
+	AddressWorker& worker = *static_cast<AddressWorker*>(userData);
+	uintptr_t next = worker.base;
+	for (int round = 0; round < 2000; round++)
+	{
+		uintptr_t const first = next;
+		for (int i = 0; i < 16; i++, next += 64)
+			worker.profiler->profileAlloc((void const*)next, 64, 16);
+		for (uintptr_t ptr = first; ptr != next; ptr += 64)
+			worker.profiler->profileDealloc((void const*)ptr);
+	}
+}
+
+static void testConcurrentCompaction()
+{
+	MemoryProfiler profiler(mallocator, 256, 16);
+	AddressWorker workers[4];
+	for (int i = 0; i < 4; i++)
+	{
+		workers[i].profiler = &profiler;
+		workers[i].base = (uintptr_t)(i + 1) << 28;
+		WOB_ASSERT(workers[i].thread.start(&churnAddresses, &workers[i]));
+	}
+	for (AddressWorker& worker : workers)
+		worker.thread.join();
+
+	WOB_ASSERT(profiler.droppedCount() == 0);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 0);
+	WOB_ASSERT(profiler.totalStats().liveCount == 0);
+	WOB_ASSERT(profiler.dumpLeaks() == 0);
+}
+
+static void testConcurrent()
+{
+	MemoryProfiler profiler(mallocator, 1024, 64);
+	AllocatorProfiler tracked(mallocator, &profiler);
+
+	Worker workers[4];
+	MemoryTag const tags[] = { MemoryTag::Core, MemoryTag::Renderer, MemoryTag::Assets, MemoryTag::Core };
+	for (int i = 0; i < 4; i++)
+	{
+		workers[i].allocator = &tracked;
+		workers[i].tag = tags[i];
+		WOB_ASSERT(workers[i].thread.start(&churn, &workers[i]));
+	}
+	for (Worker& worker : workers)
+		worker.thread.join();
+
+	WOB_ASSERT(profiler.droppedCount() == 0);
+	WOB_ASSERT(profiler.totalStats().liveBytes == 0);
+	WOB_ASSERT(profiler.tagStats(MemoryTag::Core).totalCount == 2 * 200 * 64);
+	WOB_ASSERT(profiler.tagStats(MemoryTag::Renderer).peakBytes == 64 * 32);
+	WOB_ASSERT(profiler.dumpLeaks() == 0);
+}
+
+int main()
+{
+	testTagsAndPeak();
+	testCallsites();
+	testReallocate();
+	testFrameCounts();
+	testLeaksAndOverflow();
+	testCompaction();
+	testConcurrent();
+	testConcurrentCompaction();
+	printf("memory profiler tests passed\n");
+	return 0;
+}
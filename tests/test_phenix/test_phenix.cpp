@@ -0,0 +1,135 @@
+#include "core/wob.hpp"
+#include "core/string.hpp"
+#include "renderer/phenixslang.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace wob;
+using namespace wob::phenix;
+
+static VarDecl makeMember(TType type, const char* name, AttributeType attribute)
+{
+	VarDecl member;
+	member.type = type;
+	member.name = name;
+	if (attribute != AttributeType::Custom)
+		member.attributes.push(Attribute{ attribute, String() });
+	return member;
+}
+
+static void setLiteral(LiteralNode& lit, vec4 v)
+{
+	lit.type = ASTNodeType::Literal;
+	lit.ltype = TType::Vec4;
+	lit.v4 = v;
+}
+
+static void checkOutput(String const& hlsl, const char* expected)
+{
+	if (strcmp(hlsl.c_str(), expected) != 0)
+	{
+		printf("got:\n%s\nexpected:\n%s\n", hlsl.c_str(), expected);
+		WOB_ASSERT(false);
+	}
+}
+
+// the output of a simple vertex stage program is pinned
+static void testVertexOutput()
+{
+	ShaderProgram program;
+	StructDecl output;
+	output.name = "VS_OUTPUT";
+	output.members.push(makeMember(TType::Vec4, "position", AttributeType::Position));
+	output.members.push(makeMember(TType::Vec4, "color", AttributeType::Color));
+	output.members.push(makeMember(TType::Vec2, "uv", AttributeType::Custom));
+	program.structDecl.push(wob::move(output));
+
+	// return input.color * float4(...) + float4(...);
+	VariableNode color;
+	color.type = ASTNodeType::VarDecl;
+	color.name = "input.color";
+	LiteralNode tint, bias;
+	setLiteral(tint, vec4(1.0f, 0.5f, 0.25f, 1.0f));
+	setLiteral(bias, vec4(0.1f, 0.1f, 0.1f, 0.0f));
+	BinaryOpNode mul;
+	mul.type = ASTNodeType::BinOp;
+	mul.op = BinaryOp::Mul;
+	mul.left = &color;
+	mul.right = &tint;
+	BinaryOpNode add;
+	add.type = ASTNodeType::BinOp;
+	add.op = BinaryOp::Add;
+	add.left = &mul;
+	add.right = &bias;
+	ReturnStatement ret;
+	ret.type = ASTNodeType::ReturnStatement;
+	ret.node = &add;
+
+	FunDef main;
+	main.name = "main";
+	main.retType = TType::Vec4;
+	VarDecl input;
+	input.name = "input";
+	input.type = TType::UserDefined;
+	input.type.userTypeName = "VS_OUTPUT";
+	main.args.push(wob::move(input));
+	main.body.statements.push(&ret);
+	program.fnDefs.push(wob::move(main));
+
+	checkOutput(compileToHLSL(program),
+		"struct VS_OUTPUT\n"
+		"{\n"
+		"\tfloat4 position : SV_POSITION;\n"
+		"\tfloat4 color : COLOR;\n"
+		"\tfloat2 uv;\n"
+		"}\n"
+		"\n"
+		"float4 main(VS_OUTPUT input)\n"
+		"{\n"
+		"\treturn input.color * float4(1f, 0.5f, 0.25f, 1f) + float4(0.1f, 0.1f, 0.1f, 0f);\n"
+		"}\n");
+}
+
+// statements of a nested block are emitted, they used to be dropped
+static void testCompoundStatement()
+{
+	VariableNode value;
+	value.type = ASTNodeType::VarDecl;
+	value.name = "value";
+	ReturnStatement ret;
+	ret.type = ASTNodeType::ReturnStatement;
+	ret.node = &value;
+	CompoundStatementNode block;
+	block.type = ASTNodeType::CompoundStatement;
+	block.statements.push(&ret);
+
+	ShaderProgram program;
+	FunDef fn;
+	fn.name = "identity";
+	fn.retType = TType::Float;
+	VarDecl arg;
+	arg.name = "value";
+	arg.type = TType::Float;
+	fn.args.push(wob::move(arg));
+	fn.body.statements.push(&block);
+	program.fnDefs.push(wob::move(fn));
+
+	checkOutput(compileToHLSL(program),
+		"float identity(float value)\n"
+		"{\n"
+		"\t{\n"
+		"return value;\n"
+		"}\n"
+		";\n"
+		"}\n");
+}
+
+int main()
+{
+	testVertexOutput();
+	testCompoundStatement();
+
+	printf("phenix tests passed\n");
+	return 0;
+}
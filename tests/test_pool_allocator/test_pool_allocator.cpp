@@ -0,0 +1,99 @@
+#include "core/wob.hpp"
+#include "core/poolAllocator.hpp"
+#include "core/slist.hpp"
+
+#include <string.h>
+
+using namespace wob;
+
+struct Particle
+{
+	float position[3];
+	float velocity[3];
+	uint32_t id;
+};
+
+static void testReuse()
+{
+	PoolAllocator<Particle> pool(mallocator, 4);
+	WOB_ASSERT(pool.blockSize() >= sizeof(Particle));
+
+	Particle* particles[10];
+	for (uint32_t i = 0; i < 10; i++)
+	{
+		particles[i] = pool.create<Particle>();
+		WOB_ASSERT(((uintptr_t)particles[i] & (alignof(Particle) - 1)) == 0);
+		particles[i]->id = i;
+	}
+	WOB_ASSERT(pool.allocatedCount() == 10);
+	WOB_ASSERT(pool.capacity() == 12);
+
+	for (uint32_t i = 0; i < 10; i++)
+		WOB_ASSERT(particles[i]->id == i);
+
+	// last freed, first reused
+	pool.destroy(particles[3]);
+	pool.destroy(particles[7]);
+	WOB_ASSERT(pool.allocatedCount() == 8);
+	WOB_ASSERT(pool.create<Particle>() == particles[7]);
+	WOB_ASSERT(pool.create<Particle>() == particles[3]);
+	WOB_ASSERT(pool.capacity() == 12);
+}
+
+static void testResetAndRelease()
+{
+	FixedBlockAllocator pool(mallocator, 40, 16, 8);
+	WOB_ASSERT(pool.blockSize() == 48);
+
+	void* first = nullptr;
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		void* const block = pool.allocate(40, 16);
+		WOB_ASSERT(((uintptr_t)block & 15) == 0);
+		memset(block, (int)i, 40);
+		if (i == 0)
+			first = block;
+	}
+	WOB_ASSERT(pool.capacity() == 24);
+
+	// blocks are all free again but the chunks stay
+	pool.reset();
+	WOB_ASSERT(pool.allocatedCount() == 0);
+	WOB_ASSERT(pool.capacity() == 24);
+	for (uint32_t i = 0; i < 24; i++)
+		WOB_ASSERT(pool.allocate(40, 16) != nullptr);
+	WOB_ASSERT(pool.capacity() == 24);
+
+	pool.release();
+	WOB_ASSERT(pool.capacity() == 0 && pool.allocatedCount() == 0);
+	WOB_ASSERT(pool.allocate(8, 8) != nullptr);
+	WOB_UNUSED(first);
+}
+
+static void testSListPool()
+{
+	SList<int>::NodePool pool(mallocator, 64);
+	{
+		SList<int> list(&pool);
+		for (int i = 0; i < 100; i++)
+			list.add(int(i));
+		WOB_ASSERT(list.size() == 100);
+		WOB_ASSERT(pool.allocatedCount() == 100);
+
+		list.removeFront();
+		list.removeFirst([](auto* node) { return node->data == 50; });
+		WOB_ASSERT(list.size() == 98);
+		WOB_ASSERT(pool.allocatedCount() == 98);
+		WOB_ASSERT(list.find(50) == list.end());
+	}
+	WOB_ASSERT(pool.allocatedCount() == 0);
+}
+
+int main()
+{
+	testReuse();
+	testResetAndRelease();
+	testSListPool();
+	printf("pool allocator tests passed\n");
+	return 0;
+}
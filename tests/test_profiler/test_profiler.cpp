@@ -0,0 +1,172 @@
+// the profiler macros compile away unless profiling is enabled
+#ifndef WOB_ENABLE_PROFILING
+#define WOB_ENABLE_PROFILING
+#endif
+
+#include "core/wob.hpp"
+#include "core/profiler.hpp"
+#include "core/thread.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace wob;
+
+static volatile uint64_t sink = 0;
+
+static void spin(uint32_t n)
+{
+	for (uint32_t i = 0; i < n; i++)
+		sink = sink + i;
+}
+
+static void leaf()
+{
+	WOB_PROFILE_FUNCTION();
+	spin(1000);
+}
+
+static void update()
+{
+	WOB_PROFILE_FUNCTION();
+	for (int i = 0; i < 3; i++)
+		leaf();
+}
+
+static void draw()
+{
+	WOB_PROFILE_FUNCTION();
+	leaf();
+	{
+		WOB_PROFILE_SCOPE("draw submit");
+		spin(5000);
+	}
+}
+
+static void worker(void*)
+{
+	WOB_PROFILE_SCOPE("worker job");
+	spin(20000);
+}
+
+static ProfileData const* findNode(ProfileSession const& session, const char* name, const char* parentName)
+{
+	for (ProfileData const& data : session.profileDatas)
+	{
+		if (strcmp(data.name, name) == 0 && strcmp(data.parentName, parentName) == 0)
+			return &data;
+	}
+	return nullptr;
+}
+
+static void testHierarchy()
+{
+	// recorded outside a session, must be ignored
+	update();
+
+	WOB_START_PROFILE_SESSION("frames");
+	for (int frame = 0; frame < 4; frame++)
+	{
+		WOB_PROFILE_FRAME();
+		update();
+		draw();
+	}
+	Thread thread;
+	WOB_ASSERT(thread.start(&worker, nullptr, "profiled worker"));
+	thread.join();
+	ProfileSession const session = WOB_STOP_PROFILE_SESSION();
+
+	WOB_ASSERT(session.frameCount == 4);
+	WOB_ASSERT(session.threadNames.size() == 2);
+
+	ProfileData const* updateNode = findNode(session, "update", "none");
+	ProfileData const* updateLeaf = findNode(session, "leaf", "update");
+	ProfileData const* drawLeaf = findNode(session, "leaf", "draw");
+	ProfileData const* submit = findNode(session, "draw submit", "draw");
+	ProfileData const* job = findNode(session, "worker job", "none");
+	WOB_ASSERT(updateNode && updateLeaf && drawLeaf && submit && job);
+
+	WOB_ASSERT(updateNode->count == 4);
+	WOB_ASSERT(updateLeaf->count == 12);
+	WOB_ASSERT(drawLeaf->count == 4);
+	WOB_ASSERT(updateLeaf->depth == 1);
+	WOB_ASSERT(updateNode->elapsedTime >= updateLeaf->elapsedTime);
+	WOB_ASSERT(updateNode->selfTime >= 0.0 && updateNode->selfTime <= updateNode->elapsedTime);
+	WOB_ASSERT(job->thread != updateNode->thread);
+	WOB_ASSERT(strcmp(session.threadNames[job->thread], "profiled worker") == 0);
+
+	// 4 frame markers, 4 update, 12 leaf, 4 draw, 4 leaf, 4 submit, 1 job
+	WOB_ASSERT(session.events.size() == 33);
+
+	char path[] = "test_profiler_trace.json";
+	WOB_ASSERT(session.exportChromeTrace(path));
+	FILE* file = fopen(path, "rb");
+	WOB_ASSERT(file);
+	char content[256] = {};
+	size_t const read = fread(content, 1, sizeof(content) - 1, file);
+	fclose(file);
+	remove(path);
+	WOB_ASSERT(read > 0);
+	WOB_ASSERT(strncmp(content, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 39) == 0);
+
+	printf("session %s : %.3f ms, %u frames, %u nodes\n", session.name, session.elapsedSessionTime, session.frameCount, session.profileDatas.size());
+}
+
+static void testOpenScope()
+{
+	WOB_ASSERT(currentProfileScope() == nullptr);
+	WOB_START_PROFILE_SESSION("open scope");
+	WOB_PROFILE_SCOPE("still open");
+	leaf();
+	WOB_ASSERT(strcmp(currentProfileScope(), "still open") == 0);
+	ProfileSession const session = WOB_STOP_PROFILE_SESSION();
+
+	ProfileData const* open = findNode(session, "still open", "none");
+	WOB_ASSERT(open && open->count == 1);
+	WOB_ASSERT(findNode(session, "leaf", "still open"));
+	// events of the previous session are not mixed in
+	WOB_ASSERT(session.frameCount == 0);
+	WOB_ASSERT(session.events.size() == 2);
+}
+
+static void idle(void*)
+{
+}
+
+// profiles of exited threads are reused, naming a thread allocates nothing
+static void testThreadChurn()
+{
+	uint32_t const before = profilerThreadCount();
+	for (int i = 0; i < 16; i++)
+	{
+		Thread thread;
+		WOB_ASSERT(thread.start(&idle, nullptr, "idle"));
+		thread.join();
+	}
+	WOB_ASSERT(profilerThreadCount() == before);
+
+	for (int i = 0; i < 16; i++)
+	{
+		WOB_START_PROFILE_SESSION("churn");
+		Thread thread;
+		WOB_ASSERT(thread.start(&worker, nullptr, "churned worker"));
+		thread.join();
+		ProfileSession const session = WOB_STOP_PROFILE_SESSION();
+
+		// the exited thread events are still collected
+		ProfileData const* job = findNode(session, "worker job", "none");
+		WOB_ASSERT(job && job->count == 1);
+		WOB_ASSERT(strcmp(session.threadNames[job->thread], "churned worker") == 0);
+	}
+	// the worker of testHierarchy exited, its profile is reused
+	WOB_ASSERT(profilerThreadCount() == before);
+}
+
+int main()
+{
+	testHierarchy();
+	testOpenScope();
+	testThreadChurn();
+	printf("profiler tests passed\n");
+	return 0;
+}
@@ -0,0 +1,93 @@
+#include "core/wob.hpp"
+#include "core/segmentedArray.hpp"
+#include "core/string.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+// addresses stay valid while the array grows
+static void testStableAddresses()
+{
+	SegmentedArray<uint32_t, 16> values;
+	uint32_t* firsts[4];
+	for (uint32_t i = 0; i < 1000; i++)
+	{
+		uint32_t& e = values.push(i);
+		if (i < 4)
+			firsts[i] = &e;
+	}
+
+	WOB_ASSERT(values.size() == 1000);
+	WOB_ASSERT(values.capacity() == 1008);
+	for (uint32_t i = 0; i < 4; i++)
+		WOB_ASSERT(*firsts[i] == i && &values[i] == firsts[i]);
+	for (uint32_t i = 0; i < 1000; i++)
+		WOB_ASSERT(values[i] == i);
+	WOB_ASSERT(values.back() == 999);
+}
+
+static void testIteration()
+{
+	SegmentedArray<uint32_t, 8> values;
+	WOB_ASSERT(values.begin() == values.end());
+	for (uint32_t i = 0; i < 20; i++)
+		values.push(i);
+
+	uint32_t expected = 0;
+	for (uint32_t v : values)
+		WOB_ASSERT(v == expected++);
+	WOB_ASSERT(expected == 20);
+
+	// chunk by chunk, the last chunk is partial
+	WOB_ASSERT(values.chunkCount() == 3);
+	WOB_ASSERT(values.chunk(0).size() == 8 && values.chunk(2).size() == 4);
+	uint32_t sum = 0;
+	for (uint32_t c = 0; c < values.chunkCount(); c++)
+		for (uint32_t v : values.chunk(c))
+			sum += v;
+	WOB_ASSERT(sum == 190);
+
+	// exact multiple of the chunk size
+	values.pop();
+	values.pop();
+	values.pop();
+	values.pop();
+	WOB_ASSERT(values.chunkCount() == 2 && values.chunk(1).size() == 8);
+	expected = 0;
+	SegmentedArray<uint32_t, 8> const& constValues = values;
+	for (uint32_t v : constValues)
+		WOB_ASSERT(v == expected++);
+	WOB_ASSERT(expected == 16);
+}
+
+static void testClearKeepsChunks()
+{
+	SegmentedArray<String, 4> strings;
+	for (int i = 0; i < 10; i++)
+		strings.emplace("a string long enough to allocate its own buffer");
+	uint32_t const capacity = strings.capacity();
+	String* const first = &strings[0];
+
+	strings.clear();
+	WOB_ASSERT(strings.empty() && strings.capacity() == capacity);
+	strings.push(String("reused"));
+	WOB_ASSERT(&strings[0] == first && strings[0] == "reused");
+
+	SegmentedArray<String, 4> moved = wob::move(strings);
+	WOB_ASSERT(strings.empty() && moved.size() == 1 && &moved[0] == first);
+
+	moved.release();
+	WOB_ASSERT(moved.empty() && moved.capacity() == 0);
+	moved.push(String("after release"));
+	WOB_ASSERT(moved.size() == 1);
+}
+
+int main()
+{
+	testStableAddresses();
+	testIteration();
+	testClearKeepsChunks();
+	printf("segmented array tests passed\n");
+	return 0;
+}
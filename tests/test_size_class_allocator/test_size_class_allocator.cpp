@@ -0,0 +1,210 @@
+#include "core/wob.hpp"
+#include "core/sizeClassAllocator.hpp"
+#include "core/virtualMemory.hpp"
+#include "core/thread.hpp"
+#include "core/atomic.hpp"
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace wob;
+
+static bool isAligned(void const* ptr, size_t align)
+{
+	return ((uintptr_t)ptr & (align - 1)) == 0;
+}
+
+static void testSmallBlocks()
+{
+	SizeClassAllocator allocator;
+	void* blocks[512];
+	for (uint32_t i = 0; i < 512; i++)
+	{
+		size_t const size = 1 + (i * 37) % SizeClassAllocator::maxSmallSize;
+		blocks[i] = allocator.allocate(size, 1);
+		WOB_ASSERT(blocks[i] && isAligned(blocks[i], 16));
+		WOB_ASSERT(SizeClassAllocator::blockSize(blocks[i]) >= size);
+		memset(blocks[i], (int)i, size);
+	}
+	for (uint32_t i = 0; i < 512; i++)
+	{
+		WOB_ASSERT(*static_cast<uint8_t*>(blocks[i]) == (uint8_t)i);
+		allocator.deallocate(blocks[i]);
+	}
+
+	// a freed block is handed back first
+	void* const a = allocator.allocate(100, 16);
+	allocator.deallocate(a);
+	WOB_ASSERT(allocator.allocate(100, 16) == a);
+	WOB_ASSERT(allocator.tryExpandInPlace(a, SizeClassAllocator::blockSize(a)));
+	WOB_ASSERT(!allocator.tryExpandInPlace(a, SizeClassAllocator::blockSize(a) + 1));
+	allocator.deallocate(a);
+}
+
+static void testAlignment()
+{
+	SizeClassAllocator allocator;
+	size_t const pageSize = vm::pageSize();
+	for (size_t align = 1; align <= pageSize; align *= 2)
+	{
+		void* blocks[8];
+		size_t const sizes[] = { 1, align, align + 1, 3000 };
+		for (size_t size : sizes)
+		{
+			for (void*& block : blocks)
+			{
+				block = allocator.allocate(size, align);
+				WOB_ASSERT(block && isAligned(block, align));
+				memset(block, 0xAB, size);
+			}
+			for (void* block : blocks)
+				allocator.deallocate(block);
+		}
+	}
+}
+
+static void testLargeBlocks()
+{
+	SizeClassAllocator allocator;
+	size_t const sizes[] = { SizeClassAllocator::maxSmallSize + 1, 100_kb, 1_mb + 3, 8_mb };
+	for (size_t size : sizes)
+	{
+		uint8_t* const block = static_cast<uint8_t*>(allocator.allocate(size, 64));
+		WOB_ASSERT(block && isAligned(block, 64));
+		WOB_ASSERT(SizeClassAllocator::blockSize(block) >= size);
+		block[0] = 1;
+		block[size - 1] = 2;
+		allocator.deallocate(block);
+
+		// the freed block is cached and reused for the same size
+		void* const again = allocator.allocate(size, 64);
+		WOB_ASSERT(again == block);
+		allocator.deallocate(again);
+	}
+
+	void* const aligned = allocator.allocate(20_kb, vm::pageSize());
+	WOB_ASSERT(aligned && isAligned(aligned, vm::pageSize()));
+	allocator.deallocate(aligned);
+}
+
+struct RemoteFrees
+{
+	SizeClassAllocator* allocator;
+	void** blocks;
+	uint32_t count;
+};
+
+static void freeAll(void* userData)
+{
+	RemoteFrees& frees = *static_cast<RemoteFrees*>(userData);
+	for (uint32_t i = 0; i < frees.count; i++)
+		frees.allocator->deallocate(frees.blocks[i]);
+}
+
+static void testRemoteFrees()
+{
+	SizeClassAllocator allocator;
+	constexpr uint32_t count = 4096;
+	static void* blocks[count];
+	for (uint32_t round = 0; round < 4; round++)
+	{
+		for (uint32_t i = 0; i < count; i++)
+		{
+			blocks[i] = allocator.allocate(32 + (i % 8) * 16, 16);
+			WOB_ASSERT(blocks[i]);
+			memset(blocks[i], 0x5A, 32);
+		}
+
+		// half freed by each of two threads while we keep allocating
+		RemoteFrees first{ &allocator, blocks, count / 2 };
+		RemoteFrees second{ &allocator, blocks + count / 2, count / 2 };
+		Thread a, b;
+		WOB_ASSERT(a.start(&freeAll, &first) && b.start(&freeAll, &second));
+		void* local[256];
+		for (void*& block : local)
+			block = allocator.allocate(64, 16);
+		a.join();
+		b.join();
+		for (void* block : local)
+			allocator.deallocate(block);
+	}
+}
+
+// a long lived worker sees allocators come and go, more than it has tls slots
+struct Worker
+{
+	Semaphore start;
+	Semaphore done;
+	SizeClassAllocator* allocator = nullptr;
+	void* block = nullptr;
+	bool stop = false;
+};
+
+static void workerLoop(void* userData)
+{
+	Worker& worker = *static_cast<Worker*>(userData);
+	for (;;)
+	{
+		worker.start.wait();
+		if (worker.stop)
+			return;
+		worker.block = worker.allocator->allocate(48, 16);
+		WOB_ASSERT(worker.block);
+		memset(worker.block, 0x11, 48);
+		worker.done.signal();
+	}
+}
+
+static void testAllocatorLifetimes()
+{
+	Worker worker;
+	Thread thread;
+	WOB_ASSERT(thread.start(&workerLoop, &worker));
+	for (uint32_t i = 0; i < 20; i++)
+	{
+		SizeClassAllocator* const allocator = new SizeClassAllocator();
+		worker.allocator = allocator;
+		worker.start.signal();
+		worker.done.wait();
+		allocator->deallocate(worker.block);
+		delete allocator;
+	}
+	worker.stop = true;
+	worker.start.signal();
+	thread.join();
+}
+
+static void allocateOnce(void* userData)
+{
+	SizeClassAllocator& allocator = *static_cast<SizeClassAllocator*>(userData);
+	void* blocks[64];
+	for (void*& block : blocks)
+		block = allocator.allocate(200, 16);
+	for (void* block : blocks)
+		allocator.deallocate(block);
+}
+
+// short lived threads reuse the heaps of the threads that exited
+static void testThreadChurn()
+{
+	SizeClassAllocator allocator;
+	for (uint32_t i = 0; i < 64; i++)
+	{
+		Thread thread;
+		WOB_ASSERT(thread.start(&allocateOnce, &allocator));
+		thread.join();
+	}
+	WOB_ASSERT(allocator.threadHeapCount() <= 2);
+}
+
+int main()
+{
+	testSmallBlocks();
+	testAlignment();
+	testLargeBlocks();
+	testRemoteFrees();
+	testAllocatorLifetimes();
+	testThreadChurn();
+	printf("size class allocator tests passed\n");
+	return 0;
+}
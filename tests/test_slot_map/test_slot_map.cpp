@@ -0,0 +1,110 @@
+#include "core/wob.hpp"
+#include "core/slotMap.hpp"
+#include "core/string.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static_assert(sizeof(Handle<int>) == 4);
+
+static void testInsertErase()
+{
+	SlotMap<String> names;
+	Handle<String> const a = names.insert(String("a"));
+	Handle<String> const b = names.insert(String("b, long enough to live on the heap"));
+	Handle<String> const c = names.emplace("c");
+	WOB_ASSERT(names.size() == 3);
+	WOB_ASSERT(names[a] == "a" && names[c] == "c");
+
+	// erase moves c into the hole of a
+	WOB_ASSERT(names.erase(a));
+	WOB_ASSERT(!names.contains(a) && names.get(a) == nullptr);
+	WOB_ASSERT(!names.erase(a));
+	WOB_ASSERT(names.size() == 2);
+	WOB_ASSERT(names[b] == "b, long enough to live on the heap" && names[c] == "c");
+	WOB_ASSERT(names.data()[0] == "c");
+	WOB_ASSERT(names.handleAt(0) == c && names.handleAt(1) == b);
+
+	// the slot of a is reused with a new generation, the old handle stays stale
+	Handle<String> const d = names.insert(String("d"));
+	WOB_ASSERT(d.index() == a.index());
+	WOB_ASSERT(d != a && !names.contains(a));
+	WOB_ASSERT(*names.get(d) == "d");
+
+	WOB_ASSERT(!names.contains(Handle<String>()));
+}
+
+static void testIterationIsDense()
+{
+	SlotMap<uint32_t> values;
+	Handle<uint32_t> handles[100];
+	for (uint32_t i = 0; i < 100; i++)
+		handles[i] = values.insert(i);
+	for (uint32_t i = 0; i < 100; i += 2)
+		values.erase(handles[i]);
+
+	uint32_t sum = 0;
+	for (uint32_t v : values)
+		sum += v;
+	WOB_ASSERT(values.size() == 50);
+	WOB_ASSERT(sum == 50 * 50);
+	WOB_ASSERT(values.end() - values.begin() == 50);
+
+	for (uint32_t i = 1; i < 100; i += 2)
+		WOB_ASSERT(values[handles[i]] == i);
+}
+
+static void testClearAndGenerations()
+{
+	SlotMap<int> map;
+	Handle<int> const first = map.insert(1);
+	map.clear();
+	WOB_ASSERT(map.empty() && !map.contains(first));
+
+	// churn a single element, the generation keeps changing and never produces a null handle
+	Handle<int> previous = map.insert(2);
+	for (int i = 0; i < 10000; i++)
+	{
+		map.erase(previous);
+		Handle<int> const next = map.insert(i);
+		WOB_ASSERT(next.isValid() && next != previous);
+		WOB_ASSERT(!map.contains(previous));
+		previous = next;
+	}
+	WOB_ASSERT(map.size() == 1);
+}
+
+// once a generation wraps a stale handle matches its free slot again, it must still be rejected
+static void testWrappedGenerationOnFreeSlot()
+{
+	SlotMap<int> map;
+	Handle<int> const stale = map.insert(1);
+	Handle<int> current = stale;
+	for (uint32_t i = 1; i < Handle<int>::maxGeneration; i++)
+	{
+		map.erase(current);
+		current = map.insert((int)i);
+	}
+	map.erase(current);
+	WOB_ASSERT(map.empty());
+
+	// same index and generation as the free slot
+	WOB_ASSERT(!map.contains(stale) && map.get(stale) == nullptr);
+	WOB_ASSERT(!map.erase(stale));
+
+	// the free list survived the stale erase
+	Handle<int> const a = map.insert(10);
+	Handle<int> const b = map.insert(20);
+	WOB_ASSERT(map.size() == 2 && map[a] == 10 && map[b] == 20 && a.index() != b.index());
+}
+
+int main()
+{
+	testInsertErase();
+	testIterationIsDense();
+	testClearAndGenerations();
+	testWrappedGenerationOnFreeSlot();
+	printf("slot map tests passed\n");
+	return 0;
+}
@@ -0,0 +1,119 @@
+#include "core/wob.hpp"
+#include "core/smallArray.hpp"
+#include "core/string.hpp"
+#include "core/ranges.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+// counts the allocations to check the inline storage is used
+class CountingAllocator final : public IAllocator
+{
+public:
+	void* allocate(size_t size, size_t align) override
+	{
+		allocations++;
+		live++;
+		return mallocator.allocate(size, align);
+	}
+
+	void deallocate(void* ptr) override
+	{
+		if (ptr)
+			live--;
+		mallocator.deallocate(ptr);
+	}
+
+	int allocations = 0;
+	int live = 0;
+};
+
+static void testInlineThenSpill()
+{
+	CountingAllocator counter;
+	{
+		SmallArray<uint32_t, 4> values(counter);
+		for (uint32_t i = 0; i < 4; i++)
+			values.push(i);
+		WOB_ASSERT(values.isInline());
+		WOB_ASSERT(values.capacity() == 4);
+		WOB_ASSERT(counter.allocations == 0);
+
+		values.push(4);
+		WOB_ASSERT(!values.isInline());
+		WOB_ASSERT(counter.allocations == 1);
+		for (uint32_t i = 0; i < 5; i++)
+			WOB_ASSERT(values[i] == i);
+
+		values.resize(3);
+		values.shrink();
+		WOB_ASSERT(values.isInline());
+		WOB_ASSERT(counter.live == 0);
+		WOB_ASSERT(values.size() == 3 && values.back() == 2);
+	}
+	WOB_ASSERT(counter.live == 0);
+}
+
+static void testNonTrivial()
+{
+	CountingAllocator counter;
+	{
+		SmallArray<String, 2> strings(counter);
+		strings.push(String("first"));
+		strings.emplace("second, long enough to be stored on the heap");
+		WOB_ASSERT(strings.isInline());
+
+		// copies stay inline when they fit
+		SmallArray<String, 2> copy = strings;
+		WOB_ASSERT(copy.isInline() && copy[1] == strings[1]);
+
+		strings.push(String("third"));
+		WOB_ASSERT(!strings.isInline());
+		WOB_ASSERT(strings[0] == "first" && strings[2] == "third");
+
+		String const popped = strings.popValue();
+		WOB_ASSERT(popped == "third" && strings.size() == 2);
+
+		// moving an inline array moves the elements, moving a spilled one steals the buffer
+		SmallArray<String, 2> movedInline = wob::move(copy);
+		WOB_ASSERT(copy.empty() && movedInline[0] == "first");
+
+		String const* const heapData = strings.data();
+		SmallArray<String, 2> movedHeap = wob::move(strings);
+		WOB_ASSERT(movedHeap.data() == heapData && strings.isInline() && strings.empty());
+
+		String values[] = { String("a"), String("b"), String("c") };
+		movedInline.insert(movedInline.begin() + 1, values);
+		WOB_ASSERT(movedInline.size() == 5);
+		WOB_ASSERT(movedInline[0] == "first" && movedInline[1] == "a" && movedInline[3] == "c");
+		WOB_ASSERT(movedInline[4] == "second, long enough to be stored on the heap");
+
+		auto it = ranges::findIf(movedInline, [](String const& s) { return s == "b"; });
+		WOB_ASSERT(it == movedInline.begin() + 2);
+	}
+	WOB_ASSERT(counter.live == 0);
+}
+
+static void testAppendAndPushN()
+{
+	SmallArray<uint8_t, 8> bytes;
+	bytes.pushN(0xAB, 6);
+	WOB_ASSERT(bytes.isInline());
+	uint8_t const tail[] = { 1, 2, 3, 4 };
+	bytes.append(ArrayView<uint8_t const>(tail, 4));
+	WOB_ASSERT(!bytes.isInline() && bytes.size() == 10);
+	WOB_ASSERT(bytes[5] == 0xAB && bytes[9] == 4);
+
+	bytes.clear();
+	WOB_ASSERT(bytes.empty() && !bytes.isInline());
+}
+
+int main()
+{
+	testInlineThenSpill();
+	testNonTrivial();
+	testAppendAndPushN();
+	printf("small array tests passed\n");
+	return 0;
+}
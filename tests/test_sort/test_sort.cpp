@@ -0,0 +1,188 @@
+#include "core/wob.hpp"
+#include "core/sort.hpp"
+#include "core/array.hpp"
+#include "core/string.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+// xorshift, deterministic inputs
+static uint32_t nextRandom(uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// inputs that break naive quick sorts
+static Array<uint32_t> makeInput(uint32_t n, uint32_t pattern)
+{
+	uint32_t state = 0x9E3779B9u + n;
+	Array<uint32_t> values;
+	values.reserve(n);
+	for (uint32_t i = 0; i < n; i++)
+	{
+		switch (pattern)
+		{
+		case 0: values.push(nextRandom(state)); break;
+		case 1: values.push(i); break;
+		case 2: values.push(n - i); break;
+		case 3: values.push(nextRandom(state) % 4); break;
+		case 4: values.push(i < n / 2 ? i : n - i); break; // organ pipe
+		default: values.push(7); break;
+		}
+	}
+	return values;
+}
+
+static uint64_t checksum(Array<uint32_t> const& values)
+{
+	uint64_t sum = 0;
+	for (uint32_t v : values)
+		sum += v;
+	return sum;
+}
+
+static void testSortPatterns()
+{
+	uint32_t const sizes[] = { 0, 1, 2, 3, 15, 16, 17, 100, 1000, 20000 };
+	for (uint32_t n : sizes)
+	{
+		for (uint32_t pattern = 0; pattern < 6; pattern++)
+		{
+			Array<uint32_t> const input = makeInput(n, pattern);
+			uint64_t const sum = checksum(input);
+
+			Array<uint32_t> a = input;
+			ranges::sort(a);
+			WOB_ASSERT(ranges::isSorted(a) && checksum(a) == sum);
+
+			Array<uint32_t> b = input;
+			ranges::stableSort(b);
+			WOB_ASSERT(ranges::isSorted(b) && checksum(b) == sum);
+
+			Array<uint32_t> c = input;
+			ranges::radixSort(c);
+			WOB_ASSERT(ranges::isSorted(c) && checksum(c) == sum);
+
+			// every algorithm gives the same result
+			for (uint32_t i = 0; i < n; i++)
+				WOB_ASSERT(a[i] == b[i] && a[i] == c[i]);
+		}
+	}
+}
+
+static void testComparator()
+{
+	int32_t values[] = { 5, -3, 9, 0, -3, 12, 7 };
+	ranges::sort(values, [](int32_t a, int32_t b) { return a > b; });
+	int32_t const expected[] = { 12, 9, 7, 5, 0, -3, -3 };
+	for (uint32_t i = 0; i < wob::size(values); i++)
+		WOB_ASSERT(values[i] == expected[i]);
+
+	// C arrays are ranges too
+	float floats[] = { 2.5f, -1.0f, 0.0f, -8.0f, 3.0f };
+	ranges::sort(floats);
+	WOB_ASSERT(floats[0] == -8.0f && floats[4] == 3.0f && ranges::isSorted(floats));
+
+	// non trivial elements
+	Array<String> names;
+	names.push(String("delta"));
+	names.push(String("alpha, long enough to live on the heap"));
+	names.push(String("charlie"));
+	names.push(String("bravo"));
+	ranges::stableSort(names, [](String const& a, String const& b) { return strcmp(a.c_str(), b.c_str()) < 0; });
+	WOB_ASSERT(names[0] == "alpha, long enough to live on the heap" && names[1] == "bravo" && names[3] == "delta");
+}
+
+struct Item
+{
+	uint32_t key;
+	uint32_t order;
+};
+
+static void testStability()
+{
+	uint32_t state = 1234;
+	Array<Item> items;
+	for (uint32_t i = 0; i < 5000; i++)
+		items.push({ nextRandom(state) % 50, i });
+
+	Array<Item> merged = items;
+	ranges::stableSort(merged, [](Item const& a, Item const& b) { return a.key < b.key; });
+
+	Array<Item> radix = items;
+	ranges::radixSort(radix, [](Item const& item) { return item.key; });
+
+	for (uint32_t i = 1; i < items.size(); i++)
+	{
+		WOB_ASSERT(merged[i - 1].key < merged[i].key || (merged[i - 1].key == merged[i].key && merged[i - 1].order < merged[i].order));
+		WOB_ASSERT(radix[i].key == merged[i].key && radix[i].order == merged[i].order);
+	}
+}
+
+static void testRadixKeys()
+{
+	// keys keep the order of signed and float values
+	WOB_ASSERT(ranges::radixKey(-1) < ranges::radixKey(0) && ranges::radixKey(0) < ranges::radixKey(1));
+	WOB_ASSERT(ranges::radixKey((int64_t)-5) < ranges::radixKey((int64_t)3));
+	WOB_ASSERT(ranges::radixKey(-2.0f) < ranges::radixKey(-1.0f) && ranges::radixKey(-1.0f) < ranges::radixKey(0.0f));
+	WOB_ASSERT(ranges::radixKey(0.0f) < ranges::radixKey(0.5f) && ranges::radixKey(0.5f) < ranges::radixKey(100.0f));
+	WOB_ASSERT(ranges::radixKey(-1.0) < ranges::radixKey(1.0));
+
+	uint32_t state = 77;
+	Array<float> floats;
+	for (uint32_t i = 0; i < 3000; i++)
+		floats.push(((float)(nextRandom(state) % 20000) - 10000.0f) * 0.125f);
+	ranges::radixSort(floats);
+	WOB_ASSERT(ranges::isSorted(floats));
+
+	Array<int64_t> signedValues;
+	for (uint32_t i = 0; i < 3000; i++)
+		signedValues.push((int64_t)nextRandom(state) - (int64_t)0x8000'0000 + ((int64_t)(i % 3) << 40));
+	ranges::radixSort(signedValues);
+	WOB_ASSERT(ranges::isSorted(signedValues));
+
+	// 64 bits Morton codes with a custom scratch allocator
+	Array<uint64_t> codes;
+	for (uint32_t i = 0; i < 3000; i++)
+		codes.push(((uint64_t)nextRandom(state) << 32) | nextRandom(state));
+	ranges::radixSort(codes, ranges::RadixKey{}, *getContextAllocator());
+	WOB_ASSERT(ranges::isSorted(codes));
+}
+
+static void testParallelSort()
+{
+	uint32_t const sizes[] = { 100, 1 << 16, 300001 };
+	uint32_t const threadCounts[] = { 0, 1, 2, 3, 8 };
+	for (uint32_t n : sizes)
+	{
+		for (uint32_t threadCount : threadCounts)
+		{
+			Array<uint32_t> values = makeInput(n, threadCount % 2 == 0 ? 0 : 3);
+			uint64_t const sum = checksum(values);
+			ranges::parallelSort(values, ranges::Less{}, threadCount);
+			WOB_ASSERT(ranges::isSorted(values) && checksum(values) == sum);
+		}
+	}
+
+	Array<String> names;
+	uint32_t state = 5;
+	for (uint32_t i = 0; i < 200000; i++)
+		names.push(String(nextRandom(state) % 2 ? "b" : "a"));
+	ranges::parallelSort(names, [](String const& a, String const& b) { return strcmp(a.c_str(), b.c_str()) < 0; }, 4);
+	WOB_ASSERT(ranges::isSorted(names, [](String const& a, String const& b) { return strcmp(a.c_str(), b.c_str()) < 0; }));
+}
+
+int main()
+{
+	testSortPatterns();
+	testComparator();
+	testStability();
+	testRadixKeys();
+	testParallelSort();
+	printf("sort tests passed\n");
+	return 0;
+}
@@ -0,0 +1,110 @@
+#include "core/wob.hpp"
+#include "core/steadyFrame.hpp"
+#include "core/frameAllocator.hpp"
+#include "core/array.hpp"
+#include "core/string.hpp"
+#include "core/format.hpp"
+#include "core/thread.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+// what a steady frame is allowed to do : frame memory, formatting into a buffer, reusing reserved arrays
+static void testCleanFrame()
+{
+	FrameAllocator frame(mallocator, 4_kb);
+	Array<uint32_t> reserved;
+	reserved.reserve(64);
+
+	uint32_t const before = steadyFrameViolationCount();
+	beginSteadyFrame(SteadyFramePolicy::Report);
+	{
+		Array<uint32_t> transient(frame);
+		for (uint32_t i = 0; i < 64; i++)
+		{
+			transient.push(i);
+			reserved.push(i);
+		}
+
+		char buffer[64];
+		uint32_t const size = formatTo(buffer, sizeof(buffer), "frame {} : {} ms", 12, 16.6f);
+		WOB_ASSERT(size > 0);
+	}
+	endSteadyFrame();
+	WOB_ASSERT(steadyFrameViolationCount() == before);
+}
+
+static void testViolations()
+{
+	uint32_t const before = steadyFrameViolationCount();
+	beginSteadyFrame(SteadyFramePolicy::Report);
+	WOB_ASSERT(isSteadyFrame());
+
+	// longer than the inline capacity of String
+	String const text = format("{} allocates once the text is too long to stay inline", "format");
+	WOB_ASSERT(steadyFrameViolationCount() == before + 1);
+
+	// growing an array reallocates
+	Array<uint32_t> values;
+	values.push(1);
+	uint32_t const afterPush = steadyFrameViolationCount();
+	WOB_ASSERT(afterPush > before + 1);
+
+	endSteadyFrame();
+	WOB_ASSERT(!isSteadyFrame());
+	// outside steady frames nothing is reported
+	values.resize(1000);
+	WOB_ASSERT(steadyFrameViolationCount() == afterPush);
+}
+
+static void testWhitelist()
+{
+	uint32_t const before = steadyFrameViolationCount();
+	beginSteadyFrame(SteadyFramePolicy::Trap);
+	{
+		WOB_ALLOW_FRAME_ALLOCATIONS("log history grows until it is full");
+		Array<int> history;
+		history.resize(100);
+	}
+
+	allowSteadyFrameAllocations(MemoryTag::Assets);
+	{
+		// the macro stays active without WOB_ENABLE_PROFILING, this test is built without it
+		WOB_MEMORY_SCOPE(MemoryTag::Assets);
+		String const path("textures/environment/streamed_terrain_albedo.png");
+	}
+	allowSteadyFrameAllocations(MemoryTag::Assets, false);
+	endSteadyFrame();
+	WOB_ASSERT(steadyFrameViolationCount() == before);
+}
+
+// steady frames are per thread, workers keep allocating freely
+static void worker(void* userData)
+{
+	uint32_t* violations = static_cast<uint32_t*>(userData);
+	Array<int> values;
+	values.resize(100);
+	*violations = steadyFrameViolationCount();
+}
+
+static void testOtherThreads()
+{
+	uint32_t workerViolations = 1;
+	beginSteadyFrame(SteadyFramePolicy::Trap);
+	Thread thread;
+	WOB_ASSERT(thread.start(&worker, &workerViolations));
+	thread.join();
+	endSteadyFrame();
+	WOB_ASSERT(workerViolations == 0);
+}
+
+int main()
+{
+	testCleanFrame();
+	testViolations();
+	testWhitelist();
+	testOtherThreads();
+	printf("steady frame tests passed\n");
+	return 0;
+}
@@ -1,6 +1,7 @@
 #include "core/wob.hpp"
 #include "core/string.hpp"
 #include "core/hashmap.hpp"
+#include "core/stringBuilder.hpp"
 
 using namespace wob;
 
@@ -9,7 +10,7 @@ int main()
 	{
 		String str;
 		WOB_ASSERT(str.size() == 0);
-		WOB_ASSERT(str.capacity() == 0);
+		WOB_ASSERT(str.capacity() == String::inlineCapacity);
 		str.append("a");
 		WOB_ASSERT(str.size() == 1);
 		WOB_ASSERT(str == "a");
@@ -40,7 +41,7 @@ int main()
 		WOB_ASSERT(strB.empty());
 		WOB_ASSERT(strB.capacity() > 0);
 		strB.shrink();
-		WOB_ASSERT(strB.capacity() == 0);
+		WOB_ASSERT(strB.isInline() && strB.capacity() == String::inlineCapacity);
 	}
 	{
 		WOB_LOG("[TEST] RHI");
@@ -68,5 +69,102 @@ int main()
 
 		puts(cFormat("hey %s %d", "coincoin", 5).c_str());
 	}
+	{
+		// inline up to inlineCapacity chars, then on the heap
+		String str;
+		WOB_ASSERT(str.isInline() && str.empty() && str.c_str()[0] == '\0');
+		for (uint32_t i = 0; i < String::inlineCapacity; i++)
+			str.append('a');
+		WOB_ASSERT(str.isInline() && str.size() == String::inlineCapacity && str.c_str()[String::inlineCapacity] == '\0');
+		str.append('b');
+		WOB_ASSERT(!str.isInline() && str.size() == String::inlineCapacity + 1 && str.back() == 'b');
+
+		String copy(str);
+		WOB_ASSERT(copy == str);
+		String moved(wob::move(copy));
+		WOB_ASSERT(moved == str && copy.empty());
+
+		str.resize(3);
+		str.shrink();
+		WOB_ASSERT(str.isInline() && str == "aaa");
+
+		String inserted("held");
+		StringView const lo("llo wor");
+		inserted.insert(inserted.begin() + 2, lo);
+		WOB_ASSERT(inserted == "hello world");
+
+		Array<String> strings;
+		strings.push(String("short"));
+		strings.push(String("a string too long for the inline storage"));
+		strings.reserve(100);
+		WOB_ASSERT(strings[0] == "short" && strings[1] == "a string too long for the inline storage");
+	}
+	{
+		char storage[8];
+		StringBuilder builder(storage);
+		builder.append("abc");
+		builder.append('d');
+		WOB_ASSERT(builder.view() == StringView("abcd") && builder.data() == storage);
+		builder.append(StringView("efghijkl"));
+		WOB_ASSERT(builder.view() == StringView("abcdefghijkl") && builder.data() != storage);
+		WOB_ASSERT(builder.toString() == "abcdefghijkl");
+
+		// grows in place as the last allocation of the stack allocator
+		StackAllocator stack(mallocator, 4_kb);
+		StringBuilder stackBuilder(stack, 16);
+		char const* const start = stackBuilder.data();
+		for (uint32_t i = 0; i < 100; i++)
+			stackBuilder.append("0123456789");
+		WOB_ASSERT(stackBuilder.size() == 1000 && stackBuilder.data() == start);
+
+		StringBuilder formatted(stack);
+		formatTo(formatted, "{} + {} = {}", 1, 2u, 3);
+		WOB_ASSERT(formatted.view() == StringView("1 + 2 = 3"));
+		WOB_ASSERT(format("{}-{}", "a", true) == "a-true");
+	}
+
+	{
+		WOB_LOG("[TEST] format");
+
+		WOB_ASSERT(format("{}", 0) == "0");
+		WOB_ASSERT(format("{} {} {}", 7, 42, 100) == "7 42 100");
+		WOB_ASSERT(format("{}", -1234567) == "-1234567");
+		WOB_ASSERT(format("{}", INT32_MIN) == "-2147483648");
+		WOB_ASSERT(format("{}", UINT32_MAX) == "4294967295");
+		WOB_ASSERT(format("{}", INT64_MIN) == "-9223372036854775808");
+		WOB_ASSERT(format("{}", UINT64_MAX) == "18446744073709551615");
+		WOB_ASSERT(format("{}", (int8_t)-128) == "-128");
+
+		enum class Code : uint16_t { A = 3, B = 65535 };
+		WOB_ASSERT(format("{}/{}", Code::A, Code::B) == "3/65535");
+
+		WOB_ASSERT(format("{{{}}} {{}}", 5) == "{5} {}");
+		WOB_ASSERT(format("no args") == "no args");
+		WOB_ASSERT(format("{}{}", 'x', false) == "xfalse");
+
+		char mutableStr[] = "mutable";
+		const char* nullStr = nullptr;
+		String const str("a string longer than the inline storage");
+		WOB_ASSERT(format("{}|{}|{}|{}", mutableStr, nullStr, StringView("view"), str)
+			== "mutable||view|a string longer than the inline storage");
+
+		// exact size precomputation
+		WOB_ASSERT(formattedSize("{} = {}", -10, "abc") == 9);
+		String const exact = format("{}, {}, {}", 123456789, 987654321, "exactly sized");
+		WOB_ASSERT(exact.size() == formattedSize("{}, {}, {}", 123456789, 987654321, "exactly sized"));
+
+		// caller buffer, written only when everything fits
+		char buffer[8];
+		WOB_ASSERT(formatTo(buffer, sizeof(buffer), "{}-{}", 12, 34) == 5);
+		WOB_ASSERT(StringView(buffer) == StringView("12-34"));
+		WOB_ASSERT(formatTo(buffer, sizeof(buffer), "{}-{}", 1234, 5678) == 9);
+		WOB_ASSERT(buffer[0] == '\0');
+
+		char storage[16];
+		StringBuilder builder(storage);
+		for (int i = 0; i < 10; i++)
+			formatTo(builder, "{},", i);
+		WOB_ASSERT(builder.view() == StringView("0,1,2,3,4,5,6,7,8,9,"));
+	}
 	return 0;
 }
\ No newline at end of file
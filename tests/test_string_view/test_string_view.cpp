@@ -0,0 +1,187 @@
+#include "core/wob.hpp"
+#include "core/stringView.hpp"
+#include "core/string.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+static constexpr CharClass whitespace = CharClass::whitespace();
+static constexpr CharClass identifier = CharClass::identifier();
+
+static_assert(whitespace.contains(' ') && whitespace.contains('\n') && !whitespace.contains('a'));
+static_assert(identifier.contains('_') && identifier.contains('Z') && identifier.contains('7') && !identifier.contains('('));
+static_assert((~identifier).contains('(') && !(~identifier).contains('x'));
+static_assert(CharClass::range('\x80', '\xFF').contains('\xE9') && !CharClass::range('\x80', '\xFF').contains('\x7F'));
+
+// reference implementations, every position and length around the vector sizes is checked against them
+static size_t naiveFind(StringView s, char c, size_t from)
+{
+	for (size_t i = from; i < s.size(); i++)
+	{
+		if (s.data()[i] == c)
+			return i;
+	}
+	return StringView::npos;
+}
+
+static size_t naiveFind(StringView s, StringView str, size_t from)
+{
+	for (size_t i = from; i + str.size() <= s.size(); i++)
+	{
+		if (memcmp(s.data() + i, str.data(), str.size()) == 0)
+			return i;
+	}
+	return StringView::npos;
+}
+
+static size_t naiveSkip(StringView s, CharClass const& cls, size_t from)
+{
+	size_t i = from;
+	while (i < s.size() && cls.contains(s.data()[i]))
+		i++;
+	return i < s.size() ? i : s.size();
+}
+
+static void testFindChar()
+{
+	char buffer[200];
+	for (size_t size = 0; size < 100; size++)
+	{
+		memset(buffer, 'a', sizeof(buffer));
+		StringView const view(buffer + 1, size);
+		WOB_ASSERT(view.find('b') == StringView::npos);
+		for (size_t pos = 0; pos < size; pos++)
+		{
+			buffer[1 + pos] = 'b';
+			// a match just outside the view must not be seen
+			buffer[1 + size] = 'c';
+			for (size_t from = 0; from <= size; from += 7)
+				WOB_ASSERT(view.find('b', from) == naiveFind(view, 'b', from));
+			WOB_ASSERT(view.find('c') == StringView::npos);
+			buffer[1 + pos] = 'a';
+		}
+	}
+	WOB_ASSERT(StringView().find('a') == StringView::npos);
+	WOB_ASSERT(StringView("abc").find('c', 10) == StringView::npos);
+}
+
+static void testFindString()
+{
+	const char* text = "the quick brown fox jumps over the lazy dog, then the quick brown fox sleeps under the lazy cat";
+	StringView const view(text);
+	const char* needles[] = { "the", "fox", "lazy cat", "cat", "t", "dog,", "sleeps under", "quick brown fox jumps over the lazy dog", "zebra", "then the" };
+	for (const char* needle : needles)
+	{
+		for (size_t from = 0; from <= view.size(); from += 5)
+			WOB_ASSERT(view.find(StringView(needle), from) == naiveFind(view, StringView(needle), from));
+	}
+	WOB_ASSERT(view.find(StringView("")) == 0 && view.find(StringView(""), 4) == 4);
+	WOB_ASSERT(StringView("ab").find(StringView("abc")) == StringView::npos);
+
+	// first and last chars match everywhere, only the full compare decides
+	char repeated[300];
+	memset(repeated, 'a', sizeof(repeated));
+	repeated[250] = 'b';
+	StringView const haystack(repeated, sizeof(repeated));
+	WOB_ASSERT(haystack.find(StringView("aaba")) == 248);
+	WOB_ASSERT(haystack.find(StringView("aab")) == 248);
+	WOB_ASSERT(haystack.find(StringView("aaaaaa")) == 0);
+	WOB_ASSERT(haystack.find(StringView("aaaaaa"), 246) == 251);
+	WOB_ASSERT(haystack.find(StringView("abba")) == StringView::npos);
+}
+
+static void testCount()
+{
+	// more than 255 vectors to flush the byte counters
+	String text;
+	size_t lines = 0;
+	for (uint32_t i = 0; i < 2000; i++)
+	{
+		text.append(i % 3 == 0 ? "line\n" : "a longer line of text\n");
+		lines++;
+	}
+	text.append("no newline at the end");
+	StringView const view = text;
+	WOB_ASSERT(view.count('\n') == lines);
+	WOB_ASSERT(view.count('#') == 0);
+	WOB_ASSERT(StringView().count('a') == 0);
+
+	for (size_t size = 0; size < 70; size++)
+	{
+		StringView const part(text.data(), size);
+		size_t expected = 0;
+		for (size_t i = 0; i < size; i++)
+			expected += text.data()[i] == 'e';
+		WOB_ASSERT(part.count('e') == expected);
+	}
+}
+
+static void testSkipWhile()
+{
+	char buffer[128];
+	for (size_t size = 0; size < 100; size++)
+	{
+		for (size_t stop = 0; stop <= size; stop += 3)
+		{
+			for (size_t i = 0; i < size; i++)
+				buffer[i] = " \t\r\n"[i % 4];
+			if (stop < size)
+				buffer[stop] = 'x';
+			buffer[size] = 'y';
+			StringView const view(buffer, size);
+			WOB_ASSERT(view.skipWhile(whitespace) == naiveSkip(view, whitespace, 0));
+			WOB_ASSERT(view.skipWhile(whitespace, stop) == naiveSkip(view, whitespace, stop));
+		}
+	}
+
+	// every byte value against classes using both halves of the tables
+	char bytes[256];
+	for (uint32_t i = 0; i < 256; i++)
+		bytes[i] = (char)i;
+	StringView const all(bytes, 256);
+	CharClass const classes[] = { whitespace, identifier, ~identifier, CharClass::range('\x80', '\xFF'), CharClass("\x01\x7F\x80\xFF"), ~CharClass() };
+	for (CharClass const& cls : classes)
+	{
+		for (size_t from = 0; from < 256; from++)
+			WOB_ASSERT(all.skipWhile(cls, from) == naiveSkip(all, cls, from));
+	}
+
+	StringView const code("  \n\t identifier_42(rest");
+	size_t const start = code.skipWhile(whitespace);
+	size_t const end = code.skipWhile(identifier, start);
+	WOB_ASSERT(StringView(code.data() + start, end - start) == StringView("identifier_42"));
+	WOB_ASSERT(code.skipWhile(whitespace, 100) == code.size());
+}
+
+static void testEquality()
+{
+	char a[100];
+	char b[100];
+	for (size_t i = 0; i < 100; i++)
+		a[i] = b[i] = (char)('a' + i % 26);
+	for (size_t size = 0; size < 100; size++)
+	{
+		WOB_ASSERT(StringView(a, size) == StringView(b, size));
+		for (size_t diff = 0; diff < size; diff++)
+		{
+			b[diff] = '#';
+			WOB_ASSERT(StringView(a, size) != StringView(b, size));
+			b[diff] = a[diff];
+		}
+	}
+	WOB_ASSERT(StringView("abc") != StringView("abcd"));
+	WOB_ASSERT(StringView() == StringView("", 0));
+	WOB_ASSERT(StringView().empty() && !StringView("a").empty());
+}
+
+int main()
+{
+	testFindChar();
+	testFindString();
+	testCount();
+	testSkipWhile();
+	testEquality();
+	printf("string view tests passed\n");
+	return 0;
+}
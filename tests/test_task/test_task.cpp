@@ -0,0 +1,223 @@
+#include "core/wob.hpp"
+#include "core/task.hpp"
+#include "core/jobSystem.hpp"
+#include "core/error.hpp"
+#include "core/array.hpp"
+#include "core/string.hpp"
+
+#include <stdio.h>
+
+using namespace wob;
+
+// counts the frames allocated through it
+class CountingAllocator : public IAllocator
+{
+public:
+	void* allocate(size_t size, size_t align) override
+	{
+		allocations++;
+		return context.allocator->allocate(size, align);
+	}
+
+	void deallocate(void* ptr) override
+	{
+		deallocations++;
+		context.allocator->deallocate(ptr);
+	}
+
+	uint32_t allocations = 0;
+	uint32_t deallocations = 0;
+};
+
+static Task<int> constant(int v)
+{
+	co_return v;
+}
+
+static Task<int> add(int a, int b)
+{
+	int const x = co_await constant(a);
+	int const y = co_await constant(b);
+	co_return x + y;
+}
+
+static Task<int> sumOnAllocator(IAllocator&, int n)
+{
+	int total = 0;
+	for (int i = 0; i < n; i++)
+		total += co_await constant(i);
+	co_return total;
+}
+
+static Task<String> makeString(const char* text)
+{
+	co_return String(text);
+}
+
+static Task<Result<int>> mayFail(bool fail)
+{
+	if (fail)
+		co_return ErrorCode::Undefined;
+	co_return 42;
+}
+
+// results holding a non trivial value move through the promise
+static Task<Result<String>> mayFailString(bool fail)
+{
+	if (fail)
+		co_return ErrorCode::Undefined;
+	String s("loaded");
+	co_return wob::move(s);
+}
+
+static Task<> chain(int* out)
+{
+	*out = co_await add(1, 2);
+	String s = co_await makeString("task");
+	WOB_ASSERT(s == "task");
+	Result<int> ok = co_await mayFail(false);
+	Result<int> ko = co_await mayFail(true);
+	WOB_ASSERT(ok && ok.value() == 42 && !ko);
+	Result<String> loaded = co_await mayFailString(false);
+	Result<String> failed = co_await mayFailString(true);
+	WOB_ASSERT(loaded && loaded.value() == "loaded" && !failed);
+}
+
+static void testSynchronous()
+{
+	TaskScheduler scheduler;
+	int value = 0;
+	scheduler.spawn(chain(&value));
+	// nothing suspended, it ran to the end inside spawn
+	WOB_ASSERT(value == 3 && scheduler.runningCount() == 0);
+
+	CountingAllocator counting;
+	int total = 0;
+	scheduler.spawn([](IAllocator& allocator, int* out) -> Task<> {
+		*out = co_await sumOnAllocator(allocator, 10);
+	}(counting, &total));
+	// only the coroutine taking the allocator first uses it, the others come from the context allocator
+	WOB_ASSERT(total == 45 && counting.allocations == 1 && counting.deallocations == 1);
+}
+
+static Task<> countFrames(TaskScheduler& scheduler, uint32_t frames, uint32_t* counter)
+{
+	for (uint32_t i = 0; i < frames; i++)
+	{
+		co_await scheduler.nextFrame();
+		(*counter)++;
+	}
+}
+
+static void testNextFrame()
+{
+	TaskScheduler scheduler;
+	uint32_t a = 0, b = 0;
+	scheduler.spawn(countFrames(scheduler, 3, &a));
+	scheduler.spawn(countFrames(scheduler, 1, &b));
+	WOB_ASSERT(a == 0 && b == 0 && scheduler.runningCount() == 2);
+
+	// one step per frame, never more
+	scheduler.beginFrame();
+	WOB_ASSERT(a == 1 && b == 1 && scheduler.runningCount() == 1);
+	scheduler.beginFrame();
+	WOB_ASSERT(a == 2);
+	scheduler.beginFrame();
+	WOB_ASSERT(a == 3 && scheduler.runningCount() == 0);
+	scheduler.beginFrame();
+	WOB_ASSERT(a == 3);
+}
+
+static Task<> waitEvent(TaskEvent& event, bool* resumed)
+{
+	co_await event;
+	*resumed = true;
+}
+
+static void testEvent()
+{
+	TaskScheduler scheduler;
+
+	TaskEvent event(scheduler);
+	bool resumed = false;
+	scheduler.spawn(waitEvent(event, &resumed));
+	scheduler.beginFrame();
+	WOB_ASSERT(!resumed && !event.isSet());
+
+	// completion resumes the waiter at the next frame
+	event.set();
+	WOB_ASSERT(!resumed && event.isSet());
+	scheduler.beginFrame();
+	WOB_ASSERT(resumed && scheduler.runningCount() == 0);
+
+	// awaiting a set event doesn't suspend
+	TaskEvent done(scheduler);
+	done.set();
+	bool immediate = false;
+	scheduler.spawn(waitEvent(done, &immediate));
+	WOB_ASSERT(immediate);
+}
+
+struct Load
+{
+	Array<uint32_t> data;
+	JobSystem* workerSystem = nullptr;
+	bool onWorker = false;
+	bool backOnMain = false;
+};
+
+static thread_local bool isMainThread = false;
+
+// the shape of a loading routine: heavy part on a worker, then back to the frame loop
+static Task<> load(TaskScheduler& scheduler, Load* out)
+{
+	co_await scheduler.resumeOnWorker();
+	out->onWorker = !isMainThread;
+	out->workerSystem = context.jobSystem;
+	for (uint32_t i = 0; i < 10000; i++)
+		out->data.push(i * 3);
+
+	co_await scheduler.nextFrame();
+	out->backOnMain = isMainThread;
+}
+
+static void testWorkerHop()
+{
+	JobSystem::InitInfo info;
+	info.workerCount = 2;
+	JobSystem jobs(*context.allocator, info);
+	context.jobSystem = &jobs;
+	isMainThread = true;
+
+	TaskScheduler scheduler;
+	Load results[8];
+	for (Load& l : results)
+		scheduler.spawn(load(scheduler, &l));
+
+	// the frame loop keeps going while the workers run the loads
+	uint32_t frames = 0;
+	while (scheduler.runningCount() > 0)
+	{
+		scheduler.beginFrame();
+		Thread::yield();
+		frames++;
+	}
+
+	for (Load const& l : results)
+	{
+		WOB_ASSERT(l.onWorker && l.backOnMain && l.workerSystem == &jobs && l.data.size() == 10000 && l.data[9999] == 9999 * 3);
+	}
+	WOB_ASSERT(frames >= 1);
+
+	context.jobSystem = nullptr;
+}
+
+int main()
+{
+	testSynchronous();
+	testNextFrame();
+	testEvent();
+	testWorkerHop();
+	printf("task tests passed\n");
+	return 0;
+}
@@ -0,0 +1,81 @@
+#include "core/wob.hpp"
+#include "core/virtualArena.hpp"
+#include "core/array.hpp"
+#include "core/string.hpp"
+#include "core/stringBuilder.hpp"
+
+#include <string.h>
+
+using namespace wob;
+
+static void testCommitOnDemand()
+{
+	VirtualArena arena({ .reserveSize = 64_mb, .commitGranularity = 64_kb, .retainSize = 128_kb });
+	WOB_ASSERT(arena.reservedSize() == 64_mb);
+	WOB_ASSERT(arena.committedSize() == 0);
+
+	uint8_t* const first = static_cast<uint8_t*>(arena.allocate(100, 8));
+	WOB_ASSERT(arena.committedSize() == 64_kb);
+
+	// far past the first commit, the arena never moves
+	uint8_t* const big = static_cast<uint8_t*>(arena.allocate(10_mb, 16));
+	memset(big, 0x5A, 10_mb);
+	WOB_ASSERT(big > first);
+	WOB_ASSERT(arena.committedSize() >= 10_mb && arena.committedSize() < 11_mb);
+
+	void* const aligned = arena.allocate(1, 4096);
+	WOB_ASSERT(((uintptr_t)aligned & 4095) == 0);
+
+	// reset keeps retainSize committed
+	arena.reset();
+	WOB_ASSERT(arena.usedSize() == 0);
+	WOB_ASSERT(arena.committedSize() == 128_kb);
+	WOB_ASSERT(arena.allocate(100, 8) == first);
+
+	// the reservation is a hard limit
+	WOB_ASSERT(arena.allocate(65_mb, 8) == nullptr);
+}
+
+static void testMarkers()
+{
+	VirtualArena arena({ .reserveSize = 16_mb });
+	void* const kept = arena.allocate(64, 8);
+	size_t const marker = arena.getMarker();
+	void* const scratch = arena.allocate(1_mb, 8);
+	WOB_ASSERT(scratch != nullptr);
+
+	arena.deallocateFromMarker(marker);
+	WOB_ASSERT(arena.usedSize() == marker);
+	WOB_ASSERT(arena.allocate(1_mb, 8) == scratch);
+	arena.deallocateFromMarker(marker);
+	arena.deallocateFromMarker(marker);
+	WOB_UNUSED(kept);
+}
+
+// the last allocation grows in place, an array or builder in the arena never copies
+static void testGrowInPlace()
+{
+	VirtualArena arena({ .reserveSize = 256_mb, .hugePages = true });
+	Array<uint64_t> values(arena);
+	for (uint64_t i = 0; i < 1'000'000; i++)
+		values.push(i);
+	WOB_ASSERT(arena.usedSize() == values.capacity() * sizeof(uint64_t));
+	for (uint64_t i = 0; i < 1'000'000; i++)
+		WOB_ASSERT(values[(uint32_t)i] == i);
+
+	VirtualArena textArena({ .reserveSize = 16_mb });
+	StringBuilder builder(textArena, 16);
+	for (int i = 0; i < 10'000; i++)
+		builder.append("0123456789");
+	WOB_ASSERT(builder.size() == 100'000);
+	WOB_ASSERT(textArena.usedSize() < 2 * 100'000);
+}
+
+int main()
+{
+	testCommitOnDemand();
+	testMarkers();
+	testGrowInPlace();
+	printf("virtual arena tests passed\n");
+	return 0;
+}
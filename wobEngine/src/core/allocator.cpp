@@ -1,40 +1,61 @@
 #include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
 
 #include "wob.hpp"
 #include "allocator.hpp"
 #include "profiler.hpp"
 #include "utility.hpp"
 #include "context.hpp"
+#include "sizeClassAllocator.hpp"
+#include "memoryProfiler.hpp"
+#include "steadyFrame.hpp"
 #include <stdio.h>
 
-#ifdef WOB_ENABLE_PROFILING
+using namespace wob;
 
-#define WOB_PROFILE_MEMORY_ALLOC(ptr, size) ::aes::MemoryProfiler::instance().profileAlloc(ptr, size)
-#define WOB_PROFILE_MEMORY_DEALLOC(ptr) ::aes::MemoryProfiler::instance().profileDealloc(ptr)
+wob::Mallocator wob::mallocator{};
 
+// the context allocator default to malloc, define WOB_USE_SIZE_CLASS_ALLOCATOR to use the thread cached size class allocator instead
+#ifdef WOB_USE_SIZE_CLASS_ALLOCATOR
+#define WOB_CONTEXT_BASE_ALLOCATOR wob::getSizeClassAllocator()
 #else
-
-#define WOB_PROFILE_MEMORY_ALLOC(ptr, size) 
-#define WOB_PROFILE_MEMORY_DEALLOC(ptr)
-
+#define WOB_CONTEXT_BASE_ALLOCATOR wob::mallocator
 #endif
 
-using namespace wob;
-
-wob::Mallocator wob::mallocator{};
-wob::AllocatorProfiler wob::profilerAlloc{wob::mallocator};
+// with profiling every allocation of the context allocator is tracked
+#ifdef WOB_ENABLE_PROFILING
+wob::AllocatorProfiler wob::profilerAlloc{WOB_CONTEXT_BASE_ALLOCATOR, &wob::MemoryProfiler::instance()};
+#else
+wob::AllocatorProfiler wob::profilerAlloc{WOB_CONTEXT_BASE_ALLOCATOR};
+#endif
 
 // https://stackoverflow.com/questions/53922209/how-to-invoke-aligned-new-delete-properly
 static void* alignedAlloc(size_t size, size_t al) noexcept
 {
-	WOB_ASSERT_NOLOG(size % al == 0);
+	WOB_ASSERT_NOLOG(isPowerOf2(al));
 #if _MSC_VER
 	// msvc doesn't support c11 aligned_alloc
 	return _aligned_malloc(size, al);
-#else
+#elif defined(__vita__)
 	// vita toolchains don't seems to support aligned alloc
-	// TODO write a custom version
-	return malloc(size);
+	// over allocate and store the malloc pointer right before the aligned block
+	if (al < sizeof(void*))
+		al = sizeof(void*);
+	void* const raw = malloc(size + al + sizeof(void*));
+	if (raw == nullptr)
+		return nullptr;
+	uintptr_t const aligned = wob::align(reinterpret_cast<uintptr_t>(raw) + sizeof(void*), al);
+	reinterpret_cast<void**>(aligned)[-1] = raw;
+	return reinterpret_cast<void*>(aligned);
+#else
+	// posix_memalign requires at least pointer alignment
+	if (al < sizeof(void*))
+		al = sizeof(void*);
+	void* ptr = nullptr;
+	if (posix_memalign(&ptr, al, size) != 0)
+		return nullptr;
+	return ptr;
 #endif
 }
 
@@ -42,11 +63,31 @@ static void alignedFree(void* ptr) noexcept
 {
 #if _MSC_VER
 	_aligned_free(ptr);
+#elif defined(__vita__)
+	if (ptr)
+		free(reinterpret_cast<void**>(ptr)[-1]);
 #else
 	free(ptr);
 #endif
 }
 
+void* IAllocator::reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align)
+{
+	if (ptr == nullptr)
+		return allocate(newSize, align);
+
+	if (tryExpandInPlace(ptr, newSize))
+		return ptr;
+
+	void* const newPtr = allocate(newSize, align);
+	if (newPtr == nullptr)
+		return nullptr;
+
+	memcpy(newPtr, ptr, oldSize < newSize ? oldSize : newSize);
+	deallocate(ptr);
+	return newPtr;
+}
+
 void* Mallocator::allocate(size_t size, size_t align)
 {
 	return alignedAlloc(size, align);
@@ -57,6 +98,23 @@ void Mallocator::deallocate(void* ptr)
 	alignedFree(ptr);
 }
 
+void* Mallocator::reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align)
+{
+	WOB_ASSERT_NOLOG(isPowerOf2(align));
+#if _MSC_VER
+	WOB_UNUSED(oldSize);
+	return _aligned_realloc(ptr, newSize, align);
+#elif defined(__vita__)
+	// blocks are offset from the malloc pointer, realloc would break the alignment
+	return IAllocator::reallocate(ptr, oldSize, newSize, align);
+#else
+	// realloc only guarantee the fundamental alignment
+	if (align > alignof(max_align_t))
+		return IAllocator::reallocate(ptr, oldSize, newSize, align);
+	return realloc(ptr, newSize);
+#endif
+}
+
 StackAllocator::StackAllocator(IAllocator& base, size_t size) : baseAllocator(&base),
 	start(static_cast<uint8_t*>(base.allocate(size))), totalSize(size), offset(0)
 {
@@ -76,6 +134,7 @@ void* StackAllocator::allocate(size_t size, size_t alignement)
 		return nullptr;
 
 	offset = alignedOffset + size;
+	lastOffset = alignedOffset;
 
 	return reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(start) + alignedOffset);
 }
@@ -85,10 +144,21 @@ void wob::StackAllocator::deallocate(void* ptr)
 	WOB_UNUSED(ptr);
 }
 
+bool StackAllocator::tryExpandInPlace(void* ptr, size_t newSize)
+{
+	if (lastOffset == noAllocation || ptr != start + lastOffset || lastOffset + newSize > totalSize)
+		return false;
+
+	offset = lastOffset + newSize;
+	return true;
+}
+
 void StackAllocator::deallocateFromMarker(size_t marker)
 {
 	WOB_ASSERT_NOLOG(marker < offset);
 	offset = marker;
+	if (lastOffset != noAllocation && lastOffset >= marker)
+		lastOffset = noAllocation;
 }
 
 size_t StackAllocator::getMarker() const
@@ -96,30 +166,64 @@ size_t StackAllocator::getMarker() const
 	return offset;
 }
 
-AllocatorProfiler::AllocatorProfiler(IAllocator& base) : baseAllocator(&base)
+AllocatorProfiler::AllocatorProfiler(IAllocator& base, MemoryProfiler* tracker_) : allocationCount(0), baseAllocator(&base), tracker(tracker_)
 {
 }
 
 void* AllocatorProfiler::allocate(size_t size, size_t align)
 {
+	checkSteadyFrameAllocation(size, align);
 	void* ptr = baseAllocator->allocate(size, align);
 	if (ptr != nullptr)
 	{
-		//printf("allocating %p size: %zu alignement: %zu\n", ptr, size, align);
-		allocationCount++;
+		allocationCount.fetchAdd(1, MemoryOrder::Relaxed);
+		if (tracker)
+			tracker->profileAlloc(ptr, size, align);
 	}
 	return ptr;
 }
 
 void AllocatorProfiler::deallocate(void* ptr)
 {
-	//printf("free: %p\n", ptr);
+	if (ptr == nullptr)
+		return;
+
+	// untrack first, the address can be reused by another thread as soon as it is freed
+	if (tracker)
+		tracker->profileDealloc(ptr);
 	baseAllocator->deallocate(ptr);
-	if (ptr != nullptr)
-	{
-		allocationCount--;
-		WOB_ASSERT_NOLOG(allocationCount >= 0);
-	}
+	int32_t const count = allocationCount.fetchSub(1, MemoryOrder::Relaxed);
+	WOB_ASSERT_NOLOG(count > 0);
+	WOB_UNUSED(count);
+}
+
+bool AllocatorProfiler::tryExpandInPlace(void* ptr, size_t newSize)
+{
+	if (!baseAllocator->tryExpandInPlace(ptr, newSize))
+		return false;
+	if (tracker)
+		tracker->profileResize(ptr, newSize);
+	return true;
+}
+
+void* AllocatorProfiler::reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align)
+{
+	// a growing block goes through the heap, steady frames must not do it
+	if (newSize > oldSize)
+		checkSteadyFrameAllocation(newSize, align);
+	// like deallocate, the old record must leave the table before the base allocator frees the block
+	MemoryProfiler::ReallocRecord moved{};
+	if (tracker)
+		moved = tracker->profileReallocBegin(ptr);
+	void* const newPtr = baseAllocator->reallocate(ptr, oldSize, newSize, align);
+	if (tracker)
+		tracker->profileReallocEnd(moved, newPtr, newSize, align);
+	if (newPtr == nullptr)
+		return nullptr;
+
+	if (ptr == nullptr)
+		allocationCount.fetchAdd(1, MemoryOrder::Relaxed);
+	return newPtr;
 }
 
 IAllocator* wob::getContextAllocator() noexcept
@@ -1,7 +1,9 @@
 #ifndef WOB_ALLOCATOR_HPP
 #define WOB_ALLOCATOR_HPP
 #include <stdint.h>
+#include "coreMacros.hpp"
 #include "utility.hpp"
+#include "atomic.hpp"
 
 #ifndef __PLACEMENT_NEW_INLINE
 #define __PLACEMENT_NEW_INLINE
@@ -56,6 +58,18 @@ namespace wob
 		[[nodiscard]] virtual void* allocate(size_t size, size_t align = 1) = 0;
 		virtual void deallocate(void* ptr) = 0;
 
+		// resize ptr block without moving it, return false if the allocator can't, ptr is still valid in both cases
+		[[nodiscard]] virtual bool tryExpandInPlace(void* ptr, size_t newSize)
+		{
+			WOB_UNUSED(ptr);
+			WOB_UNUSED(newSize);
+			return false;
+		}
+
+		// resize ptr block, the first min(oldSize, newSize) bytes are copied bitwise if the block move
+		// default implementation try to expand in place then fallback to allocate + copy + deallocate
+		[[nodiscard]] virtual void* reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align = 1);
+
 		virtual ~IAllocator() {}
 	};
 
@@ -65,18 +79,26 @@ namespace wob
 	public:
 		[[nodiscard]] void* allocate(size_t size, size_t align) override;
 		void deallocate(void* ptr) override;
+		[[nodiscard]] void* reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align) override;
 	};
 
+	// forward to base and count the live allocations, every allocation is also reported to tracker if there is one (see memoryProfiler.hpp)
+	// allocations made during a steady frame are reported (see steadyFrame.hpp)
 	class AllocatorProfiler final : public IAllocator
 	{
 	public:
-		AllocatorProfiler(IAllocator& base);
+		AllocatorProfiler(IAllocator& base, class MemoryProfiler* tracker = nullptr);
 		[[nodiscard]] void* allocate(size_t size, size_t align) override;
 		void deallocate(void* ptr) override;
+		[[nodiscard]] bool tryExpandInPlace(void* ptr, size_t newSize) override;
+		[[nodiscard]] void* reallocate(void* ptr, size_t oldSize, size_t newSize, size_t align) override;
+
+		[[nodiscard]] int32_t liveAllocationCount() const noexcept { return allocationCount.load(MemoryOrder::Relaxed); }
 
 	private:
-		int allocationCount = 0;
+		Atomic<int32_t> allocationCount;
 		IAllocator* baseAllocator;
+		class MemoryProfiler* tracker;
 	};
 
 	class StackAllocator final : public IAllocator
@@ -87,14 +109,20 @@ namespace wob
 		~StackAllocator() override;
 		[[nodiscard]] void* allocate(size_t size, size_t align) override;
 		void deallocate(void* ptr) override;
+		// only the last allocation can be resized
+		[[nodiscard]] bool tryExpandInPlace(void* ptr, size_t newSize) override;
 
 		void deallocateFromMarker(size_t marker);
 		size_t getMarker() const;
 		
 	private:
+		static constexpr size_t noAllocation = ~(size_t)0;
+
 		IAllocator* baseAllocator;
 		uint8_t* start;
 		size_t totalSize, offset;
+		// offset of the last allocation
+		size_t lastOffset = noAllocation;
 	};
 
 	extern Mallocator mallocator;
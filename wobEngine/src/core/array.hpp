@@ -6,102 +6,34 @@
 #include "allocator.hpp"
 #include "context.hpp"
 #include "utility.hpp"
+#include "arrayView.hpp"
+#include <string.h>
 
 namespace wob
 {
 	/*
-	 * Generic Array class similar to std vector
-	 * always store the allocator pointer
+	 * Elements and algorithms shared by Array and SmallArray, Derived owns the buffer :
+	 * it provides reallocateBuffer(n), which moves the elements to a buffer of n elements, and increasedCapacity()
 	 */
-	template<typename T>
-	class Array
+	template<typename T, typename Derived>
+	class ArrayBase
 	{
 		public:
 
 		using Iterator_t = T*;
 		using ConstIterator_t = T const*;
 
-		constexpr Array() noexcept
-			: alloc(getContextAllocator()), buffer(nullptr), size_(0), capacity_(0)
-		{
-
-		}
-
-		constexpr Array(IAllocator& allocator) noexcept
-			: alloc(&allocator), buffer(nullptr), size_(0), capacity_(0)
-		{
-			
-		}
-
-		template<typename Range>
-		constexpr Array(IAllocator& allocator, Range const& range) noexcept
-			: alloc(&allocator), buffer(nullptr), size_(0), capacity_(0)
-		{
-			insert(begin(), range);
-		}
-
-		constexpr Array(Array const& rhs) noexcept
-		{
-			*this = rhs;
-		}
-
-		constexpr Array(Array&& rhs) noexcept
-		{
-			*this = wob::move(rhs);
-		}
-
 		constexpr IAllocator* getAllocator() const noexcept
 		{
 			return alloc;
 		}
 
-		constexpr void copyFrom(Array const& rhs) noexcept
-		{
-			clear();
-			alloc = rhs.alloc;
-			buffer = static_cast<T*>(alloc->allocate<T>(rhs.size_));
-			size_ = rhs.size_;
-			capacity_ = size_;
-
-			// @performance conditionaly use memcpy here ?
-			for (uint32_t i = 0; i < size_; i++)
-				new (&buffer[i]) T(rhs.buffer[i]);
-		}
-
-		constexpr Array& operator=(Array const& rhs) noexcept
-		{
-			copyFrom(rhs);
-			return *this;
-		}
-
-		constexpr Array& operator=(Array&& rhs) noexcept
-		{
-			clear();
-			alloc = rhs.alloc;
-			buffer = rhs.buffer;
-			size_ = rhs.size_;
-			capacity_ = rhs.capacity_;
-
-			rhs.buffer = nullptr;
-		#ifdef WOB_DEBUG
-			rhs.size_ = 0;
-			rhs.capacity_ = 0;
-		#endif
-			return *this;
-		}
-
 		constexpr void reserve(uint32_t n) noexcept
 		{
 			if (n <= capacity_)
 				return;
 
-			T* const newBuffer = static_cast<T*>(alloc->allocate<T>(n));
-
-			// @Review @Performance allocator reallocate may improve performances here
-			moveBuffer(newBuffer);
-			alloc->deallocate(buffer);
-			buffer = newBuffer;
-			capacity_ = n;
+			self().reallocateBuffer(n);
 		}
 
 		constexpr void resize(uint32_t n) noexcept
@@ -115,13 +47,16 @@ namespace wob
 				{
 					reserve(n);
 				}
-				for (uint32_t i = size_; i < n; i++)
-					new (&buffer[i]) T;
+				// default initialization of trivial types is a no op
+				if constexpr (!__is_trivially_constructible(T))
+				{
+					for (uint32_t i = size_; i < n; i++)
+						new (&buffer[i]) T;
+				}
 			}
 			else // size < n
 			{
-				for (uint32_t i = n; i < size_; i++)
-					buffer[i].~T();
+				destroyRange(n, size_);
 			}
 			size_ = n;
 		}
@@ -150,6 +85,35 @@ namespace wob
 			new (&buffer[size_++]) T(wob::move(e));
 		}
 
+		// push n copies of e
+		constexpr void pushN(T const& e, uint32_t n) noexcept
+		{
+			if (size_ + n > capacity_)
+				reserveForInsert(size_ + n);
+
+			if constexpr (isTriviallyCopyable<T> && sizeof(T) == 1)
+			{
+				memset(&buffer[size_], *reinterpret_cast<uint8_t const*>(&e), n);
+			}
+			else
+			{
+				for (uint32_t i = size_; i < size_ + n; i++)
+					new (&buffer[i]) T(e);
+			}
+			size_ += n;
+		}
+
+		// push a copy of every element of view, view must not point inside this array
+		constexpr void append(ArrayView<T const> view) noexcept
+		{
+			uint32_t const n = (uint32_t)view.size();
+			if (size_ + n > capacity_)
+				reserveForInsert(size_ + n);
+
+			copyConstruct(&buffer[size_], view.data(), n);
+			size_ += n;
+		}
+
 		template<typename ...Args>
 		constexpr void emplace(Args&&... args)
 		{
@@ -170,31 +134,24 @@ namespace wob
 			uint32_t const newSize = size_ + rangeSize;
 			uint32_t const ipos = pos - begin();
 
-			T* workBuffer = buffer;
 			if (newSize > capacity_)
 			{
-				uint32_t newCapacity = increasedCapacity();
-
-				// @Review is this ok ?
-				while (newCapacity < newSize)
-					newCapacity *= 2;
-
-				T* const newBuffer = static_cast<T*>(alloc->allocate<T>(newCapacity));
-				capacity_ = newCapacity;
+				// pos is invalidated by the reallocation
+				reserveForInsert(newSize);
+			}
 
-				// Move elements after insertion point (shifted by rangeSize)
-				for (uint32_t i = ipos; i < size_; i++)
-				{
-					new (&newBuffer[i + rangeSize]) T(wob::move(buffer[i]));
-				}
-				workBuffer = newBuffer;
-				alloc->deallocate(buffer);
+			// open a gap of rangeSize elements at ipos
+			if constexpr (isTriviallyRelocatable<T>)
+			{
+				if (ipos < size_)
+					memmove(&buffer[ipos + rangeSize], &buffer[ipos], (size_ - ipos) * sizeof(T));
 			}
-			else if (ipos < size_)
+			else
 			{
 				for (uint32_t i = size_; i > ipos; i--)
 				{
-					new (&workBuffer[i + rangeSize - 1]) T(wob::move(workBuffer[i - 1]));
+					new (&buffer[i + rangeSize - 1]) T(wob::move(buffer[i - 1]));
+					buffer[i - 1].~T();
 				}
 			}
 
@@ -202,10 +159,9 @@ namespace wob
 			uint32_t insertIdx = ipos;
 			for (auto&& e : range)
 			{
-				new (&workBuffer[insertIdx++]) T(wob::move(e));
+				new (&buffer[insertIdx++]) T(wob::move(e));
 			}
 
-			buffer = workBuffer;
 			size_ = newSize;
 		}
 
@@ -217,13 +173,16 @@ namespace wob
 		constexpr void pop() noexcept
 		{
 			WOB_BOUNDS_CHECK(size_ > 0);
-			buffer[--size_].~T();
+			destroyRange(size_ - 1, size_);
+			size_--;
 		}
 
 		constexpr T popValue() noexcept
 		{
 			WOB_BOUNDS_CHECK(size_ > 0);
-			return move(buffer[--size_]);
+			T value = move(buffer[size_ - 1]);
+			pop();
+			return value;
 		}
 
 		constexpr T const& operator[](uint32_t i) const noexcept
@@ -260,6 +219,167 @@ namespace wob
 		constexpr T const* data() const noexcept { return buffer; }
 		constexpr T* data() noexcept { return buffer; }
 
+		constexpr void clear() noexcept
+		{
+			destroyRange(0, size_);
+			size_ = 0;
+		}
+
+		protected:
+
+		constexpr ArrayBase(IAllocator* allocator, T* buffer_, uint32_t capacity) noexcept
+			: alloc(allocator), buffer(buffer_), size_(0), capacity_(capacity)
+		{
+
+		}
+
+		constexpr Derived& self() noexcept { return static_cast<Derived&>(*this); }
+
+		// copy construct count elements from src to dst
+		static constexpr void copyConstruct(T* dst, T const* src, uint32_t count) noexcept
+		{
+			if constexpr (isTriviallyCopyable<T>)
+			{
+				if (count > 0)
+					memcpy(dst, src, count * sizeof(T));
+			}
+			else
+			{
+				for (uint32_t i = 0; i < count; i++)
+					new (&dst[i]) T(src[i]);
+			}
+		}
+
+		// move construct count elements from src to dst and destroy the sources
+		static constexpr void relocate(T* dst, T* src, uint32_t count) noexcept
+		{
+			if constexpr (isTriviallyRelocatable<T>)
+			{
+				if (count > 0)
+					memcpy(static_cast<void*>(dst), src, count * sizeof(T));
+			}
+			else
+			{
+				for (uint32_t i = 0; i < count; i++)
+				{
+					new (&dst[i]) T(wob::move(src[i]));
+					src[i].~T();
+				}
+			}
+		}
+
+		constexpr void destroyRange(uint32_t from, uint32_t to) noexcept
+		{
+			if constexpr (!isTriviallyDestructible<T>)
+			{
+				for (uint32_t i = from; i < to; i++)
+					buffer[i].~T();
+			}
+		}
+
+		// geometric growth, enough to hold n elements
+		constexpr void reserveForInsert(uint32_t n) noexcept
+		{
+			uint32_t newCapacity = self().increasedCapacity();
+			while (newCapacity < n)
+				newCapacity *= 2;
+			reserve(newCapacity);
+		}
+
+		constexpr void grow() noexcept
+		{
+			reserve(self().increasedCapacity());
+		}
+
+		IAllocator* alloc = nullptr;
+		T* buffer = nullptr;
+		uint32_t size_ = 0;
+		uint32_t capacity_ = 0;
+	};
+
+	/*
+	 * Generic Array class similar to std vector
+	 * always store the allocator pointer
+	 */
+	template<typename T>
+	class Array : public ArrayBase<T, Array<T>>
+	{
+		using Base = ArrayBase<T, Array<T>>;
+		friend Base;
+		using Base::alloc;
+		using Base::buffer;
+		using Base::size_;
+		using Base::capacity_;
+
+		public:
+
+		constexpr Array() noexcept
+			: Base(getContextAllocator(), nullptr, 0)
+		{
+
+		}
+
+		constexpr Array(IAllocator& allocator) noexcept
+			: Base(&allocator, nullptr, 0)
+		{
+			
+		}
+
+		template<typename Range>
+		constexpr Array(IAllocator& allocator, Range const& range) noexcept
+			: Base(&allocator, nullptr, 0)
+		{
+			this->insert(this->begin(), range);
+		}
+
+		constexpr Array(Array const& rhs) noexcept
+			: Base(rhs.alloc, nullptr, 0)
+		{
+			*this = rhs;
+		}
+
+		constexpr Array(Array&& rhs) noexcept
+			: Base(rhs.alloc, nullptr, 0)
+		{
+			*this = wob::move(rhs);
+		}
+
+		constexpr void copyFrom(Array const& rhs) noexcept
+		{
+			if (this == &rhs)
+				return;
+
+			freeBuffer();
+			alloc = rhs.alloc;
+			buffer = static_cast<T*>(alloc->template allocate<T>(rhs.size_));
+			size_ = rhs.size_;
+			capacity_ = size_;
+			Base::copyConstruct(buffer, rhs.buffer, size_);
+		}
+
+		constexpr Array& operator=(Array const& rhs) noexcept
+		{
+			copyFrom(rhs);
+			return *this;
+		}
+
+		constexpr Array& operator=(Array&& rhs) noexcept
+		{
+			if (this == &rhs)
+				return *this;
+
+			freeBuffer();
+			alloc = rhs.alloc;
+			buffer = rhs.buffer;
+			size_ = rhs.size_;
+			capacity_ = rhs.capacity_;
+
+			rhs.buffer = nullptr;
+			rhs.size_ = 0;
+			rhs.capacity_ = 0;
+			return *this;
+		}
+
 		/**
 		 * \brief free unused memory of capacity
 		 * after a successful call of shrink size() == capacity()
@@ -277,43 +397,42 @@ namespace wob
 				return;
 			}
 
-			T* const newBuffer = (T*)alloc->allocate<T>(size_);
-			moveBuffer(newBuffer);
-			alloc->deallocate(buffer);
-			buffer = newBuffer;
-			capacity_ = size_;
-		}
-			 
-		constexpr void clear() noexcept
-		{
-			for (uint32_t i = 0; i < size_; i++)
-				buffer[i].~T();
-			size_ = 0;
+			reallocateBuffer(size_);
 		}
 
 		constexpr ~Array() noexcept
 		{
-			if (buffer)
-			{
-				clear();
-				alloc->deallocate(buffer);
-				buffer = nullptr;
-			}
+			freeBuffer();
 		}
 
 		private:
 
-		constexpr void moveBuffer(T* const newBuffer)
+		constexpr void reallocateBuffer(uint32_t n) noexcept
 		{
-			// @performance conditionaly use use memcpy (or memmove if reallocate is used) here ?
-			for (uint32_t i = 0; i < size_; i++)
-				new (&newBuffer[i]) T(wob::move(buffer[i]));
+			if constexpr (isTriviallyRelocatable<T>)
+			{
+				// allocator may resize in place or realloc, only the live elements are copied otherwise
+				buffer = static_cast<T*>(alloc->reallocate(buffer, size_ * sizeof(T), n * sizeof(T), alignof(T)));
+			}
+			else if (buffer == nullptr || !alloc->tryExpandInPlace(buffer, n * sizeof(T)))
+			{
+				T* const newBuffer = static_cast<T*>(alloc->template allocate<T>(n));
+				Base::relocate(newBuffer, buffer, size_);
+				alloc->deallocate(buffer);
+				buffer = newBuffer;
+			}
+			capacity_ = n;
 		}
 
-		constexpr void grow() noexcept
+		constexpr void freeBuffer() noexcept
 		{
-			uint32_t const newCapacity = increasedCapacity();
-			reserve(newCapacity);
+			if (buffer)
+			{
+				this->clear();
+				alloc->deallocate(buffer);
+				buffer = nullptr;
+				capacity_ = 0;
+			}
 		}
 
 		constexpr uint32_t increasedCapacity() const noexcept
@@ -324,12 +443,10 @@ namespace wob
 			// maybe abstract capacity_ grow strategy ?
 			return capacity_ >= 8 ? capacity_ * 2 : 8;
 		}
-
-		IAllocator* alloc = nullptr;
-		T* buffer = nullptr;
-		uint32_t size_ = 0;
-		uint32_t capacity_ = 0;
 	};
+
+	template<typename T>
+	constexpr bool isTriviallyRelocatable<Array<T>> = true;
 }
 
 #endif
\ No newline at end of file
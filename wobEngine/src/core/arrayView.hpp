@@ -1,7 +1,9 @@
 #ifndef WOB_ARRAY_VIEW_HPP
 #define WOB_ARRAY_VIEW_HPP
 
-#include "wob.hpp"
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "utility.hpp"
 
 namespace wob
 {
@@ -41,7 +43,7 @@ namespace wob
 
 		[[nodiscard]] constexpr bool empty() const noexcept
 		{
-			return size_ > 0;
+			return size_ == 0;
 		}
 
 		[[nodiscard]] constexpr ArrayView subView(size_t start) const noexcept
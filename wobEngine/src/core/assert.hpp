@@ -13,8 +13,8 @@
 	#else
 		#define WOB_DEBUG_BREAK() __builtin_trap()
 	#endif
-	#define WOB_ASSERT(x) if (x) {} else { WOB_LOG_ERROR("Assertion Failed : " #x); WOB_DEBUG_BREAK(); }
-	#define WOB_ASSERTF(x, msg, ...) if (x) {} else { WOB_LOG_ERROR("Assertion Failed : " #x " " msg, __VA_ARGS__); WOB_DEBUG_BREAK(); }
+	#define WOB_ASSERT(x) if (x) {} else { WOB_LOG_ERROR("Assertion Failed : {}", #x); WOB_DEBUG_BREAK(); }
+	#define WOB_ASSERTF(x, msg, ...) if (x) {} else { WOB_LOG_ERROR("Assertion Failed : {} " msg, #x, __VA_ARGS__); WOB_DEBUG_BREAK(); }
 	#define WOB_ASSERT_CORE(x) if (x) {} else { WOB_DEBUG_BREAK(); }
 #else
 	#define WOB_ASSERT(x) WOB_ASSUME(x)
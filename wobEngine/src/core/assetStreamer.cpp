@@ -0,0 +1,349 @@
+#include "assetStreamer.hpp"
+#include "wob.hpp"
+#include <stdio.h>
+
+using namespace wob;
+
+AssetStreamer::AssetStreamer(IAllocator& alloc) noexcept
+	: AssetStreamer(alloc, InitInfo{})
+{
+
+}
+
+AssetStreamer::AssetStreamer(IAllocator& alloc, InitInfo const& info) noexcept
+	: allocator(&alloc), maxInFlightBytes(info.maxInFlightBytes), pending(0), ioThreads(nullptr), ioThreadCount(info.ioThreadCount > 0 ? info.ioThreadCount : 1),
+	queuedCount(0), inFlight(0), readList(nullptr), decodedList(nullptr), decodingCount(0), stopRequested(0)
+{
+	ioThreads = static_cast<Thread*>(allocator->allocate(sizeof(Thread) * ioThreadCount, alignof(Thread)));
+	for (uint32_t i = 0; i < ioThreadCount; i++)
+	{
+		new (ioThreads + i) Thread;
+		bool const started = ioThreads[i].start(&AssetStreamer::ioThreadEntry, this, "wob io");
+		WOB_ASSERT(started);
+	}
+}
+
+AssetStreamer::~AssetStreamer() noexcept
+{
+	stopRequested.store(1);
+	idle.wakeup.signal(ioThreadCount);
+	charging.wakeup.signal(ioThreadCount);
+	for (uint32_t i = 0; i < ioThreadCount; i++)
+	{
+		if (ioThreads[i].joinable())
+			ioThreads[i].join();
+		ioThreads[i].~Thread();
+	}
+	allocator->deallocate(ioThreads);
+
+	// the workers still own the entries they decode
+	while (decodingCount.load() > 0)
+		Thread::yield();
+
+	if (pending > 0)
+		WOB_WARN("{} stream requests dropped", pending);
+
+	for (EntryList& queue : queues)
+		release(queue.first);
+	release(take(readList));
+	release(take(decodedList));
+}
+
+void AssetStreamer::request(StreamRequest const& desc) noexcept
+{
+	WOB_ASSERT(desc.path && desc.priority < StreamPriority::Count);
+
+	Entry* const entry = new (allocator->allocate(sizeof(Entry), alignof(Entry))) Entry{
+		StreamedFile{ String(desc.path), Array<uint8_t>(*allocator), MappedFile(), false },
+		desc.decode, desc.complete, desc.userData, desc.priority, desc.map, 0, this, {}, nullptr
+	};
+	pending++;
+
+	{
+		ScopedLock const lock(queueLock);
+		EntryList& queue = queues[(uint32_t)desc.priority];
+		if (queue.last)
+			queue.last->next = entry;
+		else
+			queue.first = entry;
+		queue.last = entry;
+	}
+	queuedCount.fetchAdd(1);
+	wake(idle, 1);
+}
+
+uint32_t AssetStreamer::poll() noexcept
+{
+	WOB_PROFILE_FUNCTION();
+
+	// start the decode stages, without job system or workers they run here
+	// a job queued with no worker would sit in our own queue, only wait() drains it
+	JobSystem* const jobSystem = context.jobSystem && context.jobSystem->getWorkerCount() > 0 ? context.jobSystem : nullptr;
+	Entry* done = nullptr;
+	Entry** doneTail = &done;
+	for (Entry* entry = take(readList); entry;)
+	{
+		Entry* const next = entry->next;
+		entry->next = nullptr;
+		if (entry->decode && entry->file.ok && jobSystem)
+		{
+			decodingCount.fetchAdd(1, MemoryOrder::Relaxed);
+			entry->decodeJob = Job{ &AssetStreamer::runDecode, entry };
+			jobSystem->run(entry->decodeJob);
+		}
+		else
+		{
+			if (entry->decode && entry->file.ok)
+				entry->file.ok = entry->decode(entry->file, entry->userData);
+			*doneTail = entry;
+			doneTail = &entry->next;
+		}
+		entry = next;
+	}
+	*doneTail = take(decodedList);
+
+	uint32_t completed = 0;
+	uint64_t released = 0;
+	for (Entry* entry = done; entry;)
+	{
+		// the callback can queue new requests, and resume a coroutine that does
+		Entry* const next = entry->next;
+		if (entry->complete)
+			entry->complete(entry->file, entry->userData);
+		released += entry->charged;
+		entry->next = nullptr;
+		release(entry);
+		pending--;
+		completed++;
+		entry = next;
+	}
+
+	if (released > 0)
+	{
+		inFlight.fetchSub(released);
+		wake(charging, ioThreadCount);
+		wake(idle, ioThreadCount);
+	}
+	return completed;
+}
+
+void AssetStreamer::ioThreadEntry(void* self) noexcept
+{
+	static_cast<AssetStreamer*>(self)->ioLoop();
+}
+
+void AssetStreamer::ioLoop() noexcept
+{
+	while (!stopRequested.load(MemoryOrder::Relaxed))
+	{
+		Entry* const entry = hasBudget() ? popRequest() : nullptr;
+		if (entry)
+		{
+			readFile(*entry);
+			continue;
+		}
+		sleepUnless(idle, [this] { return hasBudget() && queuedCount.load() > 0; });
+	}
+}
+
+void AssetStreamer::readFile(Entry& entry) noexcept
+{
+	WOB_PROFILE_FUNCTION();
+
+	// charge the budget from the size before touching the content,
+	// the mapping is charged too : its pages are prefetched and on vita it is a heap copy made by open
+	FILE* file = fopen(entry.file.path.c_str(), "rb");
+	long size = -1;
+	if (file && fseek(file, 0, SEEK_END) == 0)
+		size = ftell(file);
+
+	if (size >= 0 && (entry.map || (uint64_t)size <= ~0u) && charge(entry, (uint64_t)size))
+	{
+		if (entry.map)
+		{
+			fclose(file);
+			file = nullptr;
+			entry.file.ok = entry.file.mapping.open(entry.file.path.c_str(), FileAccess::Sequential, *allocator);
+			if (entry.file.ok)
+				entry.file.mapping.prefetch();
+		}
+		else
+		{
+			entry.file.data.resizeNoInit((uint32_t)size);
+			entry.file.ok = fseek(file, 0, SEEK_SET) == 0 && fread(entry.file.data.data(), 1, (size_t)size, file) == (size_t)size;
+		}
+	}
+
+	if (file)
+		fclose(file);
+
+	if (!entry.file.ok && !stopRequested.load())
+		WOB_LOG_ERROR("failed to read {}", entry.file.path.c_str());
+
+	push(readList, entry);
+}
+
+bool AssetStreamer::charge(Entry& entry, uint64_t size) noexcept
+{
+	// charge the budget before touching the content, wait for poll to release some when it's full
+	while (!tryReserve(size))
+	{
+		if (stopRequested.load())
+			return false;
+		sleepUnless(charging, [&] { return fits(size) || stopRequested.load(); });
+	}
+	entry.charged = size;
+	// the destructor may have started while we waited, the charge is released with the entry anyway
+	return !stopRequested.load();
+}
+
+bool AssetStreamer::tryReserve(uint64_t size) noexcept
+{
+	// several io threads reserve at once, check and add in one step so they can't overshoot the cap together
+	uint64_t used = inFlight.load();
+	while (used == 0 || used + size <= maxInFlightBytes)
+	{
+		if (inFlight.compareExchange(used, used + size))
+			return true;
+	}
+	return false;
+}
+
+bool AssetStreamer::hasBudget() const noexcept
+{
+	return inFlight.load() < maxInFlightBytes;
+}
+
+bool AssetStreamer::fits(uint64_t size) const noexcept
+{
+	uint64_t const used = inFlight.load();
+	// a file larger than the cap still goes through alone
+	return used == 0 || used + size <= maxInFlightBytes;
+}
+
+AssetStreamer::Entry* AssetStreamer::popRequest() noexcept
+{
+	ScopedLock const lock(queueLock);
+	for (EntryList& queue : queues)
+	{
+		if (Entry* const entry = queue.first)
+		{
+			queue.first = entry->next;
+			if (!queue.first)
+				queue.last = nullptr;
+			entry->next = nullptr;
+			queuedCount.fetchSub(1);
+			return entry;
+		}
+	}
+	return nullptr;
+}
+
+template<typename Ready>
+void AssetStreamer::sleepUnless(Sleepers& sleepers, Ready const& ready) noexcept
+{
+	// wakers signal only when they see the count, check again after raising it
+	sleepers.count.fetchAdd(1);
+	if (!ready() && !stopRequested.load())
+		sleepers.wakeup.wait();
+	sleepers.count.fetchSub(1);
+}
+
+void AssetStreamer::wake(Sleepers& sleepers, uint32_t count) noexcept
+{
+	// read-modify-write so it is ordered with the increment of a thread going to sleep
+	uint32_t const sleeping = sleepers.count.fetchAdd(0);
+	if (sleeping > 0)
+		sleepers.wakeup.signal(sleeping < count ? sleeping : count);
+}
+
+void AssetStreamer::runDecode(void* data) noexcept
+{
+	Entry& entry = *static_cast<Entry*>(data);
+	AssetStreamer* const streamer = entry.streamer;
+	entry.file.ok = entry.decode(entry.file, entry.userData);
+	push(streamer->decodedList, entry);
+	streamer->decodingCount.fetchSub(1, MemoryOrder::Release);
+}
+
+void AssetStreamer::push(Atomic<Entry*>& list, Entry& entry) noexcept
+{
+	Entry* head = list.load(MemoryOrder::Relaxed);
+	do
+	{
+		entry.next = head;
+	} while (!list.compareExchange(head, &entry, MemoryOrder::Release));
+}
+
+AssetStreamer::Entry* AssetStreamer::take(Atomic<Entry*>& list) noexcept
+{
+	// the list is last in first out
+	Entry* entry = list.exchange(nullptr, MemoryOrder::Acquire);
+	Entry* ordered = nullptr;
+	while (entry)
+	{
+		Entry* const next = entry->next;
+		entry->next = ordered;
+		ordered = entry;
+		entry = next;
+	}
+	return ordered;
+}
+
+void AssetStreamer::release(Entry* entry) noexcept
+{
+	while (entry)
+	{
+		Entry* const next = entry->next;
+		entry->~Entry();
+		allocator->deallocate(entry);
+		entry = next;
+	}
+}
+
+void AssetStreamer::ReadAwaiter::await_suspend(std::coroutine_handle<> awaiting) noexcept
+{
+	handle = awaiting;
+	StreamRequest request;
+	request.path = path;
+	request.priority = priority;
+	request.userData = this;
+	request.complete = [](StreamedFile& file, void* self) {
+		ReadAwaiter& awaiter = *static_cast<ReadAwaiter*>(self);
+		awaiter.data = wob::move(file.data);
+		awaiter.ok = file.ok;
+		awaiter.handle.resume();
+	};
+	streamer->request(request);
+}
+
+Result<Array<uint8_t>> AssetStreamer::ReadAwaiter::await_resume() noexcept
+{
+	if (!ok)
+		return { ErrorCode::FileReadFailed };
+	return { wob::move(data) };
+}
+
+void AssetStreamer::MapAwaiter::await_suspend(std::coroutine_handle<> awaiting) noexcept
+{
+	handle = awaiting;
+	StreamRequest request;
+	request.path = path;
+	request.priority = priority;
+	request.map = true;
+	request.userData = this;
+	request.complete = [](StreamedFile& file, void* self) {
+		MapAwaiter& awaiter = *static_cast<MapAwaiter*>(self);
+		awaiter.mapping = wob::move(file.mapping);
+		awaiter.ok = file.ok;
+		awaiter.handle.resume();
+	};
+	streamer->request(request);
+}
+
+Result<MappedFile> AssetStreamer::MapAwaiter::await_resume() noexcept
+{
+	if (!ok)
+		return { ErrorCode::FileReadFailed };
+	return { wob::move(mapping) };
+}
@@ -0,0 +1,217 @@
+#ifndef WOB_ASSET_STREAMER_HPP
+#define WOB_ASSET_STREAMER_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "allocator.hpp"
+#include "array.hpp"
+#include "atomic.hpp"
+#include "error.hpp"
+#include "jobSystem.hpp"
+#include "mappedFile.hpp"
+#include "string.hpp"
+#include "thread.hpp"
+#include <stdint.h>
+#include <coroutine>
+
+namespace wob
+{
+	// requests of a higher priority are read first, a request already being read is never preempted
+	enum class StreamPriority : uint8_t
+	{
+		High,
+		Normal,
+		Low,
+		Count
+	};
+
+	// a file going through the stream stages, the decode stage can replace data with the decoded content
+	struct StreamedFile
+	{
+		// the bytes of the file, over the mapping for a mapped request
+		[[nodiscard]] ArrayView<uint8_t const> content() const noexcept
+		{
+			return mapping.isOpen() ? mapping.view() : ArrayView<uint8_t const>(data.data(), data.size());
+		}
+
+		String path;
+		Array<uint8_t> data;
+		// open for mapped requests, data stays empty
+		MappedFile mapping;
+		// false if the file couldn't be read or the decode stage failed
+		bool ok = false;
+	};
+
+	// run on a job worker once the file is read, return false to fail the request
+	// read the file through content() to handle mapped requests
+	using StreamDecodeFunction = bool (*)(StreamedFile& file, void* userData);
+	// run on the frame loop by poll, data can be moved out of the file
+	using StreamCompleteFunction = void (*)(StreamedFile& file, void* userData);
+
+	struct StreamRequest
+	{
+		const char* path;
+		StreamPriority priority = StreamPriority::Normal;
+		StreamDecodeFunction decode = nullptr;
+		StreamCompleteFunction complete = nullptr;
+		void* userData = nullptr;
+		// map the file and prefetch its pages instead of copying it in a heap buffer
+		bool map = false;
+	};
+
+	/*
+	 * Loads files in the background and hands them back to the frame loop
+	 * io threads read the queued requests by priority with blocking reads, decode stages run on the context job system
+	 * (on the frame loop when there is none) and poll, called once per frame, runs the completion callbacks
+	 * the bytes of files read but not completed yet are capped, io threads stop reading when the cap is reached,
+	 * a single file larger than the cap is still read when nothing else is in flight
+	 * requests and poll must come from the thread that created the streamer, the allocator must be thread safe
+	 */
+	class AssetStreamer
+	{
+	public:
+		struct InitInfo
+		{
+			// threads doing the blocking reads
+			uint32_t ioThreadCount = 1;
+			// bytes read but not yet completed by poll
+			uint64_t maxInFlightBytes = 64_mb;
+		};
+
+		explicit AssetStreamer(IAllocator& allocator) noexcept;
+		AssetStreamer(IAllocator& allocator, InitInfo const& info) noexcept;
+		// requests that didn't complete are dropped without calling their callbacks
+		~AssetStreamer() noexcept;
+
+		AssetStreamer(AssetStreamer const&) = delete;
+		AssetStreamer& operator=(AssetStreamer const&) = delete;
+
+		// the path is copied
+		void request(StreamRequest const& request) noexcept;
+
+		// dispatch the decode stages of the files read since the last call and complete the finished requests
+		// return the number of completed requests
+		uint32_t poll() noexcept;
+
+		// requests not completed yet
+		[[nodiscard]] uint32_t pendingCount() const noexcept { return pending; }
+		[[nodiscard]] uint64_t inFlightBytes() const noexcept { return inFlight.load(MemoryOrder::Acquire); }
+
+		// co_await streamer.read(path) resumes on the frame loop, inside poll, with the content of the file
+		struct ReadAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> awaiting) noexcept;
+			Result<Array<uint8_t>> await_resume() noexcept;
+
+			AssetStreamer* streamer;
+			const char* path;
+			StreamPriority priority;
+			std::coroutine_handle<> handle;
+			Array<uint8_t> data;
+			bool ok;
+		};
+
+		[[nodiscard]] ReadAwaiter read(const char* path, StreamPriority priority = StreamPriority::Normal) noexcept
+		{
+			return ReadAwaiter{ this, path, priority, nullptr, Array<uint8_t>(*allocator), false };
+		}
+
+		// co_await streamer.map(path) same as read with the file mapped instead of copied
+		struct MapAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> awaiting) noexcept;
+			Result<MappedFile> await_resume() noexcept;
+
+			AssetStreamer* streamer;
+			const char* path;
+			StreamPriority priority;
+			std::coroutine_handle<> handle;
+			MappedFile mapping;
+			bool ok;
+		};
+
+		[[nodiscard]] MapAwaiter map(const char* path, StreamPriority priority = StreamPriority::Normal) noexcept
+		{
+			return MapAwaiter{ this, path, priority, nullptr, MappedFile(), false };
+		}
+
+	private:
+		struct Entry
+		{
+			StreamedFile file;
+			StreamDecodeFunction decode;
+			StreamCompleteFunction complete;
+			void* userData;
+			StreamPriority priority;
+			bool map;
+			// bytes charged to the in flight budget
+			uint64_t charged;
+			AssetStreamer* streamer;
+			Job decodeJob;
+			Entry* next;
+		};
+
+		struct EntryList
+		{
+			Entry* first = nullptr;
+			Entry* last = nullptr;
+		};
+
+		static void ioThreadEntry(void* self) noexcept;
+		void ioLoop() noexcept;
+		void readFile(Entry& entry) noexcept;
+		// wait until size fits in the budget then add it, false if the streamer is stopping
+		bool charge(Entry& entry, uint64_t size) noexcept;
+		// add size to the budget if it fits
+		bool tryReserve(uint64_t size) noexcept;
+		bool hasBudget() const noexcept;
+		bool fits(uint64_t size) const noexcept;
+		Entry* popRequest() noexcept;
+		// io threads waiting for the same condition, a token meant for one condition can't be taken by a thread waiting for the other
+		struct Sleepers
+		{
+			Atomic<uint32_t> count;
+			Semaphore wakeup;
+		};
+
+		// sleep until woken, unless ready() turns true after announcing it
+		template<typename Ready>
+		void sleepUnless(Sleepers& sleepers, Ready const& ready) noexcept;
+		void wake(Sleepers& sleepers, uint32_t count) noexcept;
+
+		static void runDecode(void* entry) noexcept;
+		static void push(Atomic<Entry*>& list, Entry& entry) noexcept;
+		// take a list filled by push, in push order
+		static Entry* take(Atomic<Entry*>& list) noexcept;
+		void release(Entry* entry) noexcept;
+
+		IAllocator* allocator;
+		uint64_t maxInFlightBytes;
+		uint32_t pending;
+
+		Thread* ioThreads;
+		uint32_t ioThreadCount;
+
+		// queued requests by priority
+		SpinLock queueLock;
+		EntryList queues[(uint32_t)StreamPriority::Count];
+		Atomic<uint32_t> queuedCount;
+
+		alignas(64) Atomic<uint64_t> inFlight;
+		// read by the io threads, waiting for poll
+		Atomic<Entry*> readList;
+		// decoded by the workers, waiting for poll
+		Atomic<Entry*> decodedList;
+		Atomic<uint32_t> decodingCount;
+
+		// waiting for a request to read
+		Sleepers idle;
+		// holding a request, waiting for the budget
+		Sleepers charging;
+		Atomic<uint32_t> stopRequested;
+	};
+}
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef WOB_ATOMIC_HPP
+#define WOB_ATOMIC_HPP
+
+#include <stdint.h>
+#include "utility.hpp"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace wob
+{
+	enum class MemoryOrder
+	{
+		Relaxed,
+		Acquire,
+		Release,
+		AcqRel,
+		SeqCst
+	};
+
+	/*
+	 * Minimal atomic for 32/64 bits integers and pointers, built on compiler intrinsics (we don't use the std)
+	 * MSVC path assume a x86/x64 memory model
+	 */
+	template<typename T>
+	class Atomic
+	{
+		static_assert(sizeof(T) == 4 || sizeof(T) == 8, "only 32 and 64 bits atomics are supported");
+
+	public:
+		constexpr Atomic() noexcept : value() {}
+		constexpr Atomic(T v) noexcept : value(v) {}
+		Atomic(Atomic const&) = delete;
+		Atomic& operator=(Atomic const&) = delete;
+
+#if defined(__GNUC__) || defined(__clang__)
+
+		T load(MemoryOrder order = MemoryOrder::SeqCst) const noexcept
+		{
+			return __atomic_load_n(&value, toBuiltin(order));
+		}
+
+		void store(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept
+		{
+			__atomic_store_n(&value, v, toBuiltin(order));
+		}
+
+		T exchange(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept
+		{
+			return __atomic_exchange_n(&value, v, toBuiltin(order));
+		}
+
+		// on failure expected receive the current value
+		bool compareExchange(T& expected, T desired, MemoryOrder order = MemoryOrder::SeqCst) noexcept
+		{
+			// failure order can't have release semantic
+			MemoryOrder const failOrder = order == MemoryOrder::Release ? MemoryOrder::Relaxed
+				: order == MemoryOrder::AcqRel ? MemoryOrder::Acquire : order;
+			return __atomic_compare_exchange_n(&value, &expected, desired, false, toBuiltin(order), toBuiltin(failOrder));
+		}
+
+		T fetchAdd(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept requires wob::integral<T>
+		{
+			return __atomic_fetch_add(&value, v, toBuiltin(order));
+		}
+
+		T fetchSub(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept requires wob::integral<T>
+		{
+			return __atomic_fetch_sub(&value, v, toBuiltin(order));
+		}
+
+	private:
+
+		static constexpr int toBuiltin(MemoryOrder order) noexcept
+		{
+			switch (order)
+			{
+			case MemoryOrder::Relaxed: return __ATOMIC_RELAXED;
+			case MemoryOrder::Acquire: return __ATOMIC_ACQUIRE;
+			case MemoryOrder::Release: return __ATOMIC_RELEASE;
+			case MemoryOrder::AcqRel: return __ATOMIC_ACQ_REL;
+			default: return __ATOMIC_SEQ_CST;
+			}
+		}
+
+		T value;
+
+#elif defined(_MSC_VER)
+
+		T load(MemoryOrder order = MemoryOrder::SeqCst) const noexcept
+		{
+			WOB_UNUSED(order);
+			T const v = value;
+			_ReadWriteBarrier();
+			return v;
+		}
+
+		void store(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept
+		{
+			if (order == MemoryOrder::SeqCst)
+			{
+				exchange(v);
+				return;
+			}
+			_ReadWriteBarrier();
+			value = v;
+		}
+
+		T exchange(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept
+		{
+			WOB_UNUSED(order);
+			if constexpr (sizeof(T) == 8)
+				return fromBits<T>(_InterlockedExchange64(reinterpret_cast<volatile long long*>(&value), toBits<long long>(v)));
+			else
+				return fromBits<T>(_InterlockedExchange(reinterpret_cast<volatile long*>(&value), toBits<long>(v)));
+		}
+
+		bool compareExchange(T& expected, T desired, MemoryOrder order = MemoryOrder::SeqCst) noexcept
+		{
+			WOB_UNUSED(order);
+			T prev;
+			if constexpr (sizeof(T) == 8)
+				prev = fromBits<T>(_InterlockedCompareExchange64(reinterpret_cast<volatile long long*>(&value), toBits<long long>(desired), toBits<long long>(expected)));
+			else
+				prev = fromBits<T>(_InterlockedCompareExchange(reinterpret_cast<volatile long*>(&value), toBits<long>(desired), toBits<long>(expected)));
+
+			if (prev == expected)
+				return true;
+			expected = prev;
+			return false;
+		}
+
+		T fetchAdd(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept requires wob::integral<T>
+		{
+			WOB_UNUSED(order);
+			if constexpr (sizeof(T) == 8)
+				return (T)_InterlockedExchangeAdd64(reinterpret_cast<volatile long long*>(&value), (long long)v);
+			else
+				return (T)_InterlockedExchangeAdd(reinterpret_cast<volatile long*>(&value), (long)v);
+		}
+
+		T fetchSub(T v, MemoryOrder order = MemoryOrder::SeqCst) noexcept requires wob::integral<T>
+		{
+			return fetchAdd((T)(0 - v), order);
+		}
+
+	private:
+
+		template<typename To, typename From>
+		static To toBits(From v) noexcept
+		{
+			return (To)(v);
+		}
+
+		template<typename To, typename From>
+		static To fromBits(From v) noexcept
+		{
+			return (To)(v);
+		}
+
+		volatile T value;
+#endif
+	};
+
+	// busy wait hint
+	inline void cpuRelax() noexcept
+	{
+#if defined(_MSC_VER)
+		_mm_pause();
+#elif defined(__i386__) || defined(__x86_64__)
+		__builtin_ia32_pause();
+#elif defined(__arm__) || defined(__aarch64__)
+		__asm__ __volatile__("yield");
+#endif
+	}
+}
+
+#endif
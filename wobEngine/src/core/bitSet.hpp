@@ -0,0 +1,348 @@
+#ifndef WOB_BIT_SET_HPP
+#define WOB_BIT_SET_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "allocator.hpp"
+#include "array.hpp"
+#include "maths.hpp"
+#include <stdint.h>
+#include <string.h>
+
+namespace wob
+{
+	// indices of the set bits of a word array, lowest first
+	class SetBitIterator
+	{
+	public:
+		SetBitIterator(uint64_t const* words_, uint32_t wordCount_, uint32_t wordIndex_) noexcept
+			: words(words_), wordCount(wordCount_), wordIndex(wordIndex_), word(wordIndex_ < wordCount_ ? words_[wordIndex_] : 0)
+		{
+			skipEmptyWords();
+		}
+
+		uint32_t operator*() const noexcept
+		{
+			return wordIndex * 64 + (uint32_t)countTrailingZeros(word);
+		}
+
+		SetBitIterator& operator++() noexcept
+		{
+			// clear the lowest set bit
+			word &= word - 1;
+			skipEmptyWords();
+			return *this;
+		}
+
+		bool operator==(SetBitIterator const& rhs) const noexcept { return wordIndex == rhs.wordIndex && word == rhs.word; }
+		bool operator!=(SetBitIterator const& rhs) const noexcept { return !(*this == rhs); }
+
+	private:
+		void skipEmptyWords() noexcept
+		{
+			while (word == 0 && wordIndex + 1 < wordCount)
+				word = words[++wordIndex];
+			// every end position compares equal
+			if (word == 0)
+				wordIndex = wordCount;
+		}
+
+		uint64_t const* words;
+		uint32_t wordCount;
+		uint32_t wordIndex;
+		uint64_t word;
+	};
+
+	/*
+	 * Operations shared by BitSet and DynamicBitSet, Derived provides size(), wordCount() and wordData()
+	 * bits past size() are always 0 in the last word so counts and iteration never see them
+	 * binary operations work a 64 bits word at a time and need operands of the same size
+	 */
+	template<typename Derived>
+	class BitSetBase
+	{
+	public:
+		static constexpr uint32_t npos = ~0u;
+		static constexpr uint32_t bitsPerWord = 64;
+
+		[[nodiscard]] bool test(uint32_t i) const noexcept
+		{
+			WOB_BOUNDS_CHECK(i < self().size());
+			return (words()[i / bitsPerWord] >> (i % bitsPerWord)) & 1;
+		}
+
+		[[nodiscard]] bool operator[](uint32_t i) const noexcept
+		{
+			return test(i);
+		}
+
+		Derived& set(uint32_t i) noexcept
+		{
+			WOB_BOUNDS_CHECK(i < self().size());
+			words()[i / bitsPerWord] |= 1ull << (i % bitsPerWord);
+			return self();
+		}
+
+		Derived& set(uint32_t i, bool value) noexcept
+		{
+			return value ? set(i) : reset(i);
+		}
+
+		Derived& reset(uint32_t i) noexcept
+		{
+			WOB_BOUNDS_CHECK(i < self().size());
+			words()[i / bitsPerWord] &= ~(1ull << (i % bitsPerWord));
+			return self();
+		}
+
+		Derived& flip(uint32_t i) noexcept
+		{
+			WOB_BOUNDS_CHECK(i < self().size());
+			words()[i / bitsPerWord] ^= 1ull << (i % bitsPerWord);
+			return self();
+		}
+
+		Derived& setAll() noexcept
+		{
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+				words()[w] = ~0ull;
+			clearPadding();
+			return self();
+		}
+
+		Derived& resetAll() noexcept
+		{
+			if (wordCount() > 0)
+				memset(words(), 0, wordCount() * sizeof(uint64_t));
+			return self();
+		}
+
+		Derived& flipAll() noexcept
+		{
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+				words()[w] = ~words()[w];
+			clearPadding();
+			return self();
+		}
+
+		// number of set bits
+		[[nodiscard]] uint32_t count() const noexcept
+		{
+			uint32_t total = 0;
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+				total += (uint32_t)countSetBits(words()[w]);
+			return total;
+		}
+
+		[[nodiscard]] bool any() const noexcept
+		{
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+			{
+				if (words()[w] != 0)
+					return true;
+			}
+			return false;
+		}
+
+		[[nodiscard]] bool none() const noexcept
+		{
+			return !any();
+		}
+
+		[[nodiscard]] bool all() const noexcept
+		{
+			return count() == self().size();
+		}
+
+		// index of the lowest set bit, npos if none is
+		[[nodiscard]] uint32_t findFirst() const noexcept
+		{
+			return findFrom(0);
+		}
+
+		// index of the lowest set bit after i, npos if none is
+		[[nodiscard]] uint32_t findNext(uint32_t i) const noexcept
+		{
+			return i + 1 < self().size() ? findFrom(i + 1) : npos;
+		}
+
+		template<typename Rhs>
+		Derived& operator&=(BitSetBase<Rhs> const& rhs) noexcept
+		{
+			WOB_ASSERT_NOLOG(self().size() == rhs.self().size());
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+				words()[w] &= rhs.words()[w];
+			return self();
+		}
+
+		template<typename Rhs>
+		Derived& operator|=(BitSetBase<Rhs> const& rhs) noexcept
+		{
+			WOB_ASSERT_NOLOG(self().size() == rhs.self().size());
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+				words()[w] |= rhs.words()[w];
+			return self();
+		}
+
+		template<typename Rhs>
+		Derived& operator^=(BitSetBase<Rhs> const& rhs) noexcept
+		{
+			WOB_ASSERT_NOLOG(self().size() == rhs.self().size());
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+				words()[w] ^= rhs.words()[w];
+			return self();
+		}
+
+		// clear the bits set in rhs
+		template<typename Rhs>
+		Derived& andNot(BitSetBase<Rhs> const& rhs) noexcept
+		{
+			WOB_ASSERT_NOLOG(self().size() == rhs.self().size());
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+				words()[w] &= ~rhs.words()[w];
+			return self();
+		}
+
+		// true if a bit is set in both
+		template<typename Rhs>
+		[[nodiscard]] bool intersects(BitSetBase<Rhs> const& rhs) const noexcept
+		{
+			WOB_ASSERT_NOLOG(self().size() == rhs.self().size());
+			uint32_t const n = wordCount();
+			for (uint32_t w = 0; w < n; w++)
+			{
+				if ((words()[w] & rhs.words()[w]) != 0)
+					return true;
+			}
+			return false;
+		}
+
+		template<typename Rhs>
+		[[nodiscard]] bool operator==(BitSetBase<Rhs> const& rhs) const noexcept
+		{
+			return self().size() == rhs.self().size() && (wordCount() == 0 || memcmp(words(), rhs.words(), wordCount() * sizeof(uint64_t)) == 0);
+		}
+
+		template<typename Rhs>
+		[[nodiscard]] bool operator!=(BitSetBase<Rhs> const& rhs) const noexcept
+		{
+			return !(*this == rhs);
+		}
+
+		// iterate the indices of the set bits
+		[[nodiscard]] SetBitIterator begin() const noexcept { return SetBitIterator(words(), wordCount(), 0); }
+		[[nodiscard]] SetBitIterator end() const noexcept { return SetBitIterator(words(), wordCount(), wordCount()); }
+
+		// raw words, bit i is bit (i % 64) of word (i / 64), keep the bits past size() cleared when writing them
+		[[nodiscard]] uint64_t* words() noexcept { return self().wordData(); }
+		[[nodiscard]] uint64_t const* words() const noexcept { return self().wordData(); }
+		[[nodiscard]] uint32_t wordCount() const noexcept { return (self().size() + bitsPerWord - 1) / bitsPerWord; }
+
+	protected:
+		Derived& self() noexcept { return static_cast<Derived&>(*this); }
+		Derived const& self() const noexcept { return static_cast<Derived const&>(*this); }
+
+		template<typename>
+		friend class BitSetBase;
+
+		void clearPadding() noexcept
+		{
+			uint32_t const used = self().size() % bitsPerWord;
+			if (used != 0)
+				words()[wordCount() - 1] &= (1ull << used) - 1;
+		}
+
+		uint32_t findFrom(uint32_t i) const noexcept
+		{
+			uint32_t const n = wordCount();
+			uint32_t w = i / bitsPerWord;
+			if (w >= n)
+				return npos;
+
+			// drop the bits below i in the first word
+			uint64_t word = words()[w] & (~0ull << (i % bitsPerWord));
+			while (word == 0)
+			{
+				if (++w == n)
+					return npos;
+				word = words()[w];
+			}
+			return w * bitsPerWord + (uint32_t)countTrailingZeros(word);
+		}
+	};
+
+	// N bits stored inline, all cleared at construction
+	template<uint32_t N>
+	class BitSet : public BitSetBase<BitSet<N>>
+	{
+		static_assert(N > 0, "empty bit set");
+
+	public:
+		constexpr BitSet() noexcept : storage{} {}
+
+		[[nodiscard]] static constexpr uint32_t size() noexcept { return N; }
+
+		uint64_t* wordData() noexcept { return storage; }
+		uint64_t const* wordData() const noexcept { return storage; }
+
+	private:
+		uint64_t storage[(N + 63) / 64];
+	};
+
+	// bit set sized at runtime, new bits are cleared when it grows
+	class DynamicBitSet : public BitSetBase<DynamicBitSet>
+	{
+	public:
+		DynamicBitSet() noexcept = default;
+
+		explicit DynamicBitSet(IAllocator& allocator) noexcept
+			: storage(allocator)
+		{
+
+		}
+
+		explicit DynamicBitSet(uint32_t size, IAllocator& allocator = *getContextAllocator()) noexcept
+			: storage(allocator)
+		{
+			resize(size);
+		}
+
+		void resize(uint32_t n) noexcept
+		{
+			uint32_t const oldWordCount = storage.size();
+			uint32_t const newWordCount = (n + bitsPerWord - 1) / bitsPerWord;
+			storage.resizeNoInit(newWordCount);
+			for (uint32_t w = oldWordCount; w < newWordCount; w++)
+				storage[w] = 0;
+			size_ = n;
+			// bits dropped by a shrink must not come back with the next grow
+			clearPadding();
+		}
+
+		// storage for n bits without changing the size
+		void reserve(uint32_t n) noexcept
+		{
+			storage.reserve((n + bitsPerWord - 1) / bitsPerWord);
+		}
+
+		[[nodiscard]] uint32_t size() const noexcept { return size_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+		uint64_t* wordData() noexcept { return storage.data(); }
+		uint64_t const* wordData() const noexcept { return storage.data(); }
+
+	private:
+		Array<uint64_t> storage;
+		uint32_t size_ = 0;
+	};
+}
+
+#endif
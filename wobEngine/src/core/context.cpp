@@ -2,7 +2,7 @@
 #include "allocator.hpp"
 #include "string.hpp"
 
-thread_local wob::Context wob::context{&wob::profilerAlloc};
+thread_local wob::Context wob::context{&wob::profilerAlloc, nullptr, nullptr};
 
 namespace wob
 {
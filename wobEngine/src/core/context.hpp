@@ -15,6 +15,10 @@ namespace wob
 		//ErrorEntry popError();
 
 		struct IAllocator* allocator;
+		// transient memory released at frame boundaries, null if the thread has none (see frameAllocator.hpp)
+		class FrameAllocator* frameAllocator;
+		// workers to run jobs on, null if the thread can't run any (see jobSystem.hpp)
+		class JobSystem* jobSystem;
 		//struct ErrorContext* errorStack;
 		Logger logger;
 	};
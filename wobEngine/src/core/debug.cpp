@@ -3,7 +3,10 @@
 #include "context.hpp"
 #include "format.hpp"
 #include "utility.hpp"
+#include "log.hpp"
+#include "time.hpp"
 #include <stdio.h>
+#include <string.h>
 
 #ifdef __vita__
 #include "psvDebugScreen/debugScreen.h"
@@ -11,7 +14,7 @@
 
 using namespace wob;
 
-Logger::Logger() noexcept : sinkCount(0)
+Logger::Logger() noexcept : sinkCount(0), minLevel(LogLevel::Info), async(nullptr)
 {
 	for (auto& sink : sinks)
 		sink = nullptr;
@@ -30,9 +33,21 @@ void Logger::addSink(Sink& sink) noexcept
 
 void Logger::log(const char* message) noexcept
 {
+	log(LogLevel::Info, source_location(), message, (uint32_t)strlen(message));
+}
+
+void Logger::log(LogLevel level, source_location const& location, const char* message, uint32_t size) noexcept
+{
+	if (async)
+	{
+		async->push(level, location, message, size);
+		return;
+	}
+
+	LogRecord const record{ message, size, level, getPerfCount(), location };
 	for (int i = 0; i < sinkCount; i++)
 	{
-		sinks[i]->dispatch_log(message);
+		sinks[i]->dispatch(record);
 		sinks[i]->flush();
 	}
 }
@@ -2,27 +2,24 @@
 #define WOB_DEBUG_HPP
 
 #include "macro_helpers.hpp"
-//#include "format.hpp"
+#include <stdint.h>
 #include <stdio.h>
 
-// loging system should be completly revised
-// we may want to get rif of macros and use 
-// 
-// 
-// 
-// source_location
-// also we want filters, warning level and more ....
-// maybe take inspiration from spd log ?
+// logging macros, the format string is checked at compile time (see format.hpp)
+// level filtering happens before the arguments are formatted
+// we may want to get rid of macros once source_location is usable everywhere
 #ifdef __vita__
-	#define WOB_LOG(msg, ...) ::wob::Logger::instance().log(::wob::format("info: " msg "\n" __VA_OPT__(,) __VA_ARGS__).c_str())
-	#define WOB_LOG_RAW(msg, ...) ::wob::Logger::instance().wob(::wob::format(msg "\n" __VA_OPT__(,) __VA_ARGS__).c_str())
-	#define WOB_WARN(msg, ...) ::wob::Logger::instance().log(::wob::format("warn: " msg "\n" __VA_OPT__(,) __VA_ARGS__).c_str())
-	#define WOB_LOG_ERROR(msg, ...) ::wob::Logger::instance().log(::wob::format("error: " msg "\n" __VA_OPT__(,) __VA_ARGS__).c_str())
+	#define WOB_LOG_AT(level, msg, ...) (::wob::Logger::instance().isEnabled(level) ? ::wob::logFormat(::wob::Logger::instance(), level, ::wob::source_location::current(), msg __VA_OPT__(,) __VA_ARGS__) : void())
+	#define WOB_LOG(msg, ...) WOB_LOG_AT(::wob::LogLevel::Info, "info: " msg "\n" __VA_OPT__(,) __VA_ARGS__)
+	#define WOB_LOG_RAW(msg, ...) WOB_LOG_AT(::wob::LogLevel::Info, msg "\n" __VA_OPT__(,) __VA_ARGS__)
+	#define WOB_WARN(msg, ...) WOB_LOG_AT(::wob::LogLevel::Warning, "warn: " msg "\n" __VA_OPT__(,) __VA_ARGS__)
+	#define WOB_LOG_ERROR(msg, ...) WOB_LOG_AT(::wob::LogLevel::Error, "error: " msg "\n" __VA_OPT__(,) __VA_ARGS__)
 #else
-	#define WOB_LOG(msg, ...) ::wob::Logger::instance().log(::wob::format("info: " msg "\n", __VA_ARGS__).c_str())
-	#define WOB_LOG_RAW(msg, ...) ::wob::Logger::instance().log(::wob::format(msg "\n", __VA_ARGS__).c_str())
-	#define WOB_WARN(msg, ...) ::wob::Logger::instance().log(::wob::format("warn: " msg "\n", __VA_ARGS__).c_str())
-	#define WOB_LOG_ERROR(msg, ...) ::wob::Logger::instance().log(::wob::format("error: " __FUNCTION__ " : " WOB_STRINGIFY(__LINE__) ": " msg "\n", __VA_ARGS__).c_str())
+	#define WOB_LOG_AT(level, msg, ...) (::wob::Logger::instance().isEnabled(level) ? ::wob::logFormat(::wob::Logger::instance(), level, ::wob::source_location::current(), msg, __VA_ARGS__) : void())
+	#define WOB_LOG(msg, ...) WOB_LOG_AT(::wob::LogLevel::Info, "info: " msg "\n", __VA_ARGS__)
+	#define WOB_LOG_RAW(msg, ...) WOB_LOG_AT(::wob::LogLevel::Info, msg "\n", __VA_ARGS__)
+	#define WOB_WARN(msg, ...) WOB_LOG_AT(::wob::LogLevel::Warning, "warn: " msg "\n", __VA_ARGS__)
+	#define WOB_LOG_ERROR(msg, ...) WOB_LOG_AT(::wob::LogLevel::Error, "error: " __FUNCTION__ " : " WOB_STRINGIFY(__LINE__) ": " msg "\n", __VA_ARGS__)
 #endif
 
 #define WOB_CHECKR(r) if (!(r)) { WOB_LOG_ERROR("{}", r.error()); return r; };
@@ -73,6 +70,23 @@ namespace wob
 		const char* _Function = "";
 	};
 
+	enum class LogLevel : uint8_t
+	{
+		Info,
+		Warning,
+		Error,
+		Off
+	};
+
+	struct LogRecord
+	{
+		const char* message; // null terminated
+		uint32_t size;
+		LogLevel level;
+		long long timestamp; // getPerfCount when the message was logged
+		source_location location;
+	};
+
 	/// The Sink interface is used to dispatch log message
 	/// a typical sink implementation will show the log message in the console or send it over network for remote debugging
 	class Sink
@@ -81,8 +95,18 @@ namespace wob
 		virtual void dispatch_log(const char* message) noexcept = 0;
 		virtual void flush() noexcept = 0;
 		virtual ~Sink() {};
+
+		// override to use the level, time or location of the message
+		virtual void dispatch(LogRecord const& record) noexcept
+		{
+			dispatch_log(record.message);
+		}
 	};
 
+	/// Per thread front of the logging system
+	/// By default messages are dispatched to the sinks on the calling thread and every sink is flushed after each message.
+	/// With setAsync messages are pushed to an AsyncLogger (see log.hpp) shared between threads
+	/// and the sinks are called from its thread.
 	class Logger
 	{
 	public:
@@ -93,11 +117,21 @@ namespace wob
 
 		void addSink(Sink& sink) noexcept;
 		void log(const char* message) noexcept;
+		void log(LogLevel level, source_location const& location, const char* message, uint32_t size) noexcept;
+
+		[[nodiscard]] bool isEnabled(LogLevel level) const noexcept { return level >= minLevel; }
+		void setLevel(LogLevel level) noexcept { minLevel = level; }
+
+		// nullptr goes back to synchronous dispatch
+		void setAsync(class AsyncLogger* pipeline) noexcept { async = pipeline; }
+		[[nodiscard]] class AsyncLogger* getAsync() const noexcept { return async; }
 
 	private:
 
 		Sink* sinks[8];
 		int sinkCount;
+		LogLevel minLevel;
+		class AsyncLogger* async;
 	};
 
 	class StreamSink final : public Sink
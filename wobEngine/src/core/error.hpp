@@ -5,6 +5,7 @@
 #include "utility.hpp"
 #include "coreMacros.hpp"
 #include "errorCodes.hpp"
+#include "allocator.hpp"
 
 namespace wob {
 	/**
@@ -41,6 +42,43 @@ namespace wob {
 
 		}
 
+		// the union hides the value special members, a result holding a non trivial value can only move with these
+		Result(Result const& rhs) noexcept : tag(rhs.tag)
+		{
+			if (rhs.hasValue())
+				new (&value_) ValueType(rhs.value_);
+			else
+				error_ = rhs.error_;
+		}
+
+		Result(Result&& rhs) noexcept : tag(rhs.tag)
+		{
+			if (rhs.hasValue())
+				new (&value_) ValueType(wob::move(rhs.value_));
+			else
+				error_ = rhs.error_;
+		}
+
+		Result& operator=(Result const& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				this->~Result();
+				new (this) Result(rhs);
+			}
+			return *this;
+		}
+
+		Result& operator=(Result&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				this->~Result();
+				new (this) Result(wob::move(rhs));
+			}
+			return *this;
+		}
+
 		~Result()
 		{
 			if (hasValue())
@@ -21,7 +21,8 @@ namespace wob
 		FontInitFailed,
 		BlendStateCreationFailed,
 		RenderTargetCreationFailed,
-		SamplerApplicationFailed
+		SamplerApplicationFailed,
+		FileReadFailed
 	};
 
 	inline const char* to_string(ErrorCode err)
@@ -41,6 +42,7 @@ namespace wob
 				CASE(BlendStateCreationFailed)
 				CASE(RenderTargetCreationFailed)
 				CASE(SamplerApplicationFailed)
+				CASE(FileReadFailed)
 		}
 #undef CASE
 		return "undefined";
@@ -0,0 +1,413 @@
+#ifndef WOB_FLOAT_TO_CHARS_HPP
+#define WOB_FLOAT_TO_CHARS_HPP
+
+#include <stdint.h>
+#include "utility.hpp"
+#include "maths.hpp"
+#include "dragon4.hpp"
+
+/*
+ * Shortest round trip float printing
+ * Digits come from Grisu3 ("Printing Floating-Point Numbers Quickly and Accurately with Integers", Loitsch 2010)
+ * which only needs 64 bits integer math and proves its result is the shortest and closest for ~99.5% of doubles,
+ * the remaining ones fall back on Dragon4, exact but working on big integers.
+ * The digits are the same as d4::Dragon4 in CutoffMode_Unique.
+ * Everything is constexpr except the Dragon4 fallback and inf / nan.
+ */
+
+namespace wob
+{
+	// enough for any float or double, sign included
+	constexpr uint32_t floatCharsMax = 32;
+
+	namespace grisu
+	{
+		// f * 2^e
+		struct DiyFp
+		{
+			uint64_t f;
+			int32_t e;
+		};
+
+		struct CachedPower
+		{
+			uint64_t significand;
+			int16_t binaryExponent;
+			int16_t decimalExponent;
+		};
+
+		// 10^k for k = -348 to 340 by steps of 8, significands rounded to nearest
+		inline constexpr CachedPower cachedPowers[] =
+		{
+			{ 0xfa8fd5a0081c0288ull, -1220, -348 },
+			{ 0xbaaee17fa23ebf76ull, -1193, -340 },
+			{ 0x8b16fb203055ac76ull, -1166, -332 },
+			{ 0xcf42894a5dce35eaull, -1140, -324 },
+			{ 0x9a6bb0aa55653b2dull, -1113, -316 },
+			{ 0xe61acf033d1a45dfull, -1087, -308 },
+			{ 0xab70fe17c79ac6caull, -1060, -300 },
+			{ 0xff77b1fcbebcdc4full, -1034, -292 },
+			{ 0xbe5691ef416bd60cull, -1007, -284 },
+			{ 0x8dd01fad907ffc3cull, -980, -276 },
+			{ 0xd3515c2831559a83ull, -954, -268 },
+			{ 0x9d71ac8fada6c9b5ull, -927, -260 },
+			{ 0xea9c227723ee8bcbull, -901, -252 },
+			{ 0xaecc49914078536dull, -874, -244 },
+			{ 0x823c12795db6ce57ull, -847, -236 },
+			{ 0xc21094364dfb5637ull, -821, -228 },
+			{ 0x9096ea6f3848984full, -794, -220 },
+			{ 0xd77485cb25823ac7ull, -768, -212 },
+			{ 0xa086cfcd97bf97f4ull, -741, -204 },
+			{ 0xef340a98172aace5ull, -715, -196 },
+			{ 0xb23867fb2a35b28eull, -688, -188 },
+			{ 0x84c8d4dfd2c63f3bull, -661, -180 },
+			{ 0xc5dd44271ad3cdbaull, -635, -172 },
+			{ 0x936b9fcebb25c996ull, -608, -164 },
+			{ 0xdbac6c247d62a584ull, -582, -156 },
+			{ 0xa3ab66580d5fdaf6ull, -555, -148 },
+			{ 0xf3e2f893dec3f126ull, -529, -140 },
+			{ 0xb5b5ada8aaff80b8ull, -502, -132 },
+			{ 0x87625f056c7c4a8bull, -475, -124 },
+			{ 0xc9bcff6034c13053ull, -449, -116 },
+			{ 0x964e858c91ba2655ull, -422, -108 },
+			{ 0xdff9772470297ebdull, -396, -100 },
+			{ 0xa6dfbd9fb8e5b88full, -369, -92 },
+			{ 0xf8a95fcf88747d94ull, -343, -84 },
+			{ 0xb94470938fa89bcfull, -316, -76 },
+			{ 0x8a08f0f8bf0f156bull, -289, -68 },
+			{ 0xcdb02555653131b6ull, -263, -60 },
+			{ 0x993fe2c6d07b7facull, -236, -52 },
+			{ 0xe45c10c42a2b3b06ull, -210, -44 },
+			{ 0xaa242499697392d3ull, -183, -36 },
+			{ 0xfd87b5f28300ca0eull, -157, -28 },
+			{ 0xbce5086492111aebull, -130, -20 },
+			{ 0x8cbccc096f5088ccull, -103, -12 },
+			{ 0xd1b71758e219652cull, -77, -4 },
+			{ 0x9c40000000000000ull, -50, 4 },
+			{ 0xe8d4a51000000000ull, -24, 12 },
+			{ 0xad78ebc5ac620000ull, 3, 20 },
+			{ 0x813f3978f8940984ull, 30, 28 },
+			{ 0xc097ce7bc90715b3ull, 56, 36 },
+			{ 0x8f7e32ce7bea5c70ull, 83, 44 },
+			{ 0xd5d238a4abe98068ull, 109, 52 },
+			{ 0x9f4f2726179a2245ull, 136, 60 },
+			{ 0xed63a231d4c4fb27ull, 162, 68 },
+			{ 0xb0de65388cc8ada8ull, 189, 76 },
+			{ 0x83c7088e1aab65dbull, 216, 84 },
+			{ 0xc45d1df942711d9aull, 242, 92 },
+			{ 0x924d692ca61be758ull, 269, 100 },
+			{ 0xda01ee641a708deaull, 295, 108 },
+			{ 0xa26da3999aef774aull, 322, 116 },
+			{ 0xf209787bb47d6b85ull, 348, 124 },
+			{ 0xb454e4a179dd1877ull, 375, 132 },
+			{ 0x865b86925b9bc5c2ull, 402, 140 },
+			{ 0xc83553c5c8965d3dull, 428, 148 },
+			{ 0x952ab45cfa97a0b3ull, 455, 156 },
+			{ 0xde469fbd99a05fe3ull, 481, 164 },
+			{ 0xa59bc234db398c25ull, 508, 172 },
+			{ 0xf6c69a72a3989f5cull, 534, 180 },
+			{ 0xb7dcbf5354e9beceull, 561, 188 },
+			{ 0x88fcf317f22241e2ull, 588, 196 },
+			{ 0xcc20ce9bd35c78a5ull, 614, 204 },
+			{ 0x98165af37b2153dfull, 641, 212 },
+			{ 0xe2a0b5dc971f303aull, 667, 220 },
+			{ 0xa8d9d1535ce3b396ull, 694, 228 },
+			{ 0xfb9b7cd9a4a7443cull, 720, 236 },
+			{ 0xbb764c4ca7a44410ull, 747, 244 },
+			{ 0x8bab8eefb6409c1aull, 774, 252 },
+			{ 0xd01fef10a657842cull, 800, 260 },
+			{ 0x9b10a4e5e9913129ull, 827, 268 },
+			{ 0xe7109bfba19c0c9dull, 853, 276 },
+			{ 0xac2820d9623bf429ull, 880, 284 },
+			{ 0x80444b5e7aa7cf85ull, 907, 292 },
+			{ 0xbf21e44003acdd2dull, 933, 300 },
+			{ 0x8e679c2f5e44ff8full, 960, 308 },
+			{ 0xd433179d9c8cb841ull, 986, 316 },
+			{ 0x9e19db92b4e31ba9ull, 1013, 324 },
+			{ 0xeb96bf6ebadf77d9ull, 1039, 332 },
+			{ 0xaf87023b9bf0ee6bull, 1066, 340 },
+		};
+
+		inline constexpr int32_t cachedPowersFirstExponent = -348;
+		inline constexpr int32_t cachedPowersStep = 8;
+
+		// the scaled binary exponent is kept in [-60, -32] so the integral part of the scaled value fits 32 bits
+		inline constexpr int32_t minimalTargetExponent = -60;
+
+		inline constexpr uint32_t smallPowersOfTen[] = { 0, 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+		// value = digits * 10^exponent
+		struct Decimal
+		{
+			char digits[20];
+			uint32_t count;
+			int32_t exponent;
+		};
+
+		constexpr DiyFp normalize(DiyFp v) noexcept
+		{
+			int shift = 0;
+			if (is_constant_evaluated())
+			{
+				while (!((v.f << shift) >> 63))
+					shift++;
+			}
+			else
+			{
+				shift = countLeadingZeros(v.f);
+			}
+			return { v.f << shift, v.e - shift };
+		}
+
+		// upper 64 bits of the 128 bits product, rounded
+		constexpr DiyFp multiply(DiyFp lhs, DiyFp rhs) noexcept
+		{
+			uint64_t const mask = 0xFFFFFFFFull;
+			uint64_t const a = lhs.f >> 32, b = lhs.f & mask;
+			uint64_t const c = rhs.f >> 32, d = rhs.f & mask;
+			uint64_t const ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+			uint64_t const mid = (bd >> 32) + (ad & mask) + (bc & mask) + (1ull << 31);
+			return { ac + (ad >> 32) + (bc >> 32) + (mid >> 32), lhs.e + rhs.e + 64 };
+		}
+
+		// cached power c such that minExponent <= c.binaryExponent + 64 <= minExponent + 28
+		constexpr CachedPower cachedPowerFor(int32_t minExponent) noexcept
+		{
+			// k = ceil((minExponent + 63) * log10(2)), 78913 / 2^18 is exact enough for |x| < 1650
+			int32_t const x = minExponent + 63;
+			int32_t const k = ((x * 78913) >> 18) + (x != 0);
+			int32_t const index = (-cachedPowersFirstExponent + k - 1) / cachedPowersStep + 1;
+			return cachedPowers[index];
+		}
+
+		// biggest power of ten <= number, number has at most numberBits bits
+		constexpr void biggestPowerTen(uint32_t number, int32_t numberBits, uint32_t& power, int32_t& exponentPlusOne) noexcept
+		{
+			int32_t guess = ((numberBits + 1) * 1233 >> 12) + 1;
+			if (number < smallPowersOfTen[guess])
+				guess--;
+			power = smallPowersOfTen[guess];
+			exponentPlusOne = guess;
+		}
+
+		// move the last digit toward w while it stays in the safe interval, fail when the closest digit can't be proven
+		constexpr bool roundWeed(Decimal& out, uint64_t distanceTooHighW, uint64_t unsafeInterval, uint64_t rest, uint64_t tenKappa, uint64_t unit) noexcept
+		{
+			uint64_t const smallDistance = distanceTooHighW - unit;
+			uint64_t const bigDistance = distanceTooHighW + unit;
+
+			while (rest < smallDistance && unsafeInterval - rest >= tenKappa &&
+				(rest + tenKappa < smallDistance || smallDistance - rest >= rest + tenKappa - smallDistance))
+			{
+				out.digits[out.count - 1]--;
+				rest += tenKappa;
+			}
+
+			if (rest < bigDistance && unsafeInterval - rest >= tenKappa &&
+				(rest + tenKappa < bigDistance || bigDistance - rest > rest + tenKappa - bigDistance))
+			{
+				return false;
+			}
+
+			return 2 * unit <= rest && rest <= unsafeInterval - 4 * unit;
+		}
+
+		// shortest digits of w in ]low, high[, all three already scaled by the cached power
+		constexpr bool digitGen(DiyFp low, DiyFp w, DiyFp high, Decimal& out, int32_t& kappa) noexcept
+		{
+			// low and high are imprecise by one unit, the unsafe interval contains every candidate
+			uint64_t unit = 1;
+			DiyFp const tooLow{ low.f - unit, low.e };
+			DiyFp const tooHigh{ high.f + unit, high.e };
+			uint64_t unsafeInterval = tooHigh.f - tooLow.f;
+
+			int32_t const shift = -w.e;
+			uint64_t const one = 1ull << shift;
+			uint32_t integrals = (uint32_t)(tooHigh.f >> shift);
+			uint64_t fractionals = tooHigh.f & (one - 1);
+
+			uint32_t divisor = 0;
+			int32_t divisorExponentPlusOne = 0;
+			biggestPowerTen(integrals, 64 - shift, divisor, divisorExponentPlusOne);
+			kappa = divisorExponentPlusOne;
+			out.count = 0;
+
+			while (kappa > 0)
+			{
+				out.digits[out.count++] = (char)('0' + integrals / divisor);
+				integrals %= divisor;
+				kappa--;
+				uint64_t const rest = ((uint64_t)integrals << shift) + fractionals;
+				if (rest < unsafeInterval)
+					return roundWeed(out, tooHigh.f - w.f, unsafeInterval, rest, (uint64_t)divisor << shift, unit);
+				divisor /= 10;
+			}
+
+			for (;;)
+			{
+				fractionals *= 10;
+				unit *= 10;
+				unsafeInterval *= 10;
+				out.digits[out.count++] = (char)('0' + (fractionals >> shift));
+				fractionals &= one - 1;
+				kappa--;
+				if (fractionals < unsafeInterval)
+					return roundWeed(out, (tooHigh.f - w.f) * unit, unsafeInterval, fractionals, one, unit);
+			}
+		}
+
+		// value = significand * 2^exponent
+		// lowerBoundaryCloser when the previous float is nearer than the next one (power of two above the smallest normal)
+		constexpr bool shortestDigits(uint64_t significand, int32_t exponent, bool lowerBoundaryCloser, Decimal& out) noexcept
+		{
+			DiyFp const w = normalize({ significand, exponent });
+
+			// boundaries are the midpoints with the neighbour floats, both on the w exponent
+			DiyFp const plus = normalize({ (significand << 1) + 1, exponent - 1 });
+			DiyFp minus = lowerBoundaryCloser ? DiyFp{ (significand << 2) - 1, exponent - 2 } : DiyFp{ (significand << 1) - 1, exponent - 1 };
+			minus.f <<= minus.e - plus.e;
+			minus.e = plus.e;
+
+			CachedPower const power = cachedPowerFor(minimalTargetExponent - (w.e + 64));
+			DiyFp const tenMk{ power.significand, power.binaryExponent };
+
+			int32_t kappa = 0;
+			bool const success = digitGen(multiply(minus, tenMk), multiply(w, tenMk), multiply(plus, tenMk), out, kappa);
+			out.exponent = kappa - power.decimalExponent;
+			return success;
+		}
+
+		constexpr uint32_t highBitIndex(uint64_t x) noexcept
+		{
+			uint32_t index = 0;
+			while (x >>= 1)
+				index++;
+			return index;
+		}
+
+		inline void dragon4Digits(uint64_t significand, int32_t exponent, bool lowerBoundaryCloser, Decimal& out) noexcept
+		{
+			int32_t printExponent = 0;
+			out.count = d4::Dragon4(significand, exponent, highBitIndex(significand), lowerBoundaryCloser,
+				d4::CutoffMode_Unique, 0, out.digits, sizeof(out.digits), &printExponent);
+			out.exponent = printExponent - (int32_t)out.count + 1;
+		}
+
+		constexpr void decimalDigits(uint64_t significand, int32_t exponent, bool lowerBoundaryCloser, Decimal& out) noexcept
+		{
+			if (!shortestDigits(significand, exponent, lowerBoundaryCloser, out))
+				dragon4Digits(significand, exponent, lowerBoundaryCloser, out);
+		}
+
+		// positional in [1e-6, 1e21[ like javascript, scientific outside so the size stays bounded
+		constexpr uint32_t writeDecimal(char* out, Decimal const& decimal) noexcept
+		{
+			char* const start = out;
+			int32_t const count = (int32_t)decimal.count;
+			int32_t const pointExponent = decimal.exponent + count - 1;
+
+			if (pointExponent >= 0 && pointExponent < 21)
+			{
+				int32_t const wholeDigits = pointExponent + 1;
+				for (int32_t i = 0; i < count; i++)
+				{
+					if (i == wholeDigits)
+						*out++ = '.';
+					*out++ = decimal.digits[i];
+				}
+				for (int32_t i = count; i < wholeDigits; i++)
+					*out++ = '0';
+			}
+			else if (pointExponent < 0 && pointExponent > -7)
+			{
+				*out++ = '0';
+				*out++ = '.';
+				for (int32_t i = pointExponent + 1; i < 0; i++)
+					*out++ = '0';
+				for (int32_t i = 0; i < count; i++)
+					*out++ = decimal.digits[i];
+			}
+			else
+			{
+				*out++ = decimal.digits[0];
+				if (count > 1)
+				{
+					*out++ = '.';
+					for (int32_t i = 1; i < count; i++)
+						*out++ = decimal.digits[i];
+				}
+				*out++ = 'e';
+				*out++ = pointExponent < 0 ? '-' : '+';
+				uint32_t const e = (uint32_t)(pointExponent < 0 ? -pointExponent : pointExponent);
+				if (e >= 100)
+					*out++ = (char)('0' + e / 100);
+				if (e >= 10)
+					*out++ = (char)('0' + e / 10 % 10);
+				*out++ = (char)('0' + e % 10);
+			}
+			return (uint32_t)(out - start);
+		}
+
+		// inf and nan keep the Dragon4 spelling
+		template<typename T>
+		inline uint32_t writeSpecial(char* out, T value) noexcept
+		{
+			char buffer[floatCharsMax];
+			uint32_t size = 0;
+			if constexpr (sizeof(T) == sizeof(float))
+				size = d4::PrintFloat32(buffer, sizeof(buffer), value, d4::PrintFloatFormat_Positional, -1);
+			else
+				size = d4::PrintFloat64(buffer, sizeof(buffer), value, d4::PrintFloatFormat_Positional, -1);
+			for (uint32_t i = 0; i < size; i++)
+				out[i] = buffer[i];
+			return size;
+		}
+
+		// IEEE 754 binary float with MantissaBits explicit bits, Bits the storage type
+		template<typename Bits, uint32_t MantissaBits, uint32_t ExponentBits, typename T>
+		constexpr uint32_t floatToChars(char* out, T value) noexcept
+		{
+			constexpr uint32_t maxExponent = (1u << ExponentBits) - 1;
+			constexpr int32_t exponentBias = (int32_t)(maxExponent >> 1) + (int32_t)MantissaBits;
+
+			Bits const bits = __builtin_bit_cast(Bits, value);
+			uint32_t const biasedExponent = (uint32_t)(bits >> MantissaBits) & maxExponent;
+			uint64_t const mantissa = bits & (((Bits)1 << MantissaBits) - 1);
+			bool const negative = (bits >> (MantissaBits + ExponentBits)) != 0;
+
+			if (biasedExponent == maxExponent)
+				return writeSpecial(out, value);
+
+			if (negative)
+				*out++ = '-';
+
+			if (biasedExponent == 0 && mantissa == 0)
+			{
+				*out = '0';
+				return negative + 1;
+			}
+
+			// value = significand * 2^exponent, subnormals have no implicit bit
+			uint64_t const significand = biasedExponent ? (mantissa | (1ull << MantissaBits)) : mantissa;
+			int32_t const exponent = (biasedExponent ? (int32_t)biasedExponent : 1) - exponentBias;
+			bool const lowerBoundaryCloser = mantissa == 0 && biasedExponent > 1;
+
+			Decimal decimal{};
+			decimalDigits(significand, exponent, lowerBoundaryCloser, decimal);
+			return negative + writeDecimal(out, decimal);
+		}
+	}
+
+	// write the shortest string that reads back as value, out must hold floatCharsMax chars, not null terminated
+	constexpr uint32_t floatToChars(char* out, float value) noexcept
+	{
+		return grisu::floatToChars<uint32_t, 23, 8>(out, value);
+	}
+
+	constexpr uint32_t floatToChars(char* out, double value) noexcept
+	{
+		return grisu::floatToChars<uint64_t, 52, 11>(out, value);
+	}
+}
+
+#endif
@@ -2,359 +2,411 @@
 #define WOB_FORMAT_HPP
 
 #include "string.hpp"
+#include "stringBuilder.hpp"
 #include "stringView.hpp"
 #include "core/maths.hpp"
 #include "core/utility.hpp"
 #include "core/coreMacros.hpp"
-#include "core/dragon4.hpp"
+#include "core/floatToChars.hpp"
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h>
 
-#define WOB_FMT_CONSTEXPR_OR_INLINE inline
+/*
+ * Type safe formatting, "{}" is replaced by the next argument, "{{" and "}}" are escaped braces
+ * The format string is parsed and checked against the argument count at compile time,
+ * every argument is converted once by its Formatter which gives the exact output size,
+ * so formatting writes directly into the destination without intermediate buffer.
+ * Add support for a type by specializing Formatter<T> with size() and write(char*).
+ */
 
 namespace wob
 {
-	// idk how to name this
-	template<typename T>
-	concept FmtCharPtrT = wob::same_as<wob::remove_cvref_t<T>, char*>;
-
-	constexpr void reverse(char* buffer, int i, int j) noexcept
-	{
-		while (i < j) {
-			wob::swap(buffer[i++], buffer[j--]);
-		}
-	}
-
 	// max number of characters necessary to display numbers
 	constexpr int max_int32_chars = 11;
 	constexpr int max_int64_chars = 21;
 
-	// based on https://www.techiedelight.com/fr/implement-itoa-function-in-c/
-	template<typename T>
-	constexpr void itoa(auto value, char* buffer, int base = 10) noexcept;
+	inline String cFormat(const char* fmt, ...) WOB_PRINTF_FORMAT(1, 2)
+	{
+		char buffer[2048];
+		va_list args;
+		va_start(args, fmt);
+		vsnprintf(buffer, sizeof(buffer), fmt, args);
+		va_end(args);
+		return String(buffer);
+	}
 
-	template<wob::signed_integral T>
-	constexpr void itoa(T value, char* buffer, int base = 10) noexcept
+	// "00" to "99"
+	inline constexpr char digitPairs[201] =
+		"0001020304050607080910111213141516171819"
+		"2021222324252627282930313233343536373839"
+		"4041424344454647484950515253545556575859"
+		"6061626364656667686970717273747576777879"
+		"8081828384858687888990919293949596979899";
+
+	// write the decimal digits of value ending at end, two digits per division, return the first digit
+	template<typename U>
+	inline char* writeDigitsBackward(char* end, U value) noexcept
 	{
-		// invalid entry
-		if (base < 2 || base > 32)
-			return;
-		
-		auto n = wob::abs(value);
-
-		int i = 0;
-		while (n)
+		while (value >= 100)
 		{
-			auto r = n % base;
-
-			if (r >= 10) {
-				buffer[i++] = 65 + (r - 10);
-			}
-			else {
-				buffer[i++] = 48 + r;
-			}
-
-			n = n / base;
+			U const pair = value % 100;
+			value /= 100;
+			end -= 2;
+			memcpy(end, digitPairs + pair * 2, 2);
 		}
 
-		if (i == 0) {
-			buffer[i++] = '0';
+		if (value >= 10)
+		{
+			end -= 2;
+			memcpy(end, digitPairs + value * 2, 2);
 		}
-
-		if (value < 0 && base == 10) {
-			buffer[i++] = '-';
+		else
+		{
+			*--end = static_cast<char>('0' + value);
 		}
-
-		buffer[i] = '\0';
-
-		reverse(buffer, 0, i - 1);
+		return end;
 	}
 
-	template<wob::unsigned_integral T>
-	constexpr void itoa(T value, char* buffer, int base = 10) noexcept
+	template<typename T>
+	struct Formatter
 	{
-		// invalid entry
-		if (base < 2 || base > 32)
-			return;
-
-		auto n = value;
+		static_assert(sizeof(T) == 0, "wob::format : no Formatter specialization for this argument type");
+	};
 
-		int i = 0;
-		while (n)
+	template<wob::integral T>
+	struct Formatter<T>
+	{
+		explicit Formatter(T value) noexcept
 		{
-			auto r = n % base;
-
-			if (r >= 10) {
-				buffer[i++] = 65 + (r - 10);
+			// 32 bits values stay on 32 bits math, 64 bits divisions are slow on 32 bits targets
+			if constexpr (sizeof(T) <= sizeof(uint32_t))
+			{
+				uint32_t const bits = static_cast<uint32_t>(value);
+				negative = value < 0;
+				magnitude = negative ? 0u - bits : bits;
+				digits = (uint32_t)numDigits(static_cast<uint32_t>(magnitude));
 			}
-			else {
-				buffer[i++] = 48 + r;
+			else
+			{
+				uint64_t const bits = static_cast<uint64_t>(value);
+				negative = value < 0;
+				magnitude = negative ? 0ull - bits : bits;
+				digits = (uint32_t)numDigits(magnitude);
 			}
-
-			n = n / base;
 		}
 
-		if (i == 0) {
-			buffer[i++] = '0';
-		}
+		[[nodiscard]] uint32_t size() const noexcept { return digits + negative; }
 
-		buffer[i] = '\0';
+		char* write(char* out) const noexcept
+		{
+			if (negative)
+				*out++ = '-';
+			char* const end = out + digits;
+			if constexpr (sizeof(T) <= sizeof(uint32_t))
+				writeDigitsBackward(end, static_cast<uint32_t>(magnitude));
+			else
+				writeDigitsBackward(end, magnitude);
+			return end;
+		}
 
-		reverse(buffer, 0, i - 1);
-	}
+		uint64_t magnitude;
+		uint32_t digits;
+		bool negative;
+	};
 
-	// assume that dst have enough space for src
-	constexpr void strcpy_fmtinternal(char* WOB_RESTRICT(dst), const char* WOB_RESTRICT(src)) noexcept
+	template<typename T> requires __is_enum(T)
+	struct Formatter<T> : Formatter<wob::underlying_type_t<T>>
 	{
-		if (is_constant_evaluated())
+		explicit Formatter(T value) noexcept
+			: Formatter<wob::underlying_type_t<T>>(static_cast<wob::underlying_type_t<T>>(value))
 		{
-			while (*dst++ = *src++) {}
 		}
-		else
+	};
+
+	template<>
+	struct Formatter<bool>
+	{
+		explicit Formatter(bool v) noexcept : value(v) {}
+
+		[[nodiscard]] uint32_t size() const noexcept { return value ? 4 : 5; }
+
+		char* write(char* out) const noexcept
 		{
-			strcpy(dst, src);
+			memcpy(out, value ? "true" : "false", size());
+			return out + size();
 		}
-	}
 
-	constexpr void zeroMemory_fmtinternal(char* ptr, size_t n)
+		bool value;
+	};
+
+	template<>
+	struct Formatter<char>
 	{
-		if (is_constant_evaluated())
+		explicit Formatter(char c) noexcept : value(c) {}
+
+		[[nodiscard]] uint32_t size() const noexcept { return 1; }
+
+		char* write(char* out) const noexcept
 		{
-			for (size_t i = 0; i < n; i++)
-			{
-				ptr[i] = 0;
-			}
+			*out = value;
+			return out + 1;
 		}
-		else
+
+		char value;
+	};
+
+	template<>
+	struct Formatter<StringView>
+	{
+		Formatter() noexcept = default;
+		explicit Formatter(StringView str) noexcept : value(str) {}
+
+		[[nodiscard]] uint32_t size() const noexcept { return (uint32_t)value.size(); }
+
+		char* write(char* out) const noexcept
 		{
-			memset(ptr, 0, n);
+			memcpy(out, value.data(), value.size());
+			return out + value.size();
 		}
-	}
 
-	template <typename T>
-	WOB_FMT_CONSTEXPR_OR_INLINE void stringifyToBuff(T v, char* buff)
-	{
-		// TODO we shouldn't define this one to trigger link time error when using non supported format
-		// rn format is still wip so we keep this to allow compilation
-	}
-	
-	template <>
-	constexpr void stringifyToBuff(int64_t v, char* buff) 
-	{
-		itoa(v, buff); 
-	}
+		StringView value;
+	};
 
-	template <>
-	constexpr void stringifyToBuff(uint64_t v, char* buff) 
+	// nullptr formats as an empty string
+	template<>
+	struct Formatter<const char*> : Formatter<StringView>
 	{
-		itoa(v, buff); 
-	}
+		explicit Formatter(const char* str) noexcept
+			: Formatter<StringView>(str ? StringView(str) : StringView("", 0))
+		{
+		}
+	};
 
-	template <>
-	constexpr void stringifyToBuff(int32_t v, char* buff)
+	template<>
+	struct Formatter<String> : Formatter<StringView>
 	{
-		itoa(v, buff);
-	}
+		explicit Formatter(String const& str) noexcept : Formatter<StringView>(StringView(str.data(), str.size())) {}
+	};
 
-	template <>
-	constexpr void stringifyToBuff(uint32_t v, char* buff)
+	// floats are printed once in a local buffer to know their size, shortest form that reads back to the same value
+	template<>
+	struct Formatter<float> : Formatter<StringView>
 	{
-		itoa(v, buff);
-	}
+		explicit Formatter(float v) noexcept : Formatter<StringView>()
+		{
+			value = StringView(buffer, floatToChars(buffer, v));
+		}
 
-	template <>
-	WOB_FMT_CONSTEXPR_OR_INLINE void stringifyToBuff(float v, char* buff)
-	{
-		d4::PrintFloat32(buff, 64, v, d4::tPrintFloatFormat::PrintFloatFormat_Positional, -1);
-	}
+		Formatter(Formatter const&) = delete;
 
-	template <>
-	WOB_FMT_CONSTEXPR_OR_INLINE void stringifyToBuff(double v, char* buff)
-	{
-		d4::PrintFloat64(buff, 64, v, d4::tPrintFloatFormat::PrintFloatFormat_Positional, -1);
-	}
+		char buffer[floatCharsMax];
+	};
 
-	template <>
-	constexpr void stringifyToBuff(bool v, char* buff)
+	template<>
+	struct Formatter<double> : Formatter<StringView>
 	{
-		strcpy_fmtinternal(buff, v ? "true" : "false");
-	}
+		explicit Formatter(double v) noexcept : Formatter<StringView>()
+		{
+			value = StringView(buffer, floatToChars(buffer, v));
+		}
 
-	template <>
-	constexpr void stringifyToBuff(const char* v, char* buff)
-	{
-		if (v == nullptr)
-			return;
-		strcpy_fmtinternal(buff, v);
-	}
+		Formatter(Formatter const&) = delete;
 
-	template <>
-	constexpr void stringifyToBuff(char* v, char* buff)
-	{
-		if (v == nullptr)
-			return;
-		strcpy_fmtinternal(buff, v);
-	}
+		char buffer[floatCharsMax];
+	};
 
-	template <typename T>
-	WOB_FMT_CONSTEXPR_OR_INLINE uint32_t charsNeededForT(T v)
+	// char arrays and pointers to mutable chars are formatted as C strings
+	template<typename T>
+	struct FormatType
 	{
-		return 0;
-	}
+		using type = T;
+	};
 
-	template <>
-	constexpr uint32_t charsNeededForT(int32_t v)
+	template<>
+	struct FormatType<char*>
 	{
-		return numDigits(v);
-	}
+		using type = const char*;
+	};
 
-	template <>
-	constexpr uint32_t charsNeededForT(uint32_t v)
+	template<size_t N>
+	struct FormatType<char[N]>
 	{
-		return numDigits(v);
-	}
+		using type = const char*;
+	};
 
-	template <>
-	constexpr uint32_t charsNeededForT(float v)
+	template<size_t N>
+	struct FormatType<const char[N]>
 	{
-		return 32;
-	}
+		using type = const char*;
+	};
 
-	template <>
-	constexpr uint32_t charsNeededForT(double v)
-	{
-		return 32;
-	}
+	template<typename T>
+	using FormatType_t = typename FormatType<wob::remove_cvref_t<T>>::type;
 
-	template <>
-	constexpr uint32_t charsNeededForT(int64_t v)
-	{
-		return numDigits(v);
-	}
+	// never defined, calling it during constant evaluation turn a bad format string into a compile error
+	void formatStringError(const char* message);
 
-	template <>
-	constexpr uint32_t charsNeededForT(uint64_t v)
+	template<typename ...Args>
+	struct FormatString
 	{
-		return numDigits(v);
-	}
+		static constexpr uint32_t argCount = sizeof...(Args);
+
+		template<size_t N>
+		consteval FormatString(const char (&fmt)[N]) noexcept
+			: str(fmt), size(N - 1), literalSize(0), hasEscapes(false), placeholders{}
+		{
+			uint32_t count = 0;
+			for (uint32_t i = 0; i < size; i++)
+			{
+				if (fmt[i] == '{')
+				{
+					if (i + 1 < size && fmt[i + 1] == '{')
+					{
+						hasEscapes = true;
+						literalSize++;
+						i++;
+					}
+					else if (i + 1 < size && fmt[i + 1] == '}')
+					{
+						if (count == argCount)
+							formatStringError("wob::format : more {} than arguments");
+						placeholders[count++] = i;
+						i++;
+					}
+					else
+					{
+						formatStringError("wob::format : '{' must be followed by '}' or escaped as '{{'");
+					}
+				}
+				else if (fmt[i] == '}')
+				{
+					if (i + 1 < size && fmt[i + 1] == '}')
+					{
+						hasEscapes = true;
+						literalSize++;
+						i++;
+					}
+					else
+					{
+						formatStringError("wob::format : unmatched '}', escape it as '}}'");
+					}
+				}
+				else
+				{
+					literalSize++;
+				}
+			}
 
-	template <>
-	constexpr uint32_t charsNeededForT(bool v)
+			if (count != argCount)
+				formatStringError("wob::format : less {} than arguments");
+			placeholders[argCount] = size;
+		}
+
+		const char* str;
+		uint32_t size;
+		// output size of the format string alone, escaped braces count for one
+		uint32_t literalSize;
+		bool hasEscapes;
+		// offset of every "{}", the last entry is the string size
+		uint32_t placeholders[argCount + 1];
+	};
+
+	// copy fmt[begin, end[ to out, folding "{{" and "}}"
+	inline char* writeFormatLiteral(char* out, const char* fmt, uint32_t begin, uint32_t end, bool hasEscapes) noexcept
 	{
-		return v ? 4 /*true*/ : 5 /*false*/;
+		if (!hasEscapes)
+		{
+			memcpy(out, fmt + begin, end - begin);
+			return out + (end - begin);
+		}
+
+		for (uint32_t i = begin; i < end; i++)
+		{
+			*out++ = fmt[i];
+			if (fmt[i] == '{' || fmt[i] == '}')
+				i++;
+		}
+		return out;
 	}
 
-	template <>
-	constexpr uint32_t charsNeededForT(const char* v)
+	// out must hold at least formattedSize chars
+	template<typename ...Args>
+	inline char* writeFormatted(char* out, FormatString<Args...> const& fmt, Formatter<FormatType_t<Args>> const&... formatters) noexcept
 	{
-		if (v == nullptr)
-			return 0;
-		return strlen(v);
+		uint32_t literalBegin = 0;
+		uint32_t placeholder = 0;
+		((out = writeFormatLiteral(out, fmt.str, literalBegin, fmt.placeholders[placeholder], fmt.hasEscapes),
+			out = formatters.write(out),
+			literalBegin = fmt.placeholders[placeholder++] + 2), ...);
+		return writeFormatLiteral(out, fmt.str, literalBegin, fmt.size, fmt.hasEscapes);
 	}
 
-	template <>
-	constexpr uint32_t charsNeededForT(char* v)
+	template<typename ...Args>
+	[[nodiscard]] inline uint32_t formattedSizeOf(FormatString<Args...> const& fmt, Formatter<FormatType_t<Args>> const&... formatters) noexcept
 	{
-		if (v == nullptr)
-			return 0;
-		return strlen(v);
+		return (fmt.literalSize + ... + formatters.size());
 	}
 
-	struct FormatedArgs
+	template<typename ...Args>
+	inline uint32_t formatToBuffer(char* buffer, uint32_t bufferSize, FormatString<Args...> const& fmt, Formatter<FormatType_t<Args>> const&... formatters) noexcept
 	{
-		Array<String> args;
-
-		constexpr uint32_t computeSize() const noexcept
+		uint32_t const size = formattedSizeOf(fmt, formatters...);
+		if (size < bufferSize)
 		{
-			uint32_t size = 0;
-			for (auto const& arg : args)
-				size += arg.size();
-			return size;
+			writeFormatted(buffer, fmt, formatters...);
+			buffer[size] = '\0';
 		}
-	};
+		else if (bufferSize > 0)
+		{
+			buffer[0] = '\0';
+		}
+		return size;
+	}
 
-	template<typename T>
-	WOB_FMT_CONSTEXPR_OR_INLINE String formatArg(T arg)
+	template<typename ...Args>
+	inline void formatToBuilder(StringBuilder& out, FormatString<Args...> const& fmt, Formatter<FormatType_t<Args>> const&... formatters) noexcept
 	{
-		char buff[64];
-		zeroMemory_fmtinternal(buff, sizeof(buff));
-		stringifyToBuff(arg, buff);
-		String str(buff);
-		return str;
+		writeFormatted(out.appendNoInit(formattedSizeOf(fmt, formatters...)), fmt, formatters...);
 	}
 
-	template<>
-	WOB_FMT_CONSTEXPR_OR_INLINE String formatArg(char* arg)
+	template<typename ...Args>
+	[[nodiscard]] inline String formatToString(FormatString<Args...> const& fmt, Formatter<FormatType_t<Args>> const&... formatters) noexcept
 	{
-		if (!arg)
-			return String();
 		String str;
-		str.resizeNoInit(charsNeededForT(arg));
-		stringifyToBuff(arg, str.data());
+		str.resizeNoInit(formattedSizeOf(fmt, formatters...));
+		writeFormatted(str.data(), fmt, formatters...);
 		return str;
 	}
 
-	template<>
-	WOB_FMT_CONSTEXPR_OR_INLINE String formatArg(const char* arg)
+	// number of chars format would produce, without the null terminator
+	template<typename ...Args>
+	[[nodiscard]] inline uint32_t formattedSize(FormatString<wob::type_identity_t<Args>...> fmt, Args const&... args) noexcept
 	{
-		String str;
-		str.resizeNoInit(charsNeededForT(arg));
-		stringifyToBuff(arg, str.data());
-		return str;
+		return formattedSizeOf(fmt, Formatter<FormatType_t<Args>>(args)...);
 	}
 
-	String cFormat(const char* fmt, ...) WOB_PRINTF_FORMAT(1, 2)
+	// write the null terminated result in buffer only if it fits entirely, otherwise buffer is left empty
+	// return the formatted size so the caller can retry with a bigger buffer
+	template<typename ...Args>
+	inline uint32_t formatTo(char* buffer, uint32_t bufferSize, FormatString<wob::type_identity_t<Args>...> fmt, Args const&... args) noexcept
 	{
-		char buffer[2048];
-		va_list args;
-		va_start(args, fmt);
-		vsnprintf(buffer, sizeof(buffer), fmt, args);
-		va_end(args);
-		return String(buffer);
+		return formatToBuffer(buffer, bufferSize, fmt, Formatter<FormatType_t<Args>>(args)...);
 	}
 
+	// append the formatted string to out
 	template<typename ...Args>
-	WOB_FMT_CONSTEXPR_OR_INLINE String format(StringView fmt, Args&&... args) 
+	inline void formatTo(StringBuilder& out, FormatString<wob::type_identity_t<Args>...> fmt, Args const&... args) noexcept
 	{
-		// maybe use static array here to avoid alloc ?
-		FormatedArgs formatedArgs;
-		formatedArgs.args.reserve(sizeof...(args));
-	
-		// format each arg in parameter pack
-		(..., formatedArgs.args.push(formatArg(wob::forward<Args>(args))));
-
-		String str;
-		bool isInfmt = false;
-		int nformatedArg = 0;
-		uint32_t totalSize = 0;
-		int argIndex = 0;
-
-		for (int i = 0; i < fmt.size(); i++)
-		{
-			if (fmt[i] == '{')
-			{
-				isInfmt = true;
-				continue;
-			}
-
-			if (isInfmt)
-			{
-				if (fmt[i] == '}')
-					isInfmt = false;
-				// TODO parse fmt
-
-				// TODO true error handling
-				WOB_ASSERT_NOLOG(nformatedArg < formatedArgs.args.size());
-				str.append(formatedArgs.args[nformatedArg++]);
-			}
-			else
-			{
-				str.append(fmt[i]);
-			}
-		}
+		formatToBuilder(out, fmt, Formatter<FormatType_t<Args>>(args)...);
+	}
 
-		return str;
+	// single allocation of the exact size, none if the result fits in String inline storage
+	template<typename ...Args>
+	[[nodiscard]] inline String format(FormatString<wob::type_identity_t<Args>...> fmt, Args const&... args) noexcept
+	{
+		return formatToString(fmt, Formatter<FormatType_t<Args>>(args)...);
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
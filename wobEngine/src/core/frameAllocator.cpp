@@ -0,0 +1,104 @@
+#include "frameAllocator.hpp"
+#include "wob.hpp"
+#include "utility.hpp"
+
+using namespace wob;
+
+FrameAllocator::FrameAllocator(IAllocator& base, size_t arenaSize, uint32_t count) noexcept
+	: baseAllocator(&base), arenaCount(count), current(0), size(arenaSize), lastFrameUsed(0), peakUsed(0), overflowFrames(0)
+{
+	WOB_ASSERT(count > 0 && count <= maxArenaCount);
+	for (uint32_t i = 0; i < arenaCount; i++)
+		arenas[i] = Arena{ static_cast<uint8_t*>(base.allocate(arenaSize, 16)), 0, noAllocation, nullptr, 0 };
+}
+
+FrameAllocator::~FrameAllocator()
+{
+	for (uint32_t i = 0; i < arenaCount; i++)
+	{
+		release(arenas[i]);
+		baseAllocator->deallocate(arenas[i].start);
+	}
+}
+
+void* FrameAllocator::allocate(size_t allocSize, size_t align)
+{
+	WOB_ASSERT_NOLOG(isPowerOf2(align));
+	Arena& arena = arenas[current];
+	// align the address, the arena itself is only 16 bytes aligned
+	size_t const alignedOffset = wob::align((uintptr_t)arena.start + arena.offset, align) - (uintptr_t)arena.start;
+	if (alignedOffset + allocSize > size)
+		return allocateOverflow(allocSize, align);
+
+	arena.offset = alignedOffset + allocSize;
+	arena.lastOffset = alignedOffset;
+	return arena.start + alignedOffset;
+}
+
+void FrameAllocator::deallocate(void* ptr)
+{
+	WOB_UNUSED(ptr);
+}
+
+bool FrameAllocator::tryExpandInPlace(void* ptr, size_t newSize)
+{
+	Arena& arena = arenas[current];
+	if (arena.lastOffset == noAllocation || ptr != arena.start + arena.lastOffset || arena.lastOffset + newSize > size)
+		return false;
+
+	arena.offset = arena.lastOffset + newSize;
+	return true;
+}
+
+// the block header is padded to the requested alignment
+void* FrameAllocator::allocateOverflow(size_t allocSize, size_t align) noexcept
+{
+	size_t const blockAlign = max(align, alignof(OverflowBlock));
+	size_t const header = wob::align(sizeof(OverflowBlock), blockAlign);
+	uint8_t* const block = static_cast<uint8_t*>(baseAllocator->allocate(header + allocSize, blockAlign));
+	if (!block)
+		return nullptr;
+
+	Arena& arena = arenas[current];
+	OverflowBlock* const overflow = reinterpret_cast<OverflowBlock*>(block);
+	overflow->next = arena.overflow;
+	arena.overflow = overflow;
+	arena.overflowSize += allocSize;
+	return block + header;
+}
+
+void FrameAllocator::release(Arena& arena) noexcept
+{
+	OverflowBlock* block = arena.overflow;
+	while (block)
+	{
+		OverflowBlock* const next = block->next;
+		baseAllocator->deallocate(block);
+		block = next;
+	}
+	arena.offset = 0;
+	arena.lastOffset = noAllocation;
+	arena.overflow = nullptr;
+	arena.overflowSize = 0;
+}
+
+void FrameAllocator::beginFrame() noexcept
+{
+	lastFrameUsed = frameUsage();
+	peakUsed = max(peakUsed, lastFrameUsed);
+	if (arenas[current].overflow)
+		overflowFrames++;
+
+	current = (current + 1) % arenaCount;
+	release(arenas[current]);
+}
+
+size_t FrameAllocator::frameUsage() const noexcept
+{
+	return arenas[current].offset + arenas[current].overflowSize;
+}
+
+size_t FrameAllocator::highWaterMark() const noexcept
+{
+	return max(peakUsed, frameUsage());
+}
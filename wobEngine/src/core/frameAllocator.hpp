@@ -0,0 +1,103 @@
+#ifndef WOB_FRAME_ALLOCATOR_HPP
+#define WOB_FRAME_ALLOCATOR_HPP
+
+#include "allocator.hpp"
+#include "context.hpp"
+
+namespace wob
+{
+	/*
+	 * Linear allocator for transient memory, rotating between arenaCount arenas, one per frame.
+	 * beginFrame switches to the next arena and resets it, so memory allocated during a frame stays valid
+	 * for the arenaCount - 1 following frames (double buffered by default).
+	 * deallocate is a no-op, only the last allocation can be resized in place.
+	 * When an arena is full allocations fall back to the base allocator and are released with the arena,
+	 * the overflow is part of the frame usage so highWaterMark gives the arena size needed.
+	 * Not thread safe, each thread needs its own instance (see context.frameAllocator).
+	 */
+	class FrameAllocator final : public IAllocator
+	{
+	public:
+		static constexpr uint32_t maxArenaCount = 4;
+
+		FrameAllocator(IAllocator& base, size_t arenaSize, uint32_t arenaCount = 2) noexcept;
+		~FrameAllocator() override;
+
+		FrameAllocator(FrameAllocator const&) = delete;
+		FrameAllocator& operator=(FrameAllocator const&) = delete;
+
+		[[nodiscard]] void* allocate(size_t size, size_t align) override;
+		void deallocate(void* ptr) override;
+		[[nodiscard]] bool tryExpandInPlace(void* ptr, size_t newSize) override;
+
+		// frame boundary, release the memory allocated arenaCount frames ago
+		void beginFrame() noexcept;
+
+		// bytes used by the current frame, alignment padding and overflow included
+		[[nodiscard]] size_t frameUsage() const noexcept;
+		[[nodiscard]] size_t lastFrameUsage() const noexcept { return lastFrameUsed; }
+		// peak frame usage since construction
+		[[nodiscard]] size_t highWaterMark() const noexcept;
+		// number of frames that didn't fit in their arena
+		[[nodiscard]] uint64_t overflowFrameCount() const noexcept { return overflowFrames; }
+		[[nodiscard]] size_t arenaSize() const noexcept { return size; }
+
+	private:
+		struct OverflowBlock
+		{
+			OverflowBlock* next;
+		};
+
+		struct Arena
+		{
+			uint8_t* start;
+			size_t offset;
+			// offset of the last allocation
+			size_t lastOffset;
+			OverflowBlock* overflow;
+			size_t overflowSize;
+		};
+
+		static constexpr size_t noAllocation = ~(size_t)0;
+
+		void* allocateOverflow(size_t size, size_t align) noexcept;
+		void release(Arena& arena) noexcept;
+
+		IAllocator* baseAllocator;
+		Arena arenas[maxArenaCount];
+		uint32_t arenaCount;
+		uint32_t current;
+		size_t size;
+		size_t lastFrameUsed;
+		size_t peakUsed;
+		uint64_t overflowFrames;
+	};
+
+	/*
+	 * Make the context allocator the thread frame allocator for the scope,
+	 * Array, String or format temporaries created inside bump allocate and are released at a later frame boundary.
+	 * They must not outlive the frame allocator arena rotation.
+	 */
+	class FrameAllocatorScope
+	{
+	public:
+		FrameAllocatorScope() noexcept : previous(context.allocator)
+		{
+			WOB_ASSERT_NOLOG(context.frameAllocator != nullptr);
+			context.allocator = context.frameAllocator;
+		}
+
+		~FrameAllocatorScope() noexcept
+		{
+			context.allocator = previous;
+		}
+
+		FrameAllocatorScope(FrameAllocatorScope const&) = delete;
+		FrameAllocatorScope& operator=(FrameAllocatorScope const&) = delete;
+
+	private:
+		IAllocator* previous;
+	};
+}
+
+#endif
@@ -2,6 +2,12 @@
 #define WOB_HASH_HPP
 
 #include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 namespace wob
 {
@@ -59,38 +65,126 @@ namespace wob
 		}
 	};
 
+	// wyhash final4, https://github.com/wangyi-fudan/wyhash (public domain)
+	namespace wyhash
+	{
+		constexpr uint64_t secret[4] = { 0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull, 0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull };
+
+		// 64x64 -> 128 multiply, a receive the low part and b the high part
+		inline void mum(uint64_t* a, uint64_t* b) noexcept
+		{
+#if defined(__SIZEOF_INT128__)
+			__uint128_t r = *a;
+			r *= *b;
+			*a = (uint64_t)r;
+			*b = (uint64_t)(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			*a = _umul128(*a, *b, b);
+#else
+			uint64_t const ha = *a >> 32, hb = *b >> 32, la = (uint32_t)*a, lb = (uint32_t)*b;
+			uint64_t const rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+			uint64_t const t = rl + (rm0 << 32);
+			uint64_t c = t < rl;
+			uint64_t const lo = t + (rm1 << 32);
+			c += lo < t;
+			*a = lo;
+			*b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+		}
+
+		inline uint64_t mix(uint64_t a, uint64_t b) noexcept
+		{
+			mum(&a, &b);
+			return a ^ b;
+		}
+
+		inline uint64_t read8(uint8_t const* p) noexcept
+		{
+			uint64_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		inline uint64_t read4(uint8_t const* p) noexcept
+		{
+			uint32_t v;
+			memcpy(&v, p, sizeof(v));
+			return v;
+		}
+
+		inline uint64_t read3(uint8_t const* p, size_t k) noexcept
+		{
+			return (((uint64_t)p[0]) << 16) | (((uint64_t)p[k >> 1]) << 8) | p[k - 1];
+		}
+	}
+
+	// fast 64 bits hash of a byte sequence
+	inline uint64_t hashBytes(void const* data, size_t len, uint64_t seed = 0) noexcept
+	{
+		using namespace wyhash;
+		uint8_t const* p = static_cast<uint8_t const*>(data);
+		seed ^= mix(seed ^ secret[0], secret[1]);
+		uint64_t a, b;
+		if (len <= 16)
+		{
+			if (len >= 4)
+			{
+				a = (read4(p) << 32) | read4(p + ((len >> 3) << 2));
+				b = (read4(p + len - 4) << 32) | read4(p + len - 4 - ((len >> 3) << 2));
+			}
+			else if (len > 0)
+			{
+				a = read3(p, len);
+				b = 0;
+			}
+			else
+			{
+				a = b = 0;
+			}
+		}
+		else
+		{
+			size_t i = len;
+			if (i >= 48)
+			{
+				uint64_t see1 = seed, see2 = seed;
+				do
+				{
+					seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+					see1 = mix(read8(p + 16) ^ secret[2], read8(p + 24) ^ see1);
+					see2 = mix(read8(p + 32) ^ secret[3], read8(p + 40) ^ see2);
+					p += 48;
+					i -= 48;
+				} while (i >= 48);
+				seed ^= see1 ^ see2;
+			}
+			while (i > 16)
+			{
+				seed = mix(read8(p) ^ secret[1], read8(p + 8) ^ seed);
+				i -= 16;
+				p += 16;
+			}
+			a = read8(p + i - 16);
+			b = read8(p + i - 8);
+		}
+		a ^= secret[1];
+		b ^= seed;
+		mum(&a, &b);
+		return mix(a ^ secret[0] ^ len, b ^ secret[1]);
+	}
+
+	// hash the pointed string content, note that const char* keys are still compared by address
 	template<>
 	struct Hash<const char*>
 	{
-		// https://stackoverflow.com/a/8317622
-		constexpr uint64_t operator()(const char* str)
+		uint64_t operator()(const char* str)
 		{
-			constexpr uint64_t A = 54059; /* a prime */
-			constexpr uint64_t B = 76963; /* another prime */
-			//constexpr uint64_t C = 86969; /* yet 1another prime */
-			constexpr uint64_t FIRSTH = 37; /* also prime */
-			unsigned h = FIRSTH;
-			auto* s = str;
-			while (*s) {
-				h = (h * A) ^ (s[0] * B);
-				s++;
-			}
-			return h; // or return h % C;
+			return hashBytes(str, strlen(str));
 		}
 
-		constexpr uint64_t operator()(const char* str, const char* end)
+		uint64_t operator()(const char* str, const char* end)
 		{
-			constexpr uint64_t A = 54059; /* a prime */
-			constexpr uint64_t B = 76963; /* another prime */
-			//constexpr uint64_t C = 86969; /* yet 1another prime */
-			constexpr uint64_t FIRSTH = 37; /* also prime */
-			unsigned h = FIRSTH;
-			auto* s = str;
-			while (*s && s != end) {
-				h = (h * A) ^ (s[0] * B);
-				s++;
-			}
-			return h; // or return h % C;
+			return hashBytes(str, end - str);
 		}
 	};
 }
@@ -1,15 +1,34 @@
 #ifndef WOB_HASHMAP_HPP
 #define WOB_HASHMAP_HPP
 
+#include <string.h>
+
 #include "wob.hpp"
 #include "context.hpp"
-#include "array.hpp"
+#include "allocator.hpp"
+#include "maths.hpp"
 #include "hash.hpp"
 #include "pair.hpp"
-#include "slist.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define WOB_HASHMAP_SSE2
+	#include <emmintrin.h>
+#endif
 
 namespace wob
 {
+	/*
+	 * Open addressing hash map, SwissTable style.
+	 * Slots are stored in a flat array alongside one control byte per slot,
+	 * a control byte is either empty, deleted (tombstone) or the 7 low bits of the hash of the slot key.
+	 * Lookups probe whole groups of control bytes at once (16 with SSE2, 8 with the portable SWAR path)
+	 * and only compare keys whose control byte matches.
+	 * ref: https://abseil.io/about/design/swisstables
+	 *
+	 * If Hash_t declares `using is_transparent = void;` lookups also accept any type the hasher and K equality accept
+	 * (eg: StringView or literals for String keys) so that no temporary key is built.
+	 * Hot paths can compute the hash of a key once with computeHash and pass it to the lookup functions.
+	 */
 	template<typename K, typename V, typename H = Hash<K>>
 	class HashMap
 	{
@@ -17,71 +36,187 @@ namespace wob
 		using Key_t = K;
 		using Value_t = V;
 		using Hash_t = H;
-		using Bucket_t = SList<Pair<K, V>>;
+		using Entry_t = Pair<K, V>;
 
-		static constexpr float defaultMaxLoadFactor = 0.75;
+		// 7/8, see maxLoad
+		static constexpr float defaultMaxLoadFactor = 0.875f;
 
-		struct Iterator
+		template<typename KK>
+		static constexpr bool isTransparentKey = !wob::same_as<wob::remove_cvref_t<KK>, K> && requires { typename Hash_t::is_transparent; };
+
+		template<typename KK>
+		static constexpr bool isLookupKey = wob::same_as<wob::remove_cvref_t<KK>, K> || isTransparentKey<KK>;
+
+	private:
+
+		using Ctrl_t = int8_t;
+		static constexpr Ctrl_t ctrlEmpty = -128;  // 0b10000000
+		static constexpr Ctrl_t ctrlDeleted = -2;  // 0b11111110
+		static constexpr uint32_t npos = ~0u;
+
+		static constexpr bool isFull(Ctrl_t c) noexcept { return c >= 0; }
+
+#ifdef WOB_HASHMAP_SSE2
+		struct Group
 		{
-			Pair<K, V>& operator*() const noexcept
+			static constexpr uint32_t width = 16;
+			// matched bit index -> slot index in group
+			static constexpr int shift = 0;
+
+			explicit Group(Ctrl_t const* pos) noexcept : ctrl(_mm_loadu_si128(reinterpret_cast<__m128i const*>(pos))) {}
+
+			uint64_t match(Ctrl_t h2) const noexcept
 			{
-				return *currentBucketIt;
+				return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl));
 			}
 
-			Iterator& operator++() noexcept
+			uint64_t matchEmpty() const noexcept
 			{
-				++currentBucketIt;
+				return (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(ctrlEmpty), ctrl));
+			}
 
-				// If we finished the current bucket, advance to the next
-				if (currentBucketIt == BucketArrayIt->end())
-				{
-					advanceToNextNonEmptyBucket();
-				}
+			// empty and deleted are the only states with the sign bit set
+			uint64_t matchEmptyOrDeleted() const noexcept
+			{
+				return (uint32_t)_mm_movemask_epi8(ctrl);
+			}
 
-				return *this;
+			__m128i ctrl;
+		};
+#else
+		// portable path (vita), process 8 control bytes packed in a word
+		struct Group
+		{
+			static constexpr uint32_t width = 8;
+			static constexpr int shift = 3;
+			static constexpr uint64_t lsbs = 0x0101010101010101ull;
+			static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+			explicit Group(Ctrl_t const* pos) noexcept { memcpy(&ctrl, pos, sizeof(ctrl)); }
+
+			// may return false positives on full slots, this is fine since keys are compared afterward
+			uint64_t match(Ctrl_t h2) const noexcept
+			{
+				uint64_t const x = ctrl ^ (lsbs * (uint8_t)h2);
+				return (x - lsbs) & ~x & msbs;
 			}
 
-			bool operator==(Iterator const&) const noexcept = default;
+			uint64_t matchEmpty() const noexcept
+			{
+				return (ctrl & ~(ctrl << 6)) & msbs;
+			}
 
-			void advanceToNextNonEmptyBucket() noexcept
+			uint64_t matchEmptyOrDeleted() const noexcept
 			{
-				++BucketArrayIt;
+				return ctrl & msbs;
+			}
 
-				// Skip empty buckets
-				while (BucketArrayIt != map->buckets.end() && BucketArrayIt->isEmpty())
-				{
-					++BucketArrayIt;
-				}
+			uint64_t ctrl;
+		};
+#endif
 
-				// Set position in new bucket (or end if we reached the end)
-				if (BucketArrayIt != map->buckets.end())
-				{
-					currentBucketIt = BucketArrayIt->begin();
-				}
-				else
-				{
-					currentBucketIt = typename Bucket_t::Iterator{ nullptr };
-				}
+	public:
+
+		struct Iterator
+		{
+			Entry_t& operator*() const noexcept
+			{
+				WOB_BOUNDS_CHECK(index < map->capacity_);
+				return map->slots[index];
+			}
+
+			Entry_t* operator->() const noexcept
+			{
+				return &**this;
+			}
+
+			Iterator& operator++() noexcept
+			{
+				++index;
+				skipEmptySlots();
+				return *this;
 			}
+
+			bool operator==(Iterator const&) const noexcept = default;
+
+			void skipEmptySlots() noexcept
+			{
+				while (index < map->capacity_ && !isFull(map->ctrl[index]))
+					++index;
+			}
+
 			HashMap* map;
-			Array<Bucket_t>::Iterator_t BucketArrayIt;
-			Bucket_t::Iterator currentBucketIt;
+			uint32_t index;
 		};
 
-		constexpr HashMap(uint32_t nBuckets = 16) : allocator(context.allocator), size_(0)
+		constexpr HashMap(uint32_t initialCapacity = 16) : allocator(context.allocator)
 		{
-			buckets.resize(nBuckets);
+			if (initialCapacity > 0)
+				rehash(initialCapacity);
 		}
 
-		constexpr HashMap(IAllocator* alloc, uint32_t nBuckets) : allocator(alloc), size_(0)
+		constexpr HashMap(IAllocator* alloc, uint32_t initialCapacity) : allocator(alloc)
 		{
-			buckets.resize(nBuckets);
+			if (initialCapacity > 0)
+				rehash(initialCapacity);
 		}
 
+		constexpr HashMap(HashMap const& rhs) : allocator(rhs.allocator)
+		{
+			copyFrom(rhs);
+		}
+
+		constexpr HashMap(HashMap&& rhs) noexcept
+		{
+			*this = wob::move(rhs);
+		}
+
+		constexpr HashMap& operator=(HashMap const& rhs)
+		{
+			if (this != &rhs)
+			{
+				clear();
+				copyFrom(rhs);
+			}
+			return *this;
+		}
+
+		constexpr HashMap& operator=(HashMap&& rhs) noexcept
+		{
+			if (this == &rhs)
+				return *this;
+
+			release();
+			allocator = rhs.allocator;
+			ctrl = rhs.ctrl;
+			slots = rhs.slots;
+			capacity_ = rhs.capacity_;
+			size_ = rhs.size_;
+			growthLeft = rhs.growthLeft;
+
+			rhs.ctrl = nullptr;
+			rhs.slots = nullptr;
+			rhs.capacity_ = 0;
+			rhs.size_ = 0;
+			rhs.growthLeft = 0;
+			return *this;
+		}
+
+		constexpr ~HashMap()
+		{
+			release();
+		}
+
+		// destroy all elements, keep the allocated slots
 		constexpr void clear()
 		{
-			buckets.clear();
+			if (capacity_ == 0)
+				return;
+
+			destroySlots();
+			memset(ctrl, (uint8_t)ctrlEmpty, capacity_);
 			size_ = 0;
+			growthLeft = maxLoad(capacity_);
 		}
 
 		constexpr uint32_t size() const noexcept
@@ -89,160 +224,429 @@ namespace wob
 			return size_;
 		}
 
+		constexpr uint32_t capacity() const noexcept
+		{
+			return capacity_;
+		}
+
+		constexpr bool empty() const noexcept
+		{
+			return size_ == 0;
+		}
+
 		constexpr float getLoadFactor() const noexcept
 		{
-			return (float)size_ / buckets.size();
+			return capacity_ == 0 ? 0.0f : (float)size_ / capacity_;
 		}
 
-		constexpr void rehash(uint32_t newBucketCount)
+		// newCapacity is rounded up to a power of 2 large enough to hold the current elements
+		constexpr void rehash(uint32_t newCapacity)
 		{
-			Array<Bucket_t> newBuckets;
-			newBuckets.resize(newBucketCount);
-			for (auto& [k, v] : *this)
-			{
-				add(newBuckets, wob::move(k), wob::move(v));
-			}
-			buckets = wob::move(newBuckets);
+			uint32_t const minCapacity = capacityForSize(size_);
+			uint32_t cap = Group::width;
+			while (cap < newCapacity || cap < minCapacity)
+				cap *= 2;
+			resizeSlots(cap);
 		}
 
 		constexpr void rehash()
 		{
-			rehash(buckets.size() * 2);
+			rehash(capacity_ * 2);
+		}
+
+		// ensure that n elements can be added without rehashing
+		constexpr void reserve(uint32_t n)
+		{
+			if (n > size_ + growthLeft)
+				rehash(capacityForSize(n));
 		}
 
+		// add or replace value associated with key
 		constexpr void add(K const& key, V const& value) requires wob::copy_constructible<V> && wob::copy_constructible<K>
 		{
-			add(buckets, key, value);
-			size_++;
-			rehashIfNecessary();
+			insert(key, value);
 		}
 
 		constexpr void add(K&& key, V&& value)
 		{
-			add(buckets, wob::forward<K>(key), wob::forward<V>(value));
-			size_++;
-			rehashIfNecessary();
+			insert(wob::move(key), wob::move(value));
 		}
 
 		constexpr void remove(K const& key)
 		{
-			auto const hash = Hash_t{}(key);
-			uint32_t const index = hash % buckets.size();
-
-			buckets[index].removeFirst([key](auto const& node) {
-				return node->data.first == key;
-				});
-			size_--;
+			removeIndex(findIndex(key, computeHash(key)));
 		}
 
 		bool tryFind(K const& key, V& value) const requires wob::copy_constructible<V>&& wob::copy_constructible<K>
 		{
-			Bucket_t bucket;
-			auto const result = getKeyItAndBucketIndex(key);
+			uint32_t const index = findIndex(key, computeHash(key));
+			if (index == npos)
+				return false;
 
-			if (result.it != buckets[result.bucketIndex].end())
-			{
-				value = (*result.it).second;
-				return true;
-			}
+			value = slots[index].second;
+			return true;
+		}
+
+		// return nullptr if key is not present
+		constexpr V* find(K const& key) noexcept
+		{
+			uint32_t const index = findIndex(key, computeHash(key));
+			return index == npos ? nullptr : &slots[index].second;
+		}
 
-			return false;
+		constexpr V const* find(K const& key) const noexcept
+		{
+			uint32_t const index = findIndex(key, computeHash(key));
+			return index == npos ? nullptr : &slots[index].second;
 		}
 
 		constexpr bool exist(K const& key) const
 		{
-			auto const result = getKeyItAndBucketIndex(key);
-			return result.it != buckets[result.bucketIndex].end();
+			return findIndex(key, computeHash(key)) != npos;
 		}
 
 		constexpr V& operator[](K const& key)
 		{
-			Bucket_t bucket;
-			auto const result = getKeyItAndBucketIndex(key);
-			if (result.it != buckets[result.bucketIndex].end())
-			{
-				return (*result.it).second;
-			}
+			if (V* v = find(key))
+				return *v;
 
 			WOB_FATAL_ERROR("Key not present in map");
 		}
 
 		constexpr V const& operator[](K const& key) const
 		{
-			return (*this)[key];
+			if (V const* v = find(key))
+				return *v;
+
+			WOB_FATAL_ERROR("Key not present in map");
 		}
 
-		constexpr Iterator begin()
+		// heterogeneous lookups, only available with a transparent Hash_t
+
+		template<typename KK> requires isTransparentKey<KK>
+		constexpr V* find(KK const& key) noexcept
+		{
+			return find(key, computeHash(key));
+		}
+
+		template<typename KK> requires isTransparentKey<KK>
+		constexpr V const* find(KK const& key) const noexcept
+		{
+			return find(key, computeHash(key));
+		}
+
+		template<typename KK> requires isTransparentKey<KK>
+		constexpr bool exist(KK const& key) const
+		{
+			return findIndex(key, computeHash(key)) != npos;
+		}
+
+		template<typename KK> requires isTransparentKey<KK>
+		bool tryFind(KK const& key, V& value) const requires wob::copy_constructible<V>
+		{
+			return tryFind(key, computeHash(key), value);
+		}
+
+		template<typename KK> requires isTransparentKey<KK>
+		constexpr V& operator[](KK const& key)
 		{
-			uint32_t const idx = getNextNonEmptyBucketIndex(0);
-			if (idx == buckets.size())
-				return end();
+			if (V* v = find(key))
+				return *v;
 
-			return Iterator{ this, buckets.begin() + idx, buckets[idx].begin()};
+			WOB_FATAL_ERROR("Key not present in map");
+		}
+
+		template<typename KK> requires isTransparentKey<KK>
+		constexpr void remove(KK const& key)
+		{
+			removeIndex(findIndex(key, computeHash(key)));
+		}
+
+		// precomputed hash lookups, hash must come from computeHash
+
+		template<typename KK> requires isLookupKey<KK>
+		static constexpr uint64_t computeHash(KK const& key)
+		{
+			uint64_t h = Hash_t{}(key);
+			// most Hash specializations only produce 32 bits, spread them across the whole word
+			h ^= h >> 32;
+			h *= 0x9E3779B97F4A7C15ull;
+			h ^= h >> 32;
+			return h;
+		}
+
+		template<typename KK> requires isLookupKey<KK>
+		constexpr V* find(KK const& key, uint64_t hash) noexcept
+		{
+			uint32_t const index = findIndex(key, hash);
+			return index == npos ? nullptr : &slots[index].second;
+		}
+
+		template<typename KK> requires isLookupKey<KK>
+		constexpr V const* find(KK const& key, uint64_t hash) const noexcept
+		{
+			uint32_t const index = findIndex(key, hash);
+			return index == npos ? nullptr : &slots[index].second;
+		}
+
+		template<typename KK> requires isLookupKey<KK>
+		constexpr bool exist(KK const& key, uint64_t hash) const
+		{
+			return findIndex(key, hash) != npos;
+		}
+
+		template<typename KK> requires isLookupKey<KK>
+		bool tryFind(KK const& key, uint64_t hash, V& value) const requires wob::copy_constructible<V>
+		{
+			uint32_t const index = findIndex(key, hash);
+			if (index == npos)
+				return false;
+
+			value = slots[index].second;
+			return true;
+		}
+
+		constexpr void add(K const& key, V const& value, uint64_t hash) requires wob::copy_constructible<V> && wob::copy_constructible<K>
+		{
+			insert(key, value, hash);
+		}
+
+		constexpr void add(K&& key, V&& value, uint64_t hash)
+		{
+			insert(wob::move(key), wob::move(value), hash);
+		}
+
+		constexpr Iterator begin()
+		{
+			Iterator it{ this, 0 };
+			it.skipEmptySlots();
+			return it;
 		}
 
 		constexpr Iterator end()
 		{
-			return Iterator{ this, buckets.end(), buckets[buckets.size()-1].end() };
+			return Iterator{ this, capacity_ };
 		}
 
 	private:
 
-		static constexpr void add(Array<Bucket_t>& buckets, K&& key, V&& value)
+		static constexpr Ctrl_t h2(uint64_t hash) noexcept
+		{
+			return (Ctrl_t)(hash & 0x7F);
+		}
+
+		static constexpr uint32_t maxLoad(uint32_t cap) noexcept
 		{
-			auto pair = Pair<K, V>{ wob::forward<K>(key), wob::forward<V>(value) };
-			auto const hash = Hash_t{}(pair.first);
-			uint32_t const index = hash % buckets.size();
-			buckets[index].add(wob::move(pair));
+			return cap - cap / 8;
 		}
 
-		static constexpr void add(Array<Bucket_t>& buckets, K const& key, V const& value) requires wob::copy_constructible<V> && wob::copy_constructible<K>
+		static constexpr uint32_t capacityForSize(uint32_t n) noexcept
 		{
-			Pair<K, V> pair{ key, value };
-			auto const hash = Hash_t{}(pair.first);
-			uint32_t const index = hash % buckets.size();
-			buckets[index].add(wob::move(pair));
+			uint32_t cap = Group::width;
+			while (maxLoad(cap) < n)
+				cap *= 2;
+			return cap;
 		}
 
-		constexpr void rehashIfNecessary()
+		template<typename KK>
+		constexpr uint32_t findIndex(KK const& key, uint64_t hash) const
 		{
-			if (getLoadFactor() > defaultMaxLoadFactor)
+			if (capacity_ == 0)
+				return npos;
+
+			uint32_t const groupMask = capacity_ / Group::width - 1;
+			uint32_t group = (uint32_t)(hash >> 7) & groupMask;
+			Ctrl_t const tag = h2(hash);
+
+			// triangular probing over groups visits every group since group count is a power of 2
+			for (uint32_t step = 1; ; step++)
 			{
-				rehash();
+				uint32_t const base = group * Group::width;
+				Group const g(ctrl + base);
+				for (uint64_t m = g.match(tag); m != 0; m &= m - 1)
+				{
+					uint32_t const index = base + (countTrailingZeros(m) >> Group::shift);
+					if (slots[index].first == key)
+						return index;
+				}
+
+				if (g.matchEmpty())
+					return npos;
+
+				group = (group + step) & groupMask;
 			}
 		}
 
-		constexpr uint32_t getNextNonEmptyBucketIndex(uint32_t startIndex) const
+		// first empty or deleted slot in probe sequence
+		constexpr uint32_t findInsertIndex(uint64_t hash) const noexcept
 		{
-			for (uint32_t i = startIndex; i < buckets.size(); i++)
+			uint32_t const groupMask = capacity_ / Group::width - 1;
+			uint32_t group = (uint32_t)(hash >> 7) & groupMask;
+
+			for (uint32_t step = 1; ; step++)
 			{
-				if (!buckets[i].isEmpty())
-					return i;
+				uint32_t const base = group * Group::width;
+				uint64_t const m = Group(ctrl + base).matchEmptyOrDeleted();
+				if (m != 0)
+					return base + (countTrailingZeros(m) >> Group::shift);
+
+				group = (group + step) & groupMask;
 			}
-			return buckets.size();
 		}
 
-		struct KeySearchResult
+		template<typename KK, typename VV>
+		constexpr void insert(KK&& key, VV&& value)
 		{
-			typename Bucket_t::Iterator it;
-			uint32_t bucketIndex;
-		};
+			insert(wob::forward<KK>(key), wob::forward<VV>(value), computeHash(key));
+		}
+
+		template<typename KK, typename VV>
+		constexpr void insert(KK&& key, VV&& value, uint64_t hash)
+		{
+			uint32_t index = findIndex(key, hash);
+			if (index != npos)
+			{
+				slots[index].second = wob::forward<VV>(value);
+				return;
+			}
+
+			if (capacity_ == 0)
+				resizeSlots(Group::width);
+
+			index = findInsertIndex(hash);
+			if (growthLeft == 0 && ctrl[index] != ctrlDeleted)
+			{
+				growForInsert();
+				index = findInsertIndex(hash);
+			}
+
+			if (ctrl[index] == ctrlEmpty)
+				growthLeft--;
 
-		constexpr KeySearchResult getKeyItAndBucketIndex(K const& key) const
+			ctrl[index] = h2(hash);
+			new (&slots[index]) Entry_t{ wob::forward<KK>(key), wob::forward<VV>(value) };
+			size_++;
+		}
+
+		constexpr void removeIndex(uint32_t index)
 		{
-			auto const hash = Hash_t{}(key);
-			uint32_t const index = hash % buckets.size();
+			if (index == npos)
+				return;
+
+			slots[index].~Entry_t();
+			size_--;
+
+			// if the group still has an empty slot, probe sequences already stop there
+			// so we can free the slot instead of leaving a tombstone
+			if (Group(ctrl + (index & ~(Group::width - 1))).matchEmpty())
+			{
+				ctrl[index] = ctrlEmpty;
+				growthLeft++;
+			}
+			else
+			{
+				ctrl[index] = ctrlDeleted;
+			}
+		}
+
+		constexpr void growForInsert()
+		{
+			// mostly tombstones, cleaning them up in place is enough
+			if (size_ < maxLoad(capacity_) / 2)
+				resizeSlots(capacity_);
+			else
+				resizeSlots(capacity_ * 2);
+		}
+
+		// ctrl bytes and slots share a single allocation
+		static constexpr size_t slotsOffset(uint32_t cap) noexcept
+		{
+			return wob::align(cap, alignof(Entry_t));
+		}
+
+		static constexpr size_t blockAlignment() noexcept
+		{
+			return alignof(Entry_t) > 16 ? alignof(Entry_t) : 16;
+		}
 
-			auto const it = buckets[index].findIf([key](auto const& pair) {
-				return pair.first == key;
-				});
-			return {it, index};
+		static constexpr size_t blockSize(uint32_t cap) noexcept
+		{
+			return wob::align(slotsOffset(cap) + (size_t)cap * sizeof(Entry_t), blockAlignment());
+		}
+
+		constexpr void resizeSlots(uint32_t newCapacity)
+		{
+			WOB_ASSERT_NOLOG(isPowerOf2(newCapacity) && newCapacity >= Group::width);
+			WOB_ASSERT_NOLOG(maxLoad(newCapacity) >= size_);
+
+			Ctrl_t* const oldCtrl = ctrl;
+			Entry_t* const oldSlots = slots;
+			uint32_t const oldCapacity = capacity_;
+
+			uint8_t* const block = static_cast<uint8_t*>(allocator->allocate(blockSize(newCapacity), blockAlignment()));
+			ctrl = reinterpret_cast<Ctrl_t*>(block);
+			slots = reinterpret_cast<Entry_t*>(block + slotsOffset(newCapacity));
+			capacity_ = newCapacity;
+			memset(ctrl, (uint8_t)ctrlEmpty, newCapacity);
+
+			for (uint32_t i = 0; i < oldCapacity; i++)
+			{
+				if (!isFull(oldCtrl[i]))
+					continue;
+
+				uint64_t const hash = computeHash(oldSlots[i].first);
+				uint32_t const index = findInsertIndex(hash);
+				ctrl[index] = h2(hash);
+				new (&slots[index]) Entry_t(wob::move(oldSlots[i]));
+				oldSlots[i].~Entry_t();
+			}
+
+			growthLeft = maxLoad(newCapacity) - size_;
+			if (oldCtrl)
+				allocator->deallocate(oldCtrl);
+		}
+
+		constexpr void copyFrom(HashMap const& rhs)
+		{
+			reserve(rhs.size_);
+			for (uint32_t i = 0; i < rhs.capacity_; i++)
+			{
+				if (isFull(rhs.ctrl[i]))
+					insert(rhs.slots[i].first, rhs.slots[i].second);
+			}
+		}
+
+		constexpr void destroySlots()
+		{
+			for (uint32_t i = 0; i < capacity_; i++)
+			{
+				if (isFull(ctrl[i]))
+					slots[i].~Entry_t();
+			}
+		}
+
+		constexpr void release()
+		{
+			if (ctrl)
+			{
+				destroySlots();
+				allocator->deallocate(ctrl);
+			}
+			ctrl = nullptr;
+			slots = nullptr;
+			capacity_ = 0;
+			size_ = 0;
+			growthLeft = 0;
 		}
 
-		IAllocator* allocator;
-		Array<Bucket_t> buckets;
-		uint32_t size_;
+		IAllocator* allocator = nullptr;
+		Ctrl_t* ctrl = nullptr;
+		Entry_t* slots = nullptr;
+		uint32_t capacity_ = 0;
+		uint32_t size_ = 0;
+		// number of empty slots that can still be filled before reaching max load
+		uint32_t growthLeft = 0;
 	};
 }
 
-#endif
\ No newline at end of file
+#endif
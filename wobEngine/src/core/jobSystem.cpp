@@ -0,0 +1,296 @@
+#include "jobSystem.hpp"
+#include "allocator.hpp"
+#include "wob.hpp"
+
+using namespace wob;
+
+thread_local JobSystem::Worker* JobSystem::currentWorker = nullptr;
+
+WorkStealingQueue::WorkStealingQueue(IAllocator& alloc, uint32_t capacity) noexcept
+	: allocator(&alloc), jobs(nullptr), mask(0), top(0), bottom(0)
+{
+	uint32_t size = 2;
+	while (size < capacity)
+		size *= 2;
+	mask = size - 1;
+
+	jobs = static_cast<Atomic<Job*>*>(allocator->allocate(sizeof(Atomic<Job*>) * size, alignof(Atomic<Job*>)));
+	for (uint32_t i = 0; i < size; i++)
+		new (jobs + i) Atomic<Job*>(nullptr);
+}
+
+WorkStealingQueue::~WorkStealingQueue() noexcept
+{
+	allocator->deallocate(jobs);
+}
+
+bool WorkStealingQueue::push(Job* job) noexcept
+{
+	int64_t const b = bottom.load(MemoryOrder::Relaxed);
+	int64_t const t = top.load(MemoryOrder::Acquire);
+	if (b - t > mask)
+		return false;
+
+	jobs[b & mask].store(job, MemoryOrder::Relaxed);
+	// publish the slot (and the job it points to) to the thieves
+	bottom.store(b + 1, MemoryOrder::Release);
+	return true;
+}
+
+Job* WorkStealingQueue::pop() noexcept
+{
+	// reserve the bottom slot, seq cst stands for the fence between this store and the top load
+	int64_t const b = bottom.load(MemoryOrder::Relaxed) - 1;
+	bottom.store(b, MemoryOrder::SeqCst);
+	int64_t t = top.load(MemoryOrder::SeqCst);
+
+	if (t > b)
+	{
+		// empty
+		bottom.store(b + 1, MemoryOrder::Relaxed);
+		return nullptr;
+	}
+
+	Job* job = jobs[b & mask].load(MemoryOrder::Relaxed);
+	if (t == b)
+	{
+		// last job, race the thieves for it
+		if (!top.compareExchange(t, t + 1, MemoryOrder::SeqCst))
+			job = nullptr;
+		bottom.store(b + 1, MemoryOrder::Relaxed);
+	}
+	return job;
+}
+
+Job* WorkStealingQueue::steal() noexcept
+{
+	int64_t t = top.load(MemoryOrder::SeqCst);
+	int64_t const b = bottom.load(MemoryOrder::SeqCst);
+	if (t >= b)
+		return nullptr;
+
+	// the slot can only be reused once top moved past it, then the exchange fails
+	Job* const job = jobs[t & mask].load(MemoryOrder::Relaxed);
+	if (!top.compareExchange(t, t + 1, MemoryOrder::SeqCst))
+		return nullptr;
+	return job;
+}
+
+bool WorkStealingQueue::empty() const noexcept
+{
+	int64_t const t = top.load(MemoryOrder::SeqCst);
+	int64_t const b = bottom.load(MemoryOrder::SeqCst);
+	return t >= b;
+}
+
+JobSystem::Worker::Worker(JobSystem& owner, uint32_t workerIndex, IAllocator& alloc, uint32_t queueCapacity) noexcept
+	: system(&owner), index(workerIndex), random(workerIndex * 2654435761u + 1), queue(alloc, queueCapacity)
+{
+
+}
+
+JobSystem::JobSystem(IAllocator& alloc) noexcept
+	: JobSystem(alloc, InitInfo{})
+{
+
+}
+
+JobSystem::JobSystem(IAllocator& alloc, InitInfo const& info) noexcept
+	: allocator(&alloc), workers(nullptr), workerCount(info.workerCount), workerContext(context), sleepingCount(0), stopRequested(0)
+{
+	if (workerCount == 0)
+	{
+		uint32_t const cores = Thread::processorCount();
+		workerCount = cores > 1 ? cores - 1 : 0;
+	}
+
+	workerContext.allocator = allocator;
+	// frame allocators aren't thread safe
+	workerContext.frameAllocator = nullptr;
+	workerContext.jobSystem = this;
+
+	workers = static_cast<Worker*>(allocator->allocate(sizeof(Worker) * (workerCount + 1), alignof(Worker)));
+	for (uint32_t i = 0; i <= workerCount; i++)
+		new (workers + i) Worker(*this, i, alloc, info.queueCapacity);
+
+	WOB_ASSERT(currentWorker == nullptr);
+	currentWorker = &workers[0];
+
+	for (uint32_t i = 1; i <= workerCount; i++)
+	{
+		bool const started = workers[i].thread.start(&JobSystem::workerEntry, &workers[i], "wob worker", info.workerStackSize);
+		WOB_ASSERT(started);
+	}
+}
+
+JobSystem::~JobSystem() noexcept
+{
+	WOB_ASSERT(currentWorker == &workers[0]);
+
+	// run what is still queued, the workers help until they are stopped
+	while (Job* const job = findJob(workers[0]))
+		execute(job);
+
+	stopRequested.store(1);
+	wakeup.signal(workerCount);
+	for (uint32_t i = 1; i <= workerCount; i++)
+	{
+		if (workers[i].thread.joinable())
+			workers[i].thread.join();
+	}
+
+	// jobs still running on the workers may have queued more before they stopped
+	while (Job* const job = findJob(workers[0]))
+		execute(job);
+	WOB_ASSERT(!hasQueuedJobs());
+
+	currentWorker = nullptr;
+	for (uint32_t i = 0; i <= workerCount; i++)
+		workers[i].~Worker();
+	allocator->deallocate(workers);
+}
+
+void JobSystem::run(Job* jobs, uint32_t count, JobCounter& counter) noexcept
+{
+	if (count == 0)
+		return;
+
+	Worker& worker = current();
+	counter.pending.fetchAdd((int32_t)count, MemoryOrder::Relaxed);
+	for (uint32_t i = 0; i < count; i++)
+	{
+		jobs[i].counter = &counter;
+		// a full queue means there is plenty to steal already
+		if (!worker.queue.push(&jobs[i]))
+			execute(&jobs[i]);
+	}
+
+	wakeWorkers(count);
+}
+
+void JobSystem::run(Job& job) noexcept
+{
+	Worker& worker = current();
+	job.counter = nullptr;
+	if (!worker.queue.push(&job))
+	{
+		execute(&job);
+		return;
+	}
+	wakeWorkers(1);
+}
+
+void JobSystem::wakeWorkers(uint32_t jobCount) noexcept
+{
+	// read-modify-write so it is ordered with the increment of a worker going to sleep:
+	// either we see the sleeper or it sees the jobs when it checks the queues again
+	uint32_t const sleeping = sleepingCount.fetchAdd(0);
+	if (sleeping > 0)
+		wakeup.signal(sleeping < jobCount ? sleeping : jobCount);
+}
+
+void JobSystem::wait(JobCounter& counter) noexcept
+{
+	Worker& worker = current();
+	uint32_t idleCount = 0;
+	while (!counter.isDone())
+	{
+		if (Job* const job = findJob(worker))
+		{
+			execute(job);
+			idleCount = 0;
+		}
+		// the remaining jobs are running on other threads
+		else if (++idleCount < 64)
+			cpuRelax();
+		else
+			Thread::yield();
+	}
+}
+
+void JobSystem::workerEntry(void* worker) noexcept
+{
+	Worker& self = *static_cast<Worker*>(worker);
+	context = self.system->workerContext;
+	currentWorker = &self;
+	self.system->workerLoop(self);
+	currentWorker = nullptr;
+}
+
+void JobSystem::workerLoop(Worker& worker) noexcept
+{
+	constexpr uint32_t spinCount = 64;
+
+	while (!stopRequested.load(MemoryOrder::Relaxed))
+	{
+		if (Job* const job = findJob(worker))
+		{
+			execute(job);
+			continue;
+		}
+
+		// spin a little before sleeping, waking a worker costs the pusher a syscall
+		bool found = false;
+		for (uint32_t i = 0; i < spinCount && !found; i++)
+		{
+			Thread::yield();
+			found = hasQueuedJobs();
+		}
+		if (found)
+			continue;
+
+		// pushers wake us only when they see the count, check the queues again after raising it
+		sleepingCount.fetchAdd(1);
+		if (!hasQueuedJobs() && !stopRequested.load())
+			wakeup.wait();
+		sleepingCount.fetchSub(1);
+	}
+}
+
+JobSystem::Worker& JobSystem::current() const noexcept
+{
+	// jobs can only be run from the creating thread and the workers
+	WOB_ASSERT_NOLOG(currentWorker != nullptr && currentWorker->system == this);
+	return *currentWorker;
+}
+
+Job* JobSystem::findJob(Worker& worker) noexcept
+{
+	if (Job* const job = worker.queue.pop())
+		return job;
+
+	// steal from the others, starting at a random one so thieves spread out
+	uint32_t const threads = workerCount + 1;
+	worker.random ^= worker.random << 13;
+	worker.random ^= worker.random >> 17;
+	worker.random ^= worker.random << 5;
+	uint32_t const start = worker.random % threads;
+	for (uint32_t i = 0; i < threads; i++)
+	{
+		uint32_t const victim = (start + i) % threads;
+		if (victim == worker.index)
+			continue;
+		if (Job* const job = workers[victim].queue.steal())
+			return job;
+	}
+	return nullptr;
+}
+
+void JobSystem::execute(Job* job) noexcept
+{
+	// the job can be freed as soon as its counter is done, or as soon as it starts without counter
+	JobCounter* const counter = job->counter;
+	job->function(job->userData);
+	if (counter)
+		counter->pending.fetchSub(1, MemoryOrder::AcqRel);
+}
+
+bool JobSystem::hasQueuedJobs() const noexcept
+{
+	for (uint32_t i = 0; i <= workerCount; i++)
+	{
+		if (!workers[i].queue.empty())
+			return true;
+	}
+	return false;
+}
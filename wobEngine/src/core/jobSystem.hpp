@@ -0,0 +1,215 @@
+#ifndef WOB_JOB_SYSTEM_HPP
+#define WOB_JOB_SYSTEM_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "atomic.hpp"
+#include "thread.hpp"
+#include "context.hpp"
+#include "arrayView.hpp"
+#include "debug.hpp"
+#include <stdint.h>
+
+namespace wob
+{
+	class IAllocator;
+	class JobSystem;
+
+	using JobFunction = void (*)(void* userData);
+
+	// number of unfinished jobs of a group, the group is done once it reaches 0
+	class JobCounter
+	{
+	public:
+		JobCounter() noexcept = default;
+		JobCounter(JobCounter const&) = delete;
+		JobCounter& operator=(JobCounter const&) = delete;
+
+		[[nodiscard]] bool isDone() const noexcept { return pending.load(MemoryOrder::Acquire) == 0; }
+
+	private:
+		friend class JobSystem;
+		Atomic<int32_t> pending;
+	};
+
+	// owned by the caller, it must stay alive until the counter it was run with is done
+	// (until it starts for a job run without counter)
+	struct Job
+	{
+		JobFunction function;
+		void* userData;
+		JobCounter* counter = nullptr;
+	};
+
+	/*
+	 * Chase-Lev deque of jobs with a fixed capacity (power of 2)
+	 * the owner thread pushes and pops at the bottom, other threads steal from the top
+	 * ref: Le, Pop, Cohen, Zappa Nardelli - Correct and Efficient Work-Stealing for Weak Memory Models (2013)
+	 */
+	class WorkStealingQueue
+	{
+	public:
+		WorkStealingQueue(IAllocator& allocator, uint32_t capacity) noexcept;
+		~WorkStealingQueue() noexcept;
+
+		WorkStealingQueue(WorkStealingQueue const&) = delete;
+		WorkStealingQueue& operator=(WorkStealingQueue const&) = delete;
+
+		// owner only, return false when full
+		bool push(Job* job) noexcept;
+		// owner only, newest job first
+		[[nodiscard]] Job* pop() noexcept;
+		// any thread, oldest job first, nullptr when empty or when another thread won the race
+		[[nodiscard]] Job* steal() noexcept;
+
+		[[nodiscard]] bool empty() const noexcept;
+
+	private:
+		IAllocator* allocator;
+		Atomic<Job*>* jobs;
+		int64_t mask;
+		alignas(64) Atomic<int64_t> top;
+		alignas(64) Atomic<int64_t> bottom;
+	};
+
+	/*
+	 * Fixed pool of worker threads running jobs, each thread owns a work stealing queue and steals from the others when it runs dry.
+	 * Jobs are run with a counter, wait(counter) runs jobs on the calling thread until the counter is done, so jobs can fork and join.
+	 * Only the thread that created the system and its workers can run and wait for jobs, a thread creates one system at a time.
+	 * Each worker starts with a copy of the creating thread context (allocator, logger) without its frame allocator,
+	 * and context.jobSystem pointing to the system, the allocator must be thread safe.
+	 */
+	class JobSystem
+	{
+	public:
+		struct InitInfo
+		{
+			// 0 starts a worker per core besides the creating thread
+			uint32_t workerCount = 0;
+			// jobs each thread can have queued, rounded up to a power of 2, a job that doesn't fit runs right away
+			uint32_t queueCapacity = 1024;
+			uint32_t workerStackSize = 256 * 1024;
+		};
+
+		explicit JobSystem(IAllocator& allocator) noexcept;
+		JobSystem(IAllocator& allocator, InitInfo const& info) noexcept;
+		// wait for the queued jobs and join the workers
+		~JobSystem() noexcept;
+
+		JobSystem(JobSystem const&) = delete;
+		JobSystem& operator=(JobSystem const&) = delete;
+
+		// queue count jobs, counter is incremented by count and decremented as each job ends
+		void run(Job* jobs, uint32_t count, JobCounter& counter) noexcept;
+		void run(Job& job, JobCounter& counter) noexcept { run(&job, 1, counter); }
+		// queue a job nothing waits for, it must stay alive until it starts
+		void run(Job& job) noexcept;
+
+		// run queued jobs on this thread until counter is done
+		void wait(JobCounter& counter) noexcept;
+
+		// workers and the creating thread
+		[[nodiscard]] uint32_t threadCount() const noexcept { return workerCount + 1; }
+		[[nodiscard]] uint32_t getWorkerCount() const noexcept { return workerCount; }
+
+	private:
+		struct alignas(64) Worker
+		{
+			Worker(JobSystem& system, uint32_t index, IAllocator& allocator, uint32_t queueCapacity) noexcept;
+
+			JobSystem* system;
+			uint32_t index;
+			// xorshift state to pick steal victims
+			uint32_t random;
+			WorkStealingQueue queue;
+			Thread thread;
+		};
+
+		static void workerEntry(void* worker) noexcept;
+		void workerLoop(Worker& worker) noexcept;
+		// worker of the calling thread
+		Worker& current() const noexcept;
+		Job* findJob(Worker& worker) noexcept;
+		static void execute(Job* job) noexcept;
+		bool hasQueuedJobs() const noexcept;
+		void wakeWorkers(uint32_t jobCount) noexcept;
+
+		// worker slot of the running thread, in whichever system it belongs to
+		static thread_local Worker* currentWorker;
+
+		IAllocator* allocator;
+		// slot 0 is the creating thread
+		Worker* workers;
+		uint32_t workerCount;
+		Context workerContext;
+
+		// workers waiting on wakeup, pushers only signal when it isn't 0
+		alignas(64) Atomic<uint32_t> sleepingCount;
+		Atomic<uint32_t> stopRequested;
+		Semaphore wakeup;
+	};
+
+	namespace detail
+	{
+		template<typename T, typename Fn>
+		struct ParallelForRange
+		{
+			JobSystem* system;
+			T* first;
+			uint32_t count;
+			uint32_t grain;
+			Fn* fn;
+		};
+
+		// split the range in halves queued as jobs until it fits in grain, run the last part here then join the halves
+		template<typename T, typename Fn>
+		void parallelForJob(void* data) noexcept
+		{
+			ParallelForRange<T, Fn> range = *static_cast<ParallelForRange<T, Fn>*>(data);
+
+			// 32 halvings cover any uint32_t count
+			ParallelForRange<T, Fn> halves[32];
+			Job jobs[32];
+			JobCounter counter;
+			uint32_t halfCount = 0;
+			while (range.count > range.grain)
+			{
+				uint32_t const half = range.count / 2;
+				halves[halfCount] = ParallelForRange<T, Fn>{ range.system, range.first + half, range.count - half, range.grain, range.fn };
+				jobs[halfCount] = Job{ &parallelForJob<T, Fn>, &halves[halfCount] };
+				range.system->run(jobs[halfCount], counter);
+				range.count = half;
+				halfCount++;
+			}
+
+			for (uint32_t i = 0; i < range.count; i++)
+				(*range.fn)(range.first[i]);
+
+			if (halfCount > 0)
+				range.system->wait(counter);
+		}
+	}
+
+	/*
+	 * call fn(element) for every element of view, spread over the job system of the context in chunks of at least grain elements
+	 * runs on the calling thread when the context has no job system, returns once every element is done
+	 */
+	template<typename T, typename Fn>
+	void parallelFor(ArrayView<T> view, uint32_t grain, Fn&& fn) noexcept
+	{
+		grain = grain > 0 ? grain : 1;
+		JobSystem* const system = context.jobSystem;
+		if (system == nullptr || view.size() <= grain)
+		{
+			for (T& e : view)
+				fn(e);
+			return;
+		}
+
+		WOB_ASSERT_NOLOG(view.size() <= ~0u);
+		detail::ParallelForRange<T, remove_reference_t<Fn>> range{ system, view.data(), (uint32_t)view.size(), grain, &fn };
+		detail::parallelForJob<T, remove_reference_t<Fn>>(&range);
+	}
+}
+
+#endif
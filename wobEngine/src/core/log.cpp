@@ -0,0 +1,247 @@
+#include "log.hpp"
+#include "wob.hpp"
+#include "time.hpp"
+#include "utility.hpp"
+#include <string.h>
+
+using namespace wob;
+
+AsyncLogger::AsyncLogger(IAllocator& alloc, uint32_t capacity, LogOverflow overflowPolicy) noexcept
+	: allocator(&alloc), entries(nullptr), mask(0), overflow(overflowPolicy), sinks{}, sinkCount(0),
+	enqueuePos(0), dropped(0), dequeuePos(0), reportedDrops(0), dispatchedPos(0), consumerSleeping(0), stopRequested(0), consumerRunning(0)
+{
+	uint32_t size = 2;
+	while (size < capacity)
+		size *= 2;
+	mask = size - 1;
+
+	entries = static_cast<Entry*>(allocator->allocate(sizeof(Entry) * size, alignof(Entry)));
+	for (uint32_t i = 0; i < size; i++)
+	{
+		Entry* const entry = new (entries + i) Entry;
+		entry->sequence.store(i, MemoryOrder::Relaxed);
+	}
+}
+
+AsyncLogger::~AsyncLogger() noexcept
+{
+	if (thread.joinable())
+		stop();
+	for (uint32_t i = 0; i <= mask; i++)
+		entries[i].~Entry();
+	allocator->deallocate(entries);
+}
+
+void AsyncLogger::addSink(Sink& sink) noexcept
+{
+	WOB_ASSERT(!thread.joinable());
+	WOB_ASSERT(sinkCount < wob::size(sinks));
+	sinks[sinkCount++] = &sink;
+}
+
+bool AsyncLogger::start() noexcept
+{
+	WOB_ASSERT_NOLOG(!thread.joinable());
+	stopRequested.store(0);
+	consumerRunning.store(1);
+	if (thread.start(&AsyncLogger::threadEntry, this, "wob logger"))
+		return true;
+	consumerRunning.store(0);
+	return false;
+}
+
+void AsyncLogger::stop() noexcept
+{
+	WOB_ASSERT_NOLOG(thread.joinable());
+	stopRequested.store(1);
+	wakeup.signal();
+	thread.join();
+	// producers dispatch by themselves from now on, drain what was committed while the thread exited
+	consumerRunning.store(0);
+	dispatchPending();
+}
+
+AsyncLogger::Entry* AsyncLogger::begin(LogLevel level, source_location const& location) noexcept
+{
+	uint32_t pos = enqueuePos.load(MemoryOrder::Relaxed);
+	for (;;)
+	{
+		Entry* const entry = &entries[pos & mask];
+		int32_t const diff = (int32_t)(entry->sequence.load(MemoryOrder::Acquire) - pos);
+		if (diff == 0)
+		{
+			// the entry is free for this lap, claim it
+			if (enqueuePos.compareExchange(pos, pos + 1, MemoryOrder::Relaxed))
+			{
+				entry->position = pos;
+				entry->record.message = entry->text;
+				entry->record.size = 0;
+				entry->record.level = level;
+				entry->record.timestamp = getPerfCount();
+				entry->record.location = location;
+				return entry;
+			}
+		}
+		else if (diff < 0)
+		{
+			// full, the entry still holds a record of the previous lap
+			// nothing frees it before start or after stop, blocking would never return
+			if (overflow == LogOverflow::Drop || !consumerRunning.load(MemoryOrder::Acquire))
+			{
+				dropped.fetchAdd(1, MemoryOrder::Relaxed);
+				return nullptr;
+			}
+			wakeConsumer();
+			Thread::yield();
+			pos = enqueuePos.load(MemoryOrder::Relaxed);
+		}
+		else
+		{
+			// another producer claimed it first
+			pos = enqueuePos.load(MemoryOrder::Relaxed);
+		}
+	}
+}
+
+void AsyncLogger::commit(Entry* entry, uint32_t size) noexcept
+{
+	entry->text[size] = '\0';
+	entry->record.size = size;
+	// seq cst so the publication can't be reordered after the sleeping check, the consumer does the opposite
+	entry->sequence.store(entry->position + 1, MemoryOrder::SeqCst);
+	if (consumerSleeping.load(MemoryOrder::SeqCst))
+		wakeConsumer();
+	// after stop nothing else would dispatch it, stop does the opposite so either side sees the record
+	if (!consumerRunning.load(MemoryOrder::SeqCst) && stopRequested.load(MemoryOrder::SeqCst))
+		dispatchPending();
+}
+
+void AsyncLogger::push(LogLevel level, source_location const& location, const char* message, uint32_t size) noexcept
+{
+	Entry* const entry = begin(level, location);
+	if (!entry)
+		return;
+	commit(entry, copyTruncated(entry, message, size));
+	if (level >= LogLevel::Error)
+		flush();
+}
+
+uint32_t AsyncLogger::copyTruncated(Entry* entry, const char* message, uint32_t size) noexcept
+{
+	if (size <= maxMessageSize)
+	{
+		memcpy(entry->text, message, size);
+		return size;
+	}
+
+	char const suffix[] = "...\n";
+	uint32_t const kept = maxMessageSize - (sizeof(suffix) - 1);
+	memcpy(entry->text, message, kept);
+	memcpy(entry->text + kept, suffix, sizeof(suffix) - 1);
+	return maxMessageSize;
+}
+
+void AsyncLogger::flush() noexcept
+{
+	if (!thread.joinable())
+		return;
+
+	uint32_t const target = enqueuePos.load();
+	while ((int32_t)(dispatchedPos.load(MemoryOrder::Acquire) - target) < 0)
+	{
+		wakeConsumer();
+		Thread::yield();
+	}
+}
+
+void AsyncLogger::dispatchPending() noexcept
+{
+	ScopedLock lock(dispatchLock);
+	while (dispatchBatch()) {}
+}
+
+void AsyncLogger::threadEntry(void* self) noexcept
+{
+	static_cast<AsyncLogger*>(self)->consume();
+}
+
+void AsyncLogger::wakeConsumer() noexcept
+{
+	if (consumerSleeping.exchange(0))
+		wakeup.signal();
+}
+
+bool AsyncLogger::hasPending() noexcept
+{
+	return entries[dequeuePos & mask].sequence.load() == dequeuePos + 1;
+}
+
+void AsyncLogger::consume() noexcept
+{
+	for (;;)
+	{
+		if (dispatchBatch())
+			continue;
+
+		if (stopRequested.load())
+		{
+			while (dispatchBatch()) {}
+			return;
+		}
+
+		// spin a little before sleeping, waking the thread costs producers a syscall
+		bool pending = false;
+		for (uint32_t i = 0; i < spinCount && !pending; i++)
+		{
+			Thread::yield();
+			pending = hasPending();
+		}
+		if (pending)
+			continue;
+
+		// producers wake us only when this flag is set, check the queue again after setting it
+		consumerSleeping.store(1);
+		if (!hasPending() && !stopRequested.load())
+			wakeup.wait();
+		consumerSleeping.store(0);
+	}
+}
+
+bool AsyncLogger::dispatchBatch() noexcept
+{
+	uint32_t count = 0;
+	while (count < batchSize)
+	{
+		Entry& entry = entries[dequeuePos & mask];
+		if (entry.sequence.load(MemoryOrder::Acquire) != dequeuePos + 1)
+			break;
+
+		for (int i = 0; i < sinkCount; i++)
+			sinks[i]->dispatch(entry.record);
+
+		// free the entry for the next lap
+		entry.sequence.store(dequeuePos + mask + 1, MemoryOrder::Release);
+		dequeuePos++;
+		count++;
+	}
+
+	uint64_t const droppedNow = dropped.load(MemoryOrder::Relaxed);
+	if (droppedNow != reportedDrops)
+	{
+		char text[64];
+		uint32_t const size = formatTo(text, sizeof(text), "warn: {} log messages dropped\n", droppedNow - reportedDrops);
+		LogRecord const record{ text, size, LogLevel::Warning, getPerfCount(), source_location() };
+		for (int i = 0; i < sinkCount; i++)
+			sinks[i]->dispatch(record);
+		reportedDrops = droppedNow;
+		count++;
+	}
+
+	if (count == 0)
+		return false;
+
+	for (int i = 0; i < sinkCount; i++)
+		sinks[i]->flush();
+	dispatchedPos.store(dequeuePos, MemoryOrder::Release);
+	return true;
+}
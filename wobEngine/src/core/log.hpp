@@ -0,0 +1,152 @@
+#ifndef WOB_LOG_HPP
+#define WOB_LOG_HPP
+
+#include <stdint.h>
+#include "debug.hpp"
+#include "format.hpp"
+#include "atomic.hpp"
+#include "thread.hpp"
+#include "allocator.hpp"
+
+namespace wob
+{
+	// what producers do when the ring buffer is full
+	enum class LogOverflow
+	{
+		Drop,	// the message is lost and counted, the next batch report how many were dropped
+		Block	// wait for the logging thread to free a record, drop like Drop when the thread isn't running
+	};
+
+	/*
+	 * Asynchronous log pipeline shared by every thread whose Logger point to it (Logger::setAsync)
+	 * Producers format straight into fixed size records of a lock free bounded MPSC ring buffer (Vyukov queue),
+	 * a background thread dispatches them to the sinks in batches and flushes the sinks once per batch.
+	 * Messages longer than maxMessageSize are truncated.
+	 * Error messages wait until they are dispatched so an assert output is visible before the debug break.
+	 * Messages pushed before start are queued until then, after stop producers dispatch to the sinks themselves.
+	 * Sinks must be added before start, they are called by one thread at a time (the logging thread, then producers after stop).
+	 */
+	class AsyncLogger
+	{
+	public:
+		static constexpr uint32_t maxMessageSize = 199;
+
+		// one cache line multiple per record so producers don't share lines
+		struct alignas(64) Entry
+		{
+			Atomic<uint32_t> sequence;
+			uint32_t position;
+			LogRecord record;
+			char text[maxMessageSize + 1];
+		};
+
+		// capacity is rounded up to a power of 2
+		explicit AsyncLogger(IAllocator& allocator, uint32_t capacity = 1024, LogOverflow overflow = LogOverflow::Drop) noexcept;
+		~AsyncLogger() noexcept;
+
+		AsyncLogger(AsyncLogger const&) = delete;
+		AsyncLogger& operator=(AsyncLogger const&) = delete;
+
+		void addSink(Sink& sink) noexcept;
+
+		bool start() noexcept;
+		// dispatch everything already pushed then join the logging thread
+		// messages pushed after stop are dispatched synchronously by the producer
+		void stop() noexcept;
+
+		// reserve a record, return nullptr when the buffer is full with the Drop policy
+		// the caller writes entry->text then commit it
+		[[nodiscard]] Entry* begin(LogLevel level, source_location const& location) noexcept;
+		void commit(Entry* entry, uint32_t size) noexcept;
+
+		// copy message in a record, truncated to maxMessageSize
+		void push(LogLevel level, source_location const& location, const char* message, uint32_t size) noexcept;
+
+		// block until every message pushed before the call is dispatched
+		void flush() noexcept;
+
+		[[nodiscard]] uint64_t droppedCount() const noexcept { return dropped.load(MemoryOrder::Relaxed); }
+
+		// copy message in entry text, keep the trailing new line of a truncated message
+		static uint32_t copyTruncated(Entry* entry, const char* message, uint32_t size) noexcept;
+
+	private:
+		static void threadEntry(void* self) noexcept;
+		void consume() noexcept;
+		bool dispatchBatch() noexcept;
+		// dispatch every committed record from the calling thread
+		void dispatchPending() noexcept;
+		bool hasPending() noexcept;
+		void wakeConsumer() noexcept;
+
+		static constexpr uint32_t batchSize = 64;
+		static constexpr uint32_t spinCount = 64;
+
+		IAllocator* allocator;
+		Entry* entries;
+		uint32_t mask;
+		LogOverflow overflow;
+
+		Sink* sinks[8];
+		int sinkCount;
+
+		// producers side
+		alignas(64) Atomic<uint32_t> enqueuePos;
+		Atomic<uint64_t> dropped;
+
+		// consumer side
+		alignas(64) uint32_t dequeuePos;
+		uint64_t reportedDrops;
+		Atomic<uint32_t> dispatchedPos;
+		Atomic<uint32_t> consumerSleeping;
+		Atomic<uint32_t> stopRequested;
+		// set while the logging thread can free records, blocked producers give up when it's cleared
+		Atomic<uint32_t> consumerRunning;
+		// serializes dispatching producers once the logging thread is stopped
+		SpinLock dispatchLock;
+		Semaphore wakeup;
+		Thread thread;
+	};
+
+	template<typename ...Args>
+	inline void logFormatted(Logger& logger, LogLevel level, source_location const& location, FormatString<Args...> const& fmt, Formatter<FormatType_t<Args>> const&... formatters) noexcept
+	{
+		uint32_t const size = formattedSizeOf(fmt, formatters...);
+
+		if (AsyncLogger* const async = logger.getAsync())
+		{
+			AsyncLogger::Entry* const entry = async->begin(level, location);
+			if (!entry)
+				return;
+
+			if (size <= AsyncLogger::maxMessageSize)
+			{
+				writeFormatted(entry->text, fmt, formatters...);
+				async->commit(entry, size);
+			}
+			else
+			{
+				String const message = formatToString(fmt, formatters...);
+				async->commit(entry, AsyncLogger::copyTruncated(entry, message.data(), message.size()));
+			}
+
+			if (level >= LogLevel::Error)
+				async->flush();
+			return;
+		}
+
+		char storage[512];
+		StringBuilder message(storage);
+		writeFormatted(message.appendNoInit(size), fmt, formatters...);
+		logger.log(level, location, message.c_str(), message.size());
+	}
+
+	// used by the WOB_LOG macros
+	template<typename ...Args>
+	inline void logFormat(Logger& logger, LogLevel level, source_location const& location, FormatString<wob::type_identity_t<Args>...> fmt, Args const&... args) noexcept
+	{
+		logFormatted(logger, level, location, fmt, Formatter<FormatType_t<Args>>(args)...);
+	}
+}
+
+#endif
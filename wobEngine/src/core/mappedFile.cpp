@@ -0,0 +1,280 @@
+#include "mappedFile.hpp"
+#include "wob.hpp"
+#include "utility.hpp"
+#include "virtualMemory.hpp"
+
+#ifdef _WIN32
+	#include "os.hpp"
+#elif defined(__vita__)
+	#include "os.hpp"
+	#include <stdio.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace wob;
+
+MappedFile::~MappedFile() noexcept
+{
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+	: data_(rhs.data_), size_(rhs.size_), open_(rhs.open_)
+#ifdef _WIN32
+	, fileHandle(rhs.fileHandle), mappingHandle(rhs.mappingHandle)
+#elif defined(__vita__)
+	, allocator(rhs.allocator)
+#endif
+{
+	rhs.reset();
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+	if (this != &rhs)
+	{
+		close();
+		data_ = rhs.data_;
+		size_ = rhs.size_;
+		open_ = rhs.open_;
+#ifdef _WIN32
+		fileHandle = rhs.fileHandle;
+		mappingHandle = rhs.mappingHandle;
+#elif defined(__vita__)
+		allocator = rhs.allocator;
+#endif
+		rhs.reset();
+	}
+	return *this;
+}
+
+void MappedFile::reset() noexcept
+{
+	data_ = nullptr;
+	size_ = 0;
+	open_ = false;
+#ifdef _WIN32
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+#elif defined(__vita__)
+	allocator = nullptr;
+#endif
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const char* path, FileAccess access, IAllocator& fallbackAllocator) noexcept
+{
+	WOB_UNUSED(fallbackAllocator);
+	close();
+
+	// windows only takes the hint at open time
+	DWORD const flags = access == FileAccess::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN
+		: access == FileAccess::Random ? FILE_FLAG_RANDOM_ACCESS : FILE_ATTRIBUTE_NORMAL;
+	HANDLE const file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	size_ = (size_t)fileSize.QuadPart;
+	open_ = true;
+	// empty files can't be mapped
+	if (size_ == 0)
+		return true;
+
+	mappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mappingHandle)
+		data_ = static_cast<uint8_t const*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	if (!data_)
+	{
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() noexcept
+{
+	if (data_)
+		UnmapViewOfFile(data_);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle)
+		CloseHandle(fileHandle);
+	reset();
+}
+
+void MappedFile::advise(FileAccess access, size_t offset, size_t count) noexcept
+{
+	// the hint was given to CreateFile
+	WOB_UNUSED(access);
+	WOB_BOUNDS_CHECK(offset <= size_ && count <= size_ - offset);
+}
+
+void MappedFile::prefetch(size_t offset, size_t count) noexcept
+{
+	WOB_BOUNDS_CHECK(offset <= size_ && count <= size_ - offset);
+	if (count == 0)
+		return;
+	WIN32_MEMORY_RANGE_ENTRY range{ const_cast<uint8_t*>(data_) + offset, count };
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#elif defined(__vita__)
+
+// no file mapping on vita, the file is read once in a heap buffer
+
+bool MappedFile::open(const char* path, FileAccess access, IAllocator& fallbackAllocator) noexcept
+{
+	WOB_UNUSED(access);
+	close();
+
+	FILE* const file = fopen(path, "rb");
+	if (!file)
+		return false;
+
+	long size = -1;
+	if (fseek(file, 0, SEEK_END) == 0)
+		size = ftell(file);
+
+	bool ok = size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+	uint8_t* buffer = nullptr;
+	if (ok && size > 0)
+	{
+		buffer = static_cast<uint8_t*>(fallbackAllocator.allocate((size_t)size, 16));
+		ok = buffer && fread(buffer, 1, (size_t)size, file) == (size_t)size;
+		if (!ok && buffer)
+			fallbackAllocator.deallocate(buffer);
+	}
+	fclose(file);
+	if (!ok)
+		return false;
+
+	data_ = buffer;
+	size_ = (size_t)size;
+	open_ = true;
+	allocator = &fallbackAllocator;
+	return true;
+}
+
+void MappedFile::close() noexcept
+{
+	if (data_)
+		allocator->deallocate(const_cast<uint8_t*>(data_));
+	reset();
+}
+
+void MappedFile::advise(FileAccess access, size_t offset, size_t count) noexcept
+{
+	// already in memory
+	WOB_UNUSED(access);
+	WOB_BOUNDS_CHECK(offset <= size_ && count <= size_ - offset);
+}
+
+void MappedFile::prefetch(size_t offset, size_t count) noexcept
+{
+	WOB_BOUNDS_CHECK(offset <= size_ && count <= size_ - offset);
+}
+
+#else
+
+// madvise needs page aligned ranges, widen [offset, offset + count) to whole pages
+static void pageRange(uint8_t const* data, size_t offset, size_t count, void*& start, size_t& length) noexcept
+{
+	size_t const page = vm::pageSize();
+	uintptr_t const first = (uintptr_t)(data + offset) & ~(uintptr_t)(page - 1);
+	uintptr_t const last = (uintptr_t)(data + offset + count);
+	start = (void*)first;
+	length = (size_t)(last - first);
+}
+
+static int toAdvice(FileAccess access) noexcept
+{
+	switch (access)
+	{
+	case FileAccess::Sequential: return MADV_SEQUENTIAL;
+	case FileAccess::Random: return MADV_RANDOM;
+	default: return MADV_NORMAL;
+	}
+}
+
+bool MappedFile::open(const char* path, FileAccess access, IAllocator& fallbackAllocator) noexcept
+{
+	WOB_UNUSED(fallbackAllocator);
+	close();
+
+	int const fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat info;
+	if (fstat(fd, &info) != 0)
+	{
+		::close(fd);
+		return false;
+	}
+
+	size_t const size = (size_t)info.st_size;
+	void* mapping = nullptr;
+	// empty files can't be mapped
+	if (size > 0)
+	{
+		mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapping == MAP_FAILED)
+		{
+			::close(fd);
+			return false;
+		}
+	}
+	// the mapping keeps the file alive
+	::close(fd);
+
+	data_ = static_cast<uint8_t const*>(mapping);
+	size_ = size;
+	open_ = true;
+	if (access != FileAccess::Normal)
+		advise(access);
+	return true;
+}
+
+void MappedFile::close() noexcept
+{
+	if (data_)
+		munmap(const_cast<uint8_t*>(data_), size_);
+	reset();
+}
+
+void MappedFile::advise(FileAccess access, size_t offset, size_t count) noexcept
+{
+	WOB_BOUNDS_CHECK(offset <= size_ && count <= size_ - offset);
+	if (count == 0)
+		return;
+	void* start;
+	size_t length;
+	pageRange(data_, offset, count, start, length);
+	madvise(start, length, toAdvice(access));
+}
+
+void MappedFile::prefetch(size_t offset, size_t count) noexcept
+{
+	WOB_BOUNDS_CHECK(offset <= size_ && count <= size_ - offset);
+	if (count == 0)
+		return;
+	void* start;
+	size_t length;
+	pageRange(data_, offset, count, start, length);
+	madvise(start, length, MADV_WILLNEED);
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef WOB_MAPPED_FILE_HPP
+#define WOB_MAPPED_FILE_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "allocator.hpp"
+#include "arrayView.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+namespace wob
+{
+	// how the pages of a mapped file will be read, lets the OS pick its read ahead
+	enum class FileAccess : uint8_t
+	{
+		Normal,
+		// front to back once, e.g. decoding
+		Sequential,
+		// scattered reads, e.g. lookups in a baked table
+		Random
+	};
+
+	/*
+	 * Read only view of a whole file mapped in memory (mmap / MapViewOfFile), the views point straight at the file pages
+	 * pages are loaded on first touch, prefetch asks the OS to read a range ahead of time
+	 * the Vita has no file mapping, the file is read once in a buffer from the given allocator
+	 * views are valid until the file is closed or destroyed
+	 */
+	class MappedFile
+	{
+	public:
+		MappedFile() noexcept = default;
+		~MappedFile() noexcept;
+
+		MappedFile(MappedFile&& rhs) noexcept;
+		MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+		MappedFile(MappedFile const&) = delete;
+		MappedFile& operator=(MappedFile const&) = delete;
+
+		// return false if the file can't be opened or mapped, an empty file opens with an empty view
+		bool open(const char* path, FileAccess access = FileAccess::Normal, IAllocator& fallbackAllocator = *getContextAllocator()) noexcept;
+		void close() noexcept;
+
+		// change the access hint of the whole file or of [offset, offset + count)
+		// windows only takes the hint given to open, advise does nothing there (and on vita where the file is in memory)
+		void advise(FileAccess access) noexcept { advise(access, 0, size_); }
+		void advise(FileAccess access, size_t offset, size_t count) noexcept;
+		// start reading [offset, offset + count) in the background
+		void prefetch() noexcept { prefetch(0, size_); }
+		void prefetch(size_t offset, size_t count) noexcept;
+
+		[[nodiscard]] bool isOpen() const noexcept { return open_; }
+		[[nodiscard]] size_t size() const noexcept { return size_; }
+		[[nodiscard]] uint8_t const* data() const noexcept { return data_; }
+
+		[[nodiscard]] ArrayView<uint8_t const> view() const noexcept { return ArrayView<uint8_t const>(data_, size_); }
+		[[nodiscard]] ArrayView<uint8_t const> view(size_t offset, size_t count) const noexcept
+		{
+			WOB_BOUNDS_CHECK(offset <= size_ && count <= size_ - offset);
+			return ArrayView<uint8_t const>(data_ + offset, count);
+		}
+
+	private:
+		void reset() noexcept;
+
+		uint8_t const* data_ = nullptr;
+		size_t size_ = 0;
+		bool open_ = false;
+#ifdef _WIN32
+		void* fileHandle = nullptr;
+		void* mappingHandle = nullptr;
+#elif defined(__vita__)
+		IAllocator* allocator = nullptr;
+#endif
+	};
+}
+
+#endif
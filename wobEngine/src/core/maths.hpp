@@ -6,6 +6,10 @@
 #define _USE_MATH_DEFINES
 #include <math.h>
 
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
 namespace wob {
 	
 	template <typename T> constexpr int sign(T val) noexcept {
@@ -16,6 +20,66 @@ namespace wob {
 		return val > 0 ? val : -val;
 	}
 
+	// index of the lowest set bit, x must not be 0
+	inline int countTrailingZeros(uint64_t x) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long idx;
+		_BitScanForward64(&idx, x);
+		return (int)idx;
+#elif defined(_MSC_VER)
+		unsigned long idx;
+		if (_BitScanForward(&idx, (unsigned long)x))
+			return (int)idx;
+		_BitScanForward(&idx, (unsigned long)(x >> 32));
+		return (int)idx + 32;
+#else
+		int n = 0;
+		while (!(x & 1)) { x >>= 1; n++; }
+		return n;
+#endif
+	}
+
+	// number of leading zero bits, x must not be 0
+	inline int countLeadingZeros(uint64_t x) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_clzll(x);
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+		unsigned long idx;
+		_BitScanReverse64(&idx, x);
+		return 63 - (int)idx;
+#elif defined(_MSC_VER)
+		unsigned long idx;
+		if (_BitScanReverse(&idx, (unsigned long)(x >> 32)))
+			return 31 - (int)idx;
+		_BitScanReverse(&idx, (unsigned long)x);
+		return 63 - (int)idx;
+#else
+		int n = 0;
+		while (!(x & (1ull << 63))) { x <<= 1; n++; }
+		return n;
+#endif
+	}
+
+	// number of set bits
+	inline int countSetBits(uint64_t x) noexcept
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_popcountll(x);
+#elif defined(_MSC_VER) && defined(_M_X64) && defined(__AVX__)
+		// popcnt is only guaranteed on cpus with avx
+		return (int)__popcnt64(x);
+#else
+		x = x - ((x >> 1) & 0x5555555555555555ull);
+		x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+		x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+		return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+	}
+
 	constexpr double degToRad = M_PI / 180.0;
 	constexpr double tau = M_PI * 2.0f;
 
@@ -0,0 +1,528 @@
+#include "memoryProfiler.hpp"
+#include "wob.hpp"
+#include "allocator.hpp"
+#include "utility.hpp"
+#include "thread.hpp"
+
+using namespace wob;
+
+static thread_local MemoryScope const* currentScope = nullptr;
+
+// fibonacci hashing, the low bits of addresses are mostly zeros
+static uint32_t hashIndex(uint64_t key, uint32_t mask) noexcept
+{
+	return (uint32_t)((key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+}
+
+static uint32_t roundUpPow2(uint32_t v) noexcept
+{
+	uint32_t r = 1;
+	while (r < v)
+		r <<= 1;
+	return r;
+}
+
+const char* wob::memoryTagName(MemoryTag tag) noexcept
+{
+	switch (tag)
+	{
+	case MemoryTag::Untagged: return "untagged";
+	case MemoryTag::Core: return "core";
+	case MemoryTag::Renderer: return "renderer";
+	case MemoryTag::UI: return "ui";
+	case MemoryTag::Lang: return "lang";
+	case MemoryTag::Spatial: return "spatial";
+	case MemoryTag::Assets: return "assets";
+	case MemoryTag::Game: return "game";
+	default: return "invalid";
+	}
+}
+
+MemoryScope::MemoryScope(MemoryTag tag_, source_location const& location_) noexcept
+	: tag(tag_), location(location_), previous(currentScope)
+{
+	currentScope = this;
+}
+
+MemoryScope::~MemoryScope()
+{
+	WOB_ASSERT_NOLOG(currentScope == this);
+	currentScope = previous;
+}
+
+MemoryScope const* MemoryScope::current() noexcept
+{
+	return currentScope;
+}
+
+void MemoryProfiler::Counters::add(int64_t size) noexcept
+{
+	int64_t const live = liveBytes.fetchAdd(size, MemoryOrder::Relaxed) + size;
+	int64_t peak = peakBytes.load(MemoryOrder::Relaxed);
+	while (live > peak && !peakBytes.compareExchange(peak, live, MemoryOrder::Relaxed))
+	{
+	}
+	liveCount.fetchAdd(1, MemoryOrder::Relaxed);
+	totalCount.fetchAdd(1, MemoryOrder::Relaxed);
+	totalBytes.fetchAdd(size, MemoryOrder::Relaxed);
+	frameCount.fetchAdd(1, MemoryOrder::Relaxed);
+	frameBytes.fetchAdd(size, MemoryOrder::Relaxed);
+}
+
+void MemoryProfiler::Counters::remove(int64_t size) noexcept
+{
+	liveBytes.fetchSub(size, MemoryOrder::Relaxed);
+	liveCount.fetchSub(1, MemoryOrder::Relaxed);
+}
+
+void MemoryProfiler::Counters::resize(int64_t oldSize, int64_t newSize) noexcept
+{
+	int64_t const live = liveBytes.fetchAdd(newSize - oldSize, MemoryOrder::Relaxed) + newSize - oldSize;
+	int64_t peak = peakBytes.load(MemoryOrder::Relaxed);
+	while (live > peak && !peakBytes.compareExchange(peak, live, MemoryOrder::Relaxed))
+	{
+	}
+}
+
+void MemoryProfiler::Counters::endFrame() noexcept
+{
+	lastFrameCount.store(frameCount.exchange(0, MemoryOrder::Relaxed), MemoryOrder::Relaxed);
+	lastFrameBytes.store(frameBytes.exchange(0, MemoryOrder::Relaxed), MemoryOrder::Relaxed);
+}
+
+MemoryStats MemoryProfiler::Counters::snapshot() const noexcept
+{
+	return MemoryStats{
+		liveBytes.load(MemoryOrder::Relaxed),
+		peakBytes.load(MemoryOrder::Relaxed),
+		liveCount.load(MemoryOrder::Relaxed),
+		totalCount.load(MemoryOrder::Relaxed),
+		totalBytes.load(MemoryOrder::Relaxed),
+		lastFrameCount.load(MemoryOrder::Relaxed),
+		lastFrameBytes.load(MemoryOrder::Relaxed)
+	};
+}
+
+MemoryProfiler::MemoryProfiler(IAllocator& base, uint32_t capacity, uint32_t callsiteCapacity) noexcept
+	: baseAllocator(&base), records(nullptr), callsites(nullptr), recordMask(0), callsiteMask(0), dropped(0), deletedRecords(0), tableUsers(0)
+{
+	uint32_t const recordCount = roundUpPow2(max(capacity, 16u));
+	uint32_t const callsiteCount = roundUpPow2(max(callsiteCapacity, 16u));
+
+	// keys start at emptyKey and counters at 0
+	records = static_cast<Record*>(base.allocate(sizeof(Record) * recordCount, alignof(Record)));
+	callsites = static_cast<Callsite*>(base.allocate(sizeof(Callsite) * callsiteCount, alignof(Callsite)));
+	WOB_ASSERT_NOLOG(records && callsites);
+	for (uint32_t i = 0; i < recordCount; i++)
+		new (records + i) Record{};
+	for (uint32_t i = 0; i < callsiteCount; i++)
+		new (callsites + i) Callsite{};
+	recordMask = recordCount - 1;
+	callsiteMask = callsiteCount - 1;
+}
+
+MemoryProfiler::~MemoryProfiler()
+{
+	baseAllocator->deallocate(records);
+	baseAllocator->deallocate(callsites);
+}
+
+MemoryProfiler& MemoryProfiler::instance() noexcept
+{
+	// the table itself lives on malloc, tracking it would recurse
+	alignas(MemoryProfiler) static uint8_t storage[sizeof(MemoryProfiler)];
+	static MemoryProfiler* const profiler = new (storage) MemoryProfiler(mallocator);
+	return *profiler;
+}
+
+uint32_t MemoryProfiler::findCallsite(MemoryTag tag, source_location const& location) noexcept
+{
+	uint64_t key = (uint64_t)(uintptr_t)location.file_name() * 31 + location.line();
+	key = key * 31 + (uint64_t)tag;
+	key |= 1;
+
+	uint32_t index = hashIndex(key, callsiteMask);
+	for (uint32_t probe = 0; probe <= callsiteMask; probe++)
+	{
+		Callsite& site = callsites[index];
+		uint64_t current = site.key.load(MemoryOrder::Acquire);
+		if (current == key)
+			return index;
+
+		if (current == 0)
+		{
+			if (site.key.compareExchange(current, key, MemoryOrder::AcqRel))
+			{
+				site.file = location.file_name();
+				site.function = location.function_name();
+				site.line = location.line();
+				site.tag = tag;
+				site.ready.store(1, MemoryOrder::Release);
+				return index;
+			}
+			// another thread claimed the slot, it may be our callsite
+			if (current == key)
+				return index;
+		}
+		index = (index + 1) & callsiteMask;
+	}
+	return npos;
+}
+
+MemoryProfiler::Record* MemoryProfiler::findRecord(void const* ptr) noexcept
+{
+	uintptr_t const key = (uintptr_t)ptr;
+	uint32_t index = hashIndex(key, recordMask);
+	for (uint32_t probe = 0; probe <= recordMask; probe++)
+	{
+		Record& record = records[index];
+		uintptr_t const current = record.key.load(MemoryOrder::Acquire);
+		if (current == key)
+			return &record;
+		if (current == emptyKey)
+			return nullptr;
+		index = (index + 1) & recordMask;
+	}
+	return nullptr;
+}
+
+void MemoryProfiler::addCounters(MemoryTag tag, uint32_t callsite, int64_t size) noexcept
+{
+	tags[(int)tag].add(size);
+	total.add(size);
+	if (callsite != npos)
+		callsites[callsite].counters.add(size);
+}
+
+void MemoryProfiler::removeCounters(MemoryTag tag, uint32_t callsite, int64_t size) noexcept
+{
+	tags[(int)tag].remove(size);
+	total.remove(size);
+	if (callsite != npos)
+		callsites[callsite].counters.remove(size);
+}
+
+void MemoryProfiler::enterTable() noexcept
+{
+	uint32_t users = tableUsers.load(MemoryOrder::Relaxed);
+	for (;;)
+	{
+		if (users & compactingBit)
+		{
+			Thread::yield();
+			users = tableUsers.load(MemoryOrder::Relaxed);
+		}
+		else if (tableUsers.compareExchange(users, users + 1, MemoryOrder::Acquire))
+		{
+			return;
+		}
+	}
+}
+
+void MemoryProfiler::leaveTable() noexcept
+{
+	tableUsers.fetchSub(1, MemoryOrder::Release);
+}
+
+void MemoryProfiler::compactIfNeeded() noexcept
+{
+	uint32_t const capacity = recordMask + 1;
+	if (deletedRecords.load(MemoryOrder::Relaxed) < capacity / 4)
+		return;
+
+	// new users wait once the bit is set, the ones already in finish their call
+	uint32_t users = tableUsers.load(MemoryOrder::Relaxed);
+	do
+	{
+		if (users & compactingBit)
+			return;
+	} while (!tableUsers.compareExchange(users, users | compactingBit, MemoryOrder::Acquire));
+	while (tableUsers.load(MemoryOrder::Acquire) != compactingBit)
+		Thread::yield();
+
+	// checked again, another thread may have compacted while we were waiting for the bit
+	if (deletedRecords.load(MemoryOrder::Relaxed) >= capacity / 4)
+	{
+		uint32_t start = npos;
+		for (uint32_t i = 0; i < capacity; i++)
+		{
+			if (records[i].key.load(MemoryOrder::Relaxed) == deletedKey)
+				records[i].key.store(emptyKey, MemoryOrder::Relaxed);
+			if (start == npos && records[i].key.load(MemoryOrder::Relaxed) == emptyKey)
+				start = i;
+		}
+
+		// walking from a free slot, every record is moved to the first free slot of its probe sequence
+		for (uint32_t n = 1; start != npos && n <= capacity; n++)
+		{
+			Record& record = records[(start + n) & recordMask];
+			uintptr_t const key = record.key.load(MemoryOrder::Relaxed);
+			if (key == emptyKey)
+				continue;
+
+			record.key.store(emptyKey, MemoryOrder::Relaxed);
+			uint32_t index = hashIndex(key, recordMask);
+			while (records[index].key.load(MemoryOrder::Relaxed) != emptyKey)
+				index = (index + 1) & recordMask;
+			Record& moved = records[index];
+			if (&moved != &record)
+			{
+				moved.size.store(record.size.load(MemoryOrder::Relaxed), MemoryOrder::Relaxed);
+				moved.align = record.align;
+				moved.callsite = record.callsite;
+				moved.tag = record.tag;
+			}
+			moved.key.store(key, MemoryOrder::Relaxed);
+		}
+		deletedRecords.store(0, MemoryOrder::Relaxed);
+	}
+	tableUsers.fetchSub(compactingBit, MemoryOrder::Release);
+}
+
+bool MemoryProfiler::insertRecord(void const* ptr, uint64_t size, uint32_t align, MemoryTag tag, uint32_t callsite) noexcept
+{
+	// free and deleted slots are claimed as busy while the record is written, lookups skip them
+	enterTable();
+	uint32_t index = hashIndex((uintptr_t)ptr, recordMask);
+	for (uint32_t probe = 0; probe <= recordMask; probe++)
+	{
+		Record& record = records[index];
+		uintptr_t current = record.key.load(MemoryOrder::Relaxed);
+		if ((current == emptyKey || current == deletedKey) && record.key.compareExchange(current, busyKey, MemoryOrder::Acquire))
+		{
+			if (current == deletedKey)
+				deletedRecords.fetchSub(1, MemoryOrder::Relaxed);
+			record.size.store(size, MemoryOrder::Relaxed);
+			record.align = align;
+			record.callsite = callsite;
+			record.tag = tag;
+			record.key.store((uintptr_t)ptr, MemoryOrder::Release);
+			leaveTable();
+			return true;
+		}
+		index = (index + 1) & recordMask;
+	}
+	leaveTable();
+	return false;
+}
+
+void MemoryProfiler::track(void const* ptr, uint64_t size, uint32_t align, MemoryTag tag, uint32_t callsite) noexcept
+{
+	addCounters(tag, callsite, (int64_t)size);
+	if (insertRecord(ptr, size, align, tag, callsite))
+		return;
+
+	// the counters stay consistent, the block just can't be freed from them
+	dropped.fetchAdd(1, MemoryOrder::Relaxed);
+	removeCounters(tag, callsite, (int64_t)size);
+}
+
+void MemoryProfiler::untrack(Record& record) noexcept
+{
+	removeCounters(record.tag, record.callsite, (int64_t)record.size.load(MemoryOrder::Relaxed));
+	markDeleted(record);
+}
+
+void MemoryProfiler::markDeleted(Record& record) noexcept
+{
+	// only the owner of a block frees it, no need to compare exchange
+	record.key.store(deletedKey, MemoryOrder::Release);
+	deletedRecords.fetchAdd(1, MemoryOrder::Relaxed);
+}
+
+void MemoryProfiler::profileAlloc(void const* ptr, size_t size, size_t align) noexcept
+{
+	MemoryScope const* const scope = currentScope;
+	if (scope)
+		profileAlloc(ptr, size, align, scope->tag, scope->location);
+	else
+		profileAlloc(ptr, size, align, MemoryTag::Untagged, source_location());
+}
+
+void MemoryProfiler::profileAlloc(void const* ptr, size_t size, size_t align, MemoryTag tag, source_location const& location) noexcept
+{
+	if (ptr == nullptr)
+		return;
+	WOB_ASSERT_NOLOG(tag < MemoryTag::Count);
+	track(ptr, size, (uint32_t)align, tag, findCallsite(tag, location));
+}
+
+void MemoryProfiler::profileDealloc(void const* ptr) noexcept
+{
+	if (ptr == nullptr)
+		return;
+	enterTable();
+	if (Record* const record = findRecord(ptr))
+		untrack(*record);
+	leaveTable();
+	compactIfNeeded();
+}
+
+void MemoryProfiler::profileResize(void const* ptr, size_t newSize) noexcept
+{
+	enterTable();
+	if (Record* const record = findRecord(ptr))
+	{
+		int64_t const oldSize = (int64_t)record->size.load(MemoryOrder::Relaxed);
+		tags[(int)record->tag].resize(oldSize, (int64_t)newSize);
+		total.resize(oldSize, (int64_t)newSize);
+		if (record->callsite != npos)
+			callsites[record->callsite].counters.resize(oldSize, (int64_t)newSize);
+		record->size.store(newSize, MemoryOrder::Relaxed);
+	}
+	leaveTable();
+}
+
+MemoryProfiler::ReallocRecord MemoryProfiler::profileReallocBegin(void const* oldPtr) noexcept
+{
+	ReallocRecord moved{ oldPtr, 0, 0, npos, MemoryTag::Untagged, false };
+	if (!oldPtr)
+		return moved;
+
+	enterTable();
+	if (Record* const record = findRecord(oldPtr))
+	{
+		moved.size = record->size.load(MemoryOrder::Relaxed);
+		moved.align = record->align;
+		moved.callsite = record->callsite;
+		moved.tag = record->tag;
+		moved.tracked = true;
+		// the counters still hold the block, only the address is released
+		markDeleted(*record);
+	}
+	leaveTable();
+	return moved;
+}
+
+void MemoryProfiler::profileReallocEnd(ReallocRecord const& moved, void const* newPtr, size_t newSize, size_t align) noexcept
+{
+	if (!moved.tracked)
+	{
+		profileAlloc(newPtr, newSize, align);
+		return;
+	}
+
+	if (newPtr == nullptr)
+	{
+		// the old block is still alive
+		if (!insertRecord(moved.ptr, moved.size, moved.align, moved.tag, moved.callsite))
+		{
+			dropped.fetchAdd(1, MemoryOrder::Relaxed);
+			removeCounters(moved.tag, moved.callsite, (int64_t)moved.size);
+		}
+		return;
+	}
+
+	if (newPtr == moved.ptr)
+	{
+		// resized in place
+		tags[(int)moved.tag].resize((int64_t)moved.size, (int64_t)newSize);
+		total.resize((int64_t)moved.size, (int64_t)newSize);
+		if (moved.callsite != npos)
+			callsites[moved.callsite].counters.resize((int64_t)moved.size, (int64_t)newSize);
+		if (!insertRecord(newPtr, newSize, (uint32_t)align, moved.tag, moved.callsite))
+		{
+			dropped.fetchAdd(1, MemoryOrder::Relaxed);
+			removeCounters(moved.tag, moved.callsite, (int64_t)newSize);
+		}
+		return;
+	}
+
+	// a moved block counts as a new allocation
+	removeCounters(moved.tag, moved.callsite, (int64_t)moved.size);
+	track(newPtr, newSize, (uint32_t)align, moved.tag, moved.callsite);
+}
+
+void MemoryProfiler::beginFrame() noexcept
+{
+	for (Counters& counters : tags)
+		counters.endFrame();
+	total.endFrame();
+	for (uint32_t i = 0; i <= callsiteMask; i++)
+	{
+		if (callsites[i].key.load(MemoryOrder::Relaxed) != 0)
+			callsites[i].counters.endFrame();
+	}
+}
+
+MemoryStats MemoryProfiler::tagStats(MemoryTag tag) const noexcept
+{
+	WOB_ASSERT_NOLOG(tag < MemoryTag::Count);
+	return tags[(int)tag].snapshot();
+}
+
+MemoryStats MemoryProfiler::totalStats() const noexcept
+{
+	return total.snapshot();
+}
+
+bool MemoryProfiler::getCallsite(uint32_t slot, MemoryCallsite& out) const noexcept
+{
+	WOB_ASSERT_NOLOG(slot <= callsiteMask);
+	Callsite const& site = callsites[slot];
+	if (site.ready.load(MemoryOrder::Acquire) == 0)
+		return false;
+
+	out.file = site.file;
+	out.function = site.function;
+	out.line = site.line;
+	out.tag = site.tag;
+	out.stats = site.counters.snapshot();
+	return true;
+}
+
+void MemoryProfiler::logReport() const noexcept
+{
+	MemoryStats const all = totalStats();
+	WOB_LOG("memory : {} bytes live in {} allocations, peak {} bytes, {} allocations last frame, {} untracked",
+		all.liveBytes, all.liveCount, all.peakBytes, all.lastFrameCount, droppedCount());
+
+	for (int i = 0; i < (int)MemoryTag::Count; i++)
+	{
+		MemoryStats const stats = tags[i].snapshot();
+		if (stats.totalCount == 0)
+			continue;
+		WOB_LOG_RAW("  {} : {} bytes live in {} allocations, peak {} bytes, {} allocations / {} bytes last frame",
+			memoryTagName((MemoryTag)i), stats.liveBytes, stats.liveCount, stats.peakBytes, stats.lastFrameCount, stats.lastFrameBytes);
+	}
+
+	for (uint32_t i = 0; i <= callsiteMask; i++)
+	{
+		MemoryCallsite site;
+		if (!getCallsite(i, site) || site.stats.liveCount == 0)
+			continue;
+		WOB_LOG_RAW("  {}:{} {} ({}) : {} bytes live in {} allocations, peak {} bytes, {} allocations last frame",
+			site.line ? site.file : "unknown", site.line, site.function, memoryTagName(site.tag),
+			site.stats.liveBytes, site.stats.liveCount, site.stats.peakBytes, site.stats.lastFrameCount);
+	}
+}
+
+uint32_t MemoryProfiler::dumpLeaks() const noexcept
+{
+	// not guarded against a compaction, logging may allocate and enter the table again
+	uint32_t leaks = 0;
+	for (uint32_t i = 0; i <= recordMask; i++)
+	{
+		Record const& record = records[i];
+		uintptr_t const key = record.key.load(MemoryOrder::Acquire);
+		if (key == emptyKey || key == busyKey || key == deletedKey)
+			continue;
+
+		uint64_t const size = record.size.load(MemoryOrder::Relaxed);
+		leaks++;
+		if (record.callsite != npos && callsites[record.callsite].line != 0)
+		{
+			Callsite const& site = callsites[record.callsite];
+			WOB_WARN("leak : {} bytes at {} allocated in {}:{} {} ({})", size, (uint64_t)key,
+				site.file, site.line, site.function, memoryTagName(record.tag));
+		}
+		else
+		{
+			WOB_WARN("leak : {} bytes at {} ({})", size, (uint64_t)key, memoryTagName(record.tag));
+		}
+	}
+
+	if (leaks)
+		WOB_WARN("{} allocations leaked", leaks);
+	return leaks;
+}
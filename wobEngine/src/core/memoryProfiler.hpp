@@ -0,0 +1,237 @@
+#ifndef WOB_MEMORY_PROFILER_HPP
+#define WOB_MEMORY_PROFILER_HPP
+
+#include "macro_helpers.hpp"
+#include "atomic.hpp"
+#include "debug.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+// WOB_MEMORY_SCOPE tags the allocations made in the enclosing scope and attribute them to the scope callsite
+// it is kept in every build, the steady frame check (steadyFrame.hpp) reports violations with the scope tag and callsite
+#define WOB_MEMORY_SCOPE(tag) ::wob::MemoryScope WOB_CONCAT(WOB_internal_memory_scope_, __COUNTER__)(tag);
+
+// allocations of the context allocator are tracked when WOB_ENABLE_PROFILING is defined (xmake option --profiling=y)
+#ifdef WOB_ENABLE_PROFILING
+
+#define WOB_MEMORY_FRAME() ::wob::MemoryProfiler::instance().beginFrame()
+#define WOB_MEMORY_REPORT() ::wob::MemoryProfiler::instance().logReport()
+#define WOB_MEMORY_DUMP_LEAKS() ::wob::MemoryProfiler::instance().dumpLeaks()
+
+#else
+
+#define WOB_MEMORY_FRAME()
+#define WOB_MEMORY_REPORT()
+#define WOB_MEMORY_DUMP_LEAKS()
+
+#endif
+
+namespace wob
+{
+	class IAllocator;
+
+	// subsystem owning an allocation
+	enum class MemoryTag : uint8_t
+	{
+		Untagged,
+		Core,
+		Renderer,
+		UI,
+		Lang,
+		Spatial,
+		Assets,
+		Game,
+		Count
+	};
+
+	[[nodiscard]] const char* memoryTagName(MemoryTag tag) noexcept;
+
+	// snapshot of the counters of a tag or a callsite
+	struct MemoryStats
+	{
+		int64_t liveBytes;
+		int64_t peakBytes;
+		int64_t liveCount;
+		// since the profiler was created
+		int64_t totalCount;
+		int64_t totalBytes;
+		// allocations made during the last completed frame (see MemoryProfiler::beginFrame)
+		int64_t lastFrameCount;
+		int64_t lastFrameBytes;
+	};
+
+	struct MemoryCallsite
+	{
+		const char* file;
+		const char* function;
+		uint32_t line;
+		MemoryTag tag;
+		MemoryStats stats;
+	};
+
+	/*
+	 * Tag and callsite of the allocations made on this thread while the scope is alive, scopes nest.
+	 * The callsite is where the scope is declared, allocations outside any scope are untagged with an unknown callsite.
+	 */
+	class MemoryScope
+	{
+	public:
+		explicit MemoryScope(MemoryTag tag, source_location const& location = source_location::current()) noexcept;
+		~MemoryScope();
+
+		MemoryScope(MemoryScope const&) = delete;
+		MemoryScope& operator=(MemoryScope const&) = delete;
+
+		[[nodiscard]] static MemoryScope const* current() noexcept;
+
+		MemoryTag tag;
+		source_location location;
+
+	private:
+		MemoryScope const* previous;
+	};
+
+	/*
+	 * Record of every live allocation (size, alignment, tag, callsite) in a fixed size lock free open addressing table keyed by address,
+	 * with live bytes, peak bytes and per frame allocation counts aggregated by tag and by callsite.
+	 * Allocators report to it with profileAlloc / profileDealloc, AllocatorProfiler does it for the context allocator.
+	 * Every call is wait free apart from the probing, tables are sized at construction and never grow :
+	 * when a table is full the allocation isn't tracked and droppedCount is incremented.
+	 * Freed records leave deleted slots that lookups probe past, once they fill a quarter of the table
+	 * it is rehashed in place, the calls made meanwhile wait for it.
+	 */
+	class MemoryProfiler
+	{
+	public:
+		// capacity is the number of live allocations that can be tracked, keep it about twice the expected peak
+		explicit MemoryProfiler(IAllocator& base, uint32_t capacity = 1 << 16, uint32_t callsiteCapacity = 1024) noexcept;
+		~MemoryProfiler();
+
+		MemoryProfiler(MemoryProfiler const&) = delete;
+		MemoryProfiler& operator=(MemoryProfiler const&) = delete;
+
+		// profiler of the context allocator, never destroyed so allocations freed by static destructors are still seen
+		[[nodiscard]] static MemoryProfiler& instance() noexcept;
+
+		// tag and callsite come from the current MemoryScope
+		void profileAlloc(void const* ptr, size_t size, size_t align) noexcept;
+		void profileAlloc(void const* ptr, size_t size, size_t align, MemoryTag tag, source_location const& location) noexcept;
+		// untracked pointers are ignored
+		void profileDealloc(void const* ptr) noexcept;
+		// block resized in place, keeps its tag and callsite
+		void profileResize(void const* ptr, size_t newSize) noexcept;
+
+		// record of a block being reallocated, taken out of the table until the reallocation is done
+		struct ReallocRecord
+		{
+			void const* ptr;
+			uint64_t size;
+			uint32_t align;
+			uint32_t callsite;
+			MemoryTag tag;
+			bool tracked;
+		};
+
+		// call before freeing oldPtr, once freed its address can be tracked again by another thread
+		[[nodiscard]] ReallocRecord profileReallocBegin(void const* oldPtr) noexcept;
+		// the block keeps its tag and callsite, a null newPtr (failed reallocation) puts the old record back
+		void profileReallocEnd(ReallocRecord const& moved, void const* newPtr, size_t newSize, size_t align) noexcept;
+
+		// start a new frame, the counts of the frame that ends become lastFrameCount / lastFrameBytes
+		void beginFrame() noexcept;
+
+		[[nodiscard]] MemoryStats tagStats(MemoryTag tag) const noexcept;
+		[[nodiscard]] MemoryStats totalStats() const noexcept;
+		[[nodiscard]] uint32_t callsiteCapacity() const noexcept { return callsiteMask + 1; }
+		// false if the slot holds no callsite
+		[[nodiscard]] bool getCallsite(uint32_t slot, MemoryCallsite& out) const noexcept;
+		[[nodiscard]] uint32_t droppedCount() const noexcept { return dropped.load(MemoryOrder::Relaxed); }
+		[[nodiscard]] uint32_t deletedRecordCount() const noexcept { return deletedRecords.load(MemoryOrder::Relaxed); }
+
+		// log every tag and callsite owning memory
+		void logReport() const noexcept;
+		// log the live allocations and return their count, call it at shutdown once everything should be freed
+		uint32_t dumpLeaks() const noexcept;
+
+	private:
+		struct Counters
+		{
+			void add(int64_t size) noexcept;
+			void remove(int64_t size) noexcept;
+			void resize(int64_t oldSize, int64_t newSize) noexcept;
+			void endFrame() noexcept;
+			MemoryStats snapshot() const noexcept;
+
+			Atomic<int64_t> liveBytes;
+			Atomic<int64_t> peakBytes;
+			Atomic<int64_t> liveCount;
+			Atomic<int64_t> totalCount;
+			Atomic<int64_t> totalBytes;
+			Atomic<int64_t> frameCount;
+			Atomic<int64_t> frameBytes;
+			Atomic<int64_t> lastFrameCount;
+			Atomic<int64_t> lastFrameBytes;
+		};
+
+		// key is the block address, or one of the states below
+		struct Record
+		{
+			Atomic<uintptr_t> key;
+			// resized in place by the owner while another thread may dump the leaks
+			Atomic<uint64_t> size;
+			uint32_t align;
+			// npos if the callsite table was full
+			uint32_t callsite;
+			MemoryTag tag;
+		};
+
+		struct Callsite
+		{
+			// hash of file, line and tag, 0 when free
+			Atomic<uint64_t> key;
+			// set once file, function, line and tag are written
+			Atomic<uint32_t> ready;
+			const char* file;
+			const char* function;
+			uint32_t line;
+			MemoryTag tag;
+			Counters counters;
+		};
+
+		static constexpr uintptr_t emptyKey = 0;
+		static constexpr uintptr_t busyKey = 1;
+		static constexpr uintptr_t deletedKey = 2;
+		static constexpr uint32_t npos = ~0u;
+		// tableUsers bit set while the records are rehashed, the other bits count the calls using the table
+		static constexpr uint32_t compactingBit = 1u << 31;
+
+		uint32_t findCallsite(MemoryTag tag, source_location const& location) noexcept;
+		Record* findRecord(void const* ptr) noexcept;
+		void track(void const* ptr, uint64_t size, uint32_t align, MemoryTag tag, uint32_t callsite) noexcept;
+		// write the record only, false if the table is full
+		bool insertRecord(void const* ptr, uint64_t size, uint32_t align, MemoryTag tag, uint32_t callsite) noexcept;
+		void addCounters(MemoryTag tag, uint32_t callsite, int64_t size) noexcept;
+		void removeCounters(MemoryTag tag, uint32_t callsite, int64_t size) noexcept;
+		void untrack(Record& record) noexcept;
+		void markDeleted(Record& record) noexcept;
+
+		// every access to the records goes between them, they must not nest
+		void enterTable() noexcept;
+		void leaveTable() noexcept;
+		// rehash the records once enough slots are deleted, call it outside of enterTable / leaveTable
+		void compactIfNeeded() noexcept;
+
+		IAllocator* baseAllocator;
+		Record* records;
+		Callsite* callsites;
+		uint32_t recordMask;
+		uint32_t callsiteMask;
+		Atomic<uint32_t> dropped;
+		Atomic<uint32_t> deletedRecords;
+		Atomic<uint32_t> tableUsers;
+		Counters tags[(int)MemoryTag::Count];
+		Counters total;
+	};
+}
+
+#endif
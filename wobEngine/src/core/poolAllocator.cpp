@@ -0,0 +1,147 @@
+#include "poolAllocator.hpp"
+#include "wob.hpp"
+#include "utility.hpp"
+#include <string.h>
+
+using namespace wob;
+
+FixedBlockAllocator::FixedBlockAllocator(IAllocator& base, size_t blockSize_, size_t blockAlign, uint32_t blocksPerChunk_) noexcept
+	: baseAllocator(&base), freeList(nullptr), chunks(nullptr), cursor(nullptr), cursorEnd(nullptr),
+	blocksPerChunk(blocksPerChunk_), chunkCount(0), liveCount(0)
+{
+	WOB_ASSERT(isPowerOf2(blockAlign));
+	WOB_ASSERT(blocksPerChunk > 0);
+	// a free block holds the free list link
+	align = max(blockAlign, alignof(FreeBlock));
+	stride = wob::align(max(blockSize_, sizeof(FreeBlock)), (uint32_t)align);
+	chunkHeader = wob::align(sizeof(Chunk), (uint32_t)align);
+}
+
+FixedBlockAllocator::~FixedBlockAllocator()
+{
+	release();
+}
+
+void* FixedBlockAllocator::allocate(size_t size, size_t alignment)
+{
+	WOB_ASSERT(size <= stride && alignment <= align);
+	WOB_UNUSED(size);
+	WOB_UNUSED(alignment);
+
+	void* block;
+	if (freeList)
+	{
+		block = freeList;
+		freeList = freeList->next;
+		checkPoison(block);
+	}
+	else if (cursor != cursorEnd)
+	{
+		block = cursor;
+		cursor += stride;
+	}
+	else
+	{
+		block = allocateFromNewChunk();
+		if (!block)
+			return nullptr;
+	}
+
+	liveCount++;
+	return block;
+}
+
+void FixedBlockAllocator::deallocate(void* ptr)
+{
+	if (!ptr)
+		return;
+
+	WOB_ASSERT(liveCount > 0);
+	poison(ptr);
+	FreeBlock* const block = static_cast<FreeBlock*>(ptr);
+	block->next = freeList;
+	freeList = block;
+	liveCount--;
+}
+
+bool FixedBlockAllocator::tryExpandInPlace(void* ptr, size_t newSize)
+{
+	WOB_UNUSED(ptr);
+	return newSize <= stride;
+}
+
+void* FixedBlockAllocator::allocateFromNewChunk() noexcept
+{
+	uint8_t* const memory = static_cast<uint8_t*>(baseAllocator->allocate(chunkHeader + stride * blocksPerChunk, align));
+	if (!memory)
+		return nullptr;
+
+	Chunk* const chunk = reinterpret_cast<Chunk*>(memory);
+	chunk->next = chunks;
+	chunks = chunk;
+	chunkCount++;
+
+	cursor = memory + chunkHeader + stride;
+	cursorEnd = memory + chunkHeader + stride * blocksPerChunk;
+	return memory + chunkHeader;
+}
+
+void FixedBlockAllocator::reset() noexcept
+{
+	freeList = nullptr;
+	cursor = cursorEnd = nullptr;
+	liveCount = 0;
+
+	// rebuild the free list in address order, chunk by chunk
+	FreeBlock** tail = &freeList;
+	for (Chunk* chunk = chunks; chunk; chunk = chunk->next)
+	{
+		uint8_t* const first = reinterpret_cast<uint8_t*>(chunk) + chunkHeader;
+		for (uint32_t i = 0; i < blocksPerChunk; i++)
+		{
+			FreeBlock* const block = reinterpret_cast<FreeBlock*>(first + i * stride);
+			poison(block);
+			*tail = block;
+			tail = &block->next;
+		}
+	}
+	*tail = nullptr;
+}
+
+void FixedBlockAllocator::release() noexcept
+{
+	Chunk* chunk = chunks;
+	while (chunk)
+	{
+		Chunk* const next = chunk->next;
+		baseAllocator->deallocate(chunk);
+		chunk = next;
+	}
+
+	chunks = nullptr;
+	freeList = nullptr;
+	cursor = cursorEnd = nullptr;
+	chunkCount = 0;
+	liveCount = 0;
+}
+
+void FixedBlockAllocator::poison(void* block) noexcept
+{
+#ifdef WOB_DEBUG
+	memset(block, freePoison, stride);
+#else
+	WOB_UNUSED(block);
+#endif
+}
+
+// the first bytes hold the free list link, the rest must still be poisoned
+void FixedBlockAllocator::checkPoison(void const* block) noexcept
+{
+#ifdef WOB_DEBUG
+	uint8_t const* const bytes = static_cast<uint8_t const*>(block);
+	for (size_t i = sizeof(FreeBlock); i < stride; i++)
+		WOB_ASSERTF(bytes[i] == freePoison, "pool block at {} written after free", (uint64_t)(uintptr_t)block);
+#else
+	WOB_UNUSED(block);
+#endif
+}
@@ -0,0 +1,84 @@
+#ifndef WOB_POOL_ALLOCATOR_HPP
+#define WOB_POOL_ALLOCATOR_HPP
+
+#include "allocator.hpp"
+
+namespace wob
+{
+	/*
+	 * Allocator of fixed size blocks carved from chunks of blocksPerChunk blocks.
+	 * Freed blocks go on an intrusive free list, allocate and deallocate are O(1).
+	 * Requests bigger than the block size or more aligned than the block alignment are errors.
+	 * reset frees every block at once and keeps the chunks, release gives the chunks back to the base allocator,
+	 * neither call destructors.
+	 * In debug freed blocks are poisoned and checked when reused to catch writes after free.
+	 * Not thread safe.
+	 */
+	class FixedBlockAllocator : public IAllocator
+	{
+	public:
+		FixedBlockAllocator(IAllocator& base, size_t blockSize, size_t blockAlign, uint32_t blocksPerChunk = 256) noexcept;
+		~FixedBlockAllocator() override;
+
+		FixedBlockAllocator(FixedBlockAllocator const&) = delete;
+		FixedBlockAllocator& operator=(FixedBlockAllocator const&) = delete;
+
+		[[nodiscard]] void* allocate(size_t size, size_t align) override;
+		void deallocate(void* ptr) override;
+		// succeed as long as newSize fit in the block
+		[[nodiscard]] bool tryExpandInPlace(void* ptr, size_t newSize) override;
+
+		// every block becomes free, chunks are kept for reuse
+		void reset() noexcept;
+		// every block becomes free, chunks are deallocated
+		void release() noexcept;
+
+		[[nodiscard]] size_t blockSize() const noexcept { return stride; }
+		[[nodiscard]] uint32_t allocatedCount() const noexcept { return liveCount; }
+		[[nodiscard]] uint32_t capacity() const noexcept { return chunkCount * blocksPerChunk; }
+
+	private:
+		struct FreeBlock
+		{
+			FreeBlock* next;
+		};
+
+		struct Chunk
+		{
+			Chunk* next;
+		};
+
+		static constexpr uint8_t freePoison = 0xDD;
+
+		void* allocateFromNewChunk() noexcept;
+		void poison(void* block) noexcept;
+		void checkPoison(void const* block) noexcept;
+
+		IAllocator* baseAllocator;
+		FreeBlock* freeList;
+		Chunk* chunks;
+		// unused tail of the last chunk, blocks are carved lazily so a new chunk isn't touched all at once
+		uint8_t* cursor;
+		uint8_t* cursorEnd;
+		size_t stride;
+		size_t align;
+		size_t chunkHeader;
+		uint32_t blocksPerChunk;
+		uint32_t chunkCount;
+		uint32_t liveCount;
+	};
+
+	// pool of T sized blocks, T is constructed with create and destroyed with destroy
+	template<typename T>
+	class PoolAllocator final : public FixedBlockAllocator
+	{
+	public:
+		explicit PoolAllocator(IAllocator& base, uint32_t blocksPerChunk = 256) noexcept
+			: FixedBlockAllocator(base, sizeof(T), alignof(T), blocksPerChunk)
+		{
+
+		}
+	};
+}
+
+#endif
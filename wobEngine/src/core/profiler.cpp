@@ -1,14 +1,46 @@
 #include "profiler.hpp"
 
 #include "wob.hpp"
-#include "hashmap.hpp"
+#include "atomic.hpp"
+#include "thread.hpp"
+#include "time.hpp"
+#include "stringBuilder.hpp"
+#include "stringView.hpp"
+#include <stdio.h>
 
 using namespace wob;
 
-wob::ProfileScope* wob::ProfileScope::last = nullptr;
-
 namespace wob
 {
+	// events of one thread, only written by that thread while a session is running
+	// the profile of an exited thread is kept until its events are collected then reused by a new thread
+	struct ThreadProfile
+	{
+		explicit ThreadProfile(uint32_t index_) noexcept : events(mallocator), next(nullptr), name(nullptr), index(index_), depth(0), session(0), exited(false)
+		{
+
+		}
+
+		// events of a previous session are dropped the first time the thread records in a new one
+		void enterSession(uint32_t id) noexcept
+		{
+			if (session == id)
+				return;
+			events.clear();
+			depth = 0;
+			session = id;
+		}
+
+		Array<ProfileEvent> events;
+		ThreadProfile* next;
+		const char* name;
+		uint32_t index;
+		uint32_t depth;
+		uint32_t session;
+		// guarded by the instrumentor lock
+		bool exited;
+	};
+
 	class Instrumentor
 	{
 	public:
@@ -22,11 +54,47 @@ namespace wob
 		void startSession(const char* name);
 		ProfileSession stopSession();
 
-		void updateProfileData(ProfileData const& data);
+		// 0 when no session is running
+		uint32_t activeSession() const noexcept { return currentSession.load(MemoryOrder::Relaxed); }
+
+		ThreadProfile& threadProfile() noexcept;
+		// called at thread exit, the profile is reused once no session needs its events
+		void releaseThreadProfile() noexcept;
+		void setThreadName(const char* name) noexcept;
+
+		uint32_t profileCount() noexcept;
 
 	private:
-		ProfileSession currentSession;
-		//std::chrono::time_point<std::chrono::high_resolution_clock> sessionStartPoint;
+		void lock() noexcept;
+		void unlock() noexcept;
+		void collect(ThreadProfile& profile, long long end, ProfileSession& session) noexcept;
+
+		static thread_local ThreadProfile* current;
+		static thread_local const char* currentName;
+		static thread_local bool released;
+
+		Atomic<uint32_t> currentSession{ 0 };
+		uint32_t sessionCounter = 0;
+		const char* sessionName = nullptr;
+		long long sessionStart = 0;
+
+		Atomic<uint32_t> locked{ 0 };
+		ThreadProfile* firstProfile = nullptr;
+		ThreadProfile* lastProfile = nullptr;
+		uint32_t threadCount = 0;
+	};
+
+	thread_local ThreadProfile* Instrumentor::current = nullptr;
+	thread_local const char* Instrumentor::currentName = nullptr;
+	thread_local bool Instrumentor::released = false;
+
+	// destroyed at thread exit, armed when the thread first gets a profile
+	struct ThreadProfileRelease
+	{
+		~ThreadProfileRelease()
+		{
+			Instrumentor::instance().releaseThreadProfile();
+		}
 	};
 
 	void startInstrumentorSession(const char* name) noexcept
@@ -39,69 +107,368 @@ namespace wob
 		return Instrumentor::instance().stopSession();
 	}
 
-	struct ProfilerImpl
+	void profileFrame(const char* name) noexcept
 	{
-		ProfilerImpl(IAllocator* alloc) : profileDatas(alloc, 32)
-		{
+		Instrumentor& instrumentor = Instrumentor::instance();
+		uint32_t const session = instrumentor.activeSession();
+		if (session == 0)
+			return;
 
-		}
+		ThreadProfile& profile = instrumentor.threadProfile();
+		profile.enterSession(session);
+		long long const now = getPerfCount();
+		profile.events.push(ProfileEvent{ name, now, now, ProfileEvent::frameMarker, profile.index });
+	}
 
-		HashMap<const char*, ProfileData> profileDatas;
-	};
+	void setProfilerThreadName(const char* name) noexcept
+	{
+		Instrumentor::instance().setThreadName(name);
+	}
 
-	static Mallocator profStaticAllocator;
+	uint32_t profilerThreadCount() noexcept
+	{
+		return Instrumentor::instance().profileCount();
+	}
+
+	const char* currentProfileScope() noexcept
+	{
+		Instrumentor& instrumentor = Instrumentor::instance();
+		uint32_t const session = instrumentor.activeSession();
+		if (session == 0)
+			return nullptr;
+
+		ThreadProfile& profile = instrumentor.threadProfile();
+		if (profile.session != session || profile.depth == 0)
+			return nullptr;
+
+		// the innermost open scope is the last event of the current depth still running
+		for (uint32_t i = profile.events.size(); i-- > 0;)
+		{
+			ProfileEvent const& event = profile.events[i];
+			if (event.depth == profile.depth - 1 && event.end == 0)
+				return event.name;
+		}
+		return nullptr;
+	}
 
 	ProfileSession::ProfileSession() noexcept
+		: name(nullptr), elapsedSessionTime(0.0), frameCount(0), startCount(0),
+		profileDatas(mallocator), events(mallocator), threadNames(mallocator)
 	{
-		impl = profStaticAllocator.create<ProfilerImpl>(&profStaticAllocator);
+
 	}
 
 	ProfileSession::ProfileSession(const char* name_, ProfileTime_t elapsed) noexcept
+		: name(name_), elapsedSessionTime(elapsed), frameCount(0), startCount(0),
+		profileDatas(mallocator), events(mallocator), threadNames(mallocator)
 	{
-		name = name_;
-		elapsedSessionTime = elapsed;
-		impl = profStaticAllocator.create<ProfilerImpl>(&profStaticAllocator);
+
 	}
 }
 
+void Instrumentor::lock() noexcept
+{
+	while (locked.exchange(1, MemoryOrder::Acquire))
+		Thread::yield();
+}
+
+void Instrumentor::unlock() noexcept
+{
+	locked.store(0, MemoryOrder::Release);
+}
+
+ThreadProfile& Instrumentor::threadProfile() noexcept
+{
+	if (current)
+		return *current;
+
+	lock();
+	// events of a running session are still needed even if their thread exited
+	uint32_t const session = activeSession();
+	for (ThreadProfile* profile = firstProfile; profile; profile = profile->next)
+	{
+		if (profile->exited && (session == 0 || profile->session != session))
+		{
+			profile->exited = false;
+			profile->events.clear();
+			profile->depth = 0;
+			profile->session = 0;
+			current = profile;
+			break;
+		}
+	}
+	if (!current)
+	{
+		current = mallocator.create<ThreadProfile>(threadCount++);
+		if (lastProfile)
+			lastProfile->next = current;
+		else
+			firstProfile = current;
+		lastProfile = current;
+	}
+	current->name = currentName;
+	unlock();
+
+	// a profile taken by a thread_local destructor after the release is never reused
+	if (!released)
+	{
+		thread_local ThreadProfileRelease release;
+		WOB_UNUSED(release);
+	}
+	return *current;
+}
+
+void Instrumentor::releaseThreadProfile() noexcept
+{
+	released = true;
+	if (!current)
+		return;
+	lock();
+	current->exited = true;
+	unlock();
+	current = nullptr;
+}
+
+void Instrumentor::setThreadName(const char* name) noexcept
+{
+	// no profile is created for a thread that never records anything
+	currentName = name;
+	if (current)
+		current->name = name;
+}
+
+uint32_t Instrumentor::profileCount() noexcept
+{
+	lock();
+	uint32_t const count = threadCount;
+	unlock();
+	return count;
+}
+
 void Instrumentor::startSession(const char* name)
 {
-	currentSession = ProfileSession(name, 0.0);
-	//sessionStartPoint = std::chrono::high_resolution_clock::now();
+	WOB_ASSERT(activeSession() == 0);
+	sessionName = name;
+	sessionStart = getPerfCount();
+	// never 0, it means no session
+	sessionCounter = sessionCounter + 1 == 0 ? 1 : sessionCounter + 1;
+	currentSession.store(sessionCounter);
 }
 
 ProfileSession Instrumentor::stopSession()
 {
-	//std::chrono::duration<ProfileTime_t, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - sessionStartPoint;
-	//currentSession.elapsedSessionTime = elapsed.count();
-	return currentSession;
+	long long const end = getPerfCount();
+	uint32_t const session = currentSession.exchange(0);
+
+	ProfileSession result(sessionName, perfCountToMs(sessionStart, end));
+	result.startCount = sessionStart;
+	if (session == 0)
+		return result;
+
+	lock();
+	for (ThreadProfile* profile = firstProfile; profile; profile = profile->next)
+	{
+		if (profile->session == session)
+			collect(*profile, end, result);
+	}
+	unlock();
+	return result;
 }
 
-void Instrumentor::updateProfileData(ProfileData const& data)
+// copy the events of a thread in the session and merge its scopes in the call tree
+void Instrumentor::collect(ThreadProfile& profile, long long end, ProfileSession& session) noexcept
 {
-	ProfileData* d = nullptr;
-	//if (currentSession.profileDatas.tryFind(data.name, d))
-	//{
-	//	d->elapsedTime += data.elapsedTime;
-	//	d->count++;
-	//	return;
-	//}
-	//currentSession.profileDatas[data.name] = data;
+	uint32_t const thread = session.threadNames.size();
+	session.threadNames.push(profile.name);
+
+	uint32_t stack[128];
+	uint32_t firstRoot = ProfileSession::npos;
+	uint32_t const firstEvent = session.events.size();
+	session.events.reserve(firstEvent + profile.events.size());
+
+	for (ProfileEvent event : profile.events)
+	{
+		event.thread = thread;
+		if (event.depth == ProfileEvent::frameMarker)
+		{
+			session.frameCount++;
+			session.events.push(event);
+			continue;
+		}
+
+		// still open when the session stopped
+		if (event.end == 0)
+			event.end = end;
+		session.events.push(event);
+
+		if (event.depth >= wob::size(stack))
+			continue;
+
+		uint32_t const parent = event.depth > 0 ? stack[event.depth - 1] : ProfileSession::npos;
+		uint32_t* link = parent != ProfileSession::npos ? &session.profileDatas[parent].firstChild : &firstRoot;
+		while (*link != ProfileSession::npos && session.profileDatas[*link].name != event.name)
+			link = &session.profileDatas[*link].nextSibling;
+
+		ProfileTime_t const elapsed = perfCountToMs(event.start, event.end);
+		if (*link == ProfileSession::npos)
+		{
+			*link = session.profileDatas.size();
+			session.profileDatas.push(ProfileData{
+				event.name,
+				parent != ProfileSession::npos ? session.profileDatas[parent].name : "none",
+				elapsed, elapsed, 1, event.depth, parent, ProfileSession::npos, ProfileSession::npos, thread });
+		}
+		else
+		{
+			ProfileData& data = session.profileDatas[*link];
+			data.elapsedTime += elapsed;
+			data.selfTime += elapsed;
+			data.count++;
+		}
+
+		if (parent != ProfileSession::npos)
+			session.profileDatas[parent].selfTime -= elapsed;
+		stack[event.depth] = *link;
+	}
 }
 
-ProfileScope::ProfileScope(const char* name_):
-	name(name_),
-	parent(last)
-	//start(std::chrono::high_resolution_clock::now())
+ProfileScope::ProfileScope(const char* name_) noexcept
+	: thread(nullptr), index(0), session(0)
 {
-	last = this;
+	Instrumentor& instrumentor = Instrumentor::instance();
+	session = instrumentor.activeSession();
+	if (session == 0)
+		return;
+
+	ThreadProfile& profile = instrumentor.threadProfile();
+	profile.enterSession(session);
+
+	thread = &profile;
+	index = profile.events.size();
+	profile.events.push(ProfileEvent{ name_, getPerfCount(), 0, profile.depth, profile.index });
+	profile.depth++;
 }
 
-ProfileScope::~ProfileScope()
+ProfileScope::~ProfileScope() noexcept
 {
-	//std::chrono::duration<ProfileTime_t, std::milli> const elapsed = std::chrono::high_resolution_clock::now() - start;
+	if (!thread)
+		return;
+
+	long long const end = getPerfCount();
+	// a new session started inside the scope and cleared the events
+	if (thread->session != session)
+		return;
+
+	thread->events[index].end = end;
+	thread->depth--;
+}
 
-	//Instrumentor::instance().updateProfileData(ProfileData{name, parent != nullptr ? parent->name : "none", elapsed.count()});
-	if (last == this)
-		last = last->parent;
+static void appendJsonString(StringBuilder& out, const char* str)
+{
+	out.append('"');
+	for (const char* c = str ? str : ""; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			out.append('\\');
+		if ((unsigned char)*c >= 0x20)
+			out.append(*c);
+	}
+	out.append('"');
+}
+
+static bool flushTo(FILE* file, StringBuilder& out)
+{
+	bool const written = fwrite(out.data(), 1, out.size(), file) == out.size();
+	out.clear();
+	return written;
+}
+
+bool ProfileSession::exportChromeTrace(const char* path) const noexcept
+{
+	FILE* const file = fopen(path, "wb");
+	if (!file)
+	{
+		WOB_LOG_ERROR("failed to open {}", path);
+		return false;
+	}
+
+	double const toUs = 1'000'000.0 / (double)getCPUFrequency();
+	char storage[8192];
+	StringBuilder out(storage);
+	bool ok = true;
+
+	out.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	for (uint32_t i = 0; i < threadNames.size(); i++)
+	{
+		formatTo(out, "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{},\"args\":{{\"name\":", i);
+		if (threadNames[i])
+			appendJsonString(out, threadNames[i]);
+		else
+			formatTo(out, "\"thread {}\"", i);
+		out.append("}},\n");
+	}
+
+	for (uint32_t i = 0; i < events.size(); i++)
+	{
+		ProfileEvent const& event = events[i];
+		out.append("{\"name\":");
+		appendJsonString(out, event.name);
+		double const ts = (double)(event.start - startCount) * toUs;
+		if (event.depth == ProfileEvent::frameMarker)
+			formatTo(out, ",\"cat\":\"frame\",\"ph\":\"i\",\"s\":\"g\",\"pid\":0,\"tid\":{},\"ts\":{}}}", event.thread, ts);
+		else
+			formatTo(out, ",\"cat\":\"wob\",\"ph\":\"X\",\"pid\":0,\"tid\":{},\"ts\":{},\"dur\":{}}}", event.thread, ts, (double)(event.end - event.start) * toUs);
+		out.append(i + 1 < events.size() ? ",\n" : "\n");
+
+		if (out.size() > sizeof(storage) - 512)
+			ok &= flushTo(file, out);
+	}
+	out.append("]}\n");
+	ok &= flushTo(file, out);
+
+	ok &= fclose(file) == 0;
+	return ok;
+}
+
+// keep microseconds, enough for a report and shorter to read
+static double roundToUs(ProfileTime_t ms)
+{
+	return (double)(long long)(ms * 1000.0 + (ms < 0 ? -0.5 : 0.5)) / 1000.0;
+}
+
+static void logNode(ProfileSession const& session, uint32_t index)
+{
+	static char const indent[] = "                                                                ";
+	ProfileData const& data = session.profileDatas[index];
+	uint32_t const indentSize = min<uint32_t>(data.depth * 2, sizeof(indent) - 1);
+
+	if (session.frameCount > 0)
+		WOB_LOG_RAW("{}{} : {} ms total, {} ms self, {} calls, {} ms per frame", StringView(indent, indentSize), data.name,
+			roundToUs(data.elapsedTime), roundToUs(data.selfTime), (uint64_t)data.count, roundToUs(data.elapsedTime / session.frameCount));
+	else
+		WOB_LOG_RAW("{}{} : {} ms total, {} ms self, {} calls", StringView(indent, indentSize), data.name,
+			roundToUs(data.elapsedTime), roundToUs(data.selfTime), (uint64_t)data.count);
+
+	for (uint32_t child = data.firstChild; child != ProfileSession::npos; child = session.profileDatas[child].nextSibling)
+		logNode(session, child);
+}
+
+void ProfileSession::logReport() const noexcept
+{
+	WOB_LOG("profile session {} : {} ms, {} frames", name, roundToUs(elapsedSessionTime), frameCount);
+	uint32_t lastThread = npos;
+	for (uint32_t i = 0; i < profileDatas.size(); i++)
+	{
+		if (profileDatas[i].parent != npos)
+			continue;
+		if (profileDatas[i].thread != lastThread)
+		{
+			lastThread = profileDatas[i].thread;
+			if (threadNames[lastThread])
+				WOB_LOG_RAW("thread {}", threadNames[lastThread]);
+			else
+				WOB_LOG_RAW("thread {}", lastThread);
+		}
+		logNode(*this, i);
+	}
 }
@@ -2,20 +2,24 @@
 #define WOB_PROFILER_HPP
 
 #include "macro_helpers.hpp"
+#include "array.hpp"
 #include <stdint.h>
+#include <stddef.h>
 
-#ifdef WOB_ENABLE_PROFILINGs
+// instrumenting CPU profiler, scopes are only recorded while a session is running
+// enable with the xmake option --profiling=y (defines WOB_ENABLE_PROFILING)
+#ifdef WOB_ENABLE_PROFILING
 
-#define WOB_PROFILE_FUNCTION() ::aes::ProfileScope WOB_CONCAT(WOB_internal_profile_func_, __COUNTER__)(__FUNCTION__);
-#define WOB_PROFILE_SCOPE(name) ::aes::ProfileScope WOB_CONCAT(WOB_internal_profile_func_, __COUNTER__)(name); 
+#define WOB_PROFILE_FUNCTION() ::wob::ProfileScope WOB_CONCAT(WOB_internal_profile_func_, __COUNTER__)(__FUNCTION__);
+#define WOB_PROFILE_SCOPE(name) ::wob::ProfileScope WOB_CONCAT(WOB_internal_profile_func_, __COUNTER__)(name);
 
-#define WOB_PROFILE_FRAME()
-#define WOB_PROFILE_FRAMEN(name)
+#define WOB_PROFILE_FRAME() ::wob::profileFrame("frame")
+#define WOB_PROFILE_FRAMEN(name) ::wob::profileFrame(name)
 
 #else
 
 #define WOB_PROFILE_FUNCTION()
-#define WOB_PROFILE_SCOPE(name) 
+#define WOB_PROFILE_SCOPE(name)
 
 #define WOB_PROFILE_FRAME()
 #define WOB_PROFILE_FRAMEN(name)
@@ -27,51 +31,97 @@
 
 namespace wob
 {
+	// milliseconds
 	using ProfileTime_t = double;
 
+	// one node of the session call tree, scopes with the same name under the same parent are merged
 	struct ProfileData
 	{
 		const char* name;
 		const char* parentName;
-		ProfileTime_t elapsedTime;
-#ifdef _WIN32
-		size_t count = 1;
-#else
+		ProfileTime_t elapsedTime;	// including children
+		ProfileTime_t selfTime;		// excluding children
 		size_t count = 1;
-#endif
+		uint32_t depth;
+		uint32_t parent;			// index in ProfileSession::profileDatas, npos for roots
+		uint32_t firstChild;
+		uint32_t nextSibling;
+		uint32_t thread;
+	};
+
+	// raw timings, frame markers have depth frameMarker and a zero duration
+	struct ProfileEvent
+	{
+		const char* name;
+		long long start;
+		long long end;
+		uint32_t depth;
+		uint32_t thread;
+
+		static constexpr uint32_t frameMarker = 0xFFFFFFFF;
 	};
 
 	struct ProfileSession
 	{
+		static constexpr uint32_t npos = 0xFFFFFFFF;
+
 		ProfileSession() noexcept;
 
 		ProfileSession(const char* name, ProfileTime_t elapsed) noexcept;
 
+		// write the events in the Chrome trace event JSON format, open it in chrome://tracing or ui.perfetto.dev
+		bool exportChromeTrace(const char* path) const noexcept;
+
+		// log the call tree with total, self and per frame times
+		void logReport() const noexcept;
+
 		const char* name;
 		ProfileTime_t elapsedSessionTime;
-		struct ProfilerImpl* impl;
+		uint32_t frameCount;
+		long long startCount;
+
+		// call tree, roots have no parent, walk the children with firstChild and nextSibling
+		Array<ProfileData> profileDatas;
+		Array<ProfileEvent> events;
+		Array<const char*> threadNames;
 	};
 
 	void startInstrumentorSession(const char* name) noexcept;
 
+	// threads other than the caller must not be inside a profiled scope
 	ProfileSession endInstrumentorSession() noexcept;
-	
+
+	// mark the start of a frame, frames are counted to report times per frame
+	void profileFrame(const char* name) noexcept;
+
+	// shown in the trace instead of the thread index, name must outlive the session
+	// kept per thread, no profile is allocated until the thread records an event
+	void setProfilerThreadName(const char* name) noexcept;
+
+	// thread profiles allocated so far, the profiles of exited threads are reused
+	[[nodiscard]] uint32_t profilerThreadCount() noexcept;
+
+	// name of the innermost profiled scope open on this thread, nullptr outside a session or a scope
+	[[nodiscard]] const char* currentProfileScope() noexcept;
+
 	class ProfileScope
 	{
 	public:
 
-		ProfileScope(const char* name_);
+		ProfileScope(const char* name_) noexcept;
+
+		~ProfileScope() noexcept;
 
-		~ProfileScope();
+		ProfileScope(ProfileScope const&) = delete;
+		ProfileScope& operator=(ProfileScope const&) = delete;
 
 	private:
 
-		/*thread_local ?*/ static ProfileScope* last;
-		const char* name;
-		ProfileScope* parent;
-		ProfileTime_t start;
+		struct ThreadProfile* thread;
+		uint32_t index;
+		uint32_t session;
 	};
 
 }
 
-#endif
\ No newline at end of file
+#endif
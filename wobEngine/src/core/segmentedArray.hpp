@@ -0,0 +1,246 @@
+#ifndef WOB_SEGMENTED_ARRAY_HPP
+#define WOB_SEGMENTED_ARRAY_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "allocator.hpp"
+#include "array.hpp"
+#include "arrayView.hpp"
+#include "utility.hpp"
+
+namespace wob
+{
+	/*
+	 * Append only array made of fixed size chunks of ChunkSize elements
+	 * growing allocates one more chunk and never moves the elements, so addresses stay valid until pop / clear
+	 * indexing is O(1) (shift and mask), iterate chunk by chunk with chunkCount / chunk for contiguous loops
+	 * clear keeps the chunks for the next frame, release gives them back to the allocator
+	 */
+	template<typename T, uint32_t ChunkSize = 256>
+	class SegmentedArray
+	{
+		static_assert(isPowerOf2(ChunkSize), "ChunkSize must be a power of 2");
+
+		static constexpr uint32_t computeShift() noexcept
+		{
+			uint32_t shift = 0;
+			while ((1u << shift) < ChunkSize)
+				shift++;
+			return shift;
+		}
+
+		static constexpr uint32_t chunkShift = computeShift();
+		static constexpr uint32_t chunkMask = ChunkSize - 1;
+
+	public:
+
+		template<typename U>
+		class IteratorBase
+		{
+		public:
+			IteratorBase(U* const* chunks_, uint32_t index_, uint32_t size_) noexcept
+				: chunks(chunks_), current(index_ < size_ ? chunks_[index_ >> chunkShift] + (index_ & chunkMask) : nullptr), index(index_), size(size_)
+			{
+
+			}
+
+			U& operator*() const noexcept { return *current; }
+			U* operator->() const noexcept { return current; }
+
+			IteratorBase& operator++() noexcept
+			{
+				index++;
+				current++;
+				// next chunk
+				if ((index & chunkMask) == 0 && index < size)
+					current = chunks[index >> chunkShift];
+				return *this;
+			}
+
+			bool operator==(IteratorBase const& rhs) const noexcept { return index == rhs.index; }
+			bool operator!=(IteratorBase const& rhs) const noexcept { return index != rhs.index; }
+
+		private:
+			U* const* chunks;
+			U* current;
+			uint32_t index;
+			uint32_t size;
+		};
+
+		using Iterator_t = IteratorBase<T>;
+		using ConstIterator_t = IteratorBase<T const>;
+
+		static constexpr uint32_t chunkSize = ChunkSize;
+
+		SegmentedArray() noexcept
+			: alloc(getContextAllocator()), chunks(*alloc), size_(0)
+		{
+
+		}
+
+		explicit SegmentedArray(IAllocator& allocator) noexcept
+			: alloc(&allocator), chunks(allocator), size_(0)
+		{
+
+		}
+
+		SegmentedArray(SegmentedArray const&) = delete;
+		SegmentedArray& operator=(SegmentedArray const&) = delete;
+
+		SegmentedArray(SegmentedArray&& rhs) noexcept
+			: alloc(rhs.alloc), chunks(wob::move(rhs.chunks)), size_(rhs.size_)
+		{
+			rhs.size_ = 0;
+		}
+
+		SegmentedArray& operator=(SegmentedArray&& rhs) noexcept
+		{
+			if (this == &rhs)
+				return *this;
+
+			release();
+			alloc = rhs.alloc;
+			chunks = wob::move(rhs.chunks);
+			size_ = rhs.size_;
+			rhs.size_ = 0;
+			return *this;
+		}
+
+		~SegmentedArray() noexcept
+		{
+			release();
+		}
+
+		IAllocator* getAllocator() const noexcept
+		{
+			return alloc;
+		}
+
+		// allocate the chunks to hold n elements
+		void reserve(uint32_t n) noexcept
+		{
+			while (capacity() < n)
+				addChunk();
+		}
+
+		T& push(T const& e) noexcept
+		{
+			return *new (nextSlot()) T(e);
+		}
+
+		T& push(T&& e) noexcept
+		{
+			return *new (nextSlot()) T(wob::move(e));
+		}
+
+		template<typename ...Args>
+		T& emplace(Args&&... args) noexcept
+		{
+			return *new (nextSlot()) T(wob::forward<Args>(args)...);
+		}
+
+		void pop() noexcept
+		{
+			WOB_BOUNDS_CHECK(size_ > 0);
+			size_--;
+			if constexpr (!isTriviallyDestructible<T>)
+				at(size_).~T();
+		}
+
+		T& operator[](uint32_t i) noexcept
+		{
+			WOB_BOUNDS_CHECK(i < size_);
+			return at(i);
+		}
+
+		T const& operator[](uint32_t i) const noexcept
+		{
+			WOB_BOUNDS_CHECK(i < size_);
+			return at(i);
+		}
+
+		T& front() noexcept { WOB_BOUNDS_CHECK(size_ > 0); return at(0); }
+		T const& front() const noexcept { WOB_BOUNDS_CHECK(size_ > 0); return at(0); }
+		T& back() noexcept { WOB_BOUNDS_CHECK(size_ > 0); return at(size_ - 1); }
+		T const& back() const noexcept { WOB_BOUNDS_CHECK(size_ > 0); return at(size_ - 1); }
+
+		uint32_t size() const noexcept { return size_; }
+		bool empty() const noexcept { return size_ == 0; }
+		uint32_t capacity() const noexcept { return chunks.size() * ChunkSize; }
+
+		// chunks holding elements, the last one may be partially used
+		uint32_t chunkCount() const noexcept { return (size_ + chunkMask) >> chunkShift; }
+
+		ArrayView<T> chunk(uint32_t i) noexcept
+		{
+			WOB_BOUNDS_CHECK(i < chunkCount());
+			return ArrayView<T>(chunks[i], chunkUsed(i));
+		}
+
+		ArrayView<T const> chunk(uint32_t i) const noexcept
+		{
+			WOB_BOUNDS_CHECK(i < chunkCount());
+			return ArrayView<T const>(chunks[i], chunkUsed(i));
+		}
+
+		Iterator_t begin() noexcept { return Iterator_t(chunks.data(), 0, size_); }
+		Iterator_t end() noexcept { return Iterator_t(chunks.data(), size_, size_); }
+		ConstIterator_t begin() const noexcept { return ConstIterator_t(chunks.data(), 0, size_); }
+		ConstIterator_t end() const noexcept { return ConstIterator_t(chunks.data(), size_, size_); }
+
+		// destroy every element, the chunks are kept
+		void clear() noexcept
+		{
+			if constexpr (!isTriviallyDestructible<T>)
+			{
+				for (uint32_t c = 0; c < chunkCount(); c++)
+				{
+					for (T& e : chunk(c))
+						e.~T();
+				}
+			}
+			size_ = 0;
+		}
+
+		// destroy every element and free the chunks
+		void release() noexcept
+		{
+			clear();
+			for (T* c : chunks)
+				alloc->deallocate(c);
+			chunks.clear();
+			chunks.shrink();
+		}
+
+	private:
+
+		T& at(uint32_t i) noexcept { return chunks[i >> chunkShift][i & chunkMask]; }
+		T const& at(uint32_t i) const noexcept { return chunks[i >> chunkShift][i & chunkMask]; }
+
+		uint32_t chunkUsed(uint32_t i) const noexcept
+		{
+			return i + 1 < chunkCount() ? ChunkSize : size_ - (i << chunkShift);
+		}
+
+		void addChunk() noexcept
+		{
+			chunks.push(alloc->allocate<T>(ChunkSize));
+		}
+
+		T* nextSlot() noexcept
+		{
+			if (size_ == capacity())
+				addChunk();
+			T* const slot = &at(size_);
+			size_++;
+			return slot;
+		}
+
+		IAllocator* alloc;
+		// only this table grows by copy, it holds one pointer per chunk
+		Array<T*> chunks;
+		uint32_t size_;
+	};
+}
+
+#endif
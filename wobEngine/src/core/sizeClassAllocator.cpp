@@ -0,0 +1,696 @@
+#include "sizeClassAllocator.hpp"
+#include "virtualMemory.hpp"
+#include "maths.hpp"
+#include "utility.hpp"
+#include "wob.hpp"
+#ifdef __vita__
+	#include "thread.hpp"
+#endif
+
+using namespace wob;
+
+namespace
+{
+	constexpr uint32_t slabMagicSmall = 0x51AB51ABu;
+	constexpr uint32_t slabMagicLarge = 0x1A46E51Au;
+	constexpr uint32_t maxCachedEmptySlabs = 4;
+#ifdef __vita__
+	constexpr uint32_t maxCachedLargeBlocks = 4;
+	constexpr size_t maxCachedLargeBytes = 8 * 1024 * 1024;
+#else
+	constexpr uint32_t maxCachedLargeBlocks = 32;
+	constexpr size_t maxCachedLargeBytes = 64 * 1024 * 1024;
+#endif
+	constexpr uint32_t maxThreadHeaps = 4;
+	// allocators whose liveness is tracked, an untracked one is treated as dead by the tls slots
+	constexpr uint32_t maxLiveAllocators = 64;
+	constexpr size_t minAlignment = 16;
+
+	// 16 bytes steps up to 128, then 4 classes per power of 2
+	constexpr uint32_t sizeClasses[SizeClassAllocator::numSizeClasses] = {
+		16, 32, 48, 64, 80, 96, 112, 128,
+		160, 192, 224, 256,
+		320, 384, 448, 512,
+		640, 768, 896, 1024,
+		1280, 1536, 1792, 2048,
+		2560, 3072, 3584, 4096,
+		5120, 6144, 7168, 8192
+	};
+
+	uint32_t sizeToClass(size_t size) noexcept
+	{
+		if (size <= 128)
+			return size <= 16 ? 0 : (uint32_t)((size + 15) >> 4) - 1;
+
+		// 2^k < size <= 2^(k+1)
+		uint32_t const k = 63 - countLeadingZeros(size - 1);
+		size_t const step = (size_t)1 << (k - 2);
+		return 8 + (k - 7) * 4 + (uint32_t)((size - ((size_t)1 << k) + step - 1) / step) - 1;
+	}
+
+	// power of 2 classes are aligned on their size, others on 16 bytes
+	uint32_t classFor(size_t size, size_t align) noexcept
+	{
+		if (align <= minAlignment)
+			return sizeToClass(size);
+
+		uint32_t cls = sizeToClass(size > align ? size : align);
+		while (sizeClasses[cls] % align != 0)
+			cls++;
+		return cls;
+	}
+
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	Atomic<uint64_t> allocatorIdCounter;
+	// ids of the allocators not destroyed yet, ids are never reused so a dead id never comes back
+	Atomic<uint64_t> liveAllocatorIds[maxLiveAllocators];
+
+	void registerAllocator(uint64_t allocatorId) noexcept
+	{
+		for (Atomic<uint64_t>& slot : liveAllocatorIds)
+		{
+			uint64_t expected = 0;
+			if (slot.compareExchange(expected, allocatorId))
+				return;
+		}
+	}
+
+	void unregisterAllocator(uint64_t allocatorId) noexcept
+	{
+		for (Atomic<uint64_t>& slot : liveAllocatorIds)
+		{
+			uint64_t expected = allocatorId;
+			if (slot.compareExchange(expected, 0))
+				return;
+		}
+	}
+
+	bool isAllocatorLive(uint64_t allocatorId) noexcept
+	{
+		for (Atomic<uint64_t> const& slot : liveAllocatorIds)
+		{
+			if (slot.load(MemoryOrder::Acquire) == allocatorId)
+				return true;
+		}
+		return false;
+	}
+
+	struct TlsHeapEntry
+	{
+		uint64_t allocatorId;
+		void* heap;
+	};
+
+#ifdef __vita__
+	// vm::allocate is an over allocating heap block on vita, an aligned 64 kb slab would cost about 128 kb of a small heap
+	// slabs are carved from aligned chunks instead and kept in a process wide pool once released
+	constexpr size_t slabChunkSize = 1024 * 1024;
+
+	SpinLock slabPoolLock;
+	FreeBlock* freeSlabs = nullptr;
+	uint8_t* chunkCursor = nullptr;
+	uint8_t* chunkEnd = nullptr;
+
+	void* acquireSlab() noexcept
+	{
+		ScopedLock const lock(slabPoolLock);
+		if (FreeBlock* const slab = freeSlabs)
+		{
+			freeSlabs = slab->next;
+			return slab;
+		}
+		if (chunkCursor == chunkEnd)
+		{
+			chunkCursor = static_cast<uint8_t*>(vm::allocate(slabChunkSize, SizeClassAllocator::slabSize));
+			if (chunkCursor == nullptr)
+			{
+				chunkEnd = nullptr;
+				return nullptr;
+			}
+			chunkEnd = chunkCursor + slabChunkSize;
+		}
+		void* const slab = chunkCursor;
+		chunkCursor += SizeClassAllocator::slabSize;
+		return slab;
+	}
+
+	void releaseSlab(void* slab) noexcept
+	{
+		ScopedLock const lock(slabPoolLock);
+		FreeBlock* const block = static_cast<FreeBlock*>(slab);
+		block->next = freeSlabs;
+		freeSlabs = block;
+	}
+#else
+	void* acquireSlab() noexcept
+	{
+		return vm::allocate(SizeClassAllocator::slabSize, SizeClassAllocator::slabSize);
+	}
+
+	void releaseSlab(void* slab) noexcept
+	{
+		vm::release(slab, SizeClassAllocator::slabSize);
+	}
+#endif
+
+	thread_local TlsHeapEntry tlsHeaps[maxThreadHeaps];
+	thread_local uint32_t tlsNextEviction;
+	// set once the thread exit hook ran, a late allocation must not arm it again
+	thread_local bool tlsHeapsReleased;
+}
+
+namespace wob
+{
+	// destroyed at thread exit, armed on the slow path only so the fast path tls stays trivial
+	struct ThreadHeapsRelease
+	{
+		~ThreadHeapsRelease()
+		{
+			SizeClassAllocator::releaseThreadHeaps();
+		}
+	};
+}
+
+static void armThreadHeapsRelease() noexcept
+{
+	if (tlsHeapsReleased)
+		return;
+	thread_local ThreadHeapsRelease release;
+	WOB_UNUSED(release);
+}
+
+// header at the start of every slab and every large block, both are slabSize aligned
+struct SizeClassAllocator::Slab
+{
+	uint32_t magic;
+	uint32_t sizeClass;
+	ThreadHeap* owner;
+
+	// small slabs
+	Slab* prevAvailable;
+	Slab* nextAvailable;
+	Slab* prevOwned;
+	Slab* nextOwned;
+	FreeBlock* freeList;
+	uint8_t* bump;
+	uint8_t* end;
+	uint32_t blockSize;
+	uint32_t usedCount;
+	bool isAvailable;
+
+	// large blocks
+	size_t mappedSize;
+	size_t dataOffset;
+};
+
+struct SizeClassAllocator::ThreadHeap
+{
+	void* allocate(uint32_t cls) noexcept;
+	void freeLocal(Slab* slab, FreeBlock* block) noexcept;
+	void freeRemote(FreeBlock* block) noexcept;
+	void drainRemoteFrees() noexcept;
+	void releaseAll() noexcept;
+
+	Slab* takeCachedLarge(size_t mappedSize) noexcept;
+	bool cacheLarge(Slab* block) noexcept;
+
+	Slab* newSlab(uint32_t cls) noexcept;
+	void retireSlab(Slab* slab) noexcept;
+	void pushAvailable(Slab* slab) noexcept;
+	void removeAvailable(Slab* slab) noexcept;
+
+	ThreadHeap* nextHeap = nullptr;
+	Slab* available[numSizeClasses] = {};
+	Slab* owned = nullptr;
+	Slab* emptySlabs = nullptr;
+	uint32_t emptySlabCount = 0;
+	// freed large blocks kept mapped to avoid a syscall pair for each large allocation
+	Slab* largeBlocks = nullptr;
+	uint32_t largeBlockCount = 0;
+	size_t largeBlockBytes = 0;
+	// blocks of this heap freed by other threads
+	Atomic<FreeBlock*> remoteFrees;
+	// 1 when no thread owns the heap, the next thread needing one adopts it
+	Atomic<uint32_t> orphaned;
+};
+
+void* SizeClassAllocator::ThreadHeap::allocate(uint32_t cls) noexcept
+{
+	for (;;)
+	{
+		Slab* const s = available[cls];
+		if (s == nullptr)
+			break;
+
+		if (FreeBlock* const b = s->freeList)
+		{
+			s->freeList = b->next;
+			s->usedCount++;
+			return b;
+		}
+
+		if (s->bump + s->blockSize <= s->end)
+		{
+			void* const b = s->bump;
+			s->bump += s->blockSize;
+			s->usedCount++;
+			return b;
+		}
+
+		// slab is full, it comes back in the available list when one of its block is freed
+		removeAvailable(s);
+	}
+
+	// slow path, reclaim blocks freed by other threads before mapping a new slab
+	if (remoteFrees.load(MemoryOrder::Relaxed) != nullptr)
+	{
+		drainRemoteFrees();
+		if (available[cls] != nullptr)
+			return allocate(cls);
+	}
+
+	Slab* const s = newSlab(cls);
+	if (s == nullptr)
+		return nullptr;
+
+	pushAvailable(s);
+	void* const b = s->bump;
+	s->bump += s->blockSize;
+	s->usedCount++;
+	return b;
+}
+
+void SizeClassAllocator::ThreadHeap::freeLocal(Slab* s, FreeBlock* block) noexcept
+{
+	block->next = s->freeList;
+	s->freeList = block;
+	s->usedCount--;
+
+	if (!s->isAvailable)
+	{
+		pushAvailable(s);
+	}
+	else if (s->usedCount == 0 && (s->prevAvailable != nullptr || s->nextAvailable != nullptr))
+	{
+		// keep the last slab of a class to avoid map / unmap trashing
+		retireSlab(s);
+	}
+}
+
+void SizeClassAllocator::ThreadHeap::freeRemote(FreeBlock* block) noexcept
+{
+	FreeBlock* head = remoteFrees.load(MemoryOrder::Relaxed);
+	do
+	{
+		block->next = head;
+	} while (!remoteFrees.compareExchange(head, block, MemoryOrder::Release));
+}
+
+void SizeClassAllocator::ThreadHeap::drainRemoteFrees() noexcept
+{
+	FreeBlock* b = remoteFrees.exchange(nullptr, MemoryOrder::Acquire);
+	while (b)
+	{
+		FreeBlock* const next = b->next;
+		freeLocal(slabOf(b), b);
+		b = next;
+	}
+}
+
+SizeClassAllocator::Slab* SizeClassAllocator::ThreadHeap::newSlab(uint32_t cls) noexcept
+{
+	Slab* s = emptySlabs;
+	if (s)
+	{
+		emptySlabs = s->nextOwned;
+		emptySlabCount--;
+	}
+	else
+	{
+		s = static_cast<Slab*>(acquireSlab());
+		if (s == nullptr)
+			return nullptr;
+	}
+
+	uint32_t const blockSize = sizeClasses[cls];
+	// lowest power of 2 dividing the block size, all blocks are aligned on it
+	size_t const blockAlign = blockSize & (0u - blockSize);
+	uint8_t* const base = reinterpret_cast<uint8_t*>(s);
+
+	s->magic = slabMagicSmall;
+	s->sizeClass = cls;
+	s->owner = this;
+	s->prevAvailable = nullptr;
+	s->nextAvailable = nullptr;
+	s->freeList = nullptr;
+	s->bump = base + wob::align(sizeof(Slab), (uint32_t)blockAlign);
+	s->end = base + slabSize;
+	s->blockSize = blockSize;
+	s->usedCount = 0;
+	s->isAvailable = false;
+	s->mappedSize = slabSize;
+	s->dataOffset = 0;
+
+	s->prevOwned = nullptr;
+	s->nextOwned = owned;
+	if (owned)
+		owned->prevOwned = s;
+	owned = s;
+	return s;
+}
+
+void SizeClassAllocator::ThreadHeap::retireSlab(Slab* s) noexcept
+{
+	WOB_ASSERT_NOLOG(s->usedCount == 0);
+	removeAvailable(s);
+
+	if (s->prevOwned)
+		s->prevOwned->nextOwned = s->nextOwned;
+	else
+		owned = s->nextOwned;
+	if (s->nextOwned)
+		s->nextOwned->prevOwned = s->prevOwned;
+
+	if (emptySlabCount < maxCachedEmptySlabs)
+	{
+		s->magic = 0;
+		s->nextOwned = emptySlabs;
+		emptySlabs = s;
+		emptySlabCount++;
+	}
+	else
+	{
+		releaseSlab(s);
+	}
+}
+
+void SizeClassAllocator::ThreadHeap::pushAvailable(Slab* s) noexcept
+{
+	WOB_ASSERT_NOLOG(!s->isAvailable);
+	Slab*& head = available[s->sizeClass];
+	s->prevAvailable = nullptr;
+	s->nextAvailable = head;
+	if (head)
+		head->prevAvailable = s;
+	head = s;
+	s->isAvailable = true;
+}
+
+void SizeClassAllocator::ThreadHeap::removeAvailable(Slab* s) noexcept
+{
+	if (!s->isAvailable)
+		return;
+
+	if (s->prevAvailable)
+		s->prevAvailable->nextAvailable = s->nextAvailable;
+	else
+		available[s->sizeClass] = s->nextAvailable;
+	if (s->nextAvailable)
+		s->nextAvailable->prevAvailable = s->prevAvailable;
+
+	s->prevAvailable = nullptr;
+	s->nextAvailable = nullptr;
+	s->isAvailable = false;
+}
+
+void SizeClassAllocator::ThreadHeap::releaseAll() noexcept
+{
+	for (Slab* s = owned; s != nullptr;)
+	{
+		Slab* const next = s->nextOwned;
+		releaseSlab(s);
+		s = next;
+	}
+
+	for (Slab* s = emptySlabs; s != nullptr;)
+	{
+		Slab* const next = s->nextOwned;
+		releaseSlab(s);
+		s = next;
+	}
+
+	for (Slab* s = largeBlocks; s != nullptr;)
+	{
+		Slab* const next = s->nextOwned;
+		vm::release(s, s->mappedSize);
+		s = next;
+	}
+
+	owned = nullptr;
+	emptySlabs = nullptr;
+	emptySlabCount = 0;
+	largeBlocks = nullptr;
+	largeBlockCount = 0;
+	largeBlockBytes = 0;
+}
+
+// best fit, wasting at most half of the block
+SizeClassAllocator::Slab* SizeClassAllocator::ThreadHeap::takeCachedLarge(size_t mappedSize) noexcept
+{
+	Slab** best = nullptr;
+	for (Slab** it = &largeBlocks; *it != nullptr; it = &(*it)->nextOwned)
+	{
+		size_t const size = (*it)->mappedSize;
+		if (size >= mappedSize && size / 2 <= mappedSize && (best == nullptr || size < (*best)->mappedSize))
+			best = it;
+	}
+
+	if (best == nullptr)
+		return nullptr;
+
+	Slab* const s = *best;
+	*best = s->nextOwned;
+	largeBlockCount--;
+	largeBlockBytes -= s->mappedSize;
+	return s;
+}
+
+bool SizeClassAllocator::ThreadHeap::cacheLarge(Slab* s) noexcept
+{
+	if (largeBlockCount >= maxCachedLargeBlocks || largeBlockBytes + s->mappedSize > maxCachedLargeBytes)
+		return false;
+
+	s->magic = 0;
+	s->nextOwned = largeBlocks;
+	largeBlocks = s;
+	largeBlockCount++;
+	largeBlockBytes += s->mappedSize;
+	return true;
+}
+
+SizeClassAllocator::Slab* SizeClassAllocator::slabOf(void const* ptr) noexcept
+{
+	return reinterpret_cast<Slab*>(reinterpret_cast<uintptr_t>(ptr) & ~(uintptr_t)(slabSize - 1));
+}
+
+SizeClassAllocator::~SizeClassAllocator()
+{
+	// the tls slots of the other threads are recycled once they see the id is dead
+	uint64_t const myId = id.load();
+	if (myId != 0)
+		unregisterAllocator(myId);
+	for (auto& entry : tlsHeaps)
+	{
+		if (entry.allocatorId == myId)
+			entry = {};
+	}
+
+	ThreadHeap* heap = heaps.exchange(nullptr);
+	while (heap)
+	{
+		ThreadHeap* const next = heap->nextHeap;
+		heap->releaseAll();
+		heap->~ThreadHeap();
+		vm::release(heap, sizeof(ThreadHeap));
+		heap = next;
+	}
+}
+
+uint64_t SizeClassAllocator::getId() noexcept
+{
+	uint64_t current = id.load(MemoryOrder::Acquire);
+	if (current != 0)
+		return current;
+
+	uint64_t const newId = allocatorIdCounter.fetchAdd(1) + 1;
+	if (id.compareExchange(current, newId))
+	{
+		registerAllocator(newId);
+		return newId;
+	}
+	return current;
+}
+
+SizeClassAllocator::ThreadHeap* SizeClassAllocator::findThreadHeap() noexcept
+{
+	uint64_t const myId = id.load(MemoryOrder::Relaxed);
+	if (myId == 0)
+		return nullptr;
+
+	for (auto const& entry : tlsHeaps)
+	{
+		if (entry.allocatorId == myId)
+			return static_cast<ThreadHeap*>(entry.heap);
+	}
+	return nullptr;
+}
+
+SizeClassAllocator::ThreadHeap* SizeClassAllocator::adoptOrphanHeap() noexcept
+{
+	// heaps are never unlinked before the allocator is destroyed, the list can be walked without lock
+	for (ThreadHeap* heap = heaps.load(MemoryOrder::Acquire); heap; heap = heap->nextHeap)
+	{
+		uint32_t expected = 1;
+		if (heap->orphaned.load(MemoryOrder::Relaxed) == 1 && heap->orphaned.compareExchange(expected, 0, MemoryOrder::Acquire))
+			return heap;
+	}
+	return nullptr;
+}
+
+void SizeClassAllocator::releaseThreadHeaps() noexcept
+{
+	tlsHeapsReleased = true;
+	for (auto& entry : tlsHeaps)
+	{
+		// the heaps of destroyed allocators are gone
+		if (entry.heap && isAllocatorLive(entry.allocatorId))
+			static_cast<ThreadHeap*>(entry.heap)->orphaned.store(1, MemoryOrder::Release);
+		// later frees of this thread go through the remote path
+		entry = {};
+	}
+}
+
+uint32_t SizeClassAllocator::threadHeapCount() const noexcept
+{
+	uint32_t count = 0;
+	for (ThreadHeap* heap = heaps.load(MemoryOrder::Acquire); heap; heap = heap->nextHeap)
+		count++;
+	return count;
+}
+
+SizeClassAllocator::ThreadHeap* SizeClassAllocator::getThreadHeap() noexcept
+{
+	if (ThreadHeap* heap = findThreadHeap())
+		return heap;
+
+	ThreadHeap* heap = adoptOrphanHeap();
+	if (heap == nullptr)
+	{
+		void* const mem = vm::allocate(sizeof(ThreadHeap));
+		if (mem == nullptr)
+			return nullptr;
+		heap = new (mem) ThreadHeap();
+
+		ThreadHeap* head = heaps.load(MemoryOrder::Relaxed);
+		do
+		{
+			heap->nextHeap = head;
+		} while (!heaps.compareExchange(head, heap, MemoryOrder::Release));
+	}
+	armThreadHeapsRelease();
+
+	// slots of destroyed allocators are free, their heaps are gone with them
+	uint64_t const myId = getId();
+	for (auto& entry : tlsHeaps)
+	{
+		if (entry.heap == nullptr || !isAllocatorLive(entry.allocatorId))
+		{
+			entry = { myId, heap };
+			return heap;
+		}
+	}
+
+	// this thread uses more live allocators than there are slots, the evicted heap is orphaned for another thread to adopt
+	TlsHeapEntry& evicted = tlsHeaps[tlsNextEviction++ % maxThreadHeaps];
+	static_cast<ThreadHeap*>(evicted.heap)->orphaned.store(1, MemoryOrder::Release);
+	evicted = { myId, heap };
+	return heap;
+}
+
+void* SizeClassAllocator::allocate(size_t size, size_t align)
+{
+	WOB_ASSERT_NOLOG(isPowerOf2(align));
+	if (size == 0)
+		size = 1;
+
+	if ((size > align ? size : align) > maxSmallSize)
+		return allocateLarge(size, align);
+
+	ThreadHeap* const heap = getThreadHeap();
+	if (heap == nullptr)
+		return nullptr;
+	return heap->allocate(classFor(size, align));
+}
+
+void* SizeClassAllocator::allocateLarge(size_t size, size_t align) noexcept
+{
+	// data must stay in the first slabSize bytes so that slabOf find the header
+	WOB_ASSERT_NOLOG(align < slabSize);
+	size_t const dataOffset = wob::align(sizeof(Slab), (uint32_t)(align > minAlignment ? align : minAlignment));
+	// rounded to slabs so that freed blocks are more likely to be reused by the cache
+	size_t const mappedSize = wob::align(dataOffset + size, (uint32_t)slabSize);
+
+	ThreadHeap* const heap = getThreadHeap();
+	Slab* s = heap ? heap->takeCachedLarge(mappedSize) : nullptr;
+	if (s == nullptr)
+	{
+		s = static_cast<Slab*>(vm::allocate(mappedSize, slabSize));
+		if (s == nullptr)
+			return nullptr;
+		s->mappedSize = mappedSize;
+	}
+
+	s->magic = slabMagicLarge;
+	s->owner = nullptr;
+	s->dataOffset = dataOffset;
+	return reinterpret_cast<uint8_t*>(s) + dataOffset;
+}
+
+void SizeClassAllocator::deallocate(void* ptr)
+{
+	if (ptr == nullptr)
+		return;
+
+	Slab* const s = slabOf(ptr);
+	ThreadHeap* const heap = findThreadHeap();
+	if (s->magic == slabMagicLarge)
+	{
+		// large blocks have no owner, they go in the cache of the freeing thread
+		if (heap == nullptr || !heap->cacheLarge(s))
+			vm::release(s, s->mappedSize);
+		return;
+	}
+
+	WOB_ASSERT_NOLOG(s->magic == slabMagicSmall);
+	FreeBlock* const block = static_cast<FreeBlock*>(ptr);
+	if (heap == s->owner)
+		heap->freeLocal(s, block);
+	else
+		s->owner->freeRemote(block);
+}
+
+bool SizeClassAllocator::tryExpandInPlace(void* ptr, size_t newSize)
+{
+	return ptr != nullptr && newSize <= blockSize(ptr);
+}
+
+size_t SizeClassAllocator::blockSize(void const* ptr) noexcept
+{
+	Slab const* const s = slabOf(ptr);
+	if (s->magic == slabMagicLarge)
+		return s->mappedSize - s->dataOffset;
+
+	WOB_ASSERT_NOLOG(s->magic == slabMagicSmall);
+	return s->blockSize;
+}
+
+SizeClassAllocator& wob::getSizeClassAllocator() noexcept
+{
+	alignas(SizeClassAllocator) static uint8_t storage[sizeof(SizeClassAllocator)];
+	static SizeClassAllocator* const instance = new (storage) SizeClassAllocator();
+	return *instance;
+}
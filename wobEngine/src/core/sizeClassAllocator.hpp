@@ -0,0 +1,67 @@
+#ifndef WOB_SIZE_CLASS_ALLOCATOR_HPP
+#define WOB_SIZE_CLASS_ALLOCATOR_HPP
+
+#include "allocator.hpp"
+#include "atomic.hpp"
+
+namespace wob
+{
+	/*
+	 * General purpose allocator built on thread local size class pools.
+	 * Small blocks (up to maxSmallSize) are carved from slabSize slabs, a slab serves a single size class
+	 * and belongs to the thread heap that created it, so the owner thread allocates and frees without synchronisation.
+	 * Blocks freed by another thread are pushed on a lock free list of the owner heap and reclaimed by the owner on its slow path.
+	 * Large blocks are mapped directly from the OS, each thread heap keep a few freed ones mapped for reuse.
+	 * Blocks honor any alignment up to the page size.
+	 * A thread heap outlives its thread : when the thread exits it is orphaned and adopted by the next thread needing a heap,
+	 * so thread churn doesn't grow the heap list. Destroying the allocator releases every slab,
+	 * it must not run while a thread that used it is still allocating or exiting.
+	 */
+	class SizeClassAllocator final : public IAllocator
+	{
+	public:
+		static constexpr size_t slabSize = 64_kb;
+		static constexpr size_t maxSmallSize = 8_kb;
+		static constexpr uint32_t numSizeClasses = 32;
+
+		constexpr SizeClassAllocator() noexcept = default;
+		~SizeClassAllocator() override;
+
+		SizeClassAllocator(SizeClassAllocator const&) = delete;
+		SizeClassAllocator& operator=(SizeClassAllocator const&) = delete;
+
+		[[nodiscard]] void* allocate(size_t size, size_t align) override;
+		void deallocate(void* ptr) override;
+		// succeed as long as newSize fit in the block
+		[[nodiscard]] bool tryExpandInPlace(void* ptr, size_t newSize) override;
+
+		// usable size of a block returned by allocate
+		[[nodiscard]] static size_t blockSize(void const* ptr) noexcept;
+
+		// heaps created so far, owned or orphaned
+		[[nodiscard]] uint32_t threadHeapCount() const noexcept;
+
+	private:
+		friend struct ThreadHeapsRelease;
+		struct Slab;
+		struct ThreadHeap;
+
+		static Slab* slabOf(void const* ptr) noexcept;
+		ThreadHeap* getThreadHeap() noexcept;
+		ThreadHeap* findThreadHeap() noexcept;
+		ThreadHeap* adoptOrphanHeap() noexcept;
+		// orphan the heaps of the calling thread, run at thread exit
+		static void releaseThreadHeaps() noexcept;
+		uint64_t getId() noexcept;
+		void* allocateLarge(size_t size, size_t align) noexcept;
+
+		// unique id used to match thread local heaps, lazily assigned
+		Atomic<uint64_t> id;
+		Atomic<ThreadHeap*> heaps;
+	};
+
+	// process wide instance, never destroyed so that frees happening during static destruction stay valid
+	[[nodiscard]] SizeClassAllocator& getSizeClassAllocator() noexcept;
+}
+
+#endif
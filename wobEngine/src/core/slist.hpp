@@ -1,6 +1,8 @@
 #ifndef WOB_SLIST_HPP
 #define WOB_SLIST_HPP
 
+#include "poolAllocator.hpp"
+
 namespace wob
 {
 	template<typename T>
@@ -14,6 +16,9 @@ namespace wob
 
 	public:
 
+		// pass a pool to the constructor to allocate the nodes in chunks
+		using NodePool = PoolAllocator<Node>;
+
 		struct Iterator
 		{
 			struct Node* n;
@@ -68,6 +73,13 @@ namespace wob
 			c->next = createNode(wob::forward<T>(e));
 		}
 
+		constexpr void addFront(T&& e) noexcept
+		{
+			Node* const n = createNode(wob::forward<T>(e));
+			n->next = first;
+			first = n;
+		}
+
 		constexpr Iterator find(T const& e) const noexcept
 		{
 			for (Node* c = first; c != nullptr; c = c->next)
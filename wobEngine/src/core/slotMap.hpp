@@ -0,0 +1,228 @@
+#ifndef WOB_SLOT_MAP_HPP
+#define WOB_SLOT_MAP_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "allocator.hpp"
+#include "array.hpp"
+#include "utility.hpp"
+
+namespace wob
+{
+	/*
+	 * 32 bits reference to an element of a SlotMap<T>
+	 * low indexBits are the slot index, high bits the generation of the slot when the handle was made
+	 * generation 0 is never used so a zero handle is always invalid
+	 */
+	template<typename T>
+	struct Handle
+	{
+		static constexpr uint32_t indexBits = 20;
+		static constexpr uint32_t generationBits = 32 - indexBits;
+		static constexpr uint32_t indexMask = (1u << indexBits) - 1;
+		static constexpr uint32_t maxGeneration = (1u << generationBits) - 1;
+
+		constexpr Handle() noexcept : value(0) {}
+		constexpr Handle(uint32_t index, uint32_t generation) noexcept : value((generation << indexBits) | index)
+		{
+			WOB_ASSERT_NOLOG(index <= indexMask && generation != 0 && generation <= maxGeneration);
+		}
+
+		[[nodiscard]] constexpr uint32_t index() const noexcept { return value & indexMask; }
+		[[nodiscard]] constexpr uint32_t generation() const noexcept { return value >> indexBits; }
+		[[nodiscard]] constexpr bool isValid() const noexcept { return value != 0; }
+
+		constexpr bool operator==(Handle const& rhs) const noexcept { return value == rhs.value; }
+		constexpr bool operator!=(Handle const& rhs) const noexcept { return value != rhs.value; }
+
+		uint32_t value;
+	};
+
+	/*
+	 * Generational handle table, elements are stored packed in a dense array and referenced through Handle<T>
+	 * insert, erase and lookup are O(1), erase moves the last element into the hole so the dense order isn't stable
+	 * a handle to an erased element is detected as stale until its slot generation wraps after 4095 reuses and the slot is used again,
+	 * free slots are reused oldest first so churn is spread over every free slot
+	 * iterating the map iterates the dense array, handleAt gives back the handle of a dense element
+	 * pointers to elements are invalidated by insert and erase, keep handles instead
+	 */
+	template<typename T>
+	class SlotMap
+	{
+	public:
+		using Handle_t = Handle<T>;
+		using Iterator_t = T*;
+		using ConstIterator_t = T const*;
+
+		// slot indices must fit in Handle_t::indexBits
+		static constexpr uint32_t maxSize = Handle_t::indexMask + 1;
+
+		SlotMap() noexcept = default;
+
+		explicit SlotMap(IAllocator& allocator) noexcept
+			: values(allocator), denseToSlot(allocator), slots(allocator)
+		{
+
+		}
+
+		void reserve(uint32_t n) noexcept
+		{
+			values.reserve(n);
+			denseToSlot.reserve(n);
+			slots.reserve(n);
+		}
+
+		[[nodiscard]] Handle_t insert(T const& value) noexcept
+		{
+			return emplace(value);
+		}
+
+		[[nodiscard]] Handle_t insert(T&& value) noexcept
+		{
+			return emplace(wob::move(value));
+		}
+
+		template<typename ...Args>
+		[[nodiscard]] Handle_t emplace(Args&&... args) noexcept
+		{
+			uint32_t slotIndex;
+			if (freeHead != npos)
+			{
+				slotIndex = freeHead;
+				freeHead = slots[slotIndex].nextFree;
+				if (freeHead == npos)
+					freeTail = npos;
+			}
+			else
+			{
+				WOB_ASSERT_NOLOG(slots.size() < maxSize);
+				slotIndex = slots.size();
+				slots.push(Slot{ npos, npos, 1 });
+			}
+
+			Slot& slot = slots[slotIndex];
+			slot.dense = values.size();
+			slot.nextFree = npos;
+			values.emplace(wob::forward<Args>(args)...);
+			denseToSlot.push(slotIndex);
+			return Handle_t(slotIndex, slot.generation);
+		}
+
+		// return false if the handle is stale
+		bool erase(Handle_t handle) noexcept
+		{
+			if (!contains(handle))
+				return false;
+
+			uint32_t const slotIndex = handle.index();
+			uint32_t const dense = slots[slotIndex].dense;
+			uint32_t const last = values.size() - 1;
+			if (dense != last)
+			{
+				// move the last element into the hole
+				values[dense] = wob::move(values[last]);
+				denseToSlot[dense] = denseToSlot[last];
+				slots[denseToSlot[dense]].dense = dense;
+			}
+			values.pop();
+			denseToSlot.pop();
+			release(slotIndex);
+			return true;
+		}
+
+		[[nodiscard]] bool contains(Handle_t handle) const noexcept
+		{
+			uint32_t const slotIndex = handle.index();
+			if (!handle.isValid() || slotIndex >= slots.size())
+				return false;
+			// a wrapped generation can match a free slot, check the slot is also live
+			Slot const& slot = slots[slotIndex];
+			return slot.generation == handle.generation() && slot.dense < values.size() && denseToSlot[slot.dense] == slotIndex;
+		}
+
+		// nullptr if the handle is stale
+		[[nodiscard]] T* get(Handle_t handle) noexcept
+		{
+			return contains(handle) ? &values[slots[handle.index()].dense] : nullptr;
+		}
+
+		[[nodiscard]] T const* get(Handle_t handle) const noexcept
+		{
+			return contains(handle) ? &values[slots[handle.index()].dense] : nullptr;
+		}
+
+		[[nodiscard]] T& operator[](Handle_t handle) noexcept
+		{
+			WOB_BOUNDS_CHECK(contains(handle));
+			return values[slots[handle.index()].dense];
+		}
+
+		[[nodiscard]] T const& operator[](Handle_t handle) const noexcept
+		{
+			WOB_BOUNDS_CHECK(contains(handle));
+			return values[slots[handle.index()].dense];
+		}
+
+		// handle of the element at denseIndex in iteration order
+		[[nodiscard]] Handle_t handleAt(uint32_t denseIndex) const noexcept
+		{
+			uint32_t const slotIndex = denseToSlot[denseIndex];
+			return Handle_t(slotIndex, slots[slotIndex].generation);
+		}
+
+		// every handle becomes stale, slots are kept for reuse
+		void clear() noexcept
+		{
+			for (uint32_t slotIndex : denseToSlot)
+				release(slotIndex);
+			values.clear();
+			denseToSlot.clear();
+		}
+
+		[[nodiscard]] uint32_t size() const noexcept { return values.size(); }
+		[[nodiscard]] bool empty() const noexcept { return values.empty(); }
+
+		[[nodiscard]] Iterator_t begin() noexcept { return values.begin(); }
+		[[nodiscard]] Iterator_t end() noexcept { return values.end(); }
+		[[nodiscard]] ConstIterator_t begin() const noexcept { return values.begin(); }
+		[[nodiscard]] ConstIterator_t end() const noexcept { return values.end(); }
+
+		[[nodiscard]] T* data() noexcept { return values.data(); }
+		[[nodiscard]] T const* data() const noexcept { return values.data(); }
+
+	private:
+		static constexpr uint32_t npos = ~0u;
+
+		struct Slot
+		{
+			// index in values when used, npos when free
+			uint32_t dense;
+			// next slot of the free list
+			uint32_t nextFree;
+			uint32_t generation;
+		};
+
+		void release(uint32_t slotIndex) noexcept
+		{
+			Slot& slot = slots[slotIndex];
+			// skip 0 when wrapping, it marks invalid handles
+			slot.generation = slot.generation == Handle_t::maxGeneration ? 1 : slot.generation + 1;
+			// free slots are reused in FIFO order so a slot wraps its generation as late as possible
+			slot.dense = npos;
+			slot.nextFree = npos;
+			if (freeTail != npos)
+				slots[freeTail].nextFree = slotIndex;
+			else
+				freeHead = slotIndex;
+			freeTail = slotIndex;
+		}
+
+		Array<T> values;
+		Array<uint32_t> denseToSlot;
+		Array<Slot> slots;
+		uint32_t freeHead = npos;
+		uint32_t freeTail = npos;
+	};
+}
+
+#endif
@@ -0,0 +1,188 @@
+#ifndef WOB_SMALL_ARRAY_HPP
+#define WOB_SMALL_ARRAY_HPP
+
+#include "array.hpp"
+
+namespace wob
+{
+	/*
+	 * Array with inline storage for N elements, it only allocates once it grows past N
+	 * same interface and iterators as Array, the allocator is only used for the spilled buffer
+	 * moving an inline SmallArray moves its elements one by one
+	 * shrink brings the elements back inline when they fit
+	 */
+	template<typename T, uint32_t N>
+	class SmallArray : public ArrayBase<T, SmallArray<T, N>>
+	{
+		static_assert(N > 0, "use Array for arrays without inline storage");
+
+		using Base = ArrayBase<T, SmallArray<T, N>>;
+		friend Base;
+		using Base::alloc;
+		using Base::buffer;
+		using Base::size_;
+		using Base::capacity_;
+
+		public:
+
+		constexpr SmallArray() noexcept
+			: Base(getContextAllocator(), inlineBuffer(), N)
+		{
+
+		}
+
+		constexpr SmallArray(IAllocator& allocator) noexcept
+			: Base(&allocator, inlineBuffer(), N)
+		{
+
+		}
+
+		template<typename Range>
+		constexpr SmallArray(IAllocator& allocator, Range const& range) noexcept
+			: Base(&allocator, inlineBuffer(), N)
+		{
+			this->insert(this->begin(), range);
+		}
+
+		constexpr SmallArray(SmallArray const& rhs) noexcept
+			: Base(rhs.alloc, inlineBuffer(), N)
+		{
+			*this = rhs;
+		}
+
+		constexpr SmallArray(SmallArray&& rhs) noexcept
+			: Base(rhs.alloc, inlineBuffer(), N)
+		{
+			*this = wob::move(rhs);
+		}
+
+		// true while the elements are stored in the array itself
+		constexpr bool isInline() const noexcept
+		{
+			return buffer == inlineBuffer();
+		}
+
+		constexpr void copyFrom(SmallArray const& rhs) noexcept
+		{
+			if (this == &rhs)
+				return;
+
+			this->clear();
+			if (rhs.size_ > capacity_)
+			{
+				freeBuffer();
+				alloc = rhs.alloc;
+				this->reserve(rhs.size_);
+			}
+
+			Base::copyConstruct(buffer, rhs.buffer, rhs.size_);
+			size_ = rhs.size_;
+		}
+
+		constexpr SmallArray& operator=(SmallArray const& rhs) noexcept
+		{
+			copyFrom(rhs);
+			return *this;
+		}
+
+		constexpr SmallArray& operator=(SmallArray&& rhs) noexcept
+		{
+			if (this == &rhs)
+				return *this;
+
+			freeBuffer();
+			alloc = rhs.alloc;
+
+			if (!rhs.isInline())
+			{
+				// steal the spilled buffer
+				buffer = rhs.buffer;
+				size_ = rhs.size_;
+				capacity_ = rhs.capacity_;
+
+				rhs.buffer = rhs.inlineBuffer();
+				rhs.size_ = 0;
+				rhs.capacity_ = N;
+				return *this;
+			}
+
+			Base::relocate(buffer, rhs.buffer, rhs.size_);
+			size_ = rhs.size_;
+			rhs.size_ = 0;
+			return *this;
+		}
+
+		// free unused heap memory, the elements go back inline if they fit
+		constexpr void shrink() noexcept
+		{
+			if (isInline() || size_ == capacity_)
+				return;
+
+			if (size_ <= N)
+			{
+				T* const heapBuffer = buffer;
+				Base::relocate(inlineBuffer(), heapBuffer, size_);
+				alloc->deallocate(heapBuffer);
+				buffer = inlineBuffer();
+				capacity_ = N;
+				return;
+			}
+
+			reallocateBuffer(size_);
+		}
+
+		constexpr ~SmallArray() noexcept
+		{
+			freeBuffer();
+		}
+
+		private:
+
+		T* inlineBuffer() noexcept { return reinterpret_cast<T*>(storage); }
+		T const* inlineBuffer() const noexcept { return reinterpret_cast<T const*>(storage); }
+
+		constexpr void reallocateBuffer(uint32_t n) noexcept
+		{
+			if (isInline())
+			{
+				// spill, the inline storage isn't owned by the allocator
+				T* const newBuffer = static_cast<T*>(alloc->template allocate<T>(n));
+				Base::relocate(newBuffer, buffer, size_);
+				buffer = newBuffer;
+			}
+			else if constexpr (isTriviallyRelocatable<T>)
+			{
+				// allocator may resize in place or realloc, only the live elements are copied otherwise
+				buffer = static_cast<T*>(alloc->reallocate(buffer, size_ * sizeof(T), n * sizeof(T), alignof(T)));
+			}
+			else if (!alloc->tryExpandInPlace(buffer, n * sizeof(T)))
+			{
+				T* const newBuffer = static_cast<T*>(alloc->template allocate<T>(n));
+				Base::relocate(newBuffer, buffer, size_);
+				alloc->deallocate(buffer);
+				buffer = newBuffer;
+			}
+			capacity_ = n;
+		}
+
+		constexpr void freeBuffer() noexcept
+		{
+			this->clear();
+			if (!isInline())
+			{
+				alloc->deallocate(buffer);
+				buffer = inlineBuffer();
+				capacity_ = N;
+			}
+		}
+
+		constexpr uint32_t increasedCapacity() const noexcept
+		{
+			return capacity_ * 2;
+		}
+
+		alignas(T) unsigned char storage[N * sizeof(T)];
+	};
+}
+
+#endif
@@ -0,0 +1,464 @@
+#ifndef WOB_SORT_HPP
+#define WOB_SORT_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "allocator.hpp"
+#include "utility.hpp"
+#include "thread.hpp"
+#include "jobSystem.hpp"
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Sorting algorithms over contiguous ranges (Array, SmallArray, ArrayView, C arrays)
+ * sort         : introsort, O(n log n) worst case, not stable, no allocation
+ * stableSort   : bottom up merge sort, keeps the order of equal elements, n elements of scratch memory
+ * radixSort    : LSD radix sort on 32 or 64 bits keys, stable, O(n) for n elements of scratch memory,
+ *                passes whose digit is the same for every key are skipped (small Morton codes, texture ids...)
+ * parallelSort : sort of large ranges split over threads then merged, not stable
+ * segmented containers aren't contiguous, sort indices or (key, index) pairs instead
+ */
+namespace wob::ranges
+{
+	struct Less
+	{
+		template<typename A, typename B>
+		constexpr bool operator()(A const& a, B const& b) const noexcept
+		{
+			return a < b;
+		}
+	};
+
+	// order preserving conversion of a value to an unsigned radix key
+	constexpr uint32_t radixKey(uint32_t value) noexcept { return value; }
+	constexpr uint64_t radixKey(uint64_t value) noexcept { return value; }
+	constexpr uint32_t radixKey(int32_t value) noexcept { return (uint32_t)value ^ 0x8000'0000u; }
+	constexpr uint64_t radixKey(int64_t value) noexcept { return (uint64_t)value ^ 0x8000'0000'0000'0000ull; }
+
+	// negative floats have every bit flipped so larger magnitudes sort first, positive ones only the sign, NaNs sort at the ends
+	constexpr uint32_t radixKey(float value) noexcept
+	{
+		uint32_t const bits = __builtin_bit_cast(uint32_t, value);
+		return (bits & 0x8000'0000u) ? ~bits : bits | 0x8000'0000u;
+	}
+
+	constexpr uint64_t radixKey(double value) noexcept
+	{
+		uint64_t const bits = __builtin_bit_cast(uint64_t, value);
+		return (bits & 0x8000'0000'0000'0000ull) ? ~bits : bits | 0x8000'0000'0000'0000ull;
+	}
+
+	struct RadixKey
+	{
+		template<typename T>
+		constexpr auto operator()(T const& value) const noexcept
+		{
+			return radixKey(value);
+		}
+	};
+
+	namespace detail
+	{
+		// below this size insertion sort beats partitioning and merging
+		constexpr uint32_t insertionSortThreshold = 16;
+		// length of the runs sorted by insertion before stableSort merges them
+		constexpr uint32_t stableRunLength = 32;
+		// smaller ranges aren't worth the histogram passes of radixSort
+		constexpr uint32_t radixSortThreshold = 64;
+		// smaller ranges aren't worth starting threads
+		constexpr uint32_t parallelSortThreshold = 1 << 16;
+		constexpr uint32_t maxSortThreads = 64;
+
+		template<typename T, typename Compare>
+		void insertionSort(T* first, T* last, Compare& less) noexcept
+		{
+			for (T* it = first + 1; it < last; ++it)
+			{
+				if (!less(*it, *(it - 1)))
+					continue;
+
+				T value = wob::move(*it);
+				T* hole = it;
+				do
+				{
+					*hole = wob::move(*(hole - 1));
+					--hole;
+				} while (hole > first && less(value, *(hole - 1)));
+				*hole = wob::move(value);
+			}
+		}
+
+		template<typename T, typename Compare>
+		void siftDown(T* first, uint32_t i, uint32_t count, Compare& less) noexcept
+		{
+			for (;;)
+			{
+				uint32_t largest = i;
+				uint32_t const left = 2 * i + 1;
+				uint32_t const right = left + 1;
+				if (left < count && less(first[largest], first[left]))
+					largest = left;
+				if (right < count && less(first[largest], first[right]))
+					largest = right;
+				if (largest == i)
+					return;
+				wob::swap(first[i], first[largest]);
+				i = largest;
+			}
+		}
+
+		template<typename T, typename Compare>
+		void heapSort(T* first, T* last, Compare& less) noexcept
+		{
+			uint32_t const count = (uint32_t)(last - first);
+			for (uint32_t i = count / 2; i > 0; i--)
+				siftDown(first, i - 1, count, less);
+			for (uint32_t end = count - 1; end > 0; end--)
+			{
+				wob::swap(first[0], first[end]);
+				siftDown(first, 0, end, less);
+			}
+		}
+
+		template<typename T, typename Compare>
+		void sort3(T* a, T* b, T* c, Compare& less) noexcept
+		{
+			if (less(*b, *a))
+				wob::swap(*a, *b);
+			if (less(*c, *b))
+			{
+				wob::swap(*b, *c);
+				if (less(*b, *a))
+					wob::swap(*a, *b);
+			}
+		}
+
+		template<typename T, typename Compare>
+		void introSort(T* first, T* last, uint32_t depthLimit, Compare& less) noexcept
+		{
+			while (last - first > (ptrdiff_t)insertionSortThreshold)
+			{
+				// quick sort degenerates, the heap sort bounds the worst case
+				if (depthLimit == 0)
+				{
+					heapSort(first, last, less);
+					return;
+				}
+				depthLimit--;
+
+				// median of three as pivot, moved to first
+				// the smallest of the three stays at first + 1 and the largest at last - 1, they stop the scans below
+				T* const mid = first + (last - first) / 2;
+				sort3(first + 1, mid, last - 1, less);
+				wob::swap(*first, *mid);
+
+				T* i = first;
+				T* j = last;
+				for (;;)
+				{
+					do ++i; while (less(*i, *first));
+					do --j; while (less(*first, *j));
+					if (i >= j)
+						break;
+					wob::swap(*i, *j);
+				}
+				wob::swap(*first, *j);
+
+				// recurse on the smaller side so the stack depth stays in O(log n)
+				if (j - first < last - (j + 1))
+				{
+					introSort(first, j, depthLimit, less);
+					first = j + 1;
+				}
+				else
+				{
+					introSort(j + 1, last, depthLimit, less);
+					last = j;
+				}
+			}
+			insertionSort(first, last, less);
+		}
+
+		template<typename T, typename Compare>
+		void sort(T* first, T* last, Compare& less) noexcept
+		{
+			if (last - first < 2)
+				return;
+
+			uint32_t depthLimit = 0;
+			for (uint32_t n = (uint32_t)(last - first); n > 1; n >>= 1)
+				depthLimit += 2;
+			introSort(first, last, depthLimit, less);
+		}
+
+		// merge the sorted runs [first, mid) and [mid, last), buffer holds at least mid - first uninitialized elements
+		template<typename T, typename Compare>
+		void mergeRuns(T* first, T* mid, T* last, T* buffer, Compare& less) noexcept
+		{
+			if (first == mid || mid == last || !less(*mid, *(mid - 1)))
+				return;
+
+			// move the left run out of the way, the output never overtakes the right run
+			uint32_t const leftCount = (uint32_t)(mid - first);
+			for (uint32_t i = 0; i < leftCount; i++)
+				new (&buffer[i]) T(wob::move(first[i]));
+
+			T* left = buffer;
+			T* const leftEnd = buffer + leftCount;
+			T* right = mid;
+			T* out = first;
+			while (left < leftEnd && right < last)
+			{
+				// take from the left on ties to keep the sort stable
+				if (less(*right, *left))
+					*out++ = wob::move(*right++);
+				else
+					*out++ = wob::move(*left++);
+			}
+			while (left < leftEnd)
+				*out++ = wob::move(*left++);
+
+			if constexpr (!isTriviallyDestructible<T>)
+			{
+				for (uint32_t i = 0; i < leftCount; i++)
+					buffer[i].~T();
+			}
+		}
+
+		template<typename T, typename Compare>
+		void stableSort(T* first, T* last, Compare& less, IAllocator& scratch) noexcept
+		{
+			uint32_t const count = (uint32_t)(last - first);
+			for (uint32_t lo = 0; lo < count; lo += stableRunLength)
+				insertionSort(first + lo, first + (count - lo < stableRunLength ? count : lo + stableRunLength), less);
+
+			if (count <= stableRunLength)
+				return;
+
+			// the last merges can have a left run larger than half the range
+			T* const buffer = scratch.allocate<T>(count);
+			for (uint32_t width = stableRunLength; width < count; width *= 2)
+			{
+				for (uint32_t lo = 0; lo + width < count; lo += 2 * width)
+				{
+					uint32_t const hi = count - lo < 2 * width ? count : lo + 2 * width;
+					mergeRuns(first + lo, first + lo + width, first + hi, buffer, less);
+				}
+			}
+			scratch.deallocate(buffer);
+		}
+
+		template<typename T, typename KeyFn>
+		void radixSort(T* first, T* last, KeyFn& key, IAllocator& scratch) noexcept
+		{
+			using Key = remove_cvref_t<decltype(key(*first))>;
+			static_assert(is_same_v<Key, uint32_t> || is_same_v<Key, uint64_t>, "radix keys must be uint32_t or uint64_t, see radixKey");
+			static_assert(isTriviallyCopyable<T>, "radixSort copies elements between buffers, sort indices for other types");
+
+			uint32_t const count = (uint32_t)(last - first);
+			if (count < radixSortThreshold)
+			{
+				// stable like the radix passes
+				auto lessKey = [&key](T const& a, T const& b) { return key(a) < key(b); };
+				insertionSort(first, last, lessKey);
+				return;
+			}
+
+			constexpr uint32_t passCount = sizeof(Key);
+			uint32_t histograms[passCount][256] = {};
+			for (T const* it = first; it < last; ++it)
+			{
+				Key const k = key(*it);
+				for (uint32_t pass = 0; pass < passCount; pass++)
+					histograms[pass][(k >> (pass * 8)) & 0xFF]++;
+			}
+
+			T* const buffer = scratch.allocate<T>(count);
+			T* src = first;
+			T* dst = buffer;
+			for (uint32_t pass = 0; pass < passCount; pass++)
+			{
+				uint32_t* const histogram = histograms[pass];
+				uint32_t const shift = pass * 8;
+
+				// every key has the same digit, the pass wouldn't move anything
+				if (histogram[(key(*src) >> shift) & 0xFF] == count)
+					continue;
+
+				uint32_t offset = 0;
+				for (uint32_t digit = 0; digit < 256; digit++)
+				{
+					uint32_t const digitCount = histogram[digit];
+					histogram[digit] = offset;
+					offset += digitCount;
+				}
+
+				for (uint32_t i = 0; i < count; i++)
+					dst[histogram[(key(src[i]) >> shift) & 0xFF]++] = src[i];
+				wob::swap(src, dst);
+			}
+
+			if (src != first)
+				memcpy(static_cast<void*>(first), src, count * sizeof(T));
+			scratch.deallocate(buffer);
+		}
+
+		// run task(i) for i in [0, count), task 0 on the calling thread
+		// uses the workers of the context job system when there is one, else starts a thread per task
+		template<typename Task>
+		void runOnThreads(uint32_t count, Task& task) noexcept
+		{
+			struct ThreadTask
+			{
+				Task* task;
+				uint32_t index;
+			};
+
+			auto entry = [](void* data) { ThreadTask* t = static_cast<ThreadTask*>(data); (*t->task)(t->index); };
+
+			if (JobSystem* const jobSystem = context.jobSystem)
+			{
+				ThreadTask jobTasks[maxSortThreads];
+				Job jobs[maxSortThreads];
+				for (uint32_t i = 1; i < count; i++)
+				{
+					jobTasks[i] = ThreadTask{ &task, i };
+					jobs[i] = Job{ entry, &jobTasks[i] };
+				}
+				JobCounter counter;
+				jobSystem->run(jobs + 1, count - 1, counter);
+				task(0);
+				jobSystem->wait(counter);
+				return;
+			}
+
+			Thread threads[maxSortThreads];
+			ThreadTask threadTasks[maxSortThreads];
+			for (uint32_t i = 1; i < count; i++)
+			{
+				threadTasks[i] = ThreadTask{ &task, i };
+				// run it here if the OS refuses a new thread
+				if (!threads[i].start(entry, &threadTasks[i], "wob sort"))
+					task(i);
+			}
+			task(0);
+			for (uint32_t i = 1; i < count; i++)
+			{
+				if (threads[i].joinable())
+					threads[i].join();
+			}
+		}
+
+		template<typename T, typename Compare>
+		void parallelSort(T* first, T* last, Compare& less, uint32_t threadCount, IAllocator& scratch) noexcept
+		{
+			uint32_t const count = (uint32_t)(last - first);
+			if (threadCount == 0)
+				threadCount = context.jobSystem ? context.jobSystem->threadCount() : Thread::processorCount();
+			// keep chunks large enough to pay for their thread
+			while (threadCount > 1 && count / threadCount < parallelSortThreshold / 4)
+				threadCount--;
+			threadCount = threadCount < maxSortThreads ? threadCount : maxSortThreads;
+
+			if (count < parallelSortThreshold || threadCount < 2)
+			{
+				sort(first, last, less);
+				return;
+			}
+
+			// chunk i is [bounds[i], bounds[i + 1])
+			uint32_t bounds[maxSortThreads + 1];
+			for (uint32_t i = 0; i <= threadCount; i++)
+				bounds[i] = (uint32_t)((uint64_t)count * i / threadCount);
+
+			auto sortChunk = [&](uint32_t i) { sort(first + bounds[i], first + bounds[i + 1], less); };
+			runOnThreads(threadCount, sortChunk);
+
+			// merge neighbour runs in parallel until one is left, each merge uses its own part of the buffer
+			T* const buffer = scratch.allocate<T>(count);
+			for (uint32_t width = 1; width < threadCount; width *= 2)
+			{
+				uint32_t const mergeCount = (threadCount - width + 2 * width - 1) / (2 * width);
+				auto mergeChunks = [&](uint32_t m)
+				{
+					uint32_t const lo = m * 2 * width;
+					uint32_t const mid = lo + width;
+					uint32_t const hi = mid + width < threadCount ? mid + width : threadCount;
+					mergeRuns(first + bounds[lo], first + bounds[mid], first + bounds[hi], buffer + bounds[lo], less);
+				};
+				runOnThreads(mergeCount, mergeChunks);
+			}
+			scratch.deallocate(buffer);
+		}
+	}
+
+	template<typename Range, typename Compare = Less>
+	void sort(Range&& range, Compare less = {}) noexcept
+	{
+		auto* const first = begin(range);
+		auto* const last = end(range);
+		detail::sort(first, last, less);
+	}
+
+	template<typename Range, typename Compare>
+	void stableSort(Range&& range, Compare less, IAllocator& scratch) noexcept
+	{
+		auto* const first = begin(range);
+		auto* const last = end(range);
+		detail::stableSort(first, last, less, scratch);
+	}
+
+	template<typename Range, typename Compare = Less>
+	void stableSort(Range&& range, Compare less = {}) noexcept
+	{
+		stableSort(range, less, *getContextAllocator());
+	}
+
+	// sort by the unsigned key returned by key(element), elements must be trivially copyable
+	template<typename Range, typename KeyFn>
+	void radixSort(Range&& range, KeyFn key, IAllocator& scratch) noexcept
+	{
+		auto* const first = begin(range);
+		auto* const last = end(range);
+		detail::radixSort(first, last, key, scratch);
+	}
+
+	template<typename Range, typename KeyFn = RadixKey>
+	void radixSort(Range&& range, KeyFn key = {}) noexcept
+	{
+		radixSort(range, key, *getContextAllocator());
+	}
+
+	// threadCount 0 uses every core, small ranges are sorted on the calling thread
+	template<typename Range, typename Compare>
+	void parallelSort(Range&& range, Compare less, uint32_t threadCount, IAllocator& scratch) noexcept
+	{
+		auto* const first = begin(range);
+		auto* const last = end(range);
+		detail::parallelSort(first, last, less, threadCount, scratch);
+	}
+
+	template<typename Range, typename Compare = Less>
+	void parallelSort(Range&& range, Compare less = {}, uint32_t threadCount = 0) noexcept
+	{
+		parallelSort(range, less, threadCount, *getContextAllocator());
+	}
+
+	template<typename Range, typename Compare = Less>
+	[[nodiscard]] bool isSorted(Range&& range, Compare less = {}) noexcept
+	{
+		auto* const first = begin(range);
+		auto* const last = end(range);
+		if (first == last)
+			return true;
+		for (auto* it = first + 1; it < last; ++it)
+		{
+			if (less(*it, *(it - 1)))
+				return false;
+		}
+		return true;
+	}
+}
+
+#endif
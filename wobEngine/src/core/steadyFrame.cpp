@@ -0,0 +1,95 @@
+#include "steadyFrame.hpp"
+#include "wob.hpp"
+#include "atomic.hpp"
+#include "profiler.hpp"
+
+using namespace wob;
+
+namespace
+{
+	struct SteadyFrameState
+	{
+		SteadyFramePolicy policy = SteadyFramePolicy::Off;
+		// set while a violation is reported, the logger may allocate
+		bool reporting = false;
+		uint32_t exceptionDepth = 0;
+		uint32_t violations = 0;
+	};
+}
+
+static thread_local SteadyFrameState state;
+// one bit per MemoryTag
+static Atomic<uint32_t> allowedTags{ 0 };
+
+static_assert((int)MemoryTag::Count <= 32, "allowedTags holds one bit per tag");
+
+void wob::beginSteadyFrame(SteadyFramePolicy policy) noexcept
+{
+	state.policy = policy;
+}
+
+void wob::endSteadyFrame() noexcept
+{
+	state.policy = SteadyFramePolicy::Off;
+}
+
+bool wob::isSteadyFrame() noexcept
+{
+	return state.policy != SteadyFramePolicy::Off;
+}
+
+void wob::allowSteadyFrameAllocations(MemoryTag tag, bool allow) noexcept
+{
+	uint32_t const bit = 1u << (uint32_t)tag;
+	uint32_t mask = allowedTags.load(MemoryOrder::Relaxed);
+	while (!allowedTags.compareExchange(mask, allow ? mask | bit : mask & ~bit, MemoryOrder::Relaxed))
+	{
+	}
+}
+
+uint32_t wob::steadyFrameViolationCount() noexcept
+{
+	return state.violations;
+}
+
+void wob::checkSteadyFrameAllocation(size_t size, size_t align) noexcept
+{
+	if (state.policy == SteadyFramePolicy::Off || state.exceptionDepth != 0 || state.reporting)
+		return;
+
+	MemoryScope const* const scope = MemoryScope::current();
+	MemoryTag const tag = scope ? scope->tag : MemoryTag::Untagged;
+	if (allowedTags.load(MemoryOrder::Relaxed) & (1u << (uint32_t)tag))
+		return;
+
+	state.violations++;
+	state.reporting = true;
+	const char* const profileScope = currentProfileScope();
+	if (scope)
+	{
+		WOB_WARN("steady frame allocation of {} bytes (align {}) in {}, {}:{} {} ({})", (uint64_t)size, (uint64_t)align,
+			profileScope ? profileScope : "unknown scope", scope->location.file_name(), scope->location.line(),
+			scope->location.function_name(), memoryTagName(tag));
+	}
+	else
+	{
+		WOB_WARN("steady frame allocation of {} bytes (align {}) in {}, untagged", (uint64_t)size, (uint64_t)align,
+			profileScope ? profileScope : "unknown scope");
+	}
+	state.reporting = false;
+
+	if (state.policy == SteadyFramePolicy::Trap)
+		WOB_DEBUG_BREAK();
+}
+
+SteadyFrameException::SteadyFrameException(const char* reason) noexcept
+{
+	WOB_UNUSED(reason);
+	state.exceptionDepth++;
+}
+
+SteadyFrameException::~SteadyFrameException()
+{
+	WOB_ASSERT_NOLOG(state.exceptionDepth > 0);
+	state.exceptionDepth--;
+}
@@ -0,0 +1,55 @@
+#ifndef WOB_STEADY_FRAME_HPP
+#define WOB_STEADY_FRAME_HPP
+
+#include "macro_helpers.hpp"
+#include "memoryProfiler.hpp"
+#include <stdint.h>
+#include <stddef.h>
+
+// allow context allocations in the enclosing scope of a steady frame, reason documents the exception at the call site
+#define WOB_ALLOW_FRAME_ALLOCATIONS(reason) ::wob::SteadyFrameException WOB_CONCAT(WOB_internal_steady_frame_, __COUNTER__)(reason);
+
+namespace wob
+{
+	/*
+	 * Once a game reaches a steady state its frames shouldn't touch the heap, transient memory comes from the frame allocator.
+	 * Between beginSteadyFrame and endSteadyFrame every allocation made on this thread through AllocatorProfiler
+	 * (the context allocator) is a violation : it is reported with its size, the current MemoryScope callsite and tag
+	 * and the innermost profiled scope, then trapped if the policy asks for it.
+	 * Known exceptions are whitelisted by tag with allowSteadyFrameAllocations or by scope with WOB_ALLOW_FRAME_ALLOCATIONS.
+	 * The frame allocator overflows to the context allocator, an overflowing frame is reported like any heap allocation.
+	 * Engine::run enables it after InitInfo::steadyFrameWarmup frames.
+	 */
+	enum class SteadyFramePolicy : uint8_t
+	{
+		Off,
+		Report,
+		// report then break in the debugger
+		Trap
+	};
+
+	void beginSteadyFrame(SteadyFramePolicy policy) noexcept;
+	void endSteadyFrame() noexcept;
+	[[nodiscard]] bool isSteadyFrame() noexcept;
+
+	// allocations tagged with tag never violate, for every thread
+	void allowSteadyFrameAllocations(MemoryTag tag, bool allow = true) noexcept;
+
+	// violations reported on this thread since it started
+	[[nodiscard]] uint32_t steadyFrameViolationCount() noexcept;
+
+	// called by AllocatorProfiler for every allocation
+	void checkSteadyFrameAllocation(size_t size, size_t align) noexcept;
+
+	class SteadyFrameException
+	{
+	public:
+		explicit SteadyFrameException(const char* reason) noexcept;
+		~SteadyFrameException();
+
+		SteadyFrameException(SteadyFrameException const&) = delete;
+		SteadyFrameException& operator=(SteadyFrameException const&) = delete;
+	};
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define WOB_STRING_HPP
 
 #include <string.h>
+#include <stddef.h>
 #include "coreMacros.hpp"
 #include "stringView.hpp"
 #include "array.hpp"
@@ -9,225 +10,385 @@
 
 namespace wob
 {
-	/// General usage string class, for now just a wrapper over Array<Char>, we may want to implemet SSO in the future
-	// TODO try some optimisations details
+	/*
+	 * General usage string class, always null terminated
+	 * Small strings (up to inlineCapacity chars) are stored inline, longer ones go on the heap with their allocator.
+	 * Inline the last byte store inlineCapacity - size, so it double as the null terminator of a full inline string.
+	 * Heap the same byte is the high byte of the capacity, flagged with heapFlag (assume little endian).
+	 * Heap strings use the context allocator at the time they leave the inline storage.
+	 */
 	// TODO constexpr functions that relies on cstring funcs ?
 	class String
 	{
+		struct Heap
+		{
+			char* ptr;
+			IAllocator* allocator;
+			uint32_t size;
+			uint32_t capacity;
+		};
 
 	public:
 		using Char_t = char;
 		using Iterator_t = Char_t*;
 
-		constexpr String() noexcept = default;
+		// 23 on 64 bits targets, 15 on 32 bits
+		static constexpr uint32_t inlineCapacity = sizeof(Heap) - 1;
 
-		/*constexpr*/ String(const Char_t* cstr) noexcept
+		String() noexcept
 		{
-			WOB_ASSERT_NOLOG(cstr);
-
-			buffer.resize(strlen(cstr) + 1);
-			strcpy(buffer.data(), cstr);
+			setInlineSize(0);
 		}
 
-		/*constexpr*/ String(const Char_t* cstr, uint32_t count) noexcept
+		String(const Char_t* cstr) noexcept
 		{
 			WOB_ASSERT_NOLOG(cstr);
-
-			buffer.resize(count);
-			// @review
-			// do we want strncpy ?
-			strncpy(buffer.data(), cstr, count);
+			initFrom(cstr, (uint32_t)strlen(cstr));
 		}
 
-		/*constexpr*/ String(StringView str) noexcept
+		String(const Char_t* cstr, uint32_t count) noexcept
 		{
-			buffer.resize(str.size() + 1);
-			// @review same
-			strncpy(buffer.data(), str.data(), str.size());
-			buffer.back() = '\0';
+			WOB_ASSERT_NOLOG(cstr);
+			initFrom(cstr, count);
 		}
 
-		constexpr String(String const& rhs) noexcept : buffer(rhs.buffer)
+		String(StringView str) noexcept
 		{
-
+			initFrom(str.data(), (uint32_t)str.size());
 		}
 
-		constexpr String(String&& rhs) noexcept : buffer(wob::move(rhs.buffer))
+		String(String const& rhs) noexcept
 		{
+			if (rhs.isHeap())
+			{
+				initFrom(rhs.data(), rhs.size(), rhs.heap.allocator);
+			}
+			else
+			{
+				memcpy(inlineBuffer, rhs.inlineBuffer, sizeof(inlineBuffer));
+			}
+		}
 
+		String(String&& rhs) noexcept
+		{
+			memcpy(inlineBuffer, rhs.inlineBuffer, sizeof(inlineBuffer));
+			rhs.setInlineSize(0);
 		}
 
-		constexpr String& operator=(String const& rhs) noexcept
+		String& operator=(String const& rhs) noexcept
 		{
-			buffer = rhs.buffer;
+			if (this != &rhs)
+			{
+				resizeNoInit(rhs.size());
+				memcpy(data(), rhs.data(), rhs.size());
+			}
 			return *this;
 		}
 
-		constexpr String& operator=(String&& rhs) noexcept
+		String& operator=(String&& rhs) noexcept
 		{
-			buffer = wob::move(rhs.buffer);
+			if (this != &rhs)
+			{
+				freeHeap();
+				memcpy(inlineBuffer, rhs.inlineBuffer, sizeof(inlineBuffer));
+				rhs.setInlineSize(0);
+			}
 			return *this;
 		}
 
-		constexpr Char_t const& operator[](uint32_t i) const noexcept
+		~String() noexcept
 		{
-			return buffer[i];
+			freeHeap();
 		}
 
-		constexpr Char_t& operator[](uint32_t i) noexcept
+		Char_t const& operator[](uint32_t i) const noexcept
 		{
-			return buffer[i];
+			WOB_BOUNDS_CHECK(i < size());
+			return data()[i];
 		}
 
-		constexpr Char_t& front() noexcept
+		Char_t& operator[](uint32_t i) noexcept
 		{
-			return buffer.front();
+			WOB_BOUNDS_CHECK(i < size());
+			return data()[i];
 		}
 
-		constexpr Char_t const& front() const noexcept
+		Char_t& front() noexcept
 		{
-			return buffer.front();
+			WOB_BOUNDS_CHECK(!empty());
+			return data()[0];
 		}
 
-		constexpr Char_t& back() noexcept
+		Char_t const& front() const noexcept
 		{
-			return buffer.back();
+			WOB_BOUNDS_CHECK(!empty());
+			return data()[0];
 		}
 
-		constexpr Char_t const& back() const noexcept
+		Char_t& back() noexcept
 		{
-			return buffer.back();
+			WOB_BOUNDS_CHECK(!empty());
+			return data()[size() - 1];
 		}
 
-		constexpr const char* c_str() const noexcept
+		Char_t const& back() const noexcept
 		{
-			return buffer.data();
+			WOB_BOUNDS_CHECK(!empty());
+			return data()[size() - 1];
 		}
 
-		constexpr Char_t* data() noexcept
+		const char* c_str() const noexcept
 		{
-			return buffer.data();
+			return data();
 		}
 
-		constexpr Char_t const* data() const noexcept
+		Char_t* data() noexcept
 		{
-			return buffer.data();
+			return isHeap() ? heap.ptr : inlineBuffer;
 		}
 
-		constexpr uint32_t size() const noexcept
+		Char_t const* data() const noexcept
 		{
-			return buffer.empty() ? 0 : buffer.size() - 1;
+			return isHeap() ? heap.ptr : inlineBuffer;
 		}
 
-		constexpr uint32_t capacity() const noexcept
+		uint32_t size() const noexcept
 		{
-			return buffer.capacity() == 0 ? 0 : buffer.capacity() - 1;
+			return isHeap() ? heap.size : inlineCapacity - (uint8_t)inlineBuffer[inlineCapacity];
 		}
 
-		constexpr bool empty() const noexcept
+		uint32_t capacity() const noexcept
 		{
-			return buffer.empty();
+			return isHeap() ? heap.capacity & ~heapFlag : inlineCapacity;
 		}
 
-		constexpr void shrink() noexcept
+		bool empty() const noexcept
 		{
-			buffer.shrink();
+			return size() == 0;
 		}
 
-		constexpr void reserve(uint32_t cap) noexcept
+		bool isInline() const noexcept
 		{
-			buffer.reserve(cap + 1);
+			return !isHeap();
 		}
 
-		constexpr void resizeNoInit(uint32_t cap) noexcept
+		// move back inline if possible, otherwise give back the unused capacity
+		void shrink() noexcept
 		{
-			buffer.resizeNoInit(cap + 1);
+			if (!isHeap())
+				return;
+
+			uint32_t const sz = heap.size;
+			if (sz <= inlineCapacity)
+			{
+				Heap const old = heap;
+				memcpy(inlineBuffer, old.ptr, sz);
+				setInlineSize(sz);
+				old.allocator->deallocate(old.ptr);
+			}
+			else if (sz < capacity())
+			{
+				heap.ptr = static_cast<Char_t*>(heap.allocator->reallocate(heap.ptr, sz + 1, sz + 1, 1));
+				setHeapCapacity(sz);
+			}
 		}
 
-		constexpr void resize(uint32_t sz) noexcept
+		void reserve(uint32_t cap) noexcept
 		{
-			buffer.resize(sz + 1);
-			buffer.back() = '\0';
+			if (cap <= capacity())
+				return;
+
+			uint32_t const sz = size();
+			if (isHeap())
+			{
+				heap.ptr = static_cast<Char_t*>(heap.allocator->reallocate(heap.ptr, sz + 1, cap + 1, 1));
+			}
+			else
+			{
+				IAllocator* const allocator = getContextAllocator();
+				Char_t* const ptr = static_cast<Char_t*>(allocator->allocate(cap + 1, 1));
+				memcpy(ptr, inlineBuffer, sz + 1);
+				heap.ptr = ptr;
+				heap.allocator = allocator;
+				heap.size = sz;
+			}
+			setHeapCapacity(cap);
+		}
+
+		// new chars are left uninitialized
+		void resizeNoInit(uint32_t sz) noexcept
+		{
+			reserve(sz);
+			setSize(sz);
 		}
 
-		constexpr void clear() noexcept
+		// new chars are zeroed
+		void resize(uint32_t sz) noexcept
 		{
-			buffer.clear();
+			uint32_t const oldSize = size();
+			resizeNoInit(sz);
+			if (sz > oldSize)
+				memset(data() + oldSize, 0, sz - oldSize);
+		}
+
+		// keep the capacity
+		void clear() noexcept
+		{
+			setSize(0);
 		}
 
 		// todo range concepts
 		template<typename Range>
-		constexpr void insert(Iterator_t pos, Range&& range) noexcept
+		void insert(Iterator_t pos, Range&& range) noexcept
 		{
-			buffer.insert(pos, wob::forward<Range>(range));
-			buffer.push('\0');
+			WOB_BOUNDS_CHECK(pos >= begin() && pos <= end());
+			uint32_t const ipos = (uint32_t)(pos - begin());
+			uint32_t const count = (uint32_t)wob::size(range);
+			uint32_t const oldSize = size();
+			growFor(oldSize + count);
+
+			Char_t* const d = data();
+			memmove(d + ipos + count, d + ipos, oldSize - ipos);
+			uint32_t i = ipos;
+			for (auto&& c : range)
+				d[i++] = c;
+			setSize(oldSize + count);
 		}
 
-		/*constexpr*/ void append(String const& rhs) noexcept
+		void append(const Char_t* rhs, uint32_t count) noexcept
 		{
-			if (rhs.empty())
+			WOB_ASSERT_NOLOG(rhs || count == 0);
+			if (count == 0)
 				return;
-			size_t const oldSize = size();
-			resize(size() + rhs.size());
-			memcpy(&buffer[oldSize], rhs.buffer.data(), rhs.buffer.size());
+
+			uint32_t const oldSize = size();
+			growFor(oldSize + count);
+			memcpy(data() + oldSize, rhs, count);
+			setSize(oldSize + count);
 		}
 
-		/*constexpr*/ void append(const Char_t* rhs) noexcept
+		void append(String const& rhs) noexcept
+		{
+			append(rhs.data(), rhs.size());
+		}
+
+		void append(StringView rhs) noexcept
+		{
+			append(rhs.data(), (uint32_t)rhs.size());
+		}
+
+		void append(const Char_t* rhs) noexcept
 		{
 			WOB_ASSERT_NOLOG(rhs);
-			size_t const rhslen = strlen(rhs);
-			if (rhslen == 0) // string is empty
-				return;
+			append(rhs, (uint32_t)strlen(rhs));
+		}
 
-			size_t const oldSize = size();
-			resize(size() + rhslen);
+		void append(Char_t c) noexcept
+		{
+			uint32_t const oldSize = size();
+			growFor(oldSize + 1);
+			data()[oldSize] = c;
+			setSize(oldSize + 1);
+		}
 
-			if (oldSize == 0)
-			{
-				memcpy(buffer.data(), rhs, rhslen);
-			}
-			else
+		Iterator_t begin() noexcept
+		{
+			return data();
+		}
+
+		Iterator_t end() noexcept
+		{
+			return data() + size();
+		}
+
+		operator StringView() const
+		{
+			return StringView(data(), size());
+		}
+
+	private:
+
+		static constexpr uint32_t heapFlag = 0x80000000u;
+		static_assert(offsetof(Heap, capacity) + sizeof(uint32_t) == sizeof(Heap), "heap capacity must overlap the last inline char");
+
+		union
+		{
+			Heap heap;
+			Char_t inlineBuffer[inlineCapacity + 1];
+		};
+
+		bool isHeap() const noexcept
+		{
+			return ((uint8_t)inlineBuffer[inlineCapacity] & 0x80) != 0;
+		}
+
+		void initFrom(const Char_t* str, uint32_t count, IAllocator* allocator = nullptr) noexcept
+		{
+			if (count <= inlineCapacity)
 			{
-				memcpy(&buffer[oldSize], rhs, rhslen);
+				memcpy(inlineBuffer, str, count);
+				setInlineSize(count);
+				return;
 			}
+
+			if (allocator == nullptr)
+				allocator = getContextAllocator();
+			heap.ptr = static_cast<Char_t*>(allocator->allocate(count + 1, 1));
+			heap.allocator = allocator;
+			memcpy(heap.ptr, str, count);
+			heap.ptr[count] = '\0';
+			heap.size = count;
+			setHeapCapacity(count);
 		}
 
-		constexpr void append(Char_t c) noexcept
+		void freeHeap() noexcept
 		{
-			if (empty())
-				buffer.push(c);
-			else
-				buffer[size()] = c;
-			buffer.push('\0');
+			if (isHeap())
+			{
+				heap.allocator->deallocate(heap.ptr);
+				setInlineSize(0);
+			}
 		}
 
-		/*constexpr*/ void append(const Char_t* rhs, uint32_t count) noexcept
+		void setInlineSize(uint32_t sz) noexcept
 		{
-			WOB_ASSERT_NOLOG(rhs);
-			
-			resize(buffer.capacity() + count);
-			memcpy(&buffer[size()], rhs, count);
+			WOB_ASSERT_NOLOG(sz <= inlineCapacity);
+			inlineBuffer[sz] = '\0';
+			inlineBuffer[inlineCapacity] = (Char_t)(inlineCapacity - sz);
 		}
 
-		constexpr Iterator_t begin() noexcept
+		void setHeapCapacity(uint32_t cap) noexcept
 		{
-			return buffer.begin();
+			WOB_ASSERT_NOLOG(cap < heapFlag);
+			heap.capacity = cap | heapFlag;
 		}
 
-		constexpr Iterator_t end() noexcept
+		// capacity must be enough for sz
+		void setSize(uint32_t sz) noexcept
 		{
-			return buffer.end() - 1;
+			if (isHeap())
+			{
+				heap.size = sz;
+				heap.ptr[sz] = '\0';
+			}
+			else
+			{
+				setInlineSize(sz);
+			}
 		}
 
-		operator StringView() const
+		// geometric growth for appends
+		void growFor(uint32_t sz) noexcept
 		{
-			return StringView(buffer.data(), size());
+			uint32_t const cap = capacity();
+			if (sz > cap)
+				reserve(sz > cap * 2 ? sz : cap * 2);
 		}
-
-	private:
-		Array<Char_t> buffer;
 	};
 
+	template<>
+	constexpr bool isTriviallyRelocatable<String> = true;
+
 	inline/*constexpr*/ Ordering operator<=>(String const& lhs, String const& rhs) noexcept
 	{
 		return Ordering{ strcmp(lhs.data(), rhs.data()) };
@@ -248,21 +409,46 @@ namespace wob
 		return (lhs <=> rhs) == Ordering::equal;
 	}
 
+	inline bool operator==(String const& lhs, StringView rhs) noexcept
+	{
+		return lhs.size() == rhs.size() && memcmp(lhs.data(), rhs.data(), rhs.size()) == 0;
+	}
+
+	// transparent: String keyed HashMaps can be queried with a StringView or a literal without building a String
 	template<>
 	struct Hash<String>
 	{
-		constexpr uint64_t operator()(String const& str)
+		using is_transparent = void;
+
+		uint64_t operator()(String const& str)
+		{
+			return hashBytes(str.data(), str.size());
+		}
+
+		uint64_t operator()(StringView str)
+		{
+			return hashBytes(str.data(), str.size());
+		}
+
+		uint64_t operator()(const char* str)
 		{
-			return Hash<const char*>{}(str.c_str());
+			return hashBytes(str, strlen(str));
 		}
 	};
 
 	template<>
 	struct Hash<StringView>
 	{
+		using is_transparent = void;
+
 		uint64_t operator()(StringView str)
 		{
-			return Hash<const char*>{}(str.data(), str.end());
+			return hashBytes(str.data(), str.size());
+		}
+
+		uint64_t operator()(const char* str)
+		{
+			return hashBytes(str, strlen(str));
 		}
 	};
 }
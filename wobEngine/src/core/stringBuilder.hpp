@@ -0,0 +1,161 @@
+#ifndef WOB_STRING_BUILDER_HPP
+#define WOB_STRING_BUILDER_HPP
+
+#include <string.h>
+#include "coreMacros.hpp"
+#include "allocator.hpp"
+#include "stringView.hpp"
+#include "string.hpp"
+
+namespace wob
+{
+	/*
+	 * Append only char buffer used to build text (code generation, formatting) without a reallocation per append
+	 * Storage comes either from an allocator or from a caller supplied buffer (typically on the stack),
+	 * a full caller buffer moves to the context allocator. Growth is geometric and goes through IAllocator::reallocate
+	 * so a builder on a StackAllocator grows in place while it owns the last allocation.
+	 * The content is always null terminated.
+	 */
+	class StringBuilder
+	{
+	public:
+
+		explicit StringBuilder(IAllocator& allocator, uint32_t initialCapacity = 256) noexcept
+			: allocator(&allocator), buffer(nullptr), size_(0), capacity_(0), ownsBuffer(true)
+		{
+			reserve(initialCapacity);
+		}
+
+		template<uint32_t N>
+		explicit StringBuilder(char (&storage)[N]) noexcept : StringBuilder(storage, N)
+		{
+		}
+
+		StringBuilder(char* storage, uint32_t storageSize) noexcept
+			: allocator(nullptr), buffer(storage), size_(0), capacity_(storageSize - 1), ownsBuffer(false)
+		{
+			WOB_ASSERT_NOLOG(storage && storageSize > 0);
+			buffer[0] = '\0';
+		}
+
+		StringBuilder(StringBuilder const&) = delete;
+		StringBuilder& operator=(StringBuilder const&) = delete;
+
+		~StringBuilder() noexcept
+		{
+			if (ownsBuffer)
+				allocator->deallocate(buffer);
+		}
+
+		void append(const char* str, uint32_t count) noexcept
+		{
+			memcpy(appendNoInit(count), str, count);
+		}
+
+		void append(StringView str) noexcept
+		{
+			append(str.data(), (uint32_t)str.size());
+		}
+
+		void append(String const& str) noexcept
+		{
+			append(str.data(), str.size());
+		}
+
+		void append(const char* str) noexcept
+		{
+			WOB_ASSERT_NOLOG(str);
+			append(str, (uint32_t)strlen(str));
+		}
+
+		void append(char c) noexcept
+		{
+			if (size_ == capacity_)
+				grow(size_ + 1);
+			buffer[size_++] = c;
+			buffer[size_] = '\0';
+		}
+
+		// extend the content by count chars and return them to be written by the caller
+		[[nodiscard]] char* appendNoInit(uint32_t count) noexcept
+		{
+			if (size_ + count > capacity_)
+				grow(size_ + count);
+			char* const dst = buffer + size_;
+			size_ += count;
+			buffer[size_] = '\0';
+			return dst;
+		}
+
+		// drop the last count chars
+		void shrinkBy(uint32_t count) noexcept
+		{
+			WOB_BOUNDS_CHECK(count <= size_);
+			size_ -= count;
+			buffer[size_] = '\0';
+		}
+
+		void reserve(uint32_t cap) noexcept
+		{
+			if (cap <= capacity_ && buffer != nullptr)
+				return;
+
+			if (ownsBuffer)
+			{
+				buffer = static_cast<char*>(allocator->reallocate(buffer, buffer ? size_ + 1 : 0, cap + 1, 1));
+			}
+			else
+			{
+				// caller storage is full, continue on the heap
+				allocator = getContextAllocator();
+				char* const newBuffer = static_cast<char*>(allocator->allocate(cap + 1, 1));
+				memcpy(newBuffer, buffer, size_);
+				buffer = newBuffer;
+				ownsBuffer = true;
+			}
+			capacity_ = cap;
+			buffer[size_] = '\0';
+		}
+
+		// keep the storage
+		void clear() noexcept
+		{
+			size_ = 0;
+			buffer[0] = '\0';
+		}
+
+		[[nodiscard]] uint32_t size() const noexcept { return size_; }
+		[[nodiscard]] uint32_t capacity() const noexcept { return capacity_; }
+		[[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+
+		[[nodiscard]] char const* data() const noexcept { return buffer; }
+		[[nodiscard]] char const* c_str() const noexcept { return buffer; }
+
+		[[nodiscard]] StringView view() const noexcept
+		{
+			return StringView(buffer, size_);
+		}
+
+		// single allocation, none if the result fits in String inline storage
+		[[nodiscard]] String toString() const noexcept
+		{
+			return String(buffer, size_);
+		}
+
+	private:
+
+		void grow(uint32_t minCapacity) noexcept
+		{
+			uint32_t const doubled = capacity_ * 2;
+			reserve(minCapacity > doubled ? minCapacity : doubled);
+		}
+
+		IAllocator* allocator;
+		char* buffer;
+		uint32_t size_;
+		uint32_t capacity_;
+		bool ownsBuffer;
+	};
+}
+
+#endif
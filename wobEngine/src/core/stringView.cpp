@@ -0,0 +1,307 @@
+#include "stringView.hpp"
+#include "maths.hpp"
+
+// kernels are picked at compile time from the target flags, builds without any of them use the scalar loops
+#if defined(__AVX2__)
+	#define WOB_STRING_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define WOB_STRING_SSE2
+	#include <emmintrin.h>
+	// pshufb for the char class lookups, msvc only defines __AVX__ (/arch:AVX)
+	#if defined(__SSSE3__) || defined(__AVX__)
+		#define WOB_STRING_SSSE3
+		#include <tmmintrin.h>
+	#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define WOB_STRING_NEON
+	#include <arm_neon.h>
+#endif
+
+using namespace wob;
+
+namespace
+{
+#if defined(WOB_STRING_AVX2)
+
+	constexpr size_t vectorSize = 32;
+	using Vector = __m256i;
+
+	Vector load(const char* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)); }
+	Vector splat(char c) noexcept { return _mm256_set1_epi8(c); }
+	Vector equal(Vector a, Vector b) noexcept { return _mm256_cmpeq_epi8(a, b); }
+	Vector both(Vector a, Vector b) noexcept { return _mm256_and_si256(a, b); }
+	// one bit per byte lane set where the lane is 0xFF
+	uint64_t laneMask(Vector v) noexcept { return (uint32_t)_mm256_movemask_epi8(v); }
+	// log2 of the bits per lane in a laneMask
+	constexpr int laneShift = 0;
+	constexpr uint64_t allLanes = 0xFFFF'FFFF;
+
+	// number of 0xFF lanes accumulated by subtracting up to 255 comparison results
+	Vector countZero() noexcept { return _mm256_setzero_si256(); }
+	Vector countAdd(Vector counts, Vector match) noexcept { return _mm256_sub_epi8(counts, match); }
+	size_t countSum(Vector counts) noexcept
+	{
+		__m256i const sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+		return (size_t)(_mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) + _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3));
+	}
+
+	#define WOB_STRING_CHAR_CLASS
+	struct ClassTables
+	{
+		explicit ClassTables(CharClass const& cls) noexcept
+			: low(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<__m128i const*>(cls.rows[0])))),
+			  high(_mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<__m128i const*>(cls.rows[1]))))
+		{
+
+		}
+
+		__m256i low;
+		__m256i high;
+	};
+
+	// 0xFF lanes for the bytes in the class
+	Vector inClass(Vector v, ClassTables const& tables) noexcept
+	{
+		__m256i const nibbleMask = _mm256_set1_epi8(0x0F);
+		__m256i const bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+		__m256i const lo = _mm256_and_si256(v, nibbleMask);
+		__m256i const hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibbleMask);
+		__m256i const isHigh = _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7));
+		__m256i const rows = _mm256_blendv_epi8(_mm256_shuffle_epi8(tables.low, lo), _mm256_shuffle_epi8(tables.high, lo), isHigh);
+		__m256i const bit = _mm256_shuffle_epi8(bits, hi);
+		return _mm256_cmpeq_epi8(_mm256_and_si256(rows, bit), bit);
+	}
+
+#elif defined(WOB_STRING_SSE2)
+
+	constexpr size_t vectorSize = 16;
+	using Vector = __m128i;
+
+	Vector load(const char* p) noexcept { return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p)); }
+	Vector splat(char c) noexcept { return _mm_set1_epi8(c); }
+	Vector equal(Vector a, Vector b) noexcept { return _mm_cmpeq_epi8(a, b); }
+	Vector both(Vector a, Vector b) noexcept { return _mm_and_si128(a, b); }
+	uint64_t laneMask(Vector v) noexcept { return (uint32_t)_mm_movemask_epi8(v); }
+	constexpr int laneShift = 0;
+	constexpr uint64_t allLanes = 0xFFFF;
+
+	Vector countZero() noexcept { return _mm_setzero_si128(); }
+	Vector countAdd(Vector counts, Vector match) noexcept { return _mm_sub_epi8(counts, match); }
+	size_t countSum(Vector counts) noexcept
+	{
+		__m128i const sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+		return (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+	}
+
+	#ifdef WOB_STRING_SSSE3
+	#define WOB_STRING_CHAR_CLASS
+	struct ClassTables
+	{
+		explicit ClassTables(CharClass const& cls) noexcept
+			: low(_mm_load_si128(reinterpret_cast<__m128i const*>(cls.rows[0]))),
+			  high(_mm_load_si128(reinterpret_cast<__m128i const*>(cls.rows[1])))
+		{
+
+		}
+
+		__m128i low;
+		__m128i high;
+	};
+
+	Vector inClass(Vector v, ClassTables const& tables) noexcept
+	{
+		__m128i const nibbleMask = _mm_set1_epi8(0x0F);
+		__m128i const bits = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+		__m128i const lo = _mm_and_si128(v, nibbleMask);
+		__m128i const hi = _mm_and_si128(_mm_srli_epi16(v, 4), nibbleMask);
+		__m128i const isHigh = _mm_cmpgt_epi8(hi, _mm_set1_epi8(7));
+		__m128i const rows = _mm_or_si128(_mm_and_si128(isHigh, _mm_shuffle_epi8(tables.high, lo)), _mm_andnot_si128(isHigh, _mm_shuffle_epi8(tables.low, lo)));
+		__m128i const bit = _mm_shuffle_epi8(bits, hi);
+		return _mm_cmpeq_epi8(_mm_and_si128(rows, bit), bit);
+	}
+	#endif
+
+#elif defined(WOB_STRING_NEON)
+
+	constexpr size_t vectorSize = 16;
+	using Vector = uint8x16_t;
+
+	Vector load(const char* p) noexcept { return vld1q_u8(reinterpret_cast<uint8_t const*>(p)); }
+	Vector splat(char c) noexcept { return vdupq_n_u8((uint8_t)c); }
+	Vector equal(Vector a, Vector b) noexcept { return vceqq_u8(a, b); }
+	Vector both(Vector a, Vector b) noexcept { return vandq_u8(a, b); }
+	// no movemask, the narrowing shift packs each byte lane into 4 bits of a 64 bits mask
+	uint64_t laneMask(Vector v) noexcept
+	{
+		return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(v), 4)), 0);
+	}
+	constexpr int laneShift = 2;
+	constexpr uint64_t allLanes = ~0ull;
+
+	Vector countZero() noexcept { return vdupq_n_u8(0); }
+	Vector countAdd(Vector counts, Vector match) noexcept { return vsubq_u8(counts, match); }
+	size_t countSum(Vector counts) noexcept
+	{
+		uint64x2_t const sums = vpaddlq_u32(vpaddlq_u16(vpaddlq_u8(counts)));
+		return (size_t)(vgetq_lane_u64(sums, 0) + vgetq_lane_u64(sums, 1));
+	}
+
+	#define WOB_STRING_CHAR_CLASS
+	struct ClassTables
+	{
+		explicit ClassTables(CharClass const& cls) noexcept
+		{
+			low.val[0] = vld1_u8(cls.rows[0]);
+			low.val[1] = vld1_u8(cls.rows[0] + 8);
+			high.val[0] = vld1_u8(cls.rows[1]);
+			high.val[1] = vld1_u8(cls.rows[1] + 8);
+		}
+
+		uint8x8x2_t low;
+		uint8x8x2_t high;
+	};
+
+	Vector inClass(Vector v, ClassTables const& tables) noexcept
+	{
+		// armv7 only has 8 bytes table lookups
+		uint8x16_t const lo = vandq_u8(v, vdupq_n_u8(0x0F));
+		uint8x16_t const hi = vshrq_n_u8(v, 4);
+		uint8x16_t const rowsLow = vcombine_u8(vtbl2_u8(tables.low, vget_low_u8(lo)), vtbl2_u8(tables.low, vget_high_u8(lo)));
+		uint8x16_t const rowsHigh = vcombine_u8(vtbl2_u8(tables.high, vget_low_u8(lo)), vtbl2_u8(tables.high, vget_high_u8(lo)));
+		uint8x16_t const rows = vbslq_u8(vcgtq_u8(hi, vdupq_n_u8(7)), rowsHigh, rowsLow);
+		uint8x16_t const bit = vshlq_u8(vdupq_n_u8(1), vreinterpretq_s8_u8(vandq_u8(hi, vdupq_n_u8(7))));
+		return vtstq_u8(rows, bit);
+	}
+
+#endif
+
+#if defined(WOB_STRING_AVX2) || defined(WOB_STRING_SSE2) || defined(WOB_STRING_NEON)
+	#define WOB_STRING_SIMD
+
+	// lane of the lowest bit of a laneMask
+	size_t firstLane(uint64_t mask) noexcept
+	{
+		return (size_t)countTrailingZeros(mask) >> laneShift;
+	}
+
+	// clear the lowest lane of a laneMask
+	uint64_t nextLane(uint64_t mask) noexcept
+	{
+		constexpr uint64_t laneBits = (1u << (1 << laneShift)) - 1;
+		return mask & ~(laneBits << (firstLane(mask) << laneShift));
+	}
+#endif
+}
+
+bool StringView::equalBytes(const char* a, const char* b, size_t size) noexcept
+{
+	size_t i = 0;
+#ifdef WOB_STRING_SIMD
+	for (; i + vectorSize <= size; i += vectorSize)
+	{
+		if (laneMask(equal(load(a + i), load(b + i))) != allLanes)
+			return false;
+	}
+#endif
+	return memcmp(a + i, b + i, size - i) == 0;
+}
+
+size_t StringView::find(char c, size_t from) const noexcept
+{
+	if (from >= size_)
+		return npos;
+
+	size_t i = from;
+#ifdef WOB_STRING_SIMD
+	Vector const needle = splat(c);
+	for (; i + vectorSize <= size_; i += vectorSize)
+	{
+		uint64_t const mask = laneMask(equal(load(data_ + i), needle));
+		if (mask != 0)
+			return i + firstLane(mask);
+	}
+#endif
+	void const* const found = memchr(data_ + i, c, size_ - i);
+	return found ? (size_t)(static_cast<const char*>(found) - data_) : npos;
+}
+
+size_t StringView::find(StringView str, size_t from) const noexcept
+{
+	if (from > size_ || str.size_ > size_ - from)
+		return npos;
+	if (str.size_ == 0)
+		return from;
+	if (str.size_ == 1)
+		return find(str.data_[0], from);
+
+	size_t const last = str.size_ - 1;
+	size_t i = from;
+#ifdef WOB_STRING_SIMD
+	// candidates match both the first and the last char of str, only them are compared
+	// ref: http://0x80.pl/articles/simd-strfind.html
+	Vector const first = splat(str.data_[0]);
+	Vector const back = splat(str.data_[last]);
+	for (; i + last + vectorSize <= size_; i += vectorSize)
+	{
+		uint64_t mask = laneMask(both(equal(load(data_ + i), first), equal(load(data_ + i + last), back)));
+		while (mask != 0)
+		{
+			size_t const candidate = i + firstLane(mask);
+			if (memcmp(data_ + candidate + 1, str.data_ + 1, last - 1) == 0)
+				return candidate;
+			mask = nextLane(mask);
+		}
+	}
+#endif
+	for (; i + last < size_; i++)
+	{
+		if (data_[i] == str.data_[0] && data_[i + last] == str.data_[last] && memcmp(data_ + i + 1, str.data_ + 1, last - 1) == 0)
+			return i;
+	}
+	return npos;
+}
+
+size_t StringView::count(char c) const noexcept
+{
+	size_t total = 0;
+	size_t i = 0;
+#ifdef WOB_STRING_SIMD
+	Vector const needle = splat(c);
+	while (i + vectorSize <= size_)
+	{
+		// byte counters overflow after 255 vectors
+		Vector counts = countZero();
+		for (uint32_t n = 0; n < 255 && i + vectorSize <= size_; n++, i += vectorSize)
+			counts = countAdd(counts, equal(load(data_ + i), needle));
+		total += countSum(counts);
+	}
+#endif
+	for (; i < size_; i++)
+		total += data_[i] == c;
+	return total;
+}
+
+size_t StringView::skipWhile(CharClass const& cls, size_t from) const noexcept
+{
+	size_t i = from;
+	// tokens are short, most runs end before a whole vector
+	for (size_t const scalarEnd = from + 8; i < size_ && i < scalarEnd; i++)
+	{
+		if (!cls.contains(data_[i]))
+			return i;
+	}
+#ifdef WOB_STRING_CHAR_CLASS
+	ClassTables const tables(cls);
+	for (; i + vectorSize <= size_; i += vectorSize)
+	{
+		// lanes of the chars out of the class
+		uint64_t const mask = laneMask(equal(inClass(load(data_ + i), tables), splat(0)));
+		if (mask != 0)
+			return i + firstLane(mask);
+	}
+#endif
+	while (i < size_ && cls.contains(data_[i]))
+		i++;
+	return i < size_ ? i : size_;
+}
@@ -2,16 +2,92 @@
 #define WOB_STRING_VIEW_HPP
 
 #include "utility.hpp"
+#include <stdint.h>
 #include <string.h>
 
 namespace wob
 {
+	/*
+	 * Set of bytes, 256 bits stored as two 16 entries nibble lookup tables for the SIMD scans of StringView
+	 * bit (h & 7) of rows[h >> 3][l] is set when the byte (h << 4) | l belongs to the class
+	 */
+	class CharClass
+	{
+	public:
+		constexpr CharClass() noexcept : rows{} {}
+
+		// every char of the null terminated chars
+		constexpr explicit CharClass(const char* chars) noexcept : rows{}
+		{
+			for (; *chars != '\0'; chars++)
+				add(*chars);
+		}
+
+		[[nodiscard]] static constexpr CharClass range(char first, char last) noexcept
+		{
+			CharClass cls;
+			for (uint32_t b = (uint8_t)first; b <= (uint8_t)last; b++)
+				cls.add((char)b);
+			return cls;
+		}
+
+		[[nodiscard]] static constexpr CharClass whitespace() noexcept { return CharClass(" \t\n\v\f\r"); }
+		[[nodiscard]] static constexpr CharClass digits() noexcept { return range('0', '9'); }
+		[[nodiscard]] static constexpr CharClass letters() noexcept { return range('a', 'z') | range('A', 'Z'); }
+		[[nodiscard]] static constexpr CharClass alnum() noexcept { return letters() | digits(); }
+		// letters, digits and '_'
+		[[nodiscard]] static constexpr CharClass identifier() noexcept { return alnum() | CharClass("_"); }
+
+		constexpr CharClass& add(char c) noexcept
+		{
+			uint8_t const b = (uint8_t)c;
+			rows[b >> 7][b & 0xF] |= (uint8_t)(1u << ((b >> 4) & 7));
+			return *this;
+		}
+
+		[[nodiscard]] constexpr bool contains(char c) const noexcept
+		{
+			uint8_t const b = (uint8_t)c;
+			return (rows[b >> 7][b & 0xF] >> ((b >> 4) & 7)) & 1;
+		}
+
+		[[nodiscard]] constexpr CharClass operator|(CharClass const& rhs) const noexcept
+		{
+			CharClass cls;
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				cls.rows[0][i] = rows[0][i] | rhs.rows[0][i];
+				cls.rows[1][i] = rows[1][i] | rhs.rows[1][i];
+			}
+			return cls;
+		}
+
+		[[nodiscard]] constexpr CharClass operator~() const noexcept
+		{
+			CharClass cls;
+			for (uint32_t i = 0; i < 16; i++)
+			{
+				cls.rows[0][i] = (uint8_t)~rows[0][i];
+				cls.rows[1][i] = (uint8_t)~rows[1][i];
+			}
+			return cls;
+		}
+
+		alignas(16) uint8_t rows[2][16];
+	};
+
+	/*
+	 * Non owning view of a char range, not null terminated
+	 * find, count, skipWhile and equality run on SSE2 / AVX2 / NEON kernels when the target has them (see stringView.cpp)
+	 */
 	class StringView
 	{
 	public:
 		
 		using Iterator_t = const char*;
 
+		static constexpr size_t npos = ~(size_t)0;
+
 		constexpr StringView() noexcept : data_(nullptr), size_(0) { }
 		StringView(const char* str) noexcept : data_(str), size_(strlen(str)) { }
 		constexpr StringView(StringView const& rhs) noexcept : data_(rhs.data_), size_(rhs.size_) { }
@@ -38,7 +114,7 @@ namespace wob
 
 		[[nodiscard]] constexpr bool empty() const noexcept
 		{
-			return size_ > 0;
+			return size_ == 0;
 		}
 
 		[[nodiscard]] constexpr StringView substr(size_t start) const noexcept
@@ -56,7 +132,7 @@ namespace wob
 
 		[[nodiscard]] /*constexpr*/ bool operator==(StringView const& rhs) const noexcept
 		{
-			return strncmp(data_, rhs.data_, min(size_, rhs.size_)) == 0;
+			return size_ == rhs.size_ && (size_ == 0 || equalBytes(data_, rhs.data_, size_));
 		}
 
 		[[nodiscard]] /*constexpr*/ bool operator!=(StringView const& rhs) const noexcept
@@ -64,6 +140,15 @@ namespace wob
 			return !(*this == rhs);
 		}
 
+		// index of the first c at or after from, npos if there is none
+		[[nodiscard]] size_t find(char c, size_t from = 0) const noexcept;
+		// index of the first occurrence of str at or after from, npos if there is none
+		[[nodiscard]] size_t find(StringView str, size_t from = 0) const noexcept;
+		// number of c in the view, eg line count
+		[[nodiscard]] size_t count(char c) const noexcept;
+		// index of the first char at or after from that isn't in cls, size() if every char is
+		[[nodiscard]] size_t skipWhile(CharClass const& cls, size_t from = 0) const noexcept;
+
 		[[nodiscard]] constexpr Iterator_t begin() const noexcept
 		{
 			return data_;
@@ -87,6 +172,8 @@ namespace wob
 		}
 
 	private:
+		static bool equalBytes(const char* a, const char* b, size_t size) noexcept;
+
 		const char* data_;
 		size_t size_;
 	};
@@ -0,0 +1,84 @@
+#include "task.hpp"
+#include "wob.hpp"
+
+using namespace wob;
+
+// TaskEvent state once set, never a valid node address
+static detail::ScheduledResume* const setMarker = reinterpret_cast<detail::ScheduledResume*>(uintptr_t(1));
+
+TaskScheduler::~TaskScheduler() noexcept
+{
+	if (runningCount() > 0)
+		WOB_WARN("{} tasks still running when the scheduler was destroyed, their frames are leaked", runningCount());
+}
+
+void TaskScheduler::spawn(Task<void>&& task) noexcept
+{
+	running.fetchAdd(1, MemoryOrder::Relaxed);
+	runSpawned(wob::move(task), this);
+}
+
+detail::SpawnedTask TaskScheduler::runSpawned(Task<void> task, TaskScheduler* scheduler) noexcept
+{
+	co_await task;
+	scheduler->running.fetchSub(1, MemoryOrder::Release);
+}
+
+void TaskScheduler::schedule(detail::ScheduledResume& node) noexcept
+{
+	detail::ScheduledResume* head = pending.load(MemoryOrder::Relaxed);
+	do
+	{
+		node.next = head;
+	} while (!pending.compareExchange(head, &node, MemoryOrder::Release));
+}
+
+void TaskScheduler::beginFrame() noexcept
+{
+	WOB_PROFILE_FUNCTION();
+
+	// take the whole list, what gets scheduled while resuming waits for the next frame
+	detail::ScheduledResume* node = pending.exchange(nullptr, MemoryOrder::Acquire);
+
+	// the list is last in first out, resume in scheduling order
+	detail::ScheduledResume* ordered = nullptr;
+	while (node)
+	{
+		detail::ScheduledResume* const next = node->next;
+		node->next = ordered;
+		ordered = node;
+		node = next;
+	}
+
+	while (ordered)
+	{
+		// the node lives in the frame of the coroutine, read it before resuming
+		detail::ScheduledResume* const next = ordered->next;
+		ordered->handle.resume();
+		ordered = next;
+	}
+}
+
+void TaskEvent::set() noexcept
+{
+	detail::ScheduledResume* const waiting = state.exchange(setMarker, MemoryOrder::AcqRel);
+	WOB_ASSERT_NOLOG(waiting != setMarker);
+	if (waiting)
+		scheduler->schedule(*waiting);
+}
+
+bool TaskEvent::isSet() const noexcept
+{
+	return state.load(MemoryOrder::Acquire) == setMarker;
+}
+
+bool TaskEvent::Awaiter::await_suspend(std::coroutine_handle<> awaiting) noexcept
+{
+	node.handle = awaiting;
+	detail::ScheduledResume* expected = nullptr;
+	// a failed exchange means the event got set in between, keep going without suspending
+	if (event->state.compareExchange(expected, &node, MemoryOrder::AcqRel))
+		return true;
+	WOB_ASSERT_NOLOG(expected == setMarker);
+	return false;
+}
@@ -0,0 +1,343 @@
+#ifndef WOB_TASK_HPP
+#define WOB_TASK_HPP
+
+#include "coreMacros.hpp"
+#include "assert.hpp"
+#include "allocator.hpp"
+#include "atomic.hpp"
+#include "jobSystem.hpp"
+#include "utility.hpp"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+// the compiler looks up the coroutine traits in std, there is no way around this one
+#include <coroutine>
+
+namespace wob
+{
+	template<typename T>
+	class Task;
+	class TaskScheduler;
+
+	namespace detail
+	{
+		/*
+		 * coroutine frames come from an IAllocator instead of the global heap
+		 * a coroutine whose first parameter is an IAllocator& allocates from it, the others from the context allocator
+		 * the allocator is stored in front of the frame so it can be freed from any thread
+		 */
+		struct TaskFrameAllocation
+		{
+			static constexpr size_t headerSize = 16;
+
+			static void* operator new(size_t size)
+			{
+				return allocateFrame(size, *getContextAllocator());
+			}
+
+			template<typename... Args>
+			static void* operator new(size_t size, IAllocator& allocator, Args const&...)
+			{
+				return allocateFrame(size, allocator);
+			}
+
+			static void operator delete(void* frame)
+			{
+				unsigned char* const block = static_cast<unsigned char*>(frame) - headerSize;
+				IAllocator* allocator;
+				memcpy(&allocator, block, sizeof(allocator));
+				allocator->deallocate(block);
+			}
+
+			static void* allocateFrame(size_t size, IAllocator& allocator)
+			{
+				unsigned char* const block = static_cast<unsigned char*>(allocator.allocate(size + headerSize, headerSize));
+				WOB_ASSERT_NOLOG(block);
+				IAllocator* const owner = &allocator;
+				memcpy(block, &owner, sizeof(owner));
+				return block + headerSize;
+			}
+		};
+
+		struct TaskPromiseBase : TaskFrameAllocation
+		{
+			// the awaiting coroutine is resumed by symmetric transfer when the task ends
+			struct FinalAwaiter
+			{
+				bool await_ready() const noexcept { return false; }
+
+				template<typename Promise>
+				std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept
+				{
+					std::coroutine_handle<> const continuation = self.promise().continuation;
+					return continuation ? continuation : std::noop_coroutine();
+				}
+
+				void await_resume() const noexcept {}
+			};
+
+			// tasks are lazy, they start when awaited
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+
+			// we don't use exceptions
+			void unhandled_exception() const noexcept { WOB_ASSERT_NOLOG(false); }
+
+			std::coroutine_handle<> continuation;
+		};
+
+		template<typename T>
+		struct TaskPromise : TaskPromiseBase
+		{
+			TaskPromise() noexcept {}
+
+			~TaskPromise() noexcept
+			{
+				if (hasValue)
+					value.~T();
+			}
+
+			Task<T> get_return_object() noexcept;
+
+			template<typename U>
+			void return_value(U&& v) noexcept
+			{
+				WOB_ASSERT_NOLOG(!hasValue);
+				new (&value) T(wob::forward<U>(v));
+				hasValue = true;
+			}
+
+			T takeValue() noexcept
+			{
+				WOB_ASSERT_NOLOG(hasValue);
+				return wob::move(value);
+			}
+
+			union
+			{
+				T value;
+			};
+			bool hasValue = false;
+		};
+
+		template<>
+		struct TaskPromise<void> : TaskPromiseBase
+		{
+			Task<void> get_return_object() noexcept;
+
+			void return_void() const noexcept {}
+			void takeValue() const noexcept {}
+		};
+	}
+
+	/*
+	 * Lazy coroutine returning a T, it starts when awaited and resumes the awaiting coroutine when it ends
+	 * co_await moves the result out of the task, the task owns the coroutine frame and destroys it with itself
+	 * tasks are started from plain code with TaskScheduler::spawn
+	 */
+	template<typename T = void>
+	class [[nodiscard]] Task
+	{
+	public:
+		using promise_type = detail::TaskPromise<T>;
+		using Handle = std::coroutine_handle<promise_type>;
+
+		Task() noexcept = default;
+
+		explicit Task(Handle h) noexcept : handle(h) {}
+
+		Task(Task&& rhs) noexcept : handle(rhs.handle)
+		{
+			rhs.handle = nullptr;
+		}
+
+		Task& operator=(Task&& rhs) noexcept
+		{
+			if (this != &rhs)
+			{
+				if (handle)
+					handle.destroy();
+				handle = rhs.handle;
+				rhs.handle = nullptr;
+			}
+			return *this;
+		}
+
+		Task(Task const&) = delete;
+		Task& operator=(Task const&) = delete;
+
+		~Task() noexcept
+		{
+			if (handle)
+				handle.destroy();
+		}
+
+		[[nodiscard]] bool valid() const noexcept { return (bool)handle; }
+		[[nodiscard]] bool done() const noexcept { return !handle || handle.done(); }
+
+		struct Awaiter
+		{
+			bool await_ready() const noexcept { return !handle || handle.done(); }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				handle.promise().continuation = awaiting;
+				return handle;
+			}
+
+			T await_resume() noexcept
+			{
+				WOB_ASSERT_NOLOG(handle && handle.done());
+				return handle.promise().takeValue();
+			}
+
+			Handle handle;
+		};
+
+		Awaiter operator co_await() noexcept
+		{
+			return Awaiter{ handle };
+		}
+
+	private:
+		Handle handle;
+	};
+
+	namespace detail
+	{
+		template<typename T>
+		Task<T> TaskPromise<T>::get_return_object() noexcept
+		{
+			return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+		}
+
+		inline Task<void> TaskPromise<void>::get_return_object() noexcept
+		{
+			return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+		}
+
+		// eager coroutine owning a spawned task, its frame frees itself at the end
+		struct SpawnedTask
+		{
+			struct promise_type : TaskFrameAllocation
+			{
+				SpawnedTask get_return_object() const noexcept { return {}; }
+				std::suspend_never initial_suspend() const noexcept { return {}; }
+				std::suspend_never final_suspend() const noexcept { return {}; }
+				void return_void() const noexcept {}
+				void unhandled_exception() const noexcept { WOB_ASSERT_NOLOG(false); }
+			};
+		};
+
+		// coroutine waiting in one of the scheduler lists
+		struct ScheduledResume
+		{
+			std::coroutine_handle<> handle;
+			ScheduledResume* next;
+		};
+	}
+
+	/*
+	 * Resumes coroutines on the frame loop thread, the engine calls beginFrame once per frame before update
+	 * co_await scheduler.nextFrame() to yield until the next frame (from any thread, so it also hops back from a worker)
+	 * co_await scheduler.resumeOnWorker() to continue on a worker of the context job system, or right away when it has no worker
+	 * co_await on a TaskEvent to wait for a completion signaled from any thread (io, gpu fence, ...)
+	 * a spawned task that isn't done when the scheduler is destroyed is leaked and reported
+	 */
+	class TaskScheduler
+	{
+	public:
+		TaskScheduler() noexcept = default;
+		~TaskScheduler() noexcept;
+
+		TaskScheduler(TaskScheduler const&) = delete;
+		TaskScheduler& operator=(TaskScheduler const&) = delete;
+
+		// run the task until its first suspension, then let it finish on its own
+		void spawn(Task<void>&& task) noexcept;
+
+		// resume the coroutines that waited for this frame, coroutines that await nextFrame again go to the next one
+		void beginFrame() noexcept;
+
+		// spawned tasks that aren't done
+		[[nodiscard]] uint32_t runningCount() const noexcept { return running.load(MemoryOrder::Acquire); }
+
+		struct NextFrameAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+			void await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				node.handle = awaiting;
+				scheduler->schedule(node);
+			}
+			void await_resume() const noexcept {}
+
+			TaskScheduler* scheduler;
+			detail::ScheduledResume node;
+		};
+
+		struct WorkerAwaiter
+		{
+			// nowhere to go without a job system or without workers, the job would wait in our own queue forever
+			bool await_ready() const noexcept { return jobSystem == nullptr || jobSystem->getWorkerCount() == 0; }
+			void await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				// the job lives in the suspended frame until the worker resumes it
+				job = Job{ [](void* h) { std::coroutine_handle<>::from_address(h).resume(); }, awaiting.address() };
+				jobSystem->run(job);
+			}
+			void await_resume() const noexcept {}
+
+			JobSystem* jobSystem;
+			Job job;
+		};
+
+		[[nodiscard]] NextFrameAwaiter nextFrame() noexcept { return NextFrameAwaiter{ this, {} }; }
+		[[nodiscard]] WorkerAwaiter resumeOnWorker() const noexcept { return WorkerAwaiter{ context.jobSystem, {} }; }
+
+	private:
+		friend class TaskEvent;
+		static detail::SpawnedTask runSpawned(Task<void> task, TaskScheduler* scheduler) noexcept;
+
+		// push to the next frame list, lock free so workers can hop back
+		void schedule(detail::ScheduledResume& node) noexcept;
+
+		Atomic<detail::ScheduledResume*> pending;
+		Atomic<uint32_t> running;
+	};
+
+	/*
+	 * One shot completion a single coroutine can await, set from any thread
+	 * the waiting coroutine resumes at the next scheduler frame, or right away if the event was already set
+	 */
+	class TaskEvent
+	{
+	public:
+		explicit TaskEvent(TaskScheduler& s) noexcept : scheduler(&s), state(nullptr) {}
+
+		TaskEvent(TaskEvent const&) = delete;
+		TaskEvent& operator=(TaskEvent const&) = delete;
+
+		void set() noexcept;
+		[[nodiscard]] bool isSet() const noexcept;
+
+		struct Awaiter
+		{
+			bool await_ready() const noexcept { return event->isSet(); }
+			bool await_suspend(std::coroutine_handle<> awaiting) noexcept;
+			void await_resume() const noexcept {}
+
+			TaskEvent* event;
+			detail::ScheduledResume node;
+		};
+
+		Awaiter operator co_await() noexcept { return Awaiter{ this, {} }; }
+
+	private:
+		TaskScheduler* scheduler;
+		// null, the waiting node or setMarker
+		Atomic<detail::ScheduledResume*> state;
+	};
+}
+
+#endif
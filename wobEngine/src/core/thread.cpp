@@ -0,0 +1,239 @@
+#include "thread.hpp"
+#include "wob.hpp"
+#include "profiler.hpp"
+
+#if defined(_WIN32) || defined(__vita__)
+	#include "os.hpp"
+#else
+	#include <sched.h>
+	#include <time.h>
+	#include <errno.h>
+	#include <unistd.h>
+#endif
+
+using namespace wob;
+
+Thread::~Thread() noexcept
+{
+	WOB_ASSERT_NOLOG(!running);
+}
+
+void Thread::run() noexcept
+{
+	// only stored, the profile is allocated if the thread records something
+	setProfilerThreadName(name);
+	entry(userData);
+}
+
+#ifdef _WIN32
+
+unsigned long __stdcall Thread::trampoline(void* self) noexcept
+{
+	static_cast<Thread*>(self)->run();
+	return 0;
+}
+
+bool Thread::start(EntryPoint entryPoint, void* data, const char* threadName, uint32_t stackSize) noexcept
+{
+	WOB_ASSERT_NOLOG(!running);
+	entry = entryPoint;
+	userData = data;
+	name = threadName;
+	handle = CreateThread(nullptr, stackSize, &Thread::trampoline, this, 0, nullptr);
+	running = handle != nullptr;
+	return running;
+}
+
+void Thread::join() noexcept
+{
+	WOB_ASSERT_NOLOG(running);
+	WaitForSingleObject(handle, INFINITE);
+	CloseHandle(handle);
+	handle = nullptr;
+	running = false;
+}
+
+void Thread::yield() noexcept
+{
+	SwitchToThread();
+}
+
+void Thread::sleepMs(uint32_t ms) noexcept
+{
+	Sleep(ms);
+}
+
+uint32_t Thread::processorCount() noexcept
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
+
+Semaphore::Semaphore(uint32_t initialCount) noexcept
+	: handle(CreateSemaphoreW(nullptr, (LONG)initialCount, LONG_MAX, nullptr))
+{
+	WOB_ASSERT_NOLOG(handle);
+}
+
+Semaphore::~Semaphore() noexcept
+{
+	CloseHandle(handle);
+}
+
+void Semaphore::signal(uint32_t count) noexcept
+{
+	ReleaseSemaphore(handle, (LONG)count, nullptr);
+}
+
+void Semaphore::wait() noexcept
+{
+	WaitForSingleObject(handle, INFINITE);
+}
+
+#elif defined(__vita__)
+
+// the kernel copies the start arguments, we pass the Thread pointer by value
+int Thread::trampoline(unsigned int argSize, void* args) noexcept
+{
+	WOB_UNUSED(argSize);
+	(*static_cast<Thread**>(args))->run();
+	return sceKernelExitThread(0);
+}
+
+bool Thread::start(EntryPoint entryPoint, void* data, const char* threadName, uint32_t stackSize) noexcept
+{
+	WOB_ASSERT_NOLOG(!running);
+	entry = entryPoint;
+	userData = data;
+	name = threadName;
+	uid = sceKernelCreateThread(threadName, &Thread::trampoline, SCE_KERNEL_DEFAULT_PRIORITY_USER, stackSize, 0, SCE_KERNEL_CPU_MASK_USER_ALL, nullptr);
+	if (uid < 0)
+		return false;
+
+	Thread* self = this;
+	if (sceKernelStartThread(uid, sizeof(self), &self) < 0)
+	{
+		sceKernelDeleteThread(uid);
+		return false;
+	}
+	running = true;
+	return true;
+}
+
+void Thread::join() noexcept
+{
+	WOB_ASSERT_NOLOG(running);
+	sceKernelWaitThreadEnd(uid, nullptr, nullptr);
+	sceKernelDeleteThread(uid);
+	uid = -1;
+	running = false;
+}
+
+void Thread::yield() noexcept
+{
+	// no yield syscall, the shortest delay reschedules
+	sceKernelDelayThread(0);
+}
+
+void Thread::sleepMs(uint32_t ms) noexcept
+{
+	sceKernelDelayThread(ms * 1000);
+}
+
+uint32_t Thread::processorCount() noexcept
+{
+	// cores 0 to 2 are available to user threads (SCE_KERNEL_CPU_MASK_USER_ALL)
+	return 3;
+}
+
+Semaphore::Semaphore(uint32_t initialCount) noexcept
+	: uid(sceKernelCreateSema("wob semaphore", 0, (int)initialCount, 0x7FFFFFFF, nullptr))
+{
+	WOB_ASSERT_NOLOG(uid >= 0);
+}
+
+Semaphore::~Semaphore() noexcept
+{
+	sceKernelDeleteSema(uid);
+}
+
+void Semaphore::signal(uint32_t count) noexcept
+{
+	sceKernelSignalSema(uid, (int)count);
+}
+
+void Semaphore::wait() noexcept
+{
+	sceKernelWaitSema(uid, 1, nullptr);
+}
+
+#else
+
+void* Thread::trampoline(void* self) noexcept
+{
+	static_cast<Thread*>(self)->run();
+	return nullptr;
+}
+
+bool Thread::start(EntryPoint entryPoint, void* data, const char* threadName, uint32_t stackSize) noexcept
+{
+	WOB_ASSERT_NOLOG(!running);
+	entry = entryPoint;
+	userData = data;
+	name = threadName;
+
+	pthread_attr_t attributes;
+	pthread_attr_init(&attributes);
+	pthread_attr_setstacksize(&attributes, stackSize);
+	running = pthread_create(&handle, &attributes, &Thread::trampoline, this) == 0;
+	pthread_attr_destroy(&attributes);
+	return running;
+}
+
+void Thread::join() noexcept
+{
+	WOB_ASSERT_NOLOG(running);
+	pthread_join(handle, nullptr);
+	running = false;
+}
+
+void Thread::yield() noexcept
+{
+	sched_yield();
+}
+
+void Thread::sleepMs(uint32_t ms) noexcept
+{
+	timespec duration{ (time_t)(ms / 1000), (long)(ms % 1000) * 1'000'000 };
+	while (nanosleep(&duration, &duration) == -1 && errno == EINTR) {}
+}
+
+uint32_t Thread::processorCount() noexcept
+{
+	long const count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? (uint32_t)count : 1;
+}
+
+Semaphore::Semaphore(uint32_t initialCount) noexcept
+{
+	sem_init(&semaphore, 0, initialCount);
+}
+
+Semaphore::~Semaphore() noexcept
+{
+	sem_destroy(&semaphore);
+}
+
+void Semaphore::signal(uint32_t count) noexcept
+{
+	for (uint32_t i = 0; i < count; i++)
+		sem_post(&semaphore);
+}
+
+void Semaphore::wait() noexcept
+{
+	while (sem_wait(&semaphore) == -1 && errno == EINTR) {}
+}
+
+#endif
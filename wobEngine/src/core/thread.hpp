@@ -0,0 +1,131 @@
+#ifndef WOB_THREAD_HPP
+#define WOB_THREAD_HPP
+
+#include <stdint.h>
+#include "coreMacros.hpp"
+#include "atomic.hpp"
+
+#if !defined(_WIN32) && !defined(__vita__)
+	#include <pthread.h>
+	#include <semaphore.h>
+#endif
+
+namespace wob
+{
+	/*
+	 * Thin wrapper over OS threads (CreateThread / sceKernelCreateThread / pthread)
+	 * A thread must be joined before destruction. It starts with its own thread_local context,
+	 * the default allocator and an empty logger.
+	 */
+	class Thread
+	{
+	public:
+		using EntryPoint = void (*)(void* userData);
+
+		Thread() noexcept = default;
+		~Thread() noexcept;
+
+		Thread(Thread const&) = delete;
+		Thread& operator=(Thread const&) = delete;
+
+		// return false if the OS failed to create the thread
+		bool start(EntryPoint entry, void* userData, const char* name = "wob thread", uint32_t stackSize = 256 * 1024) noexcept;
+		void join() noexcept;
+
+		[[nodiscard]] bool joinable() const noexcept { return running; }
+
+		// give the rest of the time slice to another thread
+		static void yield() noexcept;
+		static void sleepMs(uint32_t ms) noexcept;
+		// logical cores this process can run on, at least 1
+		[[nodiscard]] static uint32_t processorCount() noexcept;
+
+	private:
+		void run() noexcept;
+
+#ifdef _WIN32
+		static unsigned long __stdcall trampoline(void* self) noexcept;
+		void* handle = nullptr;
+#elif defined(__vita__)
+		static int trampoline(unsigned int argSize, void* args) noexcept;
+		int uid = -1;
+#else
+		static void* trampoline(void* self) noexcept;
+		pthread_t handle{};
+#endif
+		EntryPoint entry = nullptr;
+		void* userData = nullptr;
+		const char* name = nullptr;
+		bool running = false;
+	};
+
+	// counting semaphore, wait blocks the thread until the count is positive
+	class Semaphore
+	{
+	public:
+		explicit Semaphore(uint32_t initialCount = 0) noexcept;
+		~Semaphore() noexcept;
+
+		Semaphore(Semaphore const&) = delete;
+		Semaphore& operator=(Semaphore const&) = delete;
+
+		void signal(uint32_t count = 1) noexcept;
+		void wait() noexcept;
+
+	private:
+#ifdef _WIN32
+		void* handle;
+#elif defined(__vita__)
+		int uid;
+#else
+		sem_t semaphore;
+#endif
+	};
+
+	// lock for short critical sections with little contention, spins then yields
+	class SpinLock
+	{
+	public:
+		SpinLock() noexcept = default;
+		SpinLock(SpinLock const&) = delete;
+		SpinLock& operator=(SpinLock const&) = delete;
+
+		void lock() noexcept
+		{
+			uint32_t spins = 0;
+			for (;;)
+			{
+				uint32_t expected = 0;
+				if (locked.load(MemoryOrder::Relaxed) == 0 && locked.compareExchange(expected, 1, MemoryOrder::Acquire))
+					return;
+				if (++spins < 64)
+					cpuRelax();
+				else
+					Thread::yield();
+			}
+		}
+
+		void unlock() noexcept
+		{
+			locked.store(0, MemoryOrder::Release);
+		}
+
+	private:
+		Atomic<uint32_t> locked;
+	};
+
+	class ScopedLock
+	{
+	public:
+		explicit ScopedLock(SpinLock& l) noexcept : lock(l) { lock.lock(); }
+		~ScopedLock() noexcept { lock.unlock(); }
+
+		ScopedLock(ScopedLock const&) = delete;
+		ScopedLock& operator=(ScopedLock const&) = delete;
+
+	private:
+		SpinLock& lock;
+	};
+}
+
+#endif
@@ -7,24 +7,56 @@
 namespace wob
 {
 #ifdef _WIN32
-	
+
 	//https://stackoverflow.com/a/1825740
-	long long getPerfCount()
+	inline long long getPerfCount()
 	{
 		LARGE_INTEGER ret;
 		QueryPerformanceCounter(&ret);
 		return ret.QuadPart;
 	}
 
-	long long getCPUFrequency()
+	inline long long getCPUFrequency()
 	{
 		LARGE_INTEGER ret;
 		QueryPerformanceFrequency(&ret);
 		return ret.QuadPart;
 	}
 
+#elif defined(__vita__)
+
+	// process time in microseconds
+	inline long long getPerfCount()
+	{
+		return (long long)sceKernelGetProcessTimeWide();
+	}
+
+	inline long long getCPUFrequency()
+	{
+		return 1'000'000;
+	}
+
+#else
+
+	inline long long getPerfCount()
+	{
+		timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (long long)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+	}
+
+	inline long long getCPUFrequency()
+	{
+		return 1'000'000'000;
+	}
+
 #endif
 
+	// elapsed milliseconds between two getPerfCount values
+	inline double perfCountToMs(long long start, long long end)
+	{
+		return (double)(end - start) * 1000.0 / (double)getCPUFrequency();
+	}
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -167,6 +167,9 @@ namespace wob
 		[[no_unique_address]] D deleter;
 	};
 
+	template<typename T, typename D>
+	constexpr bool isTriviallyRelocatable<UniquePtr<T, D>> = isTriviallyRelocatable<D>;
+
 	template<typename T, typename... Args>
 	auto makeUnique(IAllocator& alloc, Args&&... args) noexcept
 	{
@@ -157,6 +157,15 @@ namespace wob
 		using type = remove_cvref_t<_Ty>;
 	};
 
+	// block template argument deduction on a parameter
+	template <class _Ty>
+	struct type_identity {
+		using type = _Ty;
+	};
+
+	template <class _Ty>
+	using type_identity_t = typename type_identity<_Ty>::type;
+
 #ifdef __clang__
 		template <class _Ty1, class _Ty2>
 			constexpr bool is_same_v = __is_same(_Ty1, _Ty2);
@@ -204,6 +213,18 @@ namespace wob
 	template <class _Ty>
 	concept unsigned_integral = integral<_Ty> && !signed_integral<_Ty>;
 
+	// a memcpy is a valid copy
+	template <typename T>
+	constexpr bool isTriviallyCopyable = __is_trivially_copyable(T);
+
+	template <typename T>
+	constexpr bool isTriviallyDestructible = __is_trivially_destructible(T);
+
+	// move construct + destroy the source can be done with a memcpy
+	// specialize it for types that only hold owning pointers and never point to themselves
+	template <typename T>
+	constexpr bool isTriviallyRelocatable = isTriviallyCopyable<T>;
+
 	template <typename T>
 	constexpr T const& min(T const& lhs, T const& rhs)
 	{
@@ -298,7 +319,8 @@ namespace wob
 	// see Game engine architecture 6.2.1.3 (p431)
 	constexpr uintptr_t align(uintptr_t x, uint32_t a)
 	{
-		uint32_t const mask = a - 1;
+		// mask must be pointer sized, otherwise ~mask clear the upper bits of 64 bits addresses
+		uintptr_t const mask = (uintptr_t)a - 1;
 		//		WOB_ASSERT((a & mask) == 0);
 		return (x + mask) & ~mask;
 	}
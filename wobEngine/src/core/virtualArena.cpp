@@ -0,0 +1,91 @@
+#include "virtualArena.hpp"
+#include "wob.hpp"
+#include "utility.hpp"
+#include "virtualMemory.hpp"
+
+using namespace wob;
+
+VirtualArena::VirtualArena(Config const& config) noexcept
+	: base(nullptr), reserved(0), committed(0), offset(0), lastOffset(noAllocation)
+{
+	size_t const page = vm::pageSize();
+	granularity = wob::align(max(config.commitGranularity, page), page);
+	retain = wob::align(config.retainSize, granularity);
+	reserved = wob::align(config.reserveSize, granularity);
+
+	base = static_cast<uint8_t*>(vm::reserve(reserved));
+	WOB_ASSERT(base != nullptr);
+	if (!base)
+	{
+		reserved = 0;
+		return;
+	}
+
+	if (config.hugePages)
+		vm::adviseHugePages(base, reserved);
+}
+
+VirtualArena::~VirtualArena()
+{
+	if (base)
+		vm::release(base, reserved);
+}
+
+bool VirtualArena::ensureCommitted(size_t size) noexcept
+{
+	if (size <= committed)
+		return true;
+	if (size > reserved)
+		return false;
+
+	size_t const newCommitted = min(wob::align(size, granularity), reserved);
+	if (!vm::commit(base + committed, newCommitted - committed))
+		return false;
+	committed = newCommitted;
+	return true;
+}
+
+void* VirtualArena::allocate(size_t size, size_t align)
+{
+	WOB_ASSERT_NOLOG(isPowerOf2(align));
+	size_t const alignedOffset = wob::align((uintptr_t)base + offset, align) - (uintptr_t)base;
+	if (!ensureCommitted(alignedOffset + size))
+		return nullptr;
+
+	offset = alignedOffset + size;
+	lastOffset = alignedOffset;
+	return base + alignedOffset;
+}
+
+void VirtualArena::deallocate(void* ptr)
+{
+	WOB_UNUSED(ptr);
+}
+
+bool VirtualArena::tryExpandInPlace(void* ptr, size_t newSize)
+{
+	if (lastOffset == noAllocation || ptr != base + lastOffset || !ensureCommitted(lastOffset + newSize))
+		return false;
+
+	offset = lastOffset + newSize;
+	return true;
+}
+
+void VirtualArena::deallocateFromMarker(size_t marker) noexcept
+{
+	WOB_ASSERT_NOLOG(marker <= offset);
+	offset = marker;
+	if (lastOffset != noAllocation && lastOffset >= marker)
+		lastOffset = noAllocation;
+}
+
+void VirtualArena::reset() noexcept
+{
+	offset = 0;
+	lastOffset = noAllocation;
+	if (committed > retain)
+	{
+		vm::decommit(base + retain, committed - retain);
+		committed = retain;
+	}
+}
@@ -0,0 +1,75 @@
+#ifndef WOB_VIRTUAL_ARENA_HPP
+#define WOB_VIRTUAL_ARENA_HPP
+
+#include "allocator.hpp"
+
+namespace wob
+{
+	/*
+	 * Linear allocator over a reserved address range, pages are committed on demand by commitGranularity steps
+	 * so the arena grows up to reserveSize without moving and only touched memory uses RAM.
+	 * Same marker interface as StackAllocator, deallocate is a no-op and only the last allocation can be resized in place.
+	 * reset decommits the pages above retainSize so a one off peak doesn't keep its memory.
+	 * allocate returns nullptr once the reservation is exhausted.
+	 * On vita the whole range is committed at construction, the default reserveSize is small there.
+	 * Not thread safe.
+	 */
+	class VirtualArena final : public IAllocator
+	{
+	public:
+#ifdef __vita__
+		// the reservation is a heap block on vita
+		static constexpr size_t defaultReserveSize = 8_mb;
+#else
+		static constexpr size_t defaultReserveSize = 1_gb;
+#endif
+
+		struct Config
+		{
+			size_t reserveSize = defaultReserveSize;
+			// committed memory grows by this step, rounded up to the page size
+			size_t commitGranularity = 64_kb;
+			// committed memory kept by reset
+			size_t retainSize = 1_mb;
+			// transparent huge pages, only honored on linux
+			bool hugePages = false;
+		};
+
+		VirtualArena() noexcept : VirtualArena(Config{}) {}
+		explicit VirtualArena(Config const& config) noexcept;
+		~VirtualArena() override;
+
+		VirtualArena(VirtualArena const&) = delete;
+		VirtualArena& operator=(VirtualArena const&) = delete;
+
+		[[nodiscard]] void* allocate(size_t size, size_t align) override;
+		void deallocate(void* ptr) override;
+		[[nodiscard]] bool tryExpandInPlace(void* ptr, size_t newSize) override;
+
+		[[nodiscard]] size_t getMarker() const noexcept { return offset; }
+		// free everything allocated after the marker was taken, memory stays committed
+		void deallocateFromMarker(size_t marker) noexcept;
+		// free everything and decommit above retainSize
+		void reset() noexcept;
+
+		[[nodiscard]] size_t usedSize() const noexcept { return offset; }
+		[[nodiscard]] size_t committedSize() const noexcept { return committed; }
+		[[nodiscard]] size_t reservedSize() const noexcept { return reserved; }
+
+	private:
+		static constexpr size_t noAllocation = ~(size_t)0;
+
+		bool ensureCommitted(size_t size) noexcept;
+
+		uint8_t* base;
+		size_t reserved;
+		size_t committed;
+		size_t offset;
+		// offset of the last allocation
+		size_t lastOffset;
+		size_t granularity;
+		size_t retain;
+	};
+}
+
+#endif
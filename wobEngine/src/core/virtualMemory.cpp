@@ -0,0 +1,189 @@
+#include "virtualMemory.hpp"
+#include "wob.hpp"
+#include "utility.hpp"
+#include "allocator.hpp"
+
+#ifdef _WIN32
+	#include "os.hpp"
+#elif defined(__vita__)
+	#include "os.hpp"
+#else
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+using namespace wob;
+
+static constexpr size_t maxReserveAlignment = 64_kb;
+
+#ifdef _WIN32
+
+size_t vm::pageSize() noexcept
+{
+	static size_t const size = []() {
+		SYSTEM_INFO info;
+		GetSystemInfo(&info);
+		return (size_t)info.dwPageSize;
+	}();
+	return size;
+}
+
+void* vm::reserve(size_t size, size_t alignment) noexcept
+{
+	// VirtualAlloc ranges are aligned to the 64kb allocation granularity
+	WOB_ASSERT_NOLOG(alignment <= maxReserveAlignment);
+	WOB_UNUSED(alignment);
+	return VirtualAlloc(nullptr, wob::align(size, pageSize()), MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool vm::commit(void* ptr, size_t size) noexcept
+{
+	return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+}
+
+void vm::decommit(void* ptr, size_t size) noexcept
+{
+	VirtualFree(ptr, size, MEM_DECOMMIT);
+}
+
+void vm::release(void* ptr, size_t size) noexcept
+{
+	WOB_UNUSED(size);
+	VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+void* vm::allocate(size_t size, size_t alignment) noexcept
+{
+	WOB_ASSERT_NOLOG(alignment <= maxReserveAlignment);
+	WOB_UNUSED(alignment);
+	return VirtualAlloc(nullptr, wob::align(size, pageSize()), MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+}
+
+// large pages need the lock memory privilege and must be committed at reserve time
+bool vm::adviseHugePages(void* ptr, size_t size) noexcept
+{
+	WOB_UNUSED(ptr);
+	WOB_UNUSED(size);
+	return false;
+}
+
+#elif defined(__vita__)
+
+// no user space virtual memory management on vita, fallback on aligned heap blocks
+
+size_t vm::pageSize() noexcept
+{
+	return 4_kb;
+}
+
+void* vm::reserve(size_t size, size_t alignment) noexcept
+{
+	return vm::allocate(size, alignment);
+}
+
+bool vm::commit(void* ptr, size_t size) noexcept
+{
+	WOB_UNUSED(ptr);
+	WOB_UNUSED(size);
+	return true;
+}
+
+void vm::decommit(void* ptr, size_t size) noexcept
+{
+	WOB_UNUSED(ptr);
+	WOB_UNUSED(size);
+}
+
+void vm::release(void* ptr, size_t size) noexcept
+{
+	WOB_UNUSED(size);
+	mallocator.deallocate(ptr);
+}
+
+void* vm::allocate(size_t size, size_t alignment) noexcept
+{
+	WOB_ASSERT_NOLOG(alignment <= maxReserveAlignment);
+	size_t const al = alignment > pageSize() ? alignment : pageSize();
+	return mallocator.allocate(wob::align(size, al), al);
+}
+
+bool vm::adviseHugePages(void* ptr, size_t size) noexcept
+{
+	WOB_UNUSED(ptr);
+	WOB_UNUSED(size);
+	return false;
+}
+
+#else
+
+size_t vm::pageSize() noexcept
+{
+	static size_t const size = (size_t)sysconf(_SC_PAGESIZE);
+	return size;
+}
+
+// map with the given protection, alignment above the page size is done by over mapping and trimming
+static void* mapAligned(size_t size, size_t alignment, int prot) noexcept
+{
+	WOB_ASSERT_NOLOG(alignment <= maxReserveAlignment);
+	size = wob::align(size, vm::pageSize());
+	if (alignment <= vm::pageSize())
+	{
+		void* const ptr = mmap(nullptr, size, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+		return ptr == MAP_FAILED ? nullptr : ptr;
+	}
+
+	size_t const mappedSize = size + alignment;
+	void* const ptr = mmap(nullptr, mappedSize, prot, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (ptr == MAP_FAILED)
+		return nullptr;
+
+	uintptr_t const start = reinterpret_cast<uintptr_t>(ptr);
+	uintptr_t const alignedStart = wob::align(start, alignment);
+	if (alignedStart != start)
+		munmap(ptr, alignedStart - start);
+	size_t const tail = (start + mappedSize) - (alignedStart + size);
+	if (tail > 0)
+		munmap(reinterpret_cast<void*>(alignedStart + size), tail);
+	return reinterpret_cast<void*>(alignedStart);
+}
+
+void* vm::reserve(size_t size, size_t alignment) noexcept
+{
+	return mapAligned(size, alignment, PROT_NONE);
+}
+
+bool vm::commit(void* ptr, size_t size) noexcept
+{
+	return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+}
+
+void vm::decommit(void* ptr, size_t size) noexcept
+{
+	madvise(ptr, size, MADV_DONTNEED);
+	mprotect(ptr, size, PROT_NONE);
+}
+
+void vm::release(void* ptr, size_t size) noexcept
+{
+	munmap(ptr, wob::align(size, pageSize()));
+}
+
+void* vm::allocate(size_t size, size_t alignment) noexcept
+{
+	// map directly read write, saves the mprotect of a reserve + commit
+	return mapAligned(size, alignment, PROT_READ | PROT_WRITE);
+}
+
+bool vm::adviseHugePages(void* ptr, size_t size) noexcept
+{
+#ifdef MADV_HUGEPAGE
+	return madvise(ptr, size, MADV_HUGEPAGE) == 0;
+#else
+	WOB_UNUSED(ptr);
+	WOB_UNUSED(size);
+	return false;
+#endif
+}
+
+#endif
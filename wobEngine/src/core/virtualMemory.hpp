@@ -0,0 +1,36 @@
+#ifndef WOB_VIRTUAL_MEMORY_HPP
+#define WOB_VIRTUAL_MEMORY_HPP
+
+#include <stddef.h>
+
+namespace wob::vm
+{
+	/*
+	 * Thin wrapper over the OS virtual memory api (mmap / VirtualAlloc)
+	 * vita doesn't expose reserve / commit separately, there reserve commit the whole range
+	 * and commit / decommit are no-op
+	 */
+
+	[[nodiscard]] size_t pageSize() noexcept;
+
+	// reserve an address range, size is rounded up to page size
+	// alignment must be a power of 2, at most 64kb
+	[[nodiscard]] void* reserve(size_t size, size_t alignment = 0) noexcept;
+
+	// make pages of a reserved range usable, ptr and size must be page aligned
+	bool commit(void* ptr, size_t size) noexcept;
+
+	// give pages back to the OS while keeping the range reserved
+	void decommit(void* ptr, size_t size) noexcept;
+
+	// release a whole range returned by reserve or allocate
+	void release(void* ptr, size_t size) noexcept;
+
+	// reserve and commit
+	[[nodiscard]] void* allocate(size_t size, size_t alignment = 0) noexcept;
+
+	// ask the OS to back a range with transparent huge pages, return false if it can't (only linux does)
+	bool adviseHugePages(void* ptr, size_t size) noexcept;
+}
+
+#endif
@@ -12,6 +12,7 @@ using uchar = unsigned char;
 #include "profiler.hpp"
 #include "debug.hpp"
 #include "format.hpp"
+#include "log.hpp"
 
 #endif
 
@@ -2,7 +2,7 @@
 #include "core/debug.hpp"
 #include "core/uniquePtr.hpp"
 #include "core/time.hpp"
-#include "core/ranges.hpp"
+#include "core/memoryProfiler.hpp"
 
 #ifdef _WIN32
 	#include "core/platformWindows/win_window.hpp"
@@ -18,13 +18,25 @@ Engine::Engine(InitInfo const& info) :
 #else
 	mainWindow(makeUnique<EmptyWindow>()),
 #endif
-	appName(info.appName)
+	appName(info.appName),
+	steadyFrameWarmup(info.steadyFrameWarmup),
+	steadyFramePolicy(info.steadyFramePolicy),
+	jobWorkerCount(info.jobWorkerCount),
+	streamingBudget(info.streamingBudget),
+	frameAllocator(*context.allocator, info.frameAllocatorSize)
 {
 
 }
 
 Engine::~Engine()
 {
+	if (context.frameAllocator == &frameAllocator)
+		context.frameAllocator = nullptr;
+	// waits for the decode stages running on the workers
+	assetStreamer.reset();
+	if (context.jobSystem == jobSystem.get())
+		context.jobSystem = nullptr;
+	jobSystem.reset();
 	mainWindow->close();
 	WOB_LOG("engine destroyed");
 }
@@ -32,26 +44,39 @@ Engine::~Engine()
 void Engine::init()
 {
 	WOB_PROFILE_FUNCTION();
+	WOB_MEMORY_SCOPE(MemoryTag::Core);
 	mainWindow->open();
-	keyStates.resize((int)Key::Max);
+	context.frameAllocator = &frameAllocator;
+
+	JobSystem::InitInfo jobInfo;
+	jobInfo.workerCount = jobWorkerCount;
+	jobSystem = makeUnique<JobSystem>(*context.allocator, jobInfo);
+	context.jobSystem = jobSystem.get();
+	WOB_LOG("job system started with {} workers", jobSystem->getWorkerCount());
+
+	AssetStreamer::InitInfo streamInfo;
+	streamInfo.maxInFlightBytes = streamingBudget;
+	assetStreamer = makeUnique<AssetStreamer>(*context.allocator, streamInfo);
+
 	mainWindow->setKeyCallback({ [](InputAction action, int key, void* userData) {
 
 		Engine& self = *static_cast<Engine*>(userData);
 		Key const k = windowsToAESKey(key);
 		
-		int const keyIndex = (int)k;
+		uint32_t const keyIndex = (uint32_t)k;
 		if (action == InputAction::Pressed)
 		{
 			self.onKeyPressed(k);
-			if (self.keyStates[keyIndex] == InputState::Up)
-				self.keyJustPressed.push(k);
+			// key repeats don't count as new presses
+			if (!self.keysDown.test(keyIndex))
+				self.keysPressed.set(keyIndex);
 
-			self.keyStates[keyIndex] = InputState::Down;
+			self.keysDown.set(keyIndex);
 		}
 		else
 		{
 			self.onKeyReleased(k);
-			self.keyStates[keyIndex] = InputState::Up;
+			self.keysDown.reset(keyIndex);
 		}
 
 		}, this });
@@ -69,21 +94,40 @@ void Engine::run()
 	while (!mainWindow->shouldClose())
 	{
 		WOB_PROFILE_FRAME();
+		WOB_MEMORY_FRAME();
 		int64_t start = getPerfCount();
+		bool const steady = steadyFrameWarmup != 0 && frameCount >= steadyFrameWarmup;
+		if (steady)
+			beginSteadyFrame(steadyFramePolicy);
+
+		// the arena used two frames ago is reset
+		frameAllocator.beginFrame();
+		keysPressed.resetAll();
 
 		mainWindow->pollEvents();
+		// streamed files first, their completions can resume coroutines
+		assetStreamer->poll();
+		// coroutines waiting for this frame, loads finished on the workers
+		taskScheduler.beginFrame();
 
 		update(deltaTime);
 		draw();
 
-		keyJustPressed.clear();
-
 		int64_t const end = getPerfCount();
 		double const deltaTimeInSec = (static_cast<double>(end) - start) / getCPUFrequency();
 		deltaTime = deltaTimeInSec;
 		time += deltaTime;
 		frameCount++;
+
+		if (steady)
+			endSteadyFrame();
 	}
+
+	WOB_LOG("frame allocator high water mark : {} of {} bytes, {} frames overflowed",
+		(uint64_t)frameAllocator.highWaterMark(), (uint64_t)frameAllocator.arenaSize(), frameAllocator.overflowFrameCount());
+	WOB_MEMORY_REPORT();
+	if (steadyFrameWarmup != 0)
+		WOB_LOG("{} allocations in steady frames", steadyFrameViolationCount());
 }
 
 const char* Engine::getEngineShaderPath() const
@@ -93,17 +137,17 @@ const char* Engine::getEngineShaderPath() const
 
 InputState Engine::getKeyState(Key k) noexcept
 {
-	return keyStates[(int)k];
+	return keysDown.test((uint32_t)k) ? InputState::Down : InputState::Up;
 }
 
 bool Engine::isKeyDown(Key k) noexcept
 {
-	return keyStates[(int)k] == InputState::Down;
+	return keysDown.test((uint32_t)k);
 }
 
 bool Engine::isKeyPressed(Key k) noexcept
 {
-	return wob::ranges::find(keyJustPressed, k) != keyJustPressed.end();
+	return keysPressed.test((uint32_t)k);
 }
 
 void Engine::getViewportMousePos(float& x, float& y) const noexcept
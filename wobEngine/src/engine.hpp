@@ -5,6 +5,12 @@
 #include "core/debug.hpp"
 #include "core/window.hpp"
 #include "core/array.hpp"
+#include "core/bitSet.hpp"
+#include "core/frameAllocator.hpp"
+#include "core/jobSystem.hpp"
+#include "core/task.hpp"
+#include "core/assetStreamer.hpp"
+#include "core/steadyFrame.hpp"
 #include "core/uniquePtr.hpp"
 #include "renderer/RHI/RHIRenderContext.hpp"
 
@@ -17,6 +23,15 @@ namespace wob {
 		struct InitInfo
 		{
 			const char* appName;
+			// size of each of the two frame allocator arenas
+			size_t frameAllocatorSize = 1_mb;
+			// warm-up frames after which run() reports frames that allocate through the context allocator, 0 disables it (see steadyFrame.hpp)
+			uint32_t steadyFrameWarmup = 0;
+			SteadyFramePolicy steadyFramePolicy = SteadyFramePolicy::Report;
+			// job worker threads besides the main thread, 0 starts one per remaining core (see jobSystem.hpp)
+			uint32_t jobWorkerCount = 0;
+			// bytes the asset streamer can hold before their completion ran (see assetStreamer.hpp)
+			uint64_t streamingBudget = 64_mb;
 		};
 
 		Engine(InitInfo const& info);
@@ -54,6 +69,11 @@ namespace wob {
 		 */
 		void getScreenMousePos(int& x, int& y) const noexcept;
 
+		// spawn loading coroutines here, they are resumed at the start of each frame
+		TaskScheduler& getTaskScheduler() noexcept { return taskScheduler; }
+		// completions are delivered at the start of each frame, before the task scheduler runs
+		AssetStreamer& getAssetStreamer() noexcept { return *assetStreamer; }
+
 		UniquePtr<Window> mainWindow;
 
 	private:
@@ -69,9 +89,24 @@ namespace wob {
 		uint64_t frameCount = 0;
 
 		const char* appName;
-
-		Array<InputState> keyStates;
-		Array<Key> keyJustPressed;
+		uint32_t steadyFrameWarmup;
+		SteadyFramePolicy steadyFramePolicy;
+		uint32_t jobWorkerCount;
+		uint64_t streamingBudget;
+
+		// must outlive the arrays allocated from it
+		FrameAllocator frameAllocator;
+
+		// created in init, the workers run until the engine is destroyed
+		UniquePtr<JobSystem> jobSystem;
+		TaskScheduler taskScheduler;
+		// created in init, after the job system running its decode stages
+		UniquePtr<AssetStreamer> assetStreamer;
+
+		// indexed by Key
+		BitSet<(uint32_t)Key::Max> keysDown;
+		// keys that went down during the current frame
+		BitSet<(uint32_t)Key::Max> keysPressed;
 	};
 }
 
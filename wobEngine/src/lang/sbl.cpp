@@ -1,37 +1,53 @@
-//#include "sbl.hpp"
-//#include <ctype.h>
-//#include <core/format.hpp>
-//#include <span>
-//
-//using namespace wob::sbl;
-//using namespace std::literals;
-//
-//void SBLLexer::skipWhite()
-//{
-//	while (c < source.size() && isspace(source[c]))
-//	{
-//		if (source[c] == '\n')
-//		{
-//			currentLine++;
-//		}
-//		c++;
-//	}
-//}
-//
-//void SBLLexer::consume(char e)
-//{
-//	WOB_ASSERT(peek() == e); // TODO real error handling
-//	c++;
-//}
-//
-//char SBLLexer::peek()
-//{
-//	skipWhite();
-//	WOB_BOUNDS_CHECK(c >= 0);
-//	WOB_BOUNDS_CHECK(c < source.size());
-//	return source[c];
-//}
-//
+#include "sbl.hpp"
+
+using namespace wob;
+using namespace wob::sbl;
+
+// the rest of the parser is disabled until Node gets its variant back
+
+static constexpr CharClass whitespaceChars = CharClass::whitespace();
+static constexpr CharClass atomChars = CharClass::identifier();
+
+void SBLLexer::skipWhite()
+{
+	size_t const end = source.skipWhile(whitespaceChars, c);
+	currentLine += (int)StringView(source.data() + c, end - c).count('\n');
+	c = (int)end;
+}
+
+void SBLLexer::consume(char e)
+{
+	WOB_ASSERT(peek() == e); // TODO real error handling
+	c++;
+}
+
+char SBLLexer::peek()
+{
+	skipWhite();
+	WOB_BOUNDS_CHECK(c >= 0);
+	WOB_BOUNDS_CHECK(c < source.size());
+	return source[c];
+}
+
+SourceLoc SBLLexer::getCurrentLoc()
+{
+	SourceLoc loc;
+	loc.line = currentLine;
+	loc.column = currentColumn;
+	return loc;
+}
+
+Atom SBLLexer::parseAtom()
+{
+	int const wordStart = c;
+	c = (int)source.skipWhile(atomChars, c);
+	Atom atom;
+	atom.src = StringView(&source[wordStart], c - wordStart);
+	WOB_ASSERT(!atom.src.empty());
+	atom.loc = getCurrentLoc();
+	return atom;
+}
+
 //Node SBLLexer::parse()
 //{
 //	Node n;
@@ -49,34 +65,6 @@
 //	return n;
 //}
 //
-//static bool isValidSymOrLiteralChar(char c)
-//{
-//	return std::isalnum(c) || c == '_';
-//}
-//
-//SourceLoc SBLLexer::getCurrentLoc()
-//{
-//	SourceLoc loc;
-//	loc.line = currentLine;
-//	loc.column = currentLine;
-//	return loc;
-//}
-//
-//Atom SBLLexer::parseAtom()
-//{
-//	int const wordStart = c;
-//	while (isValidSymOrLiteralChar(source[c]) && c < source.size())
-//	{
-//		c++;
-//	}
-//	int const wordLen = c - wordStart;
-//	Atom atom;
-//	atom.src = StringView(&source[wordStart], wordLen);
-//	WOB_ASSERT(!atom.src.empty());
-//	atom.loc = getCurrentLoc();
-//	return atom;
-//}
-//
 //List SBLLexer::parseList()
 //{
 //	List l;
@@ -173,24 +173,25 @@ namespace wob::sbl
 
 		void define(const String& name, Type type, bool mutable_ = true) 
 		{
-			if (variables.exist(name)) {
+			uint64_t const hash = decltype(variables)::computeHash(name);
+			if (variables.exist(name, hash)) {
 				WOB_ASSERT(false);
 			}
-			variables[name] = { name, type, mutable_ };
+			variables.add(name, Symbol{ name, type, mutable_ }, hash);
 		}
 
-		Symbol lookup(const String& name) 
+		// StringView lookup, no String is built to query the scopes
+		Symbol lookup(StringView name) 
 		{
-			Symbol sym;
-			if (variables.tryFind(name, sym))
+			uint64_t const hash = decltype(variables)::computeHash(name);
+			for (Environment* env = this; env != nullptr; env = env->parent)
 			{
-				return sym;
+				if (Symbol const* sym = env->variables.find(name, hash))
+					return *sym;
 			}
 
-			if (parent) 
-				return parent->lookup(name);
 			WOB_ASSERT(false);
-
+			return {};
 		}
 
 		Environment enterScope() {
@@ -3,6 +3,8 @@
 
 #include "core/error.hpp"
 #include "core/array.hpp"
+#include "core/smallArray.hpp"
+#include "core/segmentedArray.hpp"
 #include "RHI/RHIBuffer.hpp"
 #include "RHI/RHIShader.hpp"
 #include "RHI/RHITexture.hpp"
@@ -82,9 +84,11 @@ namespace wob
 		
 		RHIDevice* device;
 		State currentState;
-		Array<State> statesStack;
+		// push / pop rarely nest deeper than a few levels
+		SmallArray<State, 8> statesStack;
 
-		Array<Command> commands;
+		// rebuilt every frame, a spike adds chunks instead of copying the whole list
+		SegmentedArray<Command> commands;
 
 		Array<Vertex> vertices;
 		Array<Index_t> indices;
@@ -22,10 +22,10 @@ Result<Glyph> FontRessource::getGlyph(char c) const
 	return { ErrorCode::Undefined };
 }
 
-Result<FontRessource> wob::createFontRessource(FontParams const& params)
+// cpu side of the font: glyph metrics and the atlas pixels, doesn't touch the device
+static Result<void> packFont(FontParams const& params, FontRessource& fontRessource, Array<Color>& pixels)
 {
 	WOB_PROFILE_FUNCTION();
-	WOB_ASSERT(params.device);
 
 	stbtt_fontinfo info;
 	if (stbtt_InitFont(&info, params.fontData.data(), 0) == 0)
@@ -33,7 +33,6 @@ Result<FontRessource> wob::createFontRessource(FontParams const& params)
 		WOB_LOG_ERROR("failed to init default font");
 		return { ErrorCode::FontInitFailed };
 	}
-	FontRessource fontRessource;
 
 	int const width = static_cast<int>(params.textureWidth);
 	int const height = static_cast<int>(params.textureHeight);
@@ -75,25 +74,76 @@ Result<FontRessource> wob::createFontRessource(FontParams const& params)
 	}
 
 	// @Review
-	Array<Color> pixels;
 	pixels.resize(width * height);
-
 	for (uint32_t i = 0; i < pixels.size(); i++)
 	{
 		uint8_t const alpha = bitmap[i];
 		pixels[i] = Color(alpha, alpha, alpha, alpha);
 	}
+	return {};
+}
+
+static void createFontTexture(FontParams const& params, Array<Color> const& pixels, FontRessource& fontRessource)
+{
+	TextureDescription desc;
+	desc.width = params.textureWidth;
+	desc.height = params.textureHeight;
+	desc.format = RHIFormat::R8G8B8A8_Uint; // @TODO
+	desc.cpuAccess = CPUAccessFlagBits::None;
+	desc.initialData = pixels.data();
+	desc.usage = MemoryUsage::Default;
+	desc.mipsLevel = 4;
+	fontRessource.texture = params.device->createTexture(desc).value();
+}
+
+Result<FontRessource> wob::createFontRessource(FontParams const& params)
+{
+	WOB_PROFILE_FUNCTION();
+	WOB_ASSERT(params.device);
+
+	FontRessource fontRessource;
+	Array<Color> pixels;
+	if (Result<void> packed = packFont(params, fontRessource, pixels); !packed)
+		return { ErrorCode::FontInitFailed };
 
+	createFontTexture(params, pixels, fontRessource);
+	return { wob::move(fontRessource) };
+}
+
+Result<FontRessource> wob::createFontRessource(MappedFile const& file, FontParams params)
+{
+	params.fontData = file.view();
+	return createFontRessource(params);
+}
+
+Task<Result<FontRessource>> wob::loadFontRessource(TaskScheduler& scheduler, FontParams params)
+{
+	WOB_ASSERT(params.device);
+
+	// packing is the slow part, the device is only used from the frame loop
+	co_await scheduler.resumeOnWorker();
+	FontRessource fontRessource;
+	Array<Color> pixels;
+	Result<void> packed = packFont(params, fontRessource, pixels);
+	co_await scheduler.nextFrame();
+
+	if (!packed)
+		co_return ErrorCode::FontInitFailed;
+
+	createFontTexture(params, pixels, fontRessource);
+	co_return wob::move(fontRessource);
+}
+
+Task<Result<FontRessource>> wob::loadFontRessource(TaskScheduler& scheduler, AssetStreamer& streamer, const char* path, FontParams params)
+{
+	Result<MappedFile> file = co_await streamer.map(path);
+	if (!file)
 	{
-		TextureDescription desc;
-		desc.width = width;
-		desc.height = height;
-		desc.format = RHIFormat::R8G8B8A8_Uint; // @TODO
-		desc.cpuAccess = CPUAccessFlagBits::None;
-		desc.initialData = pixels.data();
-		desc.usage = MemoryUsage::Default;
-		desc.mipsLevel = 4;
-		fontRessource.texture = params.device->createTexture(desc).value();
+		WOB_LOG_ERROR("failed to read font {}", path);
+		co_return file.error();
 	}
-	return { wob::move(fontRessource) };
+
+	// the mapping stays alive in this frame until the load is done
+	params.fontData = file.value().view();
+	co_return co_await loadFontRessource(scheduler, params);
 }
@@ -7,6 +7,9 @@
 #include "renderer/RHI/RHIDevice.hpp"
 #include "core/array.hpp"
 #include "core/arrayView.hpp"
+#include "core/task.hpp"
+#include "core/assetStreamer.hpp"
+#include "core/mappedFile.hpp"
 
 #include "core/vec2.hpp"
 
@@ -47,6 +50,13 @@ namespace wob
 	};
 
 	Result<FontRessource> createFontRessource(FontParams const& params);
+	// params.fontData is replaced by the mapped file pages, no copy of the ttf is made
+	Result<FontRessource> createFontRessource(MappedFile const& file, FontParams params);
+	// same as createFontRessource without stalling the frame, the atlas is packed on a worker
+	// and the texture created on the frame loop, params.fontData must stay alive until it is done
+	Task<Result<FontRessource>> loadFontRessource(TaskScheduler& scheduler, FontParams params);
+	// map the font file at path through the streamer then load it, params.fontData is ignored
+	Task<Result<FontRessource>> loadFontRessource(TaskScheduler& scheduler, AssetStreamer& streamer, const char* path, FontParams params);
 }
 
 #endif
\ No newline at end of file
@@ -43,7 +43,7 @@ void GraphicsPipeline::registerVertexUniform(String const& name, BufferDescripti
 	vertexUniformBuffers.push(UniformBindPoint{ name, wob::move(bufferVal.value()), slot });
 }
 
-void GraphicsPipeline::setVertexUniform(String const& name, void* data, uint32_t size)
+void GraphicsPipeline::setVertexUniform(StringView name, void* data, uint32_t size)
 {
 	auto bufferIt = wob::ranges::findIf(vertexUniformBuffers, [name](auto const& e) {
 			return e.name == name;
@@ -59,7 +59,7 @@ void wob::GraphicsPipeline::registerFragmentUniform(String const& name, BufferDe
 	fragmentUniformBuffers.push(UniformBindPoint{ name, wob::move(bufferVal.value()), slot });
 }
 
-void wob::GraphicsPipeline::setFragmentUniform(String const& name, void* data, uint32_t size)
+void wob::GraphicsPipeline::setFragmentUniform(StringView name, void* data, uint32_t size)
 {
 	auto bufferIt = wob::ranges::findIf(fragmentUniformBuffers, [name](auto const& e) {
 		return e.name == name;
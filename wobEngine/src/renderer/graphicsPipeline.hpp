@@ -2,6 +2,7 @@
 #define WOB_GRAPHISPIPELINE_HPP
 
 #include "core/array.hpp"
+#include "core/smallArray.hpp"
 #include "core/string.hpp"
 #include "renderer/RHI/RHIDevice.hpp"
 #include "renderer/RHI/RHIBuffer.hpp"
@@ -23,19 +24,19 @@ namespace wob
 		void buildVertexShader(VertexShaderDescription const& desc);
 
 		void registerVertexUniform(String const& name, BufferDescription bufferDesc, uint bindPoint);
-		void setVertexUniform(String const& name, void* data, uint32_t size);
+		void setVertexUniform(StringView name, void* data, uint32_t size);
 
 		template<typename T>
-		void setVertexUniform(String const& name, T val)
+		void setVertexUniform(StringView name, T val)
 		{
 			setVertexUniform(name, &val, sizeof(T));
 		}
 
 		void registerFragmentUniform(String const& name, BufferDescription bufferDesc, uint bindPoint);
-		void setFragmentUniform(String const& name, void* data, uint32_t size);
+		void setFragmentUniform(StringView name, void* data, uint32_t size);
 
 		template<typename T>
-		void setFragmentUniform(String const& name, T val)
+		void setFragmentUniform(StringView name, T val)
 		{
 			setFragmentUniform(name, &val, sizeof(T));
 		}
@@ -60,8 +61,9 @@ namespace wob
 		RHIVertexShader vertexShader;
 		RHIFragmentShader fragmentShader;
 
-		Array<UniformBindPoint> vertexUniformBuffers;
-		Array<UniformBindPoint> fragmentUniformBuffers;
+		// pipelines bind a handful of uniform buffers
+		SmallArray<UniformBindPoint, 4> vertexUniformBuffers;
+		SmallArray<UniformBindPoint, 4> fragmentUniformBuffers;
 	};
 }
  
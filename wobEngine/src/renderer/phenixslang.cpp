@@ -3,63 +3,68 @@
 using namespace wob;
 using namespace wob::phenix;
 
-static String evalASTNode(ASTNode* node);
+static void evalASTNode(ASTNode* node, StringBuilder& out);
 
-static String evalASTNode(VariableNode* var)
+static void evalASTNode(VariableNode* var, StringBuilder& out)
 {
-	return var->name;
+	out.append(var->name);
 }
 
-static String evalASTNode(LiteralNode* lit)
+static void evalASTNode(LiteralNode* lit, StringBuilder& out)
 {
 	switch (lit->ltype.type)
 	{
 	case TType::Int:
-		return format("{}", lit->i);
+		formatTo(out, "{}", lit->i);
+		return;
 
 	case TType::UInt:
-		return format("{}", lit->u);
+		formatTo(out, "{}", lit->u);
+		return;
 
 	case TType::Float:
-		return format("{}f", lit->f);
+		formatTo(out, "{}f", lit->f);
+		return;
 
 	case TType::Double:
-		return format("{}", lit->d);
+		formatTo(out, "{}", lit->d);
+		return;
 
 	case TType::Vec2:
-		return format("float2({}f, {}f)", lit->v2.x, lit->v2.y);
+		formatTo(out, "float2({}f, {}f)", lit->v2.x, lit->v2.y);
+		return;
 
 	case TType::Vec3:
-		return format("float3({}f, {}f, {}f)", lit->v3.x, lit->v3.y, lit->v3.z);
+		formatTo(out, "float3({}f, {}f, {}f)", lit->v3.x, lit->v3.y, lit->v3.z);
+		return;
 
 	case TType::Vec4:
-		return format("float4({}f, {}f, {}f, {}f)", lit->v4.x, lit->v4.y, lit->v4.z, lit->v4.w);
+		formatTo(out, "float4({}f, {}f, {}f, {}f)", lit->v4.x, lit->v4.y, lit->v4.z, lit->v4.w);
+		return;
 	}
 	WOB_UNREACHABLE();
 }
 
-static String evalASTNode(CompoundStatementNode* data)
+static void evalASTNode(CompoundStatementNode* data, StringBuilder& out)
 {
-	String out("{\n");
+	out.append("{\n");
 	for (ASTNode* node : data->statements)
 	{
-		evalASTNode(node);
+		evalASTNode(node, out);
+		out.append(";\n");
 	}
 	out.append("}\n");
-	return out;
 }
 
-static String evalASTNode(ReturnStatement* data)
+static void evalASTNode(ReturnStatement* data, StringBuilder& out)
 {
-	String out("return ");
-	out.append(evalASTNode(data->node));
-	return out;
+	out.append("return ");
+	evalASTNode(data->node, out);
 }
 
-static String evalASTNode(BinaryOpNode* exp)
+static void evalASTNode(BinaryOpNode* exp, StringBuilder& out)
 {
-	String out;
-	out.append(evalASTNode(exp->left));
+	evalASTNode(exp->left, out);
 	switch (exp->op)
 	{
 	case BinaryOp::Add:
@@ -78,24 +83,23 @@ static String evalASTNode(BinaryOpNode* exp)
 		out.append(" = ");
 		break;
 	}
-	out.append(evalASTNode(exp->right));
-	return out;
+	evalASTNode(exp->right, out);
 }
 
-static String evalASTNode(ASTNode* node)
+static void evalASTNode(ASTNode* node, StringBuilder& out)
 {
 	switch (node->type)
 	{
 	case ASTNodeType::Literal:
-		return evalASTNode((LiteralNode*)node);
+		return evalASTNode((LiteralNode*)node, out);
 	case ASTNodeType::VarDecl:
-		return evalASTNode((VariableNode*)node);
+		return evalASTNode((VariableNode*)node, out);
 	case ASTNodeType::ReturnStatement:
-		return evalASTNode((ReturnStatement*)node);
+		return evalASTNode((ReturnStatement*)node, out);
 	case ASTNodeType::CompoundStatement:
-		return evalASTNode((CompoundStatementNode*)node);
+		return evalASTNode((CompoundStatementNode*)node, out);
 	case ASTNodeType::BinOp:
-		return evalASTNode((BinaryOpNode*)node);
+		return evalASTNode((BinaryOpNode*)node, out);
 	}
 	WOB_UNREACHABLE();
 }
@@ -145,7 +149,9 @@ static const char* getHLSLAttributeName(AttributeType type)
 
 String wob::phenix::compileToHLSL(ShaderProgram const& program)
 {
-	String out;
+	// most shaders fit here, the output String is the only allocation
+	char storage[4_kb];
+	StringBuilder out(storage);
 	for (auto const& str : program.structDecl)
 	{
 		out.append("struct ");
@@ -157,19 +163,15 @@ String wob::phenix::compileToHLSL(ShaderProgram const& program)
 			out.append(getHLSLTypeName(member.type));
 			out.append(' ');
 			out.append(member.name);
-			String attrs;
 			for (auto const& attr : member.attributes)
 			{
 				if (attr.type == AttributeType::Color || attr.type == AttributeType::Position)
 				{
-					attrs.append(' ');
-					attrs.append(getHLSLAttributeName(attr.type));
+					out.append(" : ");
+					out.append(getHLSLAttributeName(attr.type));
 					break;
 				}
 			}
-			if (!attrs.empty())
-				out.append(" :");
-			out.append(wob::move(attrs));
 			out.append(";\n");
 		}
 		out.append("}\n\n");
@@ -194,10 +196,10 @@ String wob::phenix::compileToHLSL(ShaderProgram const& program)
 		for (auto const& data : fn.body.statements)
 		{
 			out.append("\t");
-			out.append(evalASTNode(data));
+			evalASTNode(data, out);
 			out.append(";\n");
 		}
 		out.append("}\n");
 	}
-	return out;
+	return out.toString();
 }
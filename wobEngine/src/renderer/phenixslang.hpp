@@ -3,7 +3,9 @@
 
 #include "core/wob.hpp"
 #include "core/array.hpp"
+#include "core/smallArray.hpp"
 #include "core/uniquePtr.hpp"
+#include "core/poolAllocator.hpp"
 #include "core/string.hpp"
 #include "core/vec2.hpp"
 #include "core/vec3.hpp"
@@ -11,8 +13,6 @@
 #include "core/format.hpp"
 #include "core/stringView.hpp"
 
-#include <ctype.h>
-
 namespace wob::phenix
 {
 	// front
@@ -80,7 +80,7 @@ namespace wob::phenix
 		};
 	};
 
-	void Pair::print() const
+	inline void Pair::print() const
 	{
 		printf("Pair : \n");
 		car->print();
@@ -90,11 +90,14 @@ namespace wob::phenix
 
 	struct PhenixFront
 	{
+		static constexpr CharClass whitespaceChars = CharClass::whitespace();
+		static constexpr CharClass atomChars = CharClass::alnum();
+
 		int c = 0;
 		StringView source;
-		StackAllocator parserAllocator;
+		PoolAllocator<Sexp> parserAllocator;
 
-		PhenixFront(StringView src) : source(src), parserAllocator(*context.allocator, 32_kb)
+		PhenixFront(StringView src) : source(src), parserAllocator(*context.allocator)
 		{
 
 		}
@@ -130,12 +133,7 @@ namespace wob::phenix
 
 		Sexp* parse()
 		{
-			if (c == source.size())
-				return nullptr;
-			while (isspace(source[c]) && c < source.size())
-			{
-				c++;
-			}
+			c = (int)source.skipWhile(whitespaceChars, c);
 			if (c == source.size())
 				return nullptr;
 
@@ -149,16 +147,11 @@ namespace wob::phenix
 				c++;
 				return parseList();
 			}
-			else if (isalnum(source[c]))
+			else if (atomChars.contains(source[c]))
 			{
-				// parse atom
-				// get atom value
 				int const wordStart = c;
-				while (isalnum(source[c++]) && c < source.size())
-				{
-				}
-				int const wordLen = c - wordStart;
-				return createAtom(StringView(&source[wordStart], wordLen - 1));
+				c = (int)source.skipWhile(atomChars, c);
+				return createAtom(StringView(&source[wordStart], c - wordStart));
 			}
 			return nullptr;
 		}
@@ -321,7 +314,7 @@ namespace wob::phenix
 		String name;
 	};
 
-	AttributeType stringToAttributeType(StringView str)
+	inline AttributeType stringToAttributeType(StringView str)
 	{
 		WOB_ASSERT(!str.empty());
 
@@ -337,7 +330,8 @@ namespace wob::phenix
 	{
 		Type type;
 		String name;
-		Array<Attribute> attributes;
+		// semantics, zero or one per variable most of the time
+		SmallArray<Attribute, 2> attributes;
 	};
 
 	struct StructDecl
@@ -367,7 +361,7 @@ namespace wob::phenix
 	};
 
 	// assuming that list is a list of at least index items 
-	bool assumeListElem(Sexp* list, StringView value)
+	inline bool assumeListElem(Sexp* list, StringView value)
 	{
 		return list->pair.car->type == Sexp::Type::Atom && list->pair.car->atom.value == value;
 	}
@@ -418,7 +412,7 @@ namespace wob::phenix
 			)
 	*/
 
-	VarDecl parseField(Sexp* exp)
+	inline VarDecl parseField(Sexp* exp)
 	{
 		SexpWalker walker(exp);
 		VarDecl decl;
@@ -428,7 +422,7 @@ namespace wob::phenix
 		return decl;
 	}
 
-	ShaderProgram createShaderProgram(Sexp* exp)
+	inline ShaderProgram createShaderProgram(Sexp* exp)
 	{
 		ShaderProgram shader;
 
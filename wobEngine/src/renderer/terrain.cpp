@@ -3,10 +3,21 @@
 
 using namespace wob;
 
-void Terrain::init()
+Task<> Terrain::init(TaskScheduler& scheduler, AssetStreamer& streamer, const char* heightmapPath)
 {
+	// decoded straight from the file pages
+	Result<MappedFile> file = co_await streamer.map(heightmapPath, StreamPriority::Low);
+	if (!file)
+	{
+		WOB_LOG_ERROR("failed to load the heightmap {}", heightmapPath);
+		co_return;
+	}
+
+	co_await scheduler.resumeOnWorker();
 	qoi_desc desc;
-	void* imageData = qoi_read(R"(C:\Users\grego\source\repos\AESengine\wobEngine\assets\textures\heightmap.qoi)", &desc, 0);
+	void* imageData = qoi_decode(file.value().data(), (int)file.value().size(), &desc, 0);
+	co_await scheduler.nextFrame();
+
 	TextureDescription textureDesc;
 	textureDesc.cpuAccess = CPUAccessFlagBits::Write;
 	textureDesc.width = desc.width;
@@ -4,6 +4,8 @@
 #include "graphicsPipeline.hpp"
 #include "RHI/RHIBuffer.hpp"
 #include "RHI/RHITexture.hpp"
+#include "core/task.hpp"
+#include "core/assetStreamer.hpp"
 
 namespace wob
 {
@@ -11,7 +13,8 @@ namespace wob
 	{
 	public:
 
-		void init();
+		// the heightmap is streamed and decoded on a worker, the rest runs on the frame loop
+		Task<> init(TaskScheduler& scheduler, AssetStreamer& streamer, const char* heightmapPath);
 
 	private:
 		uint32_t height, width;
@@ -175,13 +175,18 @@ void* BSPTree::Node::raycast(Ray const& r) const
 }
 
 UniquePtr<BSPTree::BSPElement> BSPTree::build(IAllocator& allocator, wob::ArrayView<Object> objects, uint depth)
+{
+	return build(allocator, allocator, objects, depth);
+}
+
+UniquePtr<BSPTree::BSPElement> BSPTree::build(IAllocator& allocator, IAllocator& elementAllocator, wob::ArrayView<Object> objects, uint depth)
 {
 	WOB_PROFILE_FUNCTION();
 	if (objects.empty())
 		return nullptr;
 
 	if (depth > maxDepth || objects.size() <= minLeafSize)
-		return makeUnique<Leaf>(allocator, Array<Object>(allocator, objects));
+		return makeUnique<Leaf>(elementAllocator, Array<Object>(allocator, objects));
 
 	Plane const splitPlane = pickSplittingPlane(objects);
 
@@ -206,7 +211,7 @@ UniquePtr<BSPTree::BSPElement> BSPTree::build(IAllocator& allocator, wob::ArrayV
 		}
 	}
 	
-	return makeUnique<Node>(allocator, splitPlane,
-		build(allocator, wob::ArrayView(frontList.begin(), frontList.end()), depth + 1),
-		build(allocator, wob::ArrayView(backList.begin(), backList.end()), depth + 1));
+	return makeUnique<Node>(elementAllocator, splitPlane,
+		build(allocator, elementAllocator, wob::ArrayView(frontList.begin(), frontList.end()), depth + 1),
+		build(allocator, elementAllocator, wob::ArrayView(backList.begin(), backList.end()), depth + 1));
 }
@@ -6,6 +6,7 @@
 #include "core/uniquePtr.hpp"
 #include "core/array.hpp"
 #include "core/arrayView.hpp"
+#include "core/poolAllocator.hpp"
 
 namespace wob
 {
@@ -62,8 +63,21 @@ namespace wob
 
 		static constexpr uint maxDepth = 16;
 		static constexpr uint minLeafSize = 2;
-		
+
+		// blocks fitting both a Leaf and a Node
+		class ElementPool final : public FixedBlockAllocator
+		{
+		public:
+			explicit ElementPool(IAllocator& base, uint32_t blocksPerChunk = 256) noexcept
+				: FixedBlockAllocator(base, max(sizeof(Leaf), sizeof(Node)), max(alignof(Leaf), alignof(Node)), blocksPerChunk)
+			{
+
+			}
+		};
+
 		static UniquePtr<BSPElement> build(IAllocator& allocator, wob::ArrayView<Object> objects, uint depth = 0);
+		// tree elements come from elementAllocator (typically an ElementPool), object arrays from allocator
+		static UniquePtr<BSPElement> build(IAllocator& allocator, IAllocator& elementAllocator, wob::ArrayView<Object> objects, uint depth = 0);
 	};
 }
 
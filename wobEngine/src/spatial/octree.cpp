@@ -11,7 +11,7 @@ Octree::Node* Octree::build(vec3 const& center, float halfSize, int stopDepth, L
 	
 	if (stopDepth < 0)
 		return nullptr;
-	nodes.add(locCode, Node{ center, halfSize, locCode, {}, false });
+	nodes.add(locCode, Node{ center, halfSize, locCode, {}, {}, false });
 	auto& val = nodes[locCode];
 
 	if (stopDepth == 0)
@@ -59,6 +59,7 @@ void Octree::insertObject(Node& tree, Object const& obj)
 
 	if (!straddle && !tree.isLeaf) {
 		// Fully contained in existing child node; insert in that subtree
+		tree.occupiedChildren.set(index);
 		insertObject(nodes[getChildCode(tree.locCode, index)], obj);
 	}
 	else {
@@ -125,13 +126,12 @@ void Octree::testAllCollisionsRec(Node const& node, void(* callback)(void*), uin
 		}
 	}
 
-	// Recursively visit all existing children
-	for (uint i = 0; i < 8; i++)
+	// Recursively visit the children holding objects, empty subtrees can't collide
+	for (uint32_t i : node.occupiedChildren)
 	{
-		Node val;
-		if (nodes.tryFind(getChildCode(node.locCode, i), val))
+		if (Node const* child = nodes.find(getChildCode(node.locCode, i)))
 		{
-			testAllCollisionsRec(val, callback, depth, ancestorStack);
+			testAllCollisionsRec(*child, callback, depth, ancestorStack);
 		}
 	}
 	depth--;
@@ -141,18 +141,12 @@ Octree::Node* Octree::root()
 {
 	WOB_PROFILE_FUNCTION();
 
-	Node val;
-	if (nodes.tryFind(1, val))
-		return &val;
-	return nullptr;
+	return nodes.find(1);
 }
 
 Octree::Node const* Octree::root() const
 {
 	WOB_PROFILE_FUNCTION();
 
-	Node val;
-	if (nodes.tryFind(1, val))
-		return &val;
-	return nullptr;
+	return nodes.find(1);
 }
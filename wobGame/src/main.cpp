@@ -1,6 +1,7 @@
 #include "core/wob.hpp"
 #include "core/debug.hpp"
 #include "core/uniquePtr.hpp"
+#include "core/memoryProfiler.hpp"
 
 #include "renderer/phenixslang.hpp"
 #include "lang/sbl.hpp"
@@ -36,11 +37,14 @@ int main()
 	)
 	)";
 
-	SBLLexer lexer(base3dShaderfs);
-	SBLParser sbl;
-	Node n = lexer.parse();
-	auto decl = sbl.parseStatement(n);
-	volatile int o = 0;
+	{
+		WOB_MEMORY_SCOPE(MemoryTag::Lang);
+		SBLLexer lexer(base3dShaderfs);
+		SBLParser sbl;
+		Node n = lexer.parse();
+		auto decl = sbl.parseStatement(n);
+		volatile int o = 0;
+	}
 	//const char* source = 
 	//R"((defstruct VSinput 
 	//	(vec2 position POSITION) 
@@ -96,6 +100,8 @@ int main()
 
 	//String generated = phenix::compileToHLSL(program);
 	//WOB_LOG("code generated\n{}", generated.c_str());
-	
+
+	// everything allocated above is freed, the sink is still alive to report leaks
+	WOB_MEMORY_DUMP_LEAKS();
 	return 0;
 }
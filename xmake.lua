@@ -18,6 +18,17 @@ if is_plat("vita") then
 	set_toolchains("vitasdk-clang")
 end
 
+-- xmake f --profiling=y to compile the WOB_PROFILE_* macros in
+option("profiling")
+	set_default(false)
+	set_showmenu(true)
+	set_description("Enable the instrumenting CPU profiler")
+option_end()
+
+if has_config("profiling") then
+	add_defines("WOB_ENABLE_PROFILING")
+end
+
 if is_mode("debug") then
 	add_defines("_DEBUG", "WOB_DEBUG")
 	set_symbols("debug")